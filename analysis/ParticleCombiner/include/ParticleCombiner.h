@@ -12,6 +12,7 @@
 #include <analysis/dataobjects/Particle.h>
 #include <analysis/VariableManager/Utility.h>
 #include <analysis/DecayDescriptor/DecayDescriptor.h>
+#include <analysis/utility/ParticleListKinematics.h>
 
 #include <framework/datastore/StoreArray.h>
 #include <framework/datastore/StoreObjPtr.h>
@@ -138,7 +139,9 @@ namespace Belle2 {
     explicit ParticleGenerator(const DecayDescriptor& decaydescriptor, const std::string& cutParameter = "");
 
     /**
-     * Initialises the generator to produce the given type of sublist
+     * Initialises the generator to produce the given type of sublist.
+     * Has to be called once per event before loadNext() as it also takes a
+     * snapshot of the kinematics of all particles in the input lists.
      */
     void init();
 
@@ -183,6 +186,21 @@ namespace Belle2 {
      */
     Particle createCurrentParticle() const;
 
+    /**
+     * Select the sub lists to combine and restart the index generator for them
+     *
+     * @param types sub list to use for each input list
+     * @param useAntiParticle use the anti-particle lists for flavor-specific sub lists
+     */
+    void initSubLists(const std::vector<ParticleList::EParticleType>& types, bool useAntiParticle);
+
+    /**
+     * Set the indices of the current index combination and check if it results in a valid particle
+     *
+     * @return true if the combination passes all checks
+     */
+    bool loadCurrentCombination();
+
     /**
      * Loads the next combination. Returns false if there is no next combination
      */
@@ -264,7 +282,8 @@ namespace Belle2 {
     m_particleIndexGenerator; /**< particleIndexGenerator makes the combinations of indices stored in the sublists of the ParticleLists */
 
     const StoreArray<Particle> m_particleArray; /**< Global list of particles. */
-    std::vector<Particle*> m_particles; /**< Pointers to the particle objects of the current combination */
+    std::vector<ParticleListKinematics> m_kinematics; /**< Kinematics of the particles in the input lists, filled in init() */
+    std::vector<const ParticleListKinematics::Columns*> m_columns; /**< Kinematics of the sub lists used in the current combination */
     std::vector<int> m_indices;         /**< Indices stored in the ParticleLists of the current combination */
     std::unordered_set<std::set<int>> m_usedCombinations; /**< already used combinations (as sets of indices or unique IDs). */
 
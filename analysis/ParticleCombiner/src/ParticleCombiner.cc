@@ -222,7 +222,10 @@ namespace Belle2 {
     m_listIndexGenerator.init(m_numberOfLists); // ListIndexGenerator must be initialised here!
     m_usedCombinations.clear();
     m_indices.resize(m_numberOfLists);
-    m_particles.resize(m_numberOfLists);
+    m_columns.assign(m_numberOfLists, nullptr);
+    m_kinematics.resize(m_numberOfLists);
+    for (unsigned int i = 0; i < m_numberOfLists; ++i)
+      m_kinematics[i].fill(*m_plists[i]);
 
     if (m_inputListsCollide)
       initIndicesToUniqueIDMap();
@@ -344,11 +347,7 @@ namespace Belle2 {
       else ++m_iParticleType;
 
       if (m_iParticleType == 2) {
-        std::vector<unsigned int> sizes(m_numberOfLists);
-        for (unsigned int i = 0; i < m_numberOfLists; ++i) {
-          sizes[i] = m_plists[i]->getList(ParticleList::c_SelfConjugatedParticle, false).size();
-        }
-        m_particleIndexGenerator.init(sizes);
+        initSubLists(std::vector<ParticleList::EParticleType>(m_numberOfLists, ParticleList::c_SelfConjugatedParticle), false);
       } else {
         m_listIndexGenerator.init(m_numberOfLists);
       }
@@ -356,43 +355,48 @@ namespace Belle2 {
     }
   }
 
-  bool ParticleGenerator::loadNextParticle(bool useAntiParticle)
+  void ParticleGenerator::initSubLists(const std::vector<ParticleList::EParticleType>& types, bool useAntiParticle)
   {
-    while (true) {
+    std::vector<unsigned int> sizes(m_numberOfLists);
+    for (unsigned int i = 0; i < m_numberOfLists; ++i) {
+      m_columns[i] = &m_kinematics[i].getColumns(types[i], types[i] == ParticleList::c_FlavorSpecificParticle ? useAntiParticle : false);
+      sizes[i] = m_columns[i]->size();
+    }
+    m_particleIndexGenerator.init(sizes);
+  }
 
-      // Load next index combination if available
-      if (m_particleIndexGenerator.loadNext()) {
+  bool ParticleGenerator::loadCurrentCombination()
+  {
+    const auto& indices = m_particleIndexGenerator.getCurrentIndices();
+    for (unsigned int i = 0; i < m_numberOfLists; i++) {
+      m_indices[i] = m_columns[i]->index[ indices[i] ];
+    }
 
-        const auto& m_types = m_listIndexGenerator.getCurrentIndices();
-        const auto& indices = m_particleIndexGenerator.getCurrentIndices();
+    if (not currentCombinationHasDifferentSources()) return false;
 
-        for (unsigned int i = 0; i < m_numberOfLists; i++) {
-          const auto& list = m_plists[i]->getList(m_types[i], m_types[i] == ParticleList::c_FlavorSpecificParticle ? useAntiParticle : false);
-          m_indices[i] =  list[ indices[i] ];
-          m_particles[i] = m_particleArray[ m_indices[i] ];
-        }
+    m_current_particle = createCurrentParticle();
+    if (!m_cut->check(&m_current_particle)) return false;
 
-        if (not currentCombinationHasDifferentSources()) continue;
+    if (not currentCombinationIsUnique()) return false;
 
-        m_current_particle = createCurrentParticle();
-        if (!m_cut->check(&m_current_particle))
-          continue;
+    if (not currentCombinationIsECLCRUnique()) return false;
 
-        if (not currentCombinationIsUnique()) continue;
+    return true;
+  }
 
-        if (not currentCombinationIsECLCRUnique()) continue;
+  bool ParticleGenerator::loadNextParticle(bool useAntiParticle)
+  {
+    while (true) {
 
-        return true;
+      // Load next index combination if available
+      if (m_particleIndexGenerator.loadNext()) {
+        if (loadCurrentCombination()) return true;
+        continue;
       }
 
       // Load next list combination if available and reset indexCombiner
       if (m_listIndexGenerator.loadNext()) {
-        const auto& m_types = m_listIndexGenerator.getCurrentIndices();
-        std::vector<unsigned int> sizes(m_numberOfLists);
-        for (unsigned int i = 0; i < m_numberOfLists; ++i) {
-          sizes[i] = m_plists[i]->getList(m_types[i], m_types[i] == ParticleList::c_FlavorSpecificParticle ? useAntiParticle : false).size();
-        }
-        m_particleIndexGenerator.init(sizes);
+        initSubLists(m_listIndexGenerator.getCurrentIndices(), useAntiParticle);
         continue;
       }
       return false;
@@ -402,34 +406,11 @@ namespace Belle2 {
 
   bool ParticleGenerator::loadNextSelfConjugatedParticle()
   {
-    while (true) {
-
-      // Load next index combination if available
-      if (m_particleIndexGenerator.loadNext()) {
-
-        const auto& indices = m_particleIndexGenerator.getCurrentIndices();
-
-        for (unsigned int i = 0; i < m_numberOfLists; i++) {
-          m_indices[i] = m_plists[i]->getList(ParticleList::c_SelfConjugatedParticle, false) [ indices[i] ];
-          m_particles[i] = m_particleArray[ m_indices[i] ];
-        }
-
-        if (not currentCombinationHasDifferentSources()) continue;
-
-        m_current_particle = createCurrentParticle();
-        if (!m_cut->check(&m_current_particle))
-          continue;
-
-        if (not currentCombinationIsUnique()) continue;
-
-        if (not currentCombinationIsECLCRUnique()) continue;
-
-        return true;
-      }
-
-      return false;
+    // the self-conjugated sub lists have been selected in loadNext()
+    while (m_particleIndexGenerator.loadNext()) {
+      if (loadCurrentCombination()) return true;
     }
-
+    return false;
   }
 
   Particle ParticleGenerator::createCurrentParticle() const
@@ -438,11 +419,14 @@ namespace Belle2 {
     double py = 0;
     double pz = 0;
     double E = 0;
-    for (const Particle* d : m_particles) {
-      px += d->getPx();
-      py += d->getPy();
-      pz += d->getPz();
-      E += d->getEnergy();
+    const auto& indices = m_particleIndexGenerator.getCurrentIndices();
+    for (unsigned int i = 0; i < m_numberOfLists; i++) {
+      const ParticleListKinematics::Columns& columns = *m_columns[i];
+      const unsigned int j = indices[i];
+      px += columns.px[j];
+      py += columns.py[j];
+      pz += columns.pz[j];
+      E += columns.energy[j];
     }
     const ROOT::Math::PxPyPzEVector vec(px, py, pz, E);
 
@@ -469,10 +453,28 @@ namespace Belle2 {
 
   bool ParticleGenerator::currentCombinationHasDifferentSources()
   {
-    std::vector<Particle*> stack = m_particles;
-    static std::vector<int> sources; // stack for particle sources
+    static thread_local std::vector<Particle*> stack;
+    static thread_local std::vector<int> sources; // stack for particle sources
+    stack.clear();
     sources.clear();
 
+    // final state daughters can be checked directly from the list kinematics,
+    // only composite daughters have to be unpacked
+    const auto& indices = m_particleIndexGenerator.getCurrentIndices();
+    for (unsigned int i = 0; i < m_numberOfLists; i++) {
+      const ParticleListKinematics::Columns& columns = *m_columns[i];
+      const unsigned int j = indices[i];
+      if (columns.finalState[j]) {
+        const int source = columns.mdstSource[j];
+        for (int k : sources) {
+          if (source == k) return false;
+        }
+        sources.push_back(source);
+      } else {
+        stack.push_back(m_particleArray[m_indices[i]]);
+      }
+    }
+
     // recursively check all daughters and daughters of daughters
     while (!stack.empty()) {
       Particle* p = stack.back();
@@ -518,9 +520,11 @@ namespace Belle2 {
   bool ParticleGenerator::currentCombinationIsECLCRUnique()
   {
     unsigned nECLSource = 0;
-    std::vector<Particle*> stack = m_particles;
-    static std::vector<int> connectedregions;
-    static std::vector<ECLCluster::EHypothesisBit> hypotheses;
+    std::vector<Particle*> stack;
+    stack.reserve(m_numberOfLists);
+    for (int index : m_indices) stack.push_back(m_particleArray[index]);
+    static thread_local std::vector<int> connectedregions;
+    static thread_local std::vector<ECLCluster::EHypothesisBit> hypotheses;
     connectedregions.clear();
     hypotheses.clear();
 
@@ -0,0 +1,101 @@
+/**************************************************************************
+ * basf2 (Belle II Analysis Software Framework)                           *
+ * Author: The Belle II Collaboration                                     *
+ *                                                                        *
+ * See git log for contributors and copyright holders.                    *
+ * This file is licensed under LGPL-3.0, see LICENSE.md.                  *
+ **************************************************************************/
+#pragma once
+
+#include <analysis/VariableManager/Manager.h>
+
+#include <vector>
+
+namespace Belle2 {
+  class Particle;
+  class ParticleList;
+
+  namespace Variable {
+    /** Evaluate a fixed list of variables for many particles at once into typed columns.
+     *
+     * The variables are resolved by the caller once, evaluation then goes
+     * through the list column by column: variables with a plain function (see
+     * Manager::Var::doubleFunction) are called directly, all others through
+     * their std::function with the result converted to the registered type.
+     *
+     * Variables of type double are stored in double columns, int and bool
+     * variables in int columns. The buffers are kept between calls so once
+     * the largest number of particles has been seen no memory is allocated.
+     *
+     * Example:
+        \code
+        ColumnEvaluator columns(Manager::Instance().getVariables({"p", "charge", "isSignal"}));
+        columns.evaluate(*particleList);
+        const double* p = columns.getDoubleColumn(0);
+        const int* charge = columns.getIntColumn(1);
+        \endcode
+     */
+    class ColumnEvaluator {
+    public:
+      /** Prepare the columns for the given variables, they all have to be valid */
+      explicit ColumnEvaluator(const std::vector<const Manager::Var*>& variables);
+
+      /** Evaluate all variables for all particles in the list */
+      void evaluate(const ParticleList& list);
+      /** Evaluate all variables for the given particles which may be nullptr for event based variables */
+      void evaluate(const std::vector<const Particle*>& particles);
+
+      /** Number of variables */
+      unsigned int getNumberOfVariables() const { return m_columns.size(); }
+      /** Number of particles evaluated in the last call to evaluate() */
+      unsigned int getNumberOfRows() const { return m_nRows; }
+      /** Registered type of the given variable */
+      Manager::VariableDataType getType(unsigned int variable) const { return m_columns[variable].var->variabletype; }
+      /** Values of a variable of type double for all particles, nullptr if it has another type */
+      const double* getDoubleColumn(unsigned int variable) const
+      {
+        const Column& column = m_columns[variable];
+        return column.var->variabletype == Manager::VariableDataType::c_double ? m_doubles.data() + column.offset * m_nRows : nullptr;
+      }
+      /** Values of a variable of type int or bool for all particles, nullptr if it is of type double */
+      const int* getIntColumn(unsigned int variable) const
+      {
+        const Column& column = m_columns[variable];
+        return column.var->variabletype != Manager::VariableDataType::c_double ? m_ints.data() + column.offset * m_nRows : nullptr;
+      }
+      /** Value of a variable for one particle converted to double */
+      double getValue(unsigned int variable, unsigned int row) const
+      {
+        if (const double* values = getDoubleColumn(variable)) return values[row];
+        return getIntColumn(variable)[row];
+      }
+
+    private:
+      /** One variable and where its values are stored */
+      struct Column {
+        const Manager::Var* var; /**< the variable */
+        unsigned int offset; /**< index of the column among all columns of the same storage type */
+        bool warned; /**< whether we already warned about a mismatched return type */
+      };
+      /** Evaluate one variable for all particles in m_particles */
+      void evaluateColumn(Column& column);
+      /** Get the value of type T from a variable result, converting it with a warning if it has another type */
+      template<class T> T convert(Column& column, const Manager::VarVariant& value);
+
+      /** The variables to evaluate */
+      std::vector<Column> m_columns;
+      /** Number of double columns */
+      unsigned int m_nDoubleColumns{0};
+      /** Number of int and bool columns */
+      unsigned int m_nIntColumns{0};
+      /** Particles of the last evaluation */
+      std::vector<const Particle*> m_particles;
+      /** Number of particles of the last evaluation */
+      unsigned int m_nRows{0};
+      /** Values of all double columns, one after the other */
+      std::vector<double> m_doubles;
+      /** Values of all int and bool columns, one after the other */
+      std::vector<int> m_ints;
+    };
+  }
+}
@@ -14,7 +14,9 @@
 #include <map>
 #include <vector>
 #include <functional>
+#include <cstdint>
 #include <memory>
+#include <mutex>
 #include <variant>
 
 namespace Belle2 {
@@ -110,6 +112,12 @@ namespace Belle2 {
       typedef std::function<VarVariant(const Particle*, const std::vector<double>&)> ParameterFunctionPtr;
       /** meta functions stored take a const std::vector<std::string>& and return a FunctionPtr. */
       typedef std::function<FunctionPtr(const std::vector<std::string>&)> MetaFunctionPtr;
+      /** plain function returning a double, see Var::doubleFunction. */
+      typedef double (*DoubleFunction)(const Particle*);
+      /** plain function returning an int, see Var::intFunction. */
+      typedef int (*IntFunction)(const Particle*);
+      /** plain function returning a bool, see Var::boolFunction. */
+      typedef bool (*BoolFunction)(const Particle*);
       /** Typedef for the cut, that we use Particles as our base objects. */
       typedef Particle Object;
 
@@ -140,10 +148,21 @@ namespace Belle2 {
       /** A variable returning a floating-point value for a given Particle. */
       struct Var : public VarBase {
         FunctionPtr function; /**< Pointer to function. */
+        /** The plain function returning a double if the variable is one, nullptr otherwise.
+         * Callers evaluating many particles can use it to skip the std::function and VarVariant. */
+        DoubleFunction doubleFunction{nullptr};
+        /** The plain function returning an int if the variable is one, nullptr otherwise. */
+        IntFunction intFunction{nullptr};
+        /** The plain function returning a bool if the variable is one, nullptr otherwise. */
+        BoolFunction boolFunction{nullptr};
         /** ctor */
         Var(const std::string& n, FunctionPtr f, const std::string& d, const std::string& g = "",
             const VariableDataType& v = VariableDataType::c_double)
-          : VarBase(n, d, g, v), function(f) { }
+          : VarBase(n, d, g, v), function(f) { resolvePlainFunction(); }
+      private:
+        /** Unwrap the plain function matching the registered type if function is just a (possibly
+         * doubly) wrapped plain function, as for all variables registered with REGISTER_VARIABLE. */
+        void resolvePlainFunction();
       };
 
       /** A variable taking additional floating-point arguments to influence the behaviour. */
@@ -164,6 +183,14 @@ namespace Belle2 {
           : VarBase(n, d, g, v), function(f) { }
       };
 
+      /** Number of cache hits and misses of a cached variable, see enableCache(). */
+      struct CacheStatistics {
+        std::string name; /**< Name of the cached variable. */
+        uint64_t hits{0}; /**< Number of values taken from the cache. */
+        uint64_t misses{0}; /**< Number of values calculated and added to the cache. */
+        uint64_t uncached{0}; /**< Number of values calculated without cache, for particles not in a StoreArray or without event. */
+      };
+
       /** get singleton instance. */
       static Manager& Instance();
 
@@ -261,6 +288,32 @@ namespace Belle2 {
        */
       std::vector<double> evaluateVariables(const std::vector<std::string>& varNames, const ParticleList* plist);
 
+      /** Enable caching of the values of the given variable.
+       *
+       * Once enabled, the value of the variable is only calculated once for
+       * each particle (identified by its index in the StoreArray) per event
+       * and taken from the cache for all further uses, also in later modules,
+       * for example in a cut, VariablesToExtraInfo and the ntuple writer. The
+       * cache is discarded at the end of each event and after modules with
+       * the Module::c_ModifiesObjectsInPlace flag, like vertex fits or
+       * momentum updaters, see DataStore::getCacheGeneration().
+       *
+       * This is only correct for variables which depend on nothing but the
+       * particle and the event, so it has to be enabled explicitly for each
+       * variable. It has to be enabled before processing starts; the cached
+       * values are kept separately for each thread. Hits and misses are
+       * added to the ModuleStatistics of the module using the variable.
+       *
+       * Return true if the variable exists and is cached.
+       */
+      bool enableCache(const std::string& name);
+
+      /** Return the hit and miss counts of all cached variables in this process. */
+      std::vector<CacheStatistics> getCacheStatistics() const;
+
+      /** Print the hit and miss counts of all cached variables in this process. */
+      void printCacheStatistics() const;
+
       /** Return list of all variable names (in order registered). */
       std::vector<std::string> getNames() const;
 
@@ -304,6 +357,14 @@ namespace Belle2 {
       std::map<std::string, std::shared_ptr<MetaVar>> m_meta_variables;
       /** List of deprecated variables. */
       std::map<std::string, std::pair<bool, std::string>> m_deprecated;
+      /** Values and statistics of a cached variable, see enableCache(). */
+      class VariableCache;
+      /** Caches of the cached variables by name. */
+      std::map<std::string, std::shared_ptr<VariableCache>> m_caches;
+
+      /** Protects the maps above. Variables are created lazily by getVariable(), also during event processing
+       * of multiple threads (e.g. in meta variables). Recursive as creating a meta variable looks up its arguments. */
+      std::recursive_mutex m_mutex;
     };
 
     /** Internal class that registers a variable with Manager when constructed. */
@@ -0,0 +1,85 @@
+/**************************************************************************
+ * basf2 (Belle II Analysis Software Framework)                           *
+ * Author: The Belle II Collaboration                                     *
+ *                                                                        *
+ * See git log for contributors and copyright holders.                    *
+ * This file is licensed under LGPL-3.0, see LICENSE.md.                  *
+ **************************************************************************/
+
+#include <analysis/VariableManager/ColumnEvaluator.h>
+#include <analysis/dataobjects/ParticleList.h>
+
+#include <framework/logging/Logger.h>
+
+using namespace Belle2;
+using namespace Belle2::Variable;
+
+ColumnEvaluator::ColumnEvaluator(const std::vector<const Manager::Var*>& variables)
+{
+  m_columns.reserve(variables.size());
+  for (const Manager::Var* var : variables) {
+    if (!var) B2FATAL("ColumnEvaluator: cannot evaluate an unknown variable");
+    const bool isDouble = var->variabletype == Manager::VariableDataType::c_double;
+    m_columns.push_back({var, isDouble ? m_nDoubleColumns++ : m_nIntColumns++, false});
+  }
+}
+
+void ColumnEvaluator::evaluate(const ParticleList& list)
+{
+  const unsigned int size = list.getListSize();
+  m_particles.resize(size);
+  for (unsigned int i = 0; i < size; ++i) m_particles[i] = list.getParticle(i);
+  m_nRows = size;
+  m_doubles.resize(m_nDoubleColumns * m_nRows);
+  m_ints.resize(m_nIntColumns * m_nRows);
+  for (Column& column : m_columns) evaluateColumn(column);
+}
+
+void ColumnEvaluator::evaluate(const std::vector<const Particle*>& particles)
+{
+  m_particles.assign(particles.begin(), particles.end());
+  m_nRows = particles.size();
+  m_doubles.resize(m_nDoubleColumns * m_nRows);
+  m_ints.resize(m_nIntColumns * m_nRows);
+  for (Column& column : m_columns) evaluateColumn(column);
+}
+
+template<class T> T ColumnEvaluator::convert(Column& column, const Manager::VarVariant& value)
+{
+  if (const T* result = std::get_if<T>(&value)) return *result;
+  if (!column.warned) {
+    B2WARNING("Wrong registered data type for variable, values are converted to the registered type"
+              << LogVar("variable", column.var->name) << LogVar("registered type", column.var->variabletype));
+    column.warned = true;
+  }
+  return std::visit([](auto x) { return static_cast<T>(x); }, value);
+}
+
+void ColumnEvaluator::evaluateColumn(Column& column)
+{
+  const Manager::Var& var = *column.var;
+  const Particle* const* particles = m_particles.data();
+  const unsigned int n = m_nRows;
+  if (var.variabletype == Manager::VariableDataType::c_double) {
+    double* values = m_doubles.data() + column.offset * n;
+    if (var.doubleFunction) {
+      for (unsigned int i = 0; i < n; ++i) values[i] = var.doubleFunction(particles[i]);
+    } else {
+      for (unsigned int i = 0; i < n; ++i) values[i] = convert<double>(column, var.function(particles[i]));
+    }
+  } else if (var.variabletype == Manager::VariableDataType::c_int) {
+    int* values = m_ints.data() + column.offset * n;
+    if (var.intFunction) {
+      for (unsigned int i = 0; i < n; ++i) values[i] = var.intFunction(particles[i]);
+    } else {
+      for (unsigned int i = 0; i < n; ++i) values[i] = convert<int>(column, var.function(particles[i]));
+    }
+  } else {
+    int* values = m_ints.data() + column.offset * n;
+    if (var.boolFunction) {
+      for (unsigned int i = 0; i < n; ++i) values[i] = var.boolFunction(particles[i]);
+    } else {
+      for (unsigned int i = 0; i < n; ++i) values[i] = convert<bool>(column, var.function(particles[i]));
+    }
+  }
+}
@@ -7,21 +7,176 @@
  **************************************************************************/
 
 #include <analysis/VariableManager/Manager.h>
+#include <analysis/VariableManager/ColumnEvaluator.h>
 #include <analysis/dataobjects/Particle.h>
 #include <analysis/dataobjects/ParticleList.h>
 
+#include <framework/core/ProcessStatistics.h>
+#include <framework/dataobjects/EventMetaData.h>
+#include <framework/datastore/DataStore.h>
+#include <framework/datastore/StoreObjPtr.h>
 #include <framework/logging/Logger.h>
 #include <framework/utilities/Conversion.h>
 #include <framework/utilities/GeneralCut.h>
 
 #include <boost/algorithm/string.hpp>
 
+#include <atomic>
+#include <iomanip>
+#include <optional>
+#include <sstream>
 #include <string>
 #include <regex>
 #include <set>
 
 using namespace Belle2;
 
+namespace {
+  /** Return the plain function returning T if the function only wraps one, either directly or
+   * through a std::function<T(const Particle*)> as created by REGISTER_VARIABLE. */
+  template<class T>
+  T(*getPlainFunction(const Variable::Manager::FunctionPtr& function))(const Particle*)
+  {
+    using Plain = T(*)(const Particle*);
+    if (const Plain* plain = function.target<Plain>()) return *plain;
+    if (const auto* wrapped = function.target<std::function<T(const Particle*)>>()) {
+      if (const Plain* plain = wrapped->template target<Plain>()) return *plain;
+    }
+    return nullptr;
+  }
+}
+
+/** Values of a cached variable for all particles, see Manager::enableCache() */
+class Variable::Manager::VariableCache {
+public:
+  /** Cache the values of the given function */
+  VariableCache(const std::string& name, const FunctionPtr& function):
+    m_name(name), m_function(function), m_index(s_nCaches++) {}
+
+  /** Return the cached value for the particle, calculating it if necessary */
+  VarVariant operator()(const Particle* particle)
+  {
+    CachedValues& cached = getCachedValues();
+    const unsigned long long generation = DataStore::Instance().getCacheGeneration();
+    if (generation != cached.generation) {
+      // without event there are no particles to cache. The event stays valid for the whole generation, but it may
+      // still be created in this generation, so only a valid event is remembered.
+      StoreObjPtr<EventMetaData> eventMetaData;
+      if (!eventMetaData.isValid()) {
+        ++m_uncached;
+        return m_function(particle);
+      }
+      cached.generation = generation;
+      cached.eventValue.reset();
+      cached.values.clear();
+    }
+    if (!particle) {
+      if (cached.eventValue) {
+        countHit();
+        return *cached.eventValue;
+      }
+      countMiss();
+      const VarVariant value = m_function(nullptr);
+      cached.eventValue = value;
+      return value;
+    }
+    const int index = particle->getArrayIndex();
+    if (index < 0) {
+      ++m_uncached;
+      return m_function(particle);
+    }
+    if (static_cast<size_t>(index) < cached.values.size() and cached.values[index].first == particle) {
+      countHit();
+      return cached.values[index].second;
+    }
+    countMiss();
+    // the function might use the cache for other particles so only look up the entry afterwards
+    const VarVariant value = m_function(particle);
+    if (static_cast<size_t>(index) >= cached.values.size()) cached.values.resize(index + 1, {nullptr, 0.0});
+    cached.values[index] = {particle, value};
+    return value;
+  }
+
+  /** Return the hit and miss counts of all threads */
+  CacheStatistics getStatistics() const
+  {
+    CacheStatistics statistics;
+    statistics.name = m_name;
+    statistics.hits = m_hits;
+    statistics.misses = m_misses;
+    statistics.uncached = m_uncached;
+    return statistics;
+  }
+
+private:
+  /** Count a value taken from the cache, for this variable and for the module statistics */
+  void countHit()
+  {
+    ++m_hits;
+    ProcessStatistics::countCacheHit();
+  }
+
+  /** Count a value calculated and added to the cache, for this variable and for the module statistics */
+  void countMiss()
+  {
+    ++m_misses;
+    ProcessStatistics::countCacheMiss();
+  }
+
+  /** Cached values of one thread */
+  struct CachedValues {
+    /** DataStore cache generation the values were calculated in and in which the event was checked, 0 is never used */
+    unsigned long long generation{0};
+    /** Value of the variable for the event itself, i.e. a nullptr particle */
+    std::optional<VarVariant> eventValue;
+    /** Particle and value by index of the particle in its StoreArray, the particle is nullptr if not cached yet */
+    std::vector<std::pair<const Particle*, VarVariant>> values;
+  };
+
+  /** Return the values of this cache for the calling thread, each thread processes its own events */
+  CachedValues& getCachedValues() const
+  {
+    // by pointer so that the values stay in place if another cache is added while calculating a value
+    static thread_local std::vector<std::unique_ptr<CachedValues>> t_cachedValues;
+    if (m_index >= t_cachedValues.size()) t_cachedValues.resize(m_index + 1);
+    if (!t_cachedValues[m_index]) t_cachedValues[m_index] = std::make_unique<CachedValues>();
+    return *t_cachedValues[m_index];
+  }
+
+  /** Number of caches created so far */
+  static inline std::atomic<size_t> s_nCaches{0};
+  /** Name of the cached variable */
+  const std::string m_name;
+  /** The function calculating the values */
+  const FunctionPtr m_function;
+  /** Index of this cache in the thread local values */
+  const size_t m_index;
+  /** Number of values taken from the cache */
+  std::atomic<uint64_t> m_hits{0};
+  /** Number of values calculated and added to the cache */
+  std::atomic<uint64_t> m_misses{0};
+  /** Number of values calculated without using the cache */
+  std::atomic<uint64_t> m_uncached{0};
+};
+
+void Variable::Manager::Var::resolvePlainFunction()
+{
+  switch (variabletype) {
+    case VariableDataType::c_double:
+      doubleFunction = getPlainFunction<double>(function);
+      if (doubleFunction) function = doubleFunction;
+      break;
+    case VariableDataType::c_int:
+      intFunction = getPlainFunction<int>(function);
+      if (intFunction) function = intFunction;
+      break;
+    case VariableDataType::c_bool:
+      boolFunction = getPlainFunction<bool>(function);
+      if (boolFunction) function = boolFunction;
+      break;
+  }
+}
+
 Variable::Manager::~Manager() = default;
 Variable::Manager& Variable::Manager::Instance()
 {
@@ -32,6 +187,7 @@ Variable::Manager& Variable::Manager::Instance()
 const Variable::Manager::Var* Variable::Manager::getVariable(const std::string& functionName,
     const std::vector<std::string>& functionArguments)
 {
+  std::lock_guard<std::recursive_mutex> lock(m_mutex);
   // Combine to full name for alias resolving
   std::string fullname = functionName + "(" + boost::algorithm::join(functionArguments, ", ") + ")";
 
@@ -57,6 +213,7 @@ const Variable::Manager::Var* Variable::Manager::getVariable(const std::string&
 
 const Variable::Manager::Var* Variable::Manager::getVariable(std::string name)
 {
+  std::lock_guard<std::recursive_mutex> lock(m_mutex);
   // resolve aliases. Aliases might point to other aliases so we need to keep a
   // set of what we have seen so far to avoid running into infinite loops
   std::set<std::string> aliasesSeen;
@@ -95,6 +252,7 @@ std::vector<const Variable::Manager::Var*> Variable::Manager::getVariables(const
 
 bool Variable::Manager::addAlias(const std::string& alias, const std::string& variable)
 {
+  std::lock_guard<std::recursive_mutex> lock(m_mutex);
 
   assertValidName(alias);
 
@@ -117,6 +275,7 @@ bool Variable::Manager::addAlias(const std::string& alias, const std::string& va
 
 void Variable::Manager::clearAliases()
 {
+  std::lock_guard<std::recursive_mutex> lock(m_mutex);
   m_alias.clear();
 }
 
@@ -333,6 +492,7 @@ void Variable::Manager::registerVariable(const std::string& name, const Variable
                                          const std::string& description, const Variable::Manager::VariableDataType& variabletype,
                                          const std::string& unit)
 {
+  std::lock_guard<std::recursive_mutex> lock(m_mutex);
   if (!f) {
     B2FATAL("No function provided for variable '" << name << "'.");
   }
@@ -358,6 +518,7 @@ void Variable::Manager::registerVariable(const std::string& name, const Variable
                                          const std::string& description, const Variable::Manager::VariableDataType& variabletype,
                                          const std::string& unit)
 {
+  std::lock_guard<std::recursive_mutex> lock(m_mutex);
   if (!f) {
     B2FATAL("No function provided for variable '" << name << "'.");
   }
@@ -381,6 +542,7 @@ void Variable::Manager::registerVariable(const std::string& name, const Variable
 void Variable::Manager::registerVariable(const std::string& name, const Variable::Manager::MetaFunctionPtr& f,
                                          const std::string& description, const Variable::Manager::VariableDataType& variabletype)
 {
+  std::lock_guard<std::recursive_mutex> lock(m_mutex);
   if (!f) {
     B2FATAL("No function provided for variable '" << name << "'.");
   }
@@ -458,6 +620,53 @@ void Variable::Manager::checkDeprecatedVariable(const std::string& name)
 }
 
 
+bool Variable::Manager::enableCache(const std::string& name)
+{
+  std::lock_guard<std::recursive_mutex> lock(m_mutex);
+  const Var* found = getVariable(name);
+  if (!found) return false;
+  if (m_caches.count(found->name) > 0) return true;
+  auto varIter = m_variables.find(found->name);
+  if (varIter == m_variables.end() or varIter->second.get() != found) {
+    B2ERROR("Cannot enable the cache for variable" << LogVar("variable", name));
+    return false;
+  }
+  Var& var = *varIter->second;
+  auto cache = std::make_shared<VariableCache>(var.name, var.function);
+  // replace the function in place so that everyone already holding a pointer to the variable uses the cache
+  var.function = [cache](const Particle * particle) -> VarVariant { return (*cache)(particle); };
+  var.doubleFunction = nullptr;
+  var.intFunction = nullptr;
+  var.boolFunction = nullptr;
+  m_caches[var.name] = cache;
+  B2DEBUG(19, "Enabled cache for variable " << var.name);
+  return true;
+}
+
+std::vector<Variable::Manager::CacheStatistics> Variable::Manager::getCacheStatistics() const
+{
+  std::vector<CacheStatistics> result;
+  for (const auto& entry : m_caches) result.push_back(entry.second->getStatistics());
+  return result;
+}
+
+void Variable::Manager::printCacheStatistics() const
+{
+  size_t longestName = 8;
+  const std::vector<CacheStatistics> allStatistics = getCacheStatistics();
+  for (const auto& statistics : allStatistics) longestName = std::max(longestName, statistics.name.length());
+  std::stringstream table;
+  table << std::left << std::setw(longestName) << "Variable" << std::right << " | " << std::setw(10) << "Hits" << " | "
+        << std::setw(10) << "Misses" << " | " << std::setw(10) << "Uncached" << " | " << std::setw(8) << "Hit rate" << "\n";
+  for (const auto& statistics : allStatistics) {
+    const uint64_t total = statistics.hits + statistics.misses + statistics.uncached;
+    table << std::left << std::setw(longestName) << statistics.name << std::right << " | " << std::setw(10) << statistics.hits << " | "
+          << std::setw(10) << statistics.misses << " | " << std::setw(10) << statistics.uncached << " | " << std::setw(7)
+          << std::fixed << std::setprecision(1) << (total > 0 ? 100. * statistics.hits / total : 0.) << "%\n";
+  }
+  B2INFO("Cache statistics of the cached variables:\n" << table.str());
+}
+
 std::vector<std::string> Variable::Manager::getNames() const
 {
   std::vector<std::string> names;
@@ -492,12 +701,23 @@ double Variable::Manager::evaluate(const std::string& varName, const Particle* p
 
 std::vector<double> Variable::Manager::evaluateVariables(const std::vector<std::string>& varNames, const ParticleList* plist)
 {
+  std::vector<const Var*> variables;
+  variables.reserve(varNames.size());
+  for (const std::string& varName : varNames) {
+    const Var* var = getVariable(varName);
+    if (!var) {
+      throw std::runtime_error("Variable::Manager::evaluateVariables(): variable '" + varName + "' not found!");
+    }
+    variables.push_back(var);
+  }
+  ColumnEvaluator columns(variables);
+  columns.evaluate(*plist);
+
   std::vector<double> values;
-  values.reserve(varNames.size() * plist->getListSize());
-  for (size_t iPart = 0; iPart < plist->getListSize(); ++iPart) {
-    const Particle* p = plist->getParticle(iPart);
-    for (size_t iVar = 0; iVar < varNames.size(); ++iVar)
-      values.push_back(evaluate(varNames[iVar], p));
+  values.reserve(varNames.size() * columns.getNumberOfRows());
+  for (unsigned int iPart = 0; iPart < columns.getNumberOfRows(); ++iPart) {
+    for (unsigned int iVar = 0; iVar < variables.size(); ++iVar)
+      values.push_back(columns.getValue(iVar, iPart));
   }
   return values;
 }
@@ -16,6 +16,9 @@
 
 #include <Math/Vector4D.h>
 
+#include <algorithm>
+#include <bitset>
+#include <cstdint>
 #include <vector>
 #include <string>
 #include <set>
@@ -48,12 +51,120 @@ namespace Belle2 {
    *
    * Internally, the RestOfEvent class holds only StoreArray indices of all unused MDST particles.
    * Indices are stored in std::set and not std::vector, since the former ensures uniqueness of all its elements.
+   * To work with them, they are converted once into a dense IndexBits with one bit per
+   * index which is much faster to iterate and look up and allows set operations between masks.
    */
 
   class RestOfEvent : public RelationsObject {
 
   public:
     static constexpr const char* c_defaultMaskName = "all"; /**< Default mask name */
+
+    /**
+     * Dense set of Particle StoreArray indices with one bit per index.
+     * Only used as transient working copy of the persistent index sets.
+     */
+    class IndexBits {
+    public:
+      /** Empty set */
+      IndexBits() = default;
+      /** Set containing the given indices */
+      explicit IndexBits(const std::set<int>& indices)
+      {
+        for (const int index : indices) insert(index);
+      }
+      /** Add an index */
+      void insert(int index)
+      {
+        const size_t word = index / 64;
+        if (word >= m_words.size()) m_words.resize(word + 1, 0);
+        m_words[word] |= uint64_t(1) << (index % 64);
+      }
+      /** Remove an index */
+      void erase(int index)
+      {
+        const size_t word = index / 64;
+        if (index >= 0 and word < m_words.size()) m_words[word] &= ~(uint64_t(1) << (index % 64));
+      }
+      /** Check if the index is contained */
+      bool contains(int index) const
+      {
+        const size_t word = index / 64;
+        return index >= 0 and word < m_words.size() and (m_words[word] >> (index % 64)) & 1;
+      }
+      /** Number of indices */
+      size_t size() const
+      {
+        size_t result = 0;
+        for (const uint64_t word : m_words) result += std::bitset<64>(word).count();
+        return result;
+      }
+      /** True if no index is contained */
+      bool empty() const
+      {
+        for (const uint64_t word : m_words) if (word) return false;
+        return true;
+      }
+      /** Remove all indices */
+      void clear() { m_words.clear(); }
+      /** Call function(index) for all indices in increasing order */
+      template<class Function> void forEach(Function function) const
+      {
+        for (size_t word = 0; word < m_words.size(); ++word) {
+          for (uint64_t bits = m_words[word]; bits; bits &= bits - 1) {
+            function(static_cast<int>(word * 64 + __builtin_ctzll(bits)));
+          }
+        }
+      }
+      /** All indices in increasing order */
+      std::vector<int> toVector() const
+      {
+        std::vector<int> result;
+        result.reserve(size());
+        forEach([&result](int index) { result.push_back(index); });
+        return result;
+      }
+      /** Union with another set */
+      IndexBits& operator|=(const IndexBits& other)
+      {
+        if (other.m_words.size() > m_words.size()) m_words.resize(other.m_words.size(), 0);
+        for (size_t word = 0; word < other.m_words.size(); ++word) m_words[word] |= other.m_words[word];
+        return *this;
+      }
+      /** Intersection with another set */
+      IndexBits& operator&=(const IndexBits& other)
+      {
+        if (m_words.size() > other.m_words.size()) m_words.resize(other.m_words.size());
+        for (size_t word = 0; word < m_words.size(); ++word) m_words[word] &= other.m_words[word];
+        return *this;
+      }
+      /** Difference: remove all indices contained in the other set */
+      IndexBits& operator-=(const IndexBits& other)
+      {
+        for (size_t word = 0; word < std::min(m_words.size(), other.m_words.size()); ++word) m_words[word] &= ~other.m_words[word];
+        return *this;
+      }
+      /** Union of two sets */
+      friend IndexBits operator|(IndexBits a, const IndexBits& b) { return a |= b; }
+      /** Intersection of two sets */
+      friend IndexBits operator&(IndexBits a, const IndexBits& b) { return a &= b; }
+      /** Difference of two sets */
+      friend IndexBits operator-(IndexBits a, const IndexBits& b) { return a -= b; }
+      /** Check if both sets contain the same indices */
+      bool operator==(const IndexBits& other) const
+      {
+        const size_t common = std::min(m_words.size(), other.m_words.size());
+        for (size_t word = 0; word < common; ++word) if (m_words[word] != other.m_words[word]) return false;
+        for (size_t word = common; word < m_words.size(); ++word) if (m_words[word]) return false;
+        for (size_t word = common; word < other.m_words.size(); ++word) if (other.m_words[word]) return false;
+        return true;
+      }
+      /** Check if the sets contain different indices */
+      bool operator!=(const IndexBits& other) const { return !(*this == other); }
+    private:
+      std::vector<uint64_t> m_words; /**< one bit per index */
+    };
+
     /**
      * Structure of Rest of Event mask. It contains array indices of particles, which were selected and associated to this mask after some selection.
      * Host ROE object always check that masks do not contain extra particles,
@@ -70,7 +181,7 @@ namespace Belle2 {
        * @param origin origin of mask, for debug
        */
       Mask(const std::string& name = c_defaultMaskName, const std::string& origin = "unknown"): m_name(name),
-        m_origin(origin)
+        m_origin(origin), m_bitsUpToDate(false)
       {
         B2DEBUG(10, "Mask " << name << " is being initialized by " << origin);
         m_isValid = false;
@@ -101,6 +212,7 @@ namespace Belle2 {
           for (auto* particle : particles) {
             m_maskedParticleIndices.insert(particle->getArrayIndex());
           }
+          m_bitsUpToDate = false;
           m_isValid = true;
         }
       }
@@ -118,6 +230,14 @@ namespace Belle2 {
       {
         return m_maskedV0Indices;
       }
+      /**
+       *  Get selected particles associated to the mask as IndexBits
+       */
+      const IndexBits& getParticleBits() const
+      {
+        updateBits();
+        return m_particleBits;
+      }
       /**
        *  Get selected particles associated to the V0 of mask
        */
@@ -128,13 +248,15 @@ namespace Belle2 {
           m_maskedParticleIndices.erase(i);
         }
         m_maskedParticleIndices.insert(v0->getArrayIndex());
+        m_bitsUpToDate = false;
       }
       /**
        *  Has selected particles associated to the mask
        */
       bool hasV0(const Particle* v0) const
       {
-        return m_maskedV0Indices.count(v0->getArrayIndex()) > 0;
+        updateBits();
+        return m_v0Bits.contains(v0->getArrayIndex());
       }
       /**
        *  Clear selected particles associated to the mask
@@ -144,6 +266,7 @@ namespace Belle2 {
       {
         m_maskedParticleIndices.clear();
         m_maskedV0Indices.clear();
+        m_bitsUpToDate = false;
         m_isValid = false;
       }
       /**
@@ -162,11 +285,23 @@ namespace Belle2 {
         B2INFO(printout);
       }
     private:
+      /** Convert the index sets to IndexBits if they changed */
+      void updateBits() const
+      {
+        if (m_bitsUpToDate) return;
+        m_particleBits = IndexBits(m_maskedParticleIndices);
+        m_v0Bits = IndexBits(m_maskedV0Indices);
+        m_bitsUpToDate = true;
+      }
+
       std::string m_name;                       /**< Mask name */
       std::string m_origin;                     /**< Mask origin  for debug */
       bool m_isValid;                           /**< Check if mask has elements or correctly initialized*/
       std::set<int> m_maskedParticleIndices;    /**< StoreArray indices for masked ROE particles */
       std::set<int> m_maskedV0Indices;          /**< StoreArray indices for masked V0 ROE particles */
+      mutable IndexBits m_particleBits;         //!< m_maskedParticleIndices as IndexBits (not persistent)
+      mutable IndexBits m_v0Bits;               //!< m_maskedV0Indices as IndexBits (not persistent)
+      mutable bool m_bitsUpToDate;              //!< whether the IndexBits correspond to the index sets (not persistent)
     };
     /**
      * Default constructor.
@@ -214,6 +349,12 @@ namespace Belle2 {
      * @param maskName Name of the mask to work with
      */
     bool hasParticle(const Particle* particle, const std::string& maskName = c_defaultMaskName) const;
+    /**
+     * Get the StoreArray indices of the ROE particles (default mask) or of the particles in the given mask.
+     * The result can be combined with the indices of other masks using set operations.
+     * @param maskName Name of the mask to work with
+     */
+    const IndexBits& getParticleIndices(const std::string& maskName = c_defaultMaskName) const;
     /**
      * Initialize new mask
      * @param name Name of the mask to work with
@@ -363,6 +504,10 @@ namespace Belle2 {
     bool m_useKLMEnergy;               /**< Include KLM energy into ROE 4-vector */
     bool m_builtWithMostLikely;        /**< indicates whether most-likely particle lists were used in build of ROE */
 
+    // transient data members
+    mutable IndexBits m_particleBits;        //!< m_particleIndices as IndexBits
+    mutable bool m_particleBitsUpToDate{false}; //!< whether m_particleBits corresponds to m_particleIndices
+
     // Private methods
     /**
      *  Checks if a particle has its copy in the provided list
@@ -373,6 +518,11 @@ namespace Belle2 {
      *  Helper method to find ROE mask
      */
     Mask* findMask(const std::string& name);
+    /**
+     *  Call function(particle) for all particles in the given mask, replacing composite particles by their
+     *  final state daughters if unpackComposite is true
+     */
+    template<class Function> void forEachParticle(const std::string& maskName, bool unpackComposite, Function function) const;
     /**
      * Prints indices in the given set in a single line
      */
@@ -15,6 +15,28 @@
 #include <mdst/dataobjects/ECLCluster.h>
 
 using namespace Belle2;
+
+template<class Function> void RestOfEvent::forEachParticle(const std::string& maskName, bool unpackComposite,
+                                                          Function function) const
+{
+  if (m_particleIndices.empty()) {
+    B2DEBUG(10, "ROE contains no particles, masks are empty too");
+    return;
+  }
+  StoreArray<Particle> allParticles;
+  getParticleIndices(maskName).forEach([&](int index) {
+    const Particle* particle = allParticles[index];
+    if ((particle->getParticleSource() == Particle::EParticleSourceObject::c_Composite or
+         particle->getParticleSource() == Particle::EParticleSourceObject::c_V0) && unpackComposite) {
+      for (const Particle* daughter : particle->getFinalStateDaughters()) {
+        function(daughter);
+      }
+      return;
+    }
+    function(particle);
+  });
+}
+
 // New methods:
 void RestOfEvent::addParticles(const std::vector<const Particle*>& particlesToAdd)
 {
@@ -32,47 +54,34 @@ void RestOfEvent::addParticles(const std::vector<const Particle*>& particlesToAd
       if (toAdd) {
         B2DEBUG(10, "\t\tAdding particle with PDG " << daughter->getPDGCode());
         m_particleIndices.insert(daughter->getArrayIndex());
+        m_particleBitsUpToDate = false;
       }
     }
   }
 }
 
-std::vector<const Particle*> RestOfEvent::getParticles(const std::string& maskName, bool unpackComposite) const
+const RestOfEvent::IndexBits& RestOfEvent::getParticleIndices(const std::string& maskName) const
 {
-  std::vector<const Particle*> result;
-  StoreArray<Particle> allParticles;
-  std::set<int> source;
-  if (m_particleIndices.size() == 0) {
-    B2DEBUG(10, "ROE contains no particles, masks are empty too");
-    return result;
-  }
   if (maskName == RestOfEvent::c_defaultMaskName or maskName.empty()) {
     // if no mask provided work with internal source
-    source = m_particleIndices;
-  } else {
-    bool maskFound = false;
-    for (auto& mask : m_masks) {
-      if (mask.getName() == maskName) {
-        maskFound = true;
-        source = mask.getParticles();
-        break;
-      }
-    }
-    if (!maskFound) {
-      B2FATAL("No '" << maskName << "' mask defined in current ROE!");
+    if (!m_particleBitsUpToDate) {
+      m_particleBits = IndexBits(m_particleIndices);
+      m_particleBitsUpToDate = true;
     }
+    return m_particleBits;
   }
-  for (const int index : source) {
-    if ((allParticles[index]->getParticleSource() == Particle::EParticleSourceObject::c_Composite or
-         allParticles[index]->getParticleSource() == Particle::EParticleSourceObject::c_V0) && unpackComposite) {
-      auto fsdaughters = allParticles[index]->getFinalStateDaughters();
-      for (auto* daughter : fsdaughters) {
-        result.push_back(daughter);
-      }
-      continue;
+  for (auto& mask : m_masks) {
+    if (mask.getName() == maskName) {
+      return mask.getParticleBits();
     }
-    result.push_back(allParticles[index]);
   }
+  B2FATAL("No '" << maskName << "' mask defined in current ROE!");
+}
+
+std::vector<const Particle*> RestOfEvent::getParticles(const std::string& maskName, bool unpackComposite) const
+{
+  std::vector<const Particle*> result;
+  forEachParticle(maskName, unpackComposite, [&result](const Particle * particle) { result.push_back(particle); });
   return result;
 }
 
@@ -122,6 +131,12 @@ bool RestOfEvent::hasParticle(const Particle* particle, const std::string& maskN
     B2FATAL("No '" << maskName << "' mask defined in current ROE!");
   }
 
+  // a final state particle which is itself part of the ROE can be found directly by its index
+  if (particle->getParticleSource() != Particle::EParticleSourceObject::c_Composite and
+      particle->getParticleSource() != Particle::EParticleSourceObject::c_V0 and
+      !m_particleIndices.empty() and getParticleIndices(maskName).contains(particle->getArrayIndex())) {
+    return true;
+  }
   std::vector<const Particle*> particlesROE = getParticles(maskName);
   return isInParticleList(particle, particlesROE);
 }
@@ -301,15 +316,14 @@ bool RestOfEvent::hasMask(const std::string& name) const
 ROOT::Math::PxPyPzEVector RestOfEvent::get4Vector(const std::string& maskName) const
 {
   ROOT::Math::PxPyPzEVector roe4Vector;
-  std::vector<const Particle*> myParticles = RestOfEvent::getParticles(maskName);
-  for (const Particle* particle : myParticles) {
+  forEachParticle(maskName, true, [this, &roe4Vector](const Particle * particle) {
     // KLMClusters are discarded, because KLM energy estimation is based on hit numbers, therefore it is unreliable
     // also, enable it as an experimental option:
     if (particle->getParticleSource() == Particle::EParticleSourceObject::c_KLMCluster and !m_useKLMEnergy) {
-      continue;
+      return;
     }
     roe4Vector += particle->get4Vector();
-  }
+  });
   return roe4Vector;
 }
 
@@ -438,23 +452,7 @@ void RestOfEvent::printIndices(const std::string& maskName, bool unpackComposite
 Particle* RestOfEvent::convertToParticle(const std::string& maskName, int pdgCode, bool isSelfConjugated)
 {
   StoreArray<Particle> particles;
-  std::set<int> source;
-  if (maskName == RestOfEvent::c_defaultMaskName) {
-    // if no mask provided work with internal source
-    source = m_particleIndices;
-  } else {
-    bool maskFound = false;
-    for (auto& mask : m_masks) {
-      if (mask.getName() == maskName) {
-        maskFound = true;
-        source = mask.getParticles();
-        break;
-      }
-    }
-    if (!maskFound) {
-      B2FATAL("No '" << maskName << "' mask defined in current ROE!");
-    }
-  }
+  const std::vector<int> source = getParticleIndices(maskName).toVector();
   int particlePDG = (pdgCode == 0) ? getPDGCode() : pdgCode;
   auto isFlavored = (isSelfConjugated) ? Particle::EFlavorType::c_Unflavored : Particle::EFlavorType::c_Flavored;
   // By default, the ROE-based particles should have unspecified property to simplify the MC-matching
@@ -462,7 +460,6 @@ Particle* RestOfEvent::convertToParticle(const std::string& maskName, int pdgCod
   // Same properties as for "->" usage in DecayDescriptor
   propertyFlags |= Particle::PropertyFlags::c_IsIgnoreIntermediate;
   propertyFlags |= Particle::PropertyFlags::c_IsIgnoreRadiatedPhotons;
-  return particles.appendNew(get4Vector(maskName), particlePDG, isFlavored, std::vector(source.begin(),
-                             source.end()), propertyFlags);
+  return particles.appendNew(get4Vector(maskName), particlePDG, isFlavored, source, propertyFlags);
 }
 
@@ -58,6 +58,7 @@ output list. If ``allowMultiRank=True`` that means that there can be more than
 ``numBest`` candidates in the output list if they share ranks.
 )DOC");
 
+  //not thread safe: ranking by the random variable uses the global random number generator
   setPropertyFlags(c_ParallelProcessingCertified);
 
   addParam("particleList", m_inputListName, "Name of the ParticleList to rank for best candidate");
@@ -35,7 +35,7 @@ KlongMomentumUpdaterExpertModule::KlongMomentumUpdaterExpertModule() : Module()
 {
   // set module description (e.g. insert text)
   setDescription("This module calculates and updates the kinematics of two body B decays including one Klong");
-  setPropertyFlags(c_ParallelProcessingCertified);
+  setPropertyFlags(c_ParallelProcessingCertified | c_ModifiesObjectsInPlace);
 
   // Add parameters
   addParam("listName", m_listName, "name of particle list", std::string(""));
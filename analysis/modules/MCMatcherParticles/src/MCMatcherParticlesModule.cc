@@ -52,7 +52,7 @@ MCMatcherParticlesModule::MCMatcherParticlesModule() : Module()
                  "- looseMCWrongDaughterBiB: 1 if the wrong daughter is Beam Induced Background\n"
                  "  Particle");
 
-  setPropertyFlags(c_ParallelProcessingCertified);
+  setPropertyFlags(c_ParallelProcessingCertified | c_ThreadSafe | c_ModifiesObjectsInPlace);
 
   addParam("listName", m_listName, "Name of the input ParticleList.");
   addParam("looseMCMatching", m_looseMatching, "Perform loose mc matching", false);
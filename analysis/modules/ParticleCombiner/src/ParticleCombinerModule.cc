@@ -39,7 +39,7 @@ ParticleCombinerModule::ParticleCombinerModule() :
 {
   // set module description (e.g. insert text)
   setDescription("Makes particle combinations");
-  setPropertyFlags(c_ParallelProcessingCertified);
+  setPropertyFlags(c_ParallelProcessingCertified | c_ThreadSafe);
 
   // Add parameters
   addParam("decayString", m_decayString,
@@ -54,7 +54,7 @@ ParticleKinematicFitterModule::ParticleKinematicFitterModule() : Module(), m_tex
       DataStore::c_Event)
 {
   setDescription("Kinematic fitter for modular analysis");
-  setPropertyFlags(c_ParallelProcessingCertified);
+  setPropertyFlags(c_ParallelProcessingCertified | c_ModifiesObjectsInPlace);
 
   // Add parameters
   addParam("listName", m_listName, "Name of particle list.", string(""));
@@ -38,7 +38,7 @@ ParticleListManipulatorModule::ParticleListManipulatorModule():
 
 {
   setDescription("Manipulates ParticleLists: copies/merges/performs particle selection");
-  setPropertyFlags(c_ParallelProcessingCertified);
+  setPropertyFlags(c_ParallelProcessingCertified | c_ThreadSafe);
 
   // Add parameters
   addParam("outputListName", m_outputListName, "Output ParticleList name");
@@ -38,7 +38,7 @@ ParticleLoaderModule::ParticleLoaderModule() : Module()
 
 {
   setDescription("Loads MDST dataobjects as Particle objects to the StoreArray<Particle> and collects them in specified ParticleList.");
-  setPropertyFlags(c_ParallelProcessingCertified);
+  setPropertyFlags(c_ParallelProcessingCertified | c_ThreadSafe);
 
   // Add parameters
   addParam("decayStrings", m_decayStrings,
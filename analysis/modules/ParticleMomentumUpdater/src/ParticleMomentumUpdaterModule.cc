@@ -26,7 +26,7 @@ ParticleMomentumUpdaterModule::ParticleMomentumUpdaterModule() : Module()
 
   //Set module properties
   setDescription("This module replaces the momentum of the particles in the selected target particle list by p(beam) - p(selected daughters). The momentum of the mother particle will not be changed.");
-  setPropertyFlags(c_ParallelProcessingCertified);
+  setPropertyFlags(c_ParallelProcessingCertified | c_ModifiesObjectsInPlace);
   //Parameter definition
   addParam("particleList", m_particleList, "Name of particle list with reconstructed particles.");
   addParam("decayStringTarget", m_decayStringTarget,
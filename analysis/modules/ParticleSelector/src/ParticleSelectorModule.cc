@@ -32,7 +32,7 @@ ParticleSelectorModule::ParticleSelectorModule() : Module()
 {
   setDescription("Removes Particles from given ParticleList that do not pass specified selection criteria.");
 
-  setPropertyFlags(c_ParallelProcessingCertified);
+  setPropertyFlags(c_ParallelProcessingCertified | c_ThreadSafe);
 
   addParam("decayString", m_decayString,
            "Input ParticleList name (see :ref:`DecayString`).");
@@ -56,7 +56,7 @@ ParticleVertexFitterModule::ParticleVertexFitterModule() : Module(),
 {
   // set module description (e.g. insert text)
   setDescription("Vertex fitter for modular analysis");
-  setPropertyFlags(c_ParallelProcessingCertified);
+  setPropertyFlags(c_ParallelProcessingCertified | c_ModifiesObjectsInPlace);
 
   // Add parameters
   addParam("listName", m_listName, "name of particle list", string(""));
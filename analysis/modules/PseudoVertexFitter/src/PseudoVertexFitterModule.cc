@@ -30,7 +30,7 @@ PseudoVertexFitterModule::PseudoVertexFitterModule() : Module()
 {
   // set module description (e.g. insert text)
   setDescription("Pseudo fitter adds a covariance matrix which is sum of the daughter covariance matrices.");
-  setPropertyFlags(c_ParallelProcessingCertified);
+  setPropertyFlags(c_ParallelProcessingCertified | c_ModifiesObjectsInPlace);
 
   // Add parameters
   addParam("listName", m_listName, "name of particle list", string(""));
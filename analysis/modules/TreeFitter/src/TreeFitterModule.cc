@@ -26,7 +26,7 @@ REG_MODULE(TreeFitter);
 TreeFitterModule::TreeFitterModule() : Module(), m_nCandidatesBeforeFit(-1), m_nCandidatesAfter(-1)
 {
   setDescription("Tree Fitter module. Performs simultaneous fit of all vertices in a decay chain. Can also be used to just fit a single vertex.");
-  setPropertyFlags(c_ParallelProcessingCertified);
+  setPropertyFlags(c_ParallelProcessingCertified | c_ModifiesObjectsInPlace);
   //
   addParam("particleList", m_particleList,
            "Type::[string]. Input mother of the decay tree to fit. For example 'B0:myB0particleList'.");
@@ -20,7 +20,7 @@ REG_MODULE(VariablesToEventExtraInfo);
 VariablesToEventExtraInfoModule::VariablesToEventExtraInfoModule()
 {
   setDescription("For each particle in the input list the selected variables are saved in an event-extra-info field with the given name. Can be used to save MC truth information, for example, in a ntuple of reconstructed particles.");
-  setPropertyFlags(c_ParallelProcessingCertified);
+  setPropertyFlags(c_ParallelProcessingCertified | c_ThreadSafe);
 
   std::map<std::string, std::string> emptymap;
   addParam("particleList", m_inputListName, "Name of particle list with reconstructed particles.");
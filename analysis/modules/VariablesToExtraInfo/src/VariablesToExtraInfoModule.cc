@@ -19,7 +19,7 @@ REG_MODULE(VariablesToExtraInfo);
 VariablesToExtraInfoModule::VariablesToExtraInfoModule()
 {
   setDescription("For each particle in the input list the selected variables are saved in an extra-info field with the given name. Can be used when wanting to save variables before modifying them, e.g. when performing vertex fits.");
-  setPropertyFlags(c_ParallelProcessingCertified);
+  setPropertyFlags(c_ParallelProcessingCertified | c_ThreadSafe);
 
   std::map<std::string, std::string> emptymap;
   addParam("particleList", m_inputListName, "Name of particle list with reconstructed particles.");
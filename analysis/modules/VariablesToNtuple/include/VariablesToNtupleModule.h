@@ -9,6 +9,7 @@
 #pragma once
 
 #include <analysis/VariableManager/Manager.h>
+#include <analysis/VariableManager/ColumnEvaluator.h>
 #include <analysis/dataobjects/RestOfEvent.h>
 
 #include <framework/core/Module.h>
@@ -21,7 +22,9 @@
 #include <TTree.h>
 #include <TFile.h>
 
+#include <memory>
 #include <string>
+#include <vector>
 
 namespace Belle2 {
 
@@ -98,8 +101,16 @@ namespace Belle2 {
 
     /** Branch addresses of variables of type int (or bool) */
     std::vector<int> m_branchAddressesInt;
-    /** List of pairs of function pointers and respective data type corresponding to given variables. */
-    std::vector<std::pair<Variable::Manager::FunctionPtr, Variable::Manager::VariableDataType>> m_functions;
+    /** Evaluates all variables for all candidates of an event at once. */
+    std::unique_ptr<Variable::ColumnEvaluator> m_columns;
+    /** Index of the branch address for each variable in m_columns. */
+    std::vector<unsigned int> m_branchIndices;
+    /** Candidates to be written in the current event. */
+    std::vector<const Particle*> m_selectedCandidates;
+    /** Candidate number of each candidate to be written in the current event. */
+    std::vector<int> m_selectedCandidateNumbers;
+    /** Weight of each candidate to be written in the current event. */
+    std::vector<float> m_selectedCandidateWeights;
 
     /** Tuple of variable name and a map of integer values and inverse sampling rate. E.g. (signal, {1: 0, 0:10}) selects all signal candidates and every 10th background candidate. */
     std::tuple<std::string, std::map<int, unsigned int>> m_sampling;
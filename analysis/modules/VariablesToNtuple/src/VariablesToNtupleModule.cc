@@ -202,6 +202,7 @@ void VariablesToNtupleModule::initialize()
     m_tree->get().Branch("__weight__", &m_branchAddressesDouble[0], "__weight__/D");
   }
   size_t enumerate = 1;
+  std::vector<const Variable::Manager::Var*> variables;
   for (const string& varStr : m_variables) {
     string branchName = MakeROOTCompatible::makeROOTCompatible(varStr);
 
@@ -232,10 +233,12 @@ void VariablesToNtupleModule::initialize()
       } else if (var->variabletype == Variable::Manager::VariableDataType::c_bool) {
         m_tree->get().Branch(branchName.c_str(), &m_branchAddressesInt[enumerate], (branchName + "/O").c_str());
       }
-      m_functions.push_back(std::make_pair(var->function, var->variabletype));
+      variables.push_back(var);
+      m_branchIndices.push_back(enumerate);
     }
     enumerate++;
   }
+  m_columns = std::make_unique<Variable::ColumnEvaluator>(variables);
   m_tree->get().SetBasketSize("*", m_basketsize);
 
   m_sampling_name = std::get<0>(m_sampling);
@@ -339,81 +342,53 @@ void VariablesToNtupleModule::event()
     }
   }
 
+  // first select the candidates to be written, then evaluate all variables for them at once
+  m_selectedCandidates.clear();
+  m_selectedCandidateNumbers.clear();
+  m_selectedCandidateWeights.clear();
   if (m_particleList.empty()) {
-    double weight = getInverseSamplingRateWeight(nullptr);
-    if (m_useFloat) {
-      m_branchAddressesFloat[0] = weight;
-    } else {
-      m_branchAddressesDouble[0] = weight;
-    }
+    float weight = getInverseSamplingRateWeight(nullptr);
     if (weight > 0) {
-      for (unsigned int iVar = 0; iVar < m_variables.size(); iVar++) {
-        auto var_result = std::get<0>(m_functions[iVar])(nullptr);
-        auto var_type = std::get<1>(m_functions[iVar]);
-        if (std::holds_alternative<double>(var_result)) {
-          if (var_type != Variable::Manager::VariableDataType::c_double)
-            B2WARNING("Wrong registered data type for variable '" + m_variables[iVar] +
-                      "'. Expected Variable::Manager::VariableDataType::c_double. Exported data for this variable might be incorrect.");
-          if (m_useFloat) {
-            m_branchAddressesFloat[iVar + 1] = std::get<double>(var_result);
-          } else {
-            m_branchAddressesDouble[iVar + 1] = std::get<double>(var_result);
-          }
-        } else if (std::holds_alternative<int>(var_result)) {
-          if (var_type != Variable::Manager::VariableDataType::c_int)
-            B2WARNING("Wrong registered data type for variable '" + m_variables[iVar] +
-                      "'. Expected Variable::Manager::VariableDataType::c_int. Exported data for this variable might be incorrect.");
-          m_branchAddressesInt[iVar + 1] = std::get<int>(var_result);
-        } else if (std::holds_alternative<bool>(var_result)) {
-          if (var_type != Variable::Manager::VariableDataType::c_bool)
-            B2WARNING("Wrong registered data type for variable '" + m_variables[iVar] +
-                      "'. Expected Variable::Manager::VariableDataType::c_bool. Exported data for this variable might be incorrect.");
-          m_branchAddressesInt[iVar + 1] = std::get<bool>(var_result);
-        }
-      }
-      m_tree->get().Fill();
+      m_selectedCandidates.push_back(nullptr);
+      m_selectedCandidateNumbers.push_back(m_candidate);
+      m_selectedCandidateWeights.push_back(weight);
     }
-
   } else {
     StoreObjPtr<ParticleList> particlelist(m_particleList);
     m_ncandidates = particlelist->getListSize();
     for (unsigned int iPart = 0; iPart < m_ncandidates; iPart++) {
-      m_candidate = iPart;
       const Particle* particle = particlelist->getParticle(iPart);
-      double weight = getInverseSamplingRateWeight(particle);
-      if (m_useFloat) {
-        m_branchAddressesFloat[0] = weight;
-      } else {
-        m_branchAddressesDouble[0] = weight;
-      }
+      float weight = getInverseSamplingRateWeight(particle);
       if (weight > 0) {
-        for (unsigned int iVar = 0; iVar < m_variables.size(); iVar++) {
-          auto var_result = std::get<0>(m_functions[iVar])(particle);
-          auto var_type = std::get<1>(m_functions[iVar]);
-          if (std::holds_alternative<double>(var_result)) {
-            if (var_type != Variable::Manager::VariableDataType::c_double)
-              B2WARNING("Wrong registered data type for variable '" + m_variables[iVar] +
-                        "'. Expected Variable::Manager::VariableDataType::c_double. Exported data for this variable might be incorrect.");
-            if (m_useFloat) {
-              m_branchAddressesFloat[iVar + 1] = std::get<double>(var_result);
-            } else {
-              m_branchAddressesDouble[iVar + 1] = std::get<double>(var_result);
-            }
-          } else if (std::holds_alternative<int>(var_result)) {
-            if (var_type != Variable::Manager::VariableDataType::c_int)
-              B2WARNING("Wrong registered data type for variable '" + m_variables[iVar] +
-                        "'. Expected Variable::Manager::VariableDataType::c_int. Exported data for this variable might be incorrect.");
-            m_branchAddressesInt[iVar + 1] = std::get<int>(var_result);
-          } else if (std::holds_alternative<bool>(var_result)) {
-            if (var_type != Variable::Manager::VariableDataType::c_bool)
-              B2WARNING("Wrong registered data type for variable '" + m_variables[iVar] +
-                        "'. Expected Variable::Manager::VariableDataType::c_bool. Exported data for this variable might be incorrect.");
-            m_branchAddressesInt[iVar + 1] = std::get<bool>(var_result);
-          }
+        m_selectedCandidates.push_back(particle);
+        m_selectedCandidateNumbers.push_back(iPart);
+        m_selectedCandidateWeights.push_back(weight);
+      }
+    }
+  }
+  if (m_selectedCandidates.empty()) return;
+
+  m_columns->evaluate(m_selectedCandidates);
+  for (unsigned int iCand = 0; iCand < m_selectedCandidates.size(); iCand++) {
+    m_candidate = m_selectedCandidateNumbers[iCand];
+    if (m_useFloat) {
+      m_branchAddressesFloat[0] = m_selectedCandidateWeights[iCand];
+    } else {
+      m_branchAddressesDouble[0] = m_selectedCandidateWeights[iCand];
+    }
+    for (unsigned int iVar = 0; iVar < m_branchIndices.size(); iVar++) {
+      const unsigned int branch = m_branchIndices[iVar];
+      if (const double* values = m_columns->getDoubleColumn(iVar)) {
+        if (m_useFloat) {
+          m_branchAddressesFloat[branch] = values[iCand];
+        } else {
+          m_branchAddressesDouble[branch] = values[iCand];
         }
-        m_tree->get().Fill();
+      } else {
+        m_branchAddressesInt[branch] = m_columns->getIntColumn(iVar)[iCand];
       }
     }
+    m_tree->get().Fill();
   }
 }
 
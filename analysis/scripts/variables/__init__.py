@@ -113,6 +113,21 @@ class PythonVariableManager:
         instance = PythonVariableManager._instance()
         return instance.evaluateVariables(variables, plist.obj())
 
+    def enableCache(self, variable):
+        '''
+        Wrapper around Manager::enableCache(const std::string& name).
+        '''
+        instance = PythonVariableManager._instance()
+        if not instance.enableCache(variable):
+            raise ValueError(f"Cannot enable the cache for variable {variable}")
+
+    def printCacheStatistics(self):
+        '''
+        Wrapper around Manager::printCacheStatistics().
+        '''
+        instance = PythonVariableManager._instance()
+        instance.printCacheStatistics()
+
     def getNames(self):
         '''
         Wrapper around Manager::getNames().
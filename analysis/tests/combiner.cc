@@ -14,6 +14,7 @@
 
 #include <analysis/DecayDescriptor/DecayDescriptor.h>
 #include <analysis/utility/EvtPDLUtil.h>
+#include <analysis/utility/ParticleListKinematics.h>
 
 #include <framework/datastore/StoreArray.h>
 #include <framework/datastore/StoreObjPtr.h>
@@ -1684,4 +1685,64 @@ namespace {
     EXPECT_EQ(6, aB0_4->getNParticlesOfType(ParticleList::c_SelfConjugatedParticle));
 
   }
+
+  TEST_F(ParticleCombinerTest, ParticleListKinematics)
+  {
+    TestParticleList K("K+");
+    StoreArray<Particle> particles;
+    StoreObjPtr<ParticleList> kplus("K+");
+    StoreObjPtr<ParticleList> kminus("K-");
+    Particle* kp = particles.appendNew(ROOT::Math::PxPyPzEVector(1, 2, 3, 4), 321, Particle::c_Flavored, Particle::c_Track, 1);
+    Particle* km = particles.appendNew(ROOT::Math::PxPyPzEVector(-1, 0, 0.5, 2), -321, Particle::c_Flavored, Particle::c_Track, 2);
+    kplus->addParticle(kp);
+    kminus->addParticle(km);
+
+    ParticleListKinematics kinematics;
+    kinematics.fill(*kplus);
+    EXPECT_EQ(kinematics.size(), 2u);
+    EXPECT_EQ(kinematics.getColumns(ParticleList::c_SelfConjugatedParticle).size(), 0u);
+    const auto& plus = kinematics.getColumns(ParticleList::c_FlavorSpecificParticle);
+    const auto& minus = kinematics.getColumns(ParticleList::c_FlavorSpecificParticle, true);
+    ASSERT_EQ(plus.size(), 1u);
+    ASSERT_EQ(minus.size(), 1u);
+    for (const auto& [columns, particle] : {std::make_pair(&plus, kp), std::make_pair(&minus, km)}) {
+      EXPECT_EQ(columns->index[0], particle->getArrayIndex());
+      EXPECT_DOUBLE_EQ(columns->px[0], particle->getPx());
+      EXPECT_DOUBLE_EQ(columns->py[0], particle->getPy());
+      EXPECT_DOUBLE_EQ(columns->pz[0], particle->getPz());
+      EXPECT_DOUBLE_EQ(columns->energy[0], particle->getEnergy());
+      EXPECT_DOUBLE_EQ(columns->mass[0], particle->getMass());
+      EXPECT_DOUBLE_EQ(columns->charge[0], particle->getCharge());
+      EXPECT_EQ(columns->pdg[0], particle->getPDGCode());
+      EXPECT_EQ(columns->mdstSource[0], particle->getMdstSource());
+      EXPECT_TRUE(columns->finalState[0]);
+    }
+
+    // the combiner builds the mother from the same snapshot
+    ParticleGenerator generator("D0 -> K- K+");
+    generator.init();
+    ASSERT_TRUE(generator.loadNext());
+    const Particle& d0 = generator.getCurrentParticle();
+    EXPECT_DOUBLE_EQ(d0.getPx(), kp->getPx() + km->getPx());
+    EXPECT_DOUBLE_EQ(d0.getPy(), kp->getPy() + km->getPy());
+    EXPECT_DOUBLE_EQ(d0.getPz(), kp->getPz() + km->getPz());
+    EXPECT_NEAR(d0.getEnergy(), kp->getEnergy() + km->getEnergy(), 1e-12);
+    EXPECT_FALSE(generator.loadNext());
+
+    // and a composite contributes the sources of its daughters
+    particles.appendNew(d0);
+    StoreObjPtr<ParticleList> d0list("D0");
+    DataStore::Instance().setInitializeActive(true);
+    d0list.registerInDataStore();
+    DataStore::Instance().setInitializeActive(false);
+    d0list.create();
+    d0list->initialize(421, "D0");
+    d0list->addParticle(particles.getEntries() - 1, 421, Particle::c_Unflavored);
+    kinematics.fill(*d0list);
+    ASSERT_EQ(kinematics.getColumns(ParticleList::c_SelfConjugatedParticle).size(), 1u);
+    EXPECT_FALSE(kinematics.getColumns(ParticleList::c_SelfConjugatedParticle).finalState[0]);
+    ParticleGenerator overlapping("B0 -> D0 K+");
+    overlapping.init();
+    EXPECT_FALSE(overlapping.loadNext());
+  }
 }  // namespace
@@ -215,6 +215,33 @@ namespace {
     EXPECT_TRUE(roe->hasParticle(myParticles[6], "keepMask")); // pi0_gamma0
     EXPECT_TRUE(roe->hasParticle(myParticles[7], "keepMask")); // pi0_gamma1
   }
+  TEST_F(ROETest, maskIndices)
+  {
+    StoreArray<RestOfEvent> myROEs{};
+    const RestOfEvent* roe = myROEs[0];
+
+    const RestOfEvent::IndexBits& all = roe->getParticleIndices();
+    EXPECT_EQ(all.toVector(), std::vector<int>({0, 1, 3, 4, 6, 7}));
+    EXPECT_EQ(roe->getParticleIndices("cutMask").toVector(), std::vector<int>({3, 4}));
+    EXPECT_EQ(roe->getParticleIndices("excludeMask").toVector(), std::vector<int>({0, 4, 6, 7}));
+    EXPECT_EQ(roe->getParticleIndices("keepMask").toVector(), std::vector<int>({1, 3, 6, 7}));
+    EXPECT_B2FATAL(roe->getParticleIndices("doesNotExist"));
+
+    // set operations between masks
+    EXPECT_EQ(roe->getParticleIndices("excludeMask") | roe->getParticleIndices("keepMask"), all);
+    EXPECT_EQ((roe->getParticleIndices("excludeMask") & roe->getParticleIndices("keepMask")).toVector(), std::vector<int>({6, 7}));
+    EXPECT_EQ((all - roe->getParticleIndices("cutMask")).toVector(), std::vector<int>({0, 1, 6, 7}));
+    EXPECT_EQ((all - all).size(), 0u);
+    EXPECT_TRUE((all - all).empty());
+
+    // the 4-vector is the sum over the mask
+    ROOT::Math::PxPyPzEVector sum;
+    StoreArray<Particle> myParticles;
+    roe->getParticleIndices("cutMask").forEach([&](int index) { sum += myParticles[index]->get4Vector(); });
+    EXPECT_FLOAT_EQ(roe->get4Vector("cutMask").E(), sum.E());
+    EXPECT_FLOAT_EQ(roe->get4Vector("cutMask").Px(), sum.Px());
+  }
+
   TEST_F(ROETest, updateMaskWithV0)
   {
     StoreArray<Particle> myParticles;
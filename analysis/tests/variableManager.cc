@@ -6,12 +6,22 @@
  * This file is licensed under LGPL-3.0, see LICENSE.md.                  *
  **************************************************************************/
 #include <analysis/VariableManager/Manager.h>
+#include <analysis/VariableManager/ColumnEvaluator.h>
 #include <analysis/VariableManager/Utility.h>
 #include <analysis/dataobjects/Particle.h>
+#include <analysis/utility/ParticleSubset.h>
+#include <framework/core/ProcessStatistics.h>
+#include <framework/dataobjects/EventMetaData.h>
+#include <framework/datastore/StoreArray.h>
+#include <framework/datastore/StoreObjPtr.h>
 #include <framework/utilities/TestHelpers.h>
 
 #include <gtest/gtest.h>
 
+#include <Math/Vector4D.h>
+
+#include <cmath>
+
 using namespace std;
 using namespace Belle2;
 using namespace Belle2::Variable;
@@ -35,6 +45,46 @@ namespace {
     return func;
   }
 
+  /** Plain variables of all types for the ColumnEvaluator tests */
+  double columnTestPx(const Particle* p) { return p->getPx(); }
+  int columnTestPDG(const Particle* p) { return p->getPDGCode(); }
+  bool columnTestForward(const Particle* p) { return p->getPz() > 0; }
+  double columnTestScaled(const Particle* p, const std::vector<double>& parameters) { return p->getPy() * parameters[0]; }
+  Manager::FunctionPtr columnTestAbs(const std::vector<std::string>& arguments)
+  {
+    const Manager::Var* var = Manager::Instance().getVariable(arguments[0]);
+    auto func = [var](const Particle * p) -> double {
+      return std::abs(std::get<double>(var->function(p)));
+    };
+    return func;
+  }
+
+  /** Number of calls of cacheTestCounted() */
+  int cacheTestCalls = 0;
+  /** Variable counting how often it is called */
+  double cacheTestCounted(const Particle* p)
+  {
+    ++cacheTestCalls;
+    return p ? p->getPx() : -1;
+  }
+
+  /** Register the variables for the ColumnEvaluator tests once, the same way REGISTER_VARIABLE does */
+  void registerColumnTestVariables()
+  {
+    static bool registered = false;
+    if (registered) return;
+    registered = true;
+    Manager& manager = Manager::Instance();
+    manager.registerVariable("columnTestPx", make_function(columnTestPx), "px", get_function_type("columnTestPx", columnTestPx));
+    manager.registerVariable("columnTestPDG", make_function(columnTestPDG), "pdg", get_function_type("columnTestPDG", columnTestPDG));
+    manager.registerVariable("columnTestForward", make_function(columnTestForward), "forward",
+                             get_function_type("columnTestForward", columnTestForward));
+    manager.registerVariable("columnTestScaled(factor)", (Manager::ParameterFunctionPtr)&columnTestScaled, "scaled py",
+                             Manager::VariableDataType::c_double);
+    manager.registerVariable("columnTestAbs(variable)", (Manager::MetaFunctionPtr)&columnTestAbs, "abs",
+                             Manager::VariableDataType::c_double);
+  }
+
   /** test VariableManager. */
   TEST(VariableTest, ManagerDeathTest)
   {
@@ -265,4 +315,164 @@ namespace {
   }
 
 
+  /** Variables registered with plain functions can be called without std::function */
+  TEST(VariableTest, PlainFunctions)
+  {
+    registerColumnTestVariables();
+    const Manager::Var* px = Manager::Instance().getVariable("columnTestPx");
+    const Manager::Var* pdg = Manager::Instance().getVariable("columnTestPDG");
+    const Manager::Var* forward = Manager::Instance().getVariable("columnTestForward");
+    const Manager::Var* scaled = Manager::Instance().getVariable("columnTestScaled(2)");
+    EXPECT_EQ(px->doubleFunction, &columnTestPx);
+    EXPECT_EQ(pdg->intFunction, &columnTestPDG);
+    EXPECT_EQ(forward->boolFunction, &columnTestForward);
+    EXPECT_EQ(scaled->doubleFunction, nullptr);
+
+    // and the std::function still works
+    Particle p({ 0.1, -0.4, 0.8, 1.0 }, 411);
+    EXPECT_EQ(std::get<double>(px->function(&p)), p.getPx());
+    EXPECT_EQ(std::get<int>(pdg->function(&p)), 411);
+    EXPECT_EQ(std::get<bool>(forward->function(&p)), true);
+    EXPECT_EQ(std::get<double>(scaled->function(&p)), 2 * p.getPy());
+  }
+
+  /** Columnar evaluation of a 200 variable ntuple gives the same values as evaluating each variable for each candidate */
+  TEST(VariableTest, ColumnEvaluator)
+  {
+    registerColumnTestVariables();
+    // a mix like in a typical ntuple: plain variables, parameter variables and meta variables on top of them
+    std::vector<std::string> names;
+    for (int i = 0; names.size() < 200; ++i) {
+      names.push_back("columnTestPx");
+      names.push_back("columnTestPDG");
+      names.push_back("columnTestForward");
+      names.push_back("columnTestScaled(" + std::to_string(i) + ")");
+      names.push_back("columnTestAbs(columnTestScaled(" + std::to_string(-i) + "))");
+    }
+    const std::vector<const Manager::Var*> variables = Manager::Instance().getVariables(names);
+
+    std::vector<Particle> particles;
+    particles.reserve(100);
+    for (int i = 0; i < 100; ++i) {
+      particles.emplace_back(ROOT::Math::PxPyPzEVector(0.01 * i, 0.5 - 0.02 * i, 0.3 - 0.01 * i, 2.0), i % 2 ? 211 : -211);
+    }
+    std::vector<const Particle*> candidates;
+    for (const Particle& p : particles) candidates.push_back(&p);
+
+    // evaluate one candidate and variable after the other as VariablesToNtuple used to do
+    std::vector<double> singleResults, columnResults;
+    for (const Particle* candidate : candidates) {
+      for (const Manager::Var* variable : variables) {
+        auto result = variable->function(candidate);
+        if (std::holds_alternative<double>(result)) singleResults.push_back(std::get<double>(result));
+        else if (std::holds_alternative<int>(result)) singleResults.push_back(std::get<int>(result));
+        else if (std::holds_alternative<bool>(result)) singleResults.push_back(std::get<bool>(result));
+      }
+    }
+
+    ColumnEvaluator columns(variables);
+    columns.evaluate(candidates);
+    ASSERT_EQ(columns.getNumberOfRows(), candidates.size());
+    ASSERT_EQ(columns.getNumberOfVariables(), variables.size());
+    for (unsigned int iCand = 0; iCand < candidates.size(); ++iCand) {
+      for (unsigned int iVar = 0; iVar < variables.size(); ++iVar) {
+        columnResults.push_back(columns.getValue(iVar, iCand));
+      }
+    }
+    EXPECT_EQ(singleResults, columnResults);
+    EXPECT_EQ(columns.getDoubleColumn(0)[3], particles[3].getPx());
+    EXPECT_EQ(columns.getIntColumn(0), nullptr);
+    EXPECT_EQ(columns.getIntColumn(1)[3], 211);
+    EXPECT_EQ(columns.getIntColumn(2)[50], 0);
+    EXPECT_EQ(columns.getType(2), Manager::VariableDataType::c_bool);
+
+    // fewer candidates reuse the buffers
+    candidates.resize(10);
+    columns.evaluate(candidates);
+    EXPECT_EQ(columns.getNumberOfRows(), 10u);
+    EXPECT_EQ(columns.getIntColumn(1)[3], 211);
+  }
+
+  /** Cached variables are only calculated once per event and particle */
+  TEST(VariableTest, Cache)
+  {
+    DataStore::Instance().setInitializeActive(true);
+    StoreObjPtr<EventMetaData> eventMetaData;
+    eventMetaData.registerInDataStore();
+    StoreArray<Particle> particles;
+    particles.registerInDataStore();
+    ParticleSubset subset;
+    subset.registerSubset(particles);
+    DataStore::Instance().setInitializeActive(false);
+
+    Manager::Instance().registerVariable("cacheTestCounted", make_function(cacheTestCounted), "counted",
+                                         Manager::VariableDataType::c_double);
+    const Manager::Var* var = Manager::Instance().getVariable("cacheTestCounted");
+    // variables created before enabling the cache use it as well
+    const Manager::Var* absVar = Manager::Instance().getVariable("abs(cacheTestCounted)");
+    EXPECT_EQ(var->doubleFunction, &cacheTestCounted);
+    EXPECT_TRUE(Manager::Instance().enableCache("cacheTestCounted"));
+    EXPECT_TRUE(Manager::Instance().enableCache("cacheTestCounted"));
+    EXPECT_EQ(var->doubleFunction, nullptr);
+    EXPECT_B2FATAL(Manager::Instance().enableCache("cacheTestDoesNotExist"));
+
+    // without an event nothing is cached
+    Particle outside({ 1.0, 0.0, 0.0, 1.0 }, 11);
+    EXPECT_EQ(std::get<double>(var->function(&outside)), outside.getPx());
+    EXPECT_EQ(std::get<double>(var->function(&outside)), outside.getPx());
+    EXPECT_EQ(cacheTestCalls, 2);
+
+    eventMetaData.create();
+    eventMetaData->setEvent(1);
+    const Particle* a = particles.appendNew(ROOT::Math::PxPyPzEVector(1.0, 0.0, 0.0, 2.0), 11);
+    const Particle* b = particles.appendNew(ROOT::Math::PxPyPzEVector(-2.0, 0.0, 0.0, 3.0), -11);
+    cacheTestCalls = 0;
+    // hits and misses are attributed to the module processing the event
+    ProcessStatistics processStatistics;
+    processStatistics.startModule();
+    EXPECT_EQ(std::get<double>(var->function(a)), a->getPx());
+    EXPECT_EQ(std::get<double>(var->function(a)), a->getPx());
+    EXPECT_EQ(std::get<double>(absVar->function(b)), -b->getPx());
+    EXPECT_EQ(std::get<double>(var->function(b)), b->getPx());
+    EXPECT_EQ(std::get<double>(var->function(nullptr)), -1);
+    EXPECT_EQ(std::get<double>(var->function(nullptr)), -1);
+    // particles not in a StoreArray are never cached
+    EXPECT_EQ(std::get<double>(var->function(&outside)), outside.getPx());
+    EXPECT_EQ(cacheTestCalls, 4);
+    processStatistics.stopModule(nullptr, ModuleStatistics::c_Event);
+    EXPECT_EQ(processStatistics.getStatistics(nullptr).getCacheHits(), 3u);
+    EXPECT_EQ(processStatistics.getStatistics(nullptr).getCacheMisses(), 3u);
+
+    // a module changing particles in place invalidates the cache
+    DataStore::Instance().newCacheGeneration();
+    particles[0]->set4Vector(ROOT::Math::PxPyPzEVector(3.0, 0.0, 0.0, 4.0));
+    EXPECT_EQ(std::get<double>(var->function(a)), 3.0);
+    EXPECT_EQ(std::get<double>(var->function(a)), 3.0);
+    EXPECT_EQ(cacheTestCalls, 5);
+
+    // as does removing particles, which moves the remaining ones to the front of the array
+    particles.appendNew(ROOT::Math::PxPyPzEVector(5.0, 0.0, 0.0, 6.0), 11);
+    subset.select([](const Particle * particle) { return particle->getArrayIndex() == 2; });
+    ASSERT_EQ(particles.getEntries(), 1);
+    EXPECT_EQ(std::get<double>(var->function(particles[0])), 5.0);
+    EXPECT_EQ(std::get<double>(var->function(particles[0])), 5.0);
+    EXPECT_EQ(cacheTestCalls, 6);
+
+    // as does the end of the event
+    const unsigned long long generation = DataStore::Instance().getCacheGeneration();
+    DataStore::Instance().invalidateData(DataStore::c_Event);
+    EXPECT_NE(DataStore::Instance().getCacheGeneration(), generation);
+
+    bool found = false;
+    for (const auto& statistics : Manager::Instance().getCacheStatistics()) {
+      if (statistics.name != "cacheTestCounted") continue;
+      found = true;
+      EXPECT_EQ(statistics.hits, 5u);
+      EXPECT_EQ(statistics.misses, 5u);
+      EXPECT_EQ(statistics.uncached, 3u);
+    }
+    EXPECT_TRUE(found);
+    DataStore::Instance().reset();
+  }
+
 }  // namespace
@@ -0,0 +1,89 @@
+/**************************************************************************
+ * basf2 (Belle II Analysis Software Framework)                           *
+ * Author: The Belle II Collaboration                                     *
+ *                                                                        *
+ * See git log for contributors and copyright holders.                    *
+ * This file is licensed under LGPL-3.0, see LICENSE.md.                  *
+ **************************************************************************/
+
+#include <analysis/VariableManager/ColumnEvaluator.h>
+#include <analysis/VariableManager/Manager.h>
+#include <analysis/dataobjects/Particle.h>
+
+#include <Math/Vector4D.h>
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <variant>
+#include <vector>
+
+using namespace Belle2;
+using namespace Belle2::Variable;
+
+/** Compare evaluating ntuple variables one candidate and variable after the other, as VariablesToNtuple did before,
+ * with the evaluation in columns by the ColumnEvaluator.
+ *
+ * Usage: analysis-column_evaluation [variable ...]
+ */
+int main(int argc, char* argv[])
+{
+  // a mix like in a typical ntuple: plain variables, parameter variables and meta variables on top of them
+  std::vector<std::string> names = {"px", "py", "pz", "E", "M", "p", "pt", "charge", "PDG", "cosTheta", "phi", "theta",
+                                    "abs(px)", "abs(formula(px + py))", "formula(E - p)", "passesCut(p > 0.5)"
+                                   };
+  if (argc > 1) names.assign(argv + 1, argv + argc);
+  const std::vector<const Manager::Var*> variables = Manager::Instance().getVariables(names);
+  for (unsigned int iVar = 0; iVar < variables.size(); ++iVar) {
+    if (!variables[iVar]) {
+      std::cerr << "Unknown variable " << names[iVar] << "\n";
+      return 1;
+    }
+  }
+
+  std::vector<Particle> particles;
+  particles.reserve(100);
+  for (int i = 0; i < 100; ++i) {
+    particles.emplace_back(ROOT::Math::PxPyPzEVector(0.01 * i, 0.5 - 0.02 * i, 0.3 - 0.01 * i, 2.0), i % 2 ? 211 : -211);
+  }
+  std::vector<const Particle*> candidates;
+  for (const Particle& p : particles) candidates.push_back(&p);
+
+  const int nEvents = 1000;
+  std::vector<double> doubles(variables.size());
+  std::vector<int> ints(variables.size());
+  double singleSum = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int iEvent = 0; iEvent < nEvents; ++iEvent) {
+    for (const Particle* candidate : candidates) {
+      for (unsigned int iVar = 0; iVar < variables.size(); ++iVar) {
+        auto result = variables[iVar]->function(candidate);
+        if (std::holds_alternative<double>(result)) doubles[iVar] = std::get<double>(result);
+        else if (std::holds_alternative<int>(result)) ints[iVar] = std::get<int>(result);
+        else if (std::holds_alternative<bool>(result)) ints[iVar] = std::get<bool>(result);
+      }
+      singleSum += doubles[0] + ints[0];
+    }
+  }
+  const std::chrono::duration<double, std::nano> singleTime = std::chrono::steady_clock::now() - start;
+
+  ColumnEvaluator columns(variables);
+  double columnSum = 0;
+  start = std::chrono::steady_clock::now();
+  for (int iEvent = 0; iEvent < nEvents; ++iEvent) {
+    columns.evaluate(candidates);
+    for (unsigned int iCand = 0; iCand < candidates.size(); ++iCand) columnSum += columns.getValue(0, iCand);
+  }
+  const std::chrono::duration<double, std::nano> columnTime = std::chrono::steady_clock::now() - start;
+
+  // the values themselves are compared in the VariableTest.ColumnEvaluator unit test
+  if (std::abs(singleSum - columnSum) > 1e-6 * std::abs(singleSum)) {
+    std::cerr << "The first variable differs: " << singleSum << " one by one, " << columnSum << " in columns\n";
+    return 1;
+  }
+  const double nValues = double(nEvents) * candidates.size();
+  std::cout << "Ntuple with " << variables.size() << " variables: " << singleTime.count() / nValues <<
+            " ns per candidate one by one, " << columnTime.count() / nValues << " ns per candidate in columns\n";
+  return 0;
+}
@@ -0,0 +1,81 @@
+/**************************************************************************
+ * basf2 (Belle II Analysis Software Framework)                           *
+ * Author: The Belle II Collaboration                                     *
+ *                                                                        *
+ * See git log for contributors and copyright holders.                    *
+ * This file is licensed under LGPL-3.0, see LICENSE.md.                  *
+ **************************************************************************/
+#pragma once
+
+#include <analysis/dataobjects/ParticleList.h>
+
+#include <vector>
+
+namespace Belle2 {
+  class Particle;
+
+  /** Structure-of-arrays copy of the kinematics of all particles in a ParticleList.
+   *
+   * A ParticleList only holds indices into the Particles StoreArray so any
+   * loop over combinations of particles has to touch the scattered Particle
+   * objects again and again. This class extracts the quantities needed in
+   * such loops once and stores them in contiguous arrays, separately for each
+   * sub list (flavor-specific, anti-particle and self-conjugated) and in the
+   * same order as ParticleList::getList().
+   *
+   * The content is a snapshot: it has to be filled again once per event and
+   * whenever the Particles in the list are modified.
+   *
+   * Example:
+      \code
+      ParticleListKinematics kinematics;
+      kinematics.fill(*list);
+      const auto& columns = kinematics.getColumns(ParticleList::c_FlavorSpecificParticle);
+      for (unsigned int i = 0; i < columns.size(); ++i) sumE += columns.energy[i];
+      \endcode
+   */
+  class ParticleListKinematics {
+  public:
+    /** Kinematics of all particles of one sub list, one entry per particle */
+    struct Columns {
+      std::vector<int> index; /**< StoreArray index of the particle */
+      std::vector<double> px; /**< momentum in x, see Particle::getPx() */
+      std::vector<double> py; /**< momentum in y, see Particle::getPy() */
+      std::vector<double> pz; /**< momentum in z, see Particle::getPz() */
+      std::vector<double> energy; /**< energy, see Particle::getEnergy() */
+      std::vector<double> mass; /**< mass, see Particle::getMass() */
+      std::vector<double> charge; /**< charge, see Particle::getCharge() */
+      std::vector<int> pdg; /**< PDG code */
+      std::vector<int> mdstSource; /**< mdst source (see Particle::getMdstSource()) for final state particles, 0 for composites */
+      std::vector<char> finalState; /**< true if the particle has no daughters */
+
+      /** Number of particles */
+      unsigned int size() const { return index.size(); }
+      /** Remove all particles */
+      void clear();
+      /** Append the kinematics of one particle */
+      void push_back(const Particle& particle, double particleCharge);
+    };
+
+    /** Extract the kinematics of all particles in the list (and its anti-particle list) */
+    void fill(const ParticleList& list);
+
+    /** Kinematics of the given sub list, the order is the same as ParticleList::getList(type, forAntiParticle) */
+    const Columns& getColumns(ParticleList::EParticleType type, bool forAntiParticle = false) const
+    {
+      if (type == ParticleList::c_SelfConjugatedParticle) return m_selfConjugated;
+      return forAntiParticle ? m_antiParticles : m_particles;
+    }
+
+    /** Total number of particles in all sub lists */
+    unsigned int size() const { return m_particles.size() + m_antiParticles.size() + m_selfConjugated.size(); }
+
+  private:
+    /** Fill the columns for the given StoreArray indices */
+    static void fillColumns(Columns& columns, const std::vector<int>& indices, const std::string& arrayName);
+
+    Columns m_particles; /**< flavor-specific particles */
+    Columns m_antiParticles; /**< flavor-specific anti-particles */
+    Columns m_selfConjugated; /**< self-conjugated particles */
+  };
+}
@@ -116,7 +116,7 @@ namespace Belle2 {
       m_reference_frames.pop();
     }
 
-    static std::stack<const ReferenceFrame*> m_reference_frames; /**< Stack of current rest frames */
+    static thread_local std::stack<const ReferenceFrame*> m_reference_frames; /**< Stack of current rest frames, one per thread */
 
     template<class T>
     friend class UseReferenceFrame;
@@ -0,0 +1,70 @@
+/**************************************************************************
+ * basf2 (Belle II Analysis Software Framework)                           *
+ * Author: The Belle II Collaboration                                     *
+ *                                                                        *
+ * See git log for contributors and copyright holders.                    *
+ * This file is licensed under LGPL-3.0, see LICENSE.md.                  *
+ **************************************************************************/
+
+#include <analysis/utility/ParticleListKinematics.h>
+#include <analysis/dataobjects/Particle.h>
+
+#include <framework/datastore/StoreArray.h>
+
+using namespace Belle2;
+
+void ParticleListKinematics::Columns::clear()
+{
+  index.clear();
+  px.clear();
+  py.clear();
+  pz.clear();
+  energy.clear();
+  mass.clear();
+  charge.clear();
+  pdg.clear();
+  mdstSource.clear();
+  finalState.clear();
+}
+
+void ParticleListKinematics::Columns::push_back(const Particle& particle, double particleCharge)
+{
+  const bool isFinalState = particle.getNDaughters() == 0;
+  index.push_back(particle.getArrayIndex());
+  px.push_back(particle.getPx());
+  py.push_back(particle.getPy());
+  pz.push_back(particle.getPz());
+  energy.push_back(particle.getEnergy());
+  mass.push_back(particle.getMass());
+  charge.push_back(particleCharge);
+  pdg.push_back(particle.getPDGCode());
+  mdstSource.push_back(isFinalState ? particle.getMdstSource() : 0);
+  finalState.push_back(isFinalState);
+}
+
+void ParticleListKinematics::fill(const ParticleList& list)
+{
+  const std::string arrayName = list.getParticleCollectionName();
+  fillColumns(m_particles, list.getList(ParticleList::c_FlavorSpecificParticle, false), arrayName);
+  fillColumns(m_antiParticles, list.getList(ParticleList::c_FlavorSpecificParticle, true), arrayName);
+  fillColumns(m_selfConjugated, list.getList(ParticleList::c_SelfConjugatedParticle, false), arrayName);
+}
+
+void ParticleListKinematics::fillColumns(Columns& columns, const std::vector<int>& indices, const std::string& arrayName)
+{
+  columns.clear();
+  if (indices.empty()) return;
+  const StoreArray<Particle> particles(arrayName);
+  // all particles in a sub list usually have the same PDG code so we only
+  // look up the charge in the particle database when it changes
+  int lastPDG{0};
+  double lastCharge{0};
+  for (int i : indices) {
+    const Particle* particle = particles[i];
+    if (columns.size() == 0 or particle->getPDGCode() != lastPDG) {
+      lastPDG = particle->getPDGCode();
+      lastCharge = particle->getCharge();
+    }
+    columns.push_back(*particle, lastCharge);
+  }
+}
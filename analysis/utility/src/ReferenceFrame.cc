@@ -12,7 +12,7 @@
 
 using namespace Belle2;
 
-std::stack<const ReferenceFrame*> ReferenceFrame::m_reference_frames;
+thread_local std::stack<const ReferenceFrame*> ReferenceFrame::m_reference_frames;
 
 
 RestFrame::RestFrame(const Particle* particle) :
@@ -175,6 +175,10 @@ void FastRbuf2DsModule::endRun()
 void FastRbuf2DsModule::terminate()
 {
   pthread_join(m_thr_input, NULL);
+  const TaskPool::Statistics stats = m_streamer->getDecoderStatistics();
+  B2INFO("FastRbuf2Ds: decoded " << stats.executed << " events in " << m_streamer->getMaxThreads() << " threads"
+         << LogVar("mean wait [ms]", stats.meanWaitTime() * 1e3) << LogVar("mean decoding time [ms]", stats.meanRunTime() * 1e3)
+         << LogVar("max queue depth", stats.maxQueueDepth) << LogVar("stolen", stats.stolen));
   B2INFO("FastRbuf2Ds: terminate called");
 }
 
@@ -158,6 +158,20 @@ namespace Belle2 {
         return m_numberProcesses;
     }
 
+    /**
+     * Sets the number of worker threads which should be used for multi-threaded event processing.
+     * If the value is set to 0, no multi-threading will be used in the event loop.
+     * Multi-processing (setNumberProcesses()) takes precedence if both are set.
+     *
+     * @param number The number of worker threads.
+     */
+    void setNumberThreads(int number) { m_numberThreads = number; }
+
+    /**
+     * Returns the number of worker threads which should be used for multi-threaded event processing.
+     */
+    int getNumberThreads() const { return m_numberThreads; }
+
     /**
      * Sets the path to the file where the pickled path is stored
      *
@@ -386,6 +400,7 @@ namespace Belle2 {
 
     std::string m_externalsPath;  /**< The path in which the externals are located. */
     int m_numberProcesses;        /**< The number of worker processes that should be used for the parallel processing. */
+    int m_numberThreads{0};       /**< The number of worker threads that should be used for multi-threaded processing. */
     std::string m_steering;       /**< The content of the steering file. */
     unsigned int m_numberEventsOverride;   /**< Override number of events in the first run. */
     std::vector<std::string> m_inputFilesOverride; /**< Override input file names for input modules */
@@ -112,7 +112,7 @@ namespace Belle2 {
     /** Calls event() on one single module, setting up logging and statistics as needed
      * @param module Module to call the event() function
      */
-    void callEvent(Module* module);
+    virtual void callEvent(Module* module);
 
     /**
      * Terminates the modules.
@@ -130,7 +130,7 @@ namespace Belle2 {
      * beginRun() method of the module which triggered
      * the beginRun() loop will also be called.
      */
-    void processBeginRun(bool skipDB = false);
+    virtual void processBeginRun(bool skipDB = false);
 
     /**
      * Calls the end run methods of all modules.
@@ -140,7 +140,7 @@ namespace Belle2 {
      * endRun() method of the module which triggered
      * the endRun() loop will also be called.
      */
-    void processEndRun();
+    virtual void processEndRun();
 
     /**
      * Calculate the maximum event number out of the argument from command line and the environment.
@@ -179,6 +179,12 @@ namespace Belle2 {
 
     /** True if the SteerRootInputModule is in charge for event processing */
     bool m_steerRootInputModuleOn = false;
+
+    /** Update the process wide state (conditions payloads, random number
+     * generators, job metadata) on new events and runs. Disabled for event
+     * loops running in additional threads, which share this state with the
+     * event loop of the main thread. */
+    bool m_updateGlobalState = true;
   };
 
 }
@@ -74,6 +74,7 @@ namespace Belle2 {
 
     /** Returns total number of entries in the event tree.
      *
+     * If only some entries are read (entry sequences), the number of these entries is returned.
      * If no file is opened, zero is returned.
      */
     static long numEntries(bool independentPath = false);
@@ -78,6 +78,8 @@ namespace Belle2 {
       c_InternalSerializer          = 16,  /**< This module is an internal serializer/deserializer for parallel processing */
       c_TerminateInAllProcesses     = 32,  /**< When using parallel processing, call this module's terminate() function in all processes(). This will also ensure that there is exactly one process (single-core if no parallel modules found) or at least one input, one main and one output process. */
       c_DontCollectStatistics       = 64,  /**< No statistics is collected for this module. */
+      c_ThreadSafe                  = 128, /**< Several instances of this module can process events concurrently in different threads of the same process, each with its own DataStore (see ThreadedEventProcessor). */
+      c_ModifiesObjectsInPlace      = 256, /**< This module changes existing objects in the DataStore, e.g. refits particles. Caches of quantities derived from them are invalidated after each of its event() calls (see DataStore::getCacheGeneration()). */
     };
 
     /// Forward the EAfterConditionPath definition from the ModuleCondition.
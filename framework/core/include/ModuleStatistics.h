@@ -9,6 +9,7 @@
 #pragma once
 
 #include <framework/utilities/CalcMeanCov.h>
+#include <Rtypes.h>
 #include <string>
 #include <ostream>
 
@@ -42,7 +43,8 @@ namespace Belle2 {
     typedef double value_type;
 
     /** Construct with a given name */
-    explicit ModuleStatistics(const std::string& name = ""): m_index(0), m_name(name) {}
+    explicit ModuleStatistics(const std::string& name = ""): m_index(0), m_name(name), m_cacheHits(0), m_cacheMisses(0),
+      m_inputBytes(0), m_readAheadHits(0), m_readAheadRestarts(0), m_readAheadWaitTime(0) {}
 
     /** Add a time and memory measurement to the counter of a given type.
      * @param type Type of counter to add the value to
@@ -62,6 +64,42 @@ namespace Belle2 {
       for (int i = c_Init; i <= c_Total; i++) {
         m_stats[i].add(other.m_stats[i]);
       }
+      m_cacheHits += other.m_cacheHits;
+      m_cacheMisses += other.m_cacheMisses;
+      m_inputBytes += other.m_inputBytes;
+      m_readAheadHits += other.m_readAheadHits;
+      m_readAheadRestarts += other.m_readAheadRestarts;
+      m_readAheadWaitTime += other.m_readAheadWaitTime;
+    }
+
+    /** Add the number of values taken from and added to caches of derived quantities, e.g. cached analysis variables.
+     * @param hits number of values taken from a cache
+     * @param misses number of values calculated and added to a cache
+     */
+    void addCacheCounts(unsigned long long hits, unsigned long long misses)
+    {
+      m_cacheHits += hits;
+      m_cacheMisses += misses;
+    }
+
+    /** Add the amount of input data read by the module.
+     * @param bytes number of uncompressed bytes read
+     */
+    void addInputCounts(unsigned long long bytes)
+    {
+      m_inputBytes += bytes;
+    }
+
+    /** Add the counters of reading input ahead of time in the background.
+     * @param hits number of entries which were already read when they were requested
+     * @param restarts number of times the entries read ahead had to be discarded
+     * @param waitTime time spent waiting for entries read in the background, in the default time unit
+     */
+    void addReadAheadCounts(unsigned long long hits, unsigned long long restarts, value_type waitTime)
+    {
+      m_readAheadHits += hits;
+      m_readAheadRestarts += restarts;
+      m_readAheadWaitTime += waitTime;
     }
 
     /** Set the name of the module for display */
@@ -117,6 +155,19 @@ namespace Belle2 {
       return m_stats[type].getCorrelation<0, 1>();
     }
 
+    /** return the number of values the module took from caches of derived quantities */
+    unsigned long long getCacheHits() const { return m_cacheHits; }
+    /** return the number of values the module calculated and added to caches of derived quantities */
+    unsigned long long getCacheMisses() const { return m_cacheMisses; }
+    /** return the number of uncompressed bytes the module read from its input */
+    unsigned long long getInputBytes() const { return m_inputBytes; }
+    /** return the number of input entries which were already read ahead when the module requested them */
+    unsigned long long getReadAheadHits() const { return m_readAheadHits; }
+    /** return the number of times the module discarded the input entries read ahead */
+    unsigned long long getReadAheadRestarts() const { return m_readAheadRestarts; }
+    /** return the time the module waited for input entries read ahead in the background */
+    value_type getReadAheadWaitTime() const { return m_readAheadWaitTime; }
+
     /** write csv header to the given stream */
     void csv_header(std::ostream& output) const;
     /** write data to the given stream in csv format */
@@ -131,6 +182,12 @@ namespace Belle2 {
     void clear()
     {
       for (auto& stat : m_stats) stat.clear();
+      m_cacheHits = 0;
+      m_cacheMisses = 0;
+      m_inputBytes = 0;
+      m_readAheadHits = 0;
+      m_readAheadRestarts = 0;
+      m_readAheadWaitTime = 0;
     }
   private:
     /** display index of the module */
@@ -139,6 +196,22 @@ namespace Belle2 {
     std::string m_name;
     /** array with  mean/covariance for all counters */
     CalcMeanCov<2, value_type> m_stats[c_Total + 1];
+    /** number of values taken from caches of derived quantities in event() */
+    unsigned long long m_cacheHits;
+    /** number of values calculated and added to caches of derived quantities in event() */
+    unsigned long long m_cacheMisses;
+    /** number of uncompressed bytes read from the input */
+    unsigned long long m_inputBytes;
+    /** number of input entries which were already read ahead when they were requested */
+    unsigned long long m_readAheadHits;
+    /** number of times the input entries read ahead were discarded */
+    unsigned long long m_readAheadRestarts;
+    /** time spent waiting for input entries read ahead in the background */
+    value_type m_readAheadWaitTime;
+
+    /** Version 2: add the cache, input and read-ahead counters. Before, there was no ClassDef and the
+     * class was identified by its checksum only. */
+    ClassDefNV(ModuleStatistics, 2);
   };
 
 } //Belle2 namespace
@@ -134,6 +134,7 @@ namespace Belle2 {
     void startModule()
     {
       setCounters(m_moduleTime, m_moduleMemory);
+      takeCounts(nullptr);
     }
 
     /** Stop module counter and attribute values to appropriate module */
@@ -141,10 +142,35 @@ namespace Belle2 {
     {
       setCounters(m_moduleTime, m_moduleMemory,
                   m_moduleTime, m_moduleMemory);
-      if (module && module->hasProperties(Module::c_DontCollectStatistics)) return;
-      m_stats[getIndex(module)].add(type, m_moduleTime, m_moduleMemory);
+      if (module && module->hasProperties(Module::c_DontCollectStatistics)) {
+        takeCounts(nullptr);
+        return;
+      }
+      ModuleStatistics& stats = m_stats[getIndex(module)];
+      stats.add(type, m_moduleTime, m_moduleMemory);
+      takeCounts(&stats);
     }
 
+    /** Count a value taken from a cache of derived quantities, e.g. a cached analysis variable.
+     *
+     * The counts are kept separately for each thread and attributed to the module
+     * running in the calling thread by stopModule().
+     */
+    static void countCacheHit();
+
+    /** Count a value calculated and added to a cache of derived quantities, see countCacheHit(). */
+    static void countCacheMiss();
+
+    /** Count uncompressed bytes read from the input, attributed to the running module like countCacheHit(). */
+    static void countInput(unsigned long long bytes);
+
+    /** Count the results of reading input ahead of time in the background, attributed to the running module like countCacheHit().
+     * @param hits number of entries which were already read when they were requested
+     * @param restarts number of times the entries read ahead had to be discarded
+     * @param waitTime time spent waiting for entries read in the background
+     */
+    static void countReadAhead(unsigned long long hits, unsigned long long restarts, double waitTime);
+
     /** Init module statistics: Set name from module if still empty and
      * remember initialization index for display
      */
@@ -201,6 +227,9 @@ namespace Belle2 {
     void setCounters(double& time, double& memory,
                      double startTime = 0, double startMemory = 0);
 
+    /** Add the cache and input counts of the calling thread since the last call to the given statistics (if not nullptr) and reset them. */
+    static void takeCounts(ModuleStatistics* stats);
+
     ModuleStatistics m_global; /**< Statistics object for global time and memory consumption */
     std::vector<Belle2::ModuleStatistics> m_stats; /**< module statistics */
 
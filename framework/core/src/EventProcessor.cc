@@ -233,6 +233,8 @@ void EventProcessor::callEvent(Module* module)
   if (collectStats) m_processStatisticsPtr->startModule();
   // call module
   CALL_MODULE(module, event);
+  // caches of derived quantities are kept for the whole event unless the module changed objects in place
+  if (module->hasProperties(Module::c_ModifiesObjectsInPlace)) DataStore::Instance().newCacheGeneration();
   // stop timing
   if (collectStats) m_processStatisticsPtr->stopModule(module, ModuleStatistics::c_Event);
   // reset logging
@@ -252,7 +254,7 @@ void EventProcessor::processInitialize(const ModulePtrList& modulePathList, bool
     m_processStatisticsPtr.create();
   m_processStatisticsPtr->startGlobal();
 
-  MetadataService::Instance().addBasf2Status("initializing");
+  if (m_updateGlobalState) MetadataService::Instance().addBasf2Status("initializing");
 
   // EventExtraInfo is needed in several modules so register it here
   m_eventExtraInfo.registerInDataStore();
@@ -286,7 +288,7 @@ void EventProcessor::processInitialize(const ModulePtrList& modulePathList, bool
         callEvent(module);
         // update Database payloads: we now have valid event meta data unless
         // we don't process any events
-        if (m_eventMetaDataPtr) DBStore::Instance().update();
+        if (m_eventMetaDataPtr and m_updateGlobalState) DBStore::Instance().update();
       }
     }
 
@@ -324,7 +326,7 @@ void EventProcessor::installMainSignalHandlers(void (*fn)(int))
 bool EventProcessor::processEvent(PathIterator moduleIter, bool skipMasterModule)
 {
   double time = Utils::getClock() / Unit::s;
-  if (time > m_lastMetadataUpdate + m_metadataUpdateInterval) {
+  if (m_updateGlobalState and time > m_lastMetadataUpdate + m_metadataUpdateInterval) {
     MetadataService::Instance().addBasf2Status("running event loop");
     m_lastMetadataUpdate = time;
   }
@@ -353,7 +355,7 @@ bool EventProcessor::processEvent(PathIterator moduleIter, bool skipMasterModule
     if (module == m_master) {
 
       //initialize random number state for the event
-      RandomNumbers::initializeEvent();
+      if (m_updateGlobalState) RandomNumbers::initializeEvent();
 
       //Check for a change of the run
       if ((m_eventMetaDataPtr->getExperiment() != m_previousEventMetaData.getExperiment()) ||
@@ -371,10 +373,12 @@ bool EventProcessor::processEvent(PathIterator moduleIter, bool skipMasterModule
 
       m_previousEventMetaData = *m_eventMetaDataPtr;
 
-      //make sure we use the event dependent generator again
-      RandomNumbers::useEventDependent();
+      if (m_updateGlobalState) {
+        //make sure we use the event dependent generator again
+        RandomNumbers::useEventDependent();
 
-      DBStore::Instance().updateEvent();
+        DBStore::Instance().updateEvent();
+      }
 
     } else {
       //Check for a second master module. Cannot do this if we skipped the
@@ -442,7 +446,7 @@ void EventProcessor::processCore(const PathPtr& startPath, const ModulePtrList&
 
 void EventProcessor::processTerminate(const ModulePtrList& modulePathList)
 {
-  MetadataService::Instance().addBasf2Status("terminating");
+  if (m_updateGlobalState) MetadataService::Instance().addBasf2Status("terminating");
 
   LogSystem& logSystem = LogSystem::Instance();
   ModulePtrList::const_reverse_iterator listIter;
@@ -469,18 +473,21 @@ void EventProcessor::processTerminate(const ModulePtrList& modulePathList)
 
 void EventProcessor::processBeginRun(bool skipDB)
 {
-  MetadataService::Instance().addBasf2Status("beginning run");
+  if (m_updateGlobalState) MetadataService::Instance().addBasf2Status("beginning run");
 
   m_inRun = true;
-  auto dbsession = Database::Instance().createScopedUpdateSession(); // cppcheck-suppress unreadVariable
+  // cppcheck-suppress unreadVariable
+  ScopeGuard dbsession = m_updateGlobalState ? Database::Instance().createScopedUpdateSession() : ScopeGuard([] {});
 
   LogSystem& logSystem = LogSystem::Instance();
   m_processStatisticsPtr->startGlobal();
 
-  if (!skipDB) DBStore::Instance().update();
+  if (m_updateGlobalState) {
+    if (!skipDB) DBStore::Instance().update();
 
-  //initialize random generator for end run
-  RandomNumbers::initializeBeginRun();
+    //initialize random generator for end run
+    RandomNumbers::initializeBeginRun();
+  }
 
   for (const ModulePtr& modPtr : m_moduleList) {
     Module* module = modPtr.get();
@@ -503,7 +510,7 @@ void EventProcessor::processBeginRun(bool skipDB)
 
 void EventProcessor::processEndRun()
 {
-  MetadataService::Instance().addBasf2Status("ending run");
+  if (m_updateGlobalState) MetadataService::Instance().addBasf2Status("ending run");
 
   if (!m_inRun)
     return;
@@ -516,7 +523,7 @@ void EventProcessor::processEndRun()
   *m_eventMetaDataPtr = m_previousEventMetaData;
 
   //initialize random generator for end run
-  RandomNumbers::initializeEndRun();
+  if (m_updateGlobalState) RandomNumbers::initializeEndRun();
 
   for (const ModulePtr& modPtr : m_moduleList) {
     Module* module = modPtr.get();
@@ -9,6 +9,7 @@
 #include <framework/logging/Logger.h>
 
 #include <TChain.h>
+#include <TEventList.h>
 #include <TFile.h>
 
 using namespace Belle2;
@@ -80,15 +81,14 @@ std::string InputController::getCurrentFileName(bool independentPath)
 
 long InputController::numEntries(bool independentPath)
 {
-  if (!independentPath) {
-    if (s_chain.first)
-      return s_chain.first->GetEntries();
-  } else {
-    if (s_chain.second)
-      return s_chain.second->GetEntries();
-  }
+  const TChain* chain = !independentPath ? s_chain.first : s_chain.second;
+  if (!chain)
+    return 0;
 
-  return 0;
+  // with entry sequences (or events selected with an event index) only the entries in the event list are read
+  if (const TEventList* list = chain->GetEventList())
+    return list->GetN();
+  return chain->GetEntries();
 }
 
 long InputController::getNumEntriesToProcess()
@@ -369,6 +369,14 @@ void Module::exposePythonAPI()
 .. attribute:: TERMINATEINALLPROCESSES
 
   When using parallel processing, call this module's terminate() function in all processes. This will also ensure that there is exactly one process (single-core if no parallel modules found) or at least one input, one main and one output process.
+
+.. attribute:: THREADSAFE
+
+  Several instances of this module can process events at the same time in different threads of one process, each one using its own DataStore (see :func:`basf2.set_nthreads`). The module must not modify global state without synchronisation.
+
+.. attribute:: MODIFIESOBJECTSINPLACE
+
+  This module changes existing objects in the DataStore, for example it refits particles or updates their momenta. Caches of quantities derived from these objects, like cached analysis variables, are invalidated after each of its event() calls.
 )")
   .value("INPUT", Module::EModulePropFlags::c_Input)
   .value("OUTPUT", Module::EModulePropFlags::c_Output)
@@ -376,6 +384,8 @@ void Module::exposePythonAPI()
   .value("HISTOGRAMMANAGER", Module::EModulePropFlags::c_HistogramManager)
   .value("INTERNALSERIALIZER", Module::EModulePropFlags::c_InternalSerializer)
   .value("TERMINATEINALLPROCESSES", Module::EModulePropFlags::c_TerminateInAllProcesses)
+  .value("THREADSAFE", Module::EModulePropFlags::c_ThreadSafe)
+  .value("MODIFIESOBJECTSINPLACE", Module::EModulePropFlags::c_ModifiesObjectsInPlace)
   ;
 
   //Python class definition
@@ -19,6 +19,8 @@ void ModuleStatistics::csv_header(std::ostream& output) const
     }
     output << "," << resource << " mean" << "," << resource << " stddev";
   }
+  output << ",cache hits,cache misses";
+  output << ",input bytes,read-ahead hits,read-ahead restarts,read-ahead wait time";
   output << std::endl;
 }
 
@@ -36,5 +38,8 @@ void ModuleStatistics::csv(std::ostream& output) const
   }
   output << "," << m_stats[c_Event].getMean<1>() << ","  << m_stats[c_Event].getStddev<1>();
 
+  output << "," << m_cacheHits << "," << m_cacheMisses;
+  output << "," << m_inputBytes << "," << m_readAheadHits << "," << m_readAheadRestarts << "," << m_readAheadWaitTime;
+
   output << std::endl;
 }
\ No newline at end of file
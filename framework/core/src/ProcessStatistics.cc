@@ -24,6 +24,58 @@
 using namespace std;
 using namespace Belle2;
 
+namespace {
+  /** Values taken from caches of derived quantities by the module running in this thread */
+  thread_local unsigned long long t_cacheHits = 0;
+  /** Values calculated and added to caches of derived quantities by the module running in this thread */
+  thread_local unsigned long long t_cacheMisses = 0;
+  /** Uncompressed bytes read from the input by the module running in this thread */
+  thread_local unsigned long long t_inputBytes = 0;
+  /** Input entries already read ahead when the module running in this thread requested them */
+  thread_local unsigned long long t_readAheadHits = 0;
+  /** Times the module running in this thread discarded the input entries read ahead */
+  thread_local unsigned long long t_readAheadRestarts = 0;
+  /** Time the module running in this thread waited for input entries read ahead */
+  thread_local double t_readAheadWaitTime = 0;
+}
+
+void ProcessStatistics::countCacheHit()
+{
+  ++t_cacheHits;
+}
+
+void ProcessStatistics::countCacheMiss()
+{
+  ++t_cacheMisses;
+}
+
+void ProcessStatistics::countInput(unsigned long long bytes)
+{
+  t_inputBytes += bytes;
+}
+
+void ProcessStatistics::countReadAhead(unsigned long long hits, unsigned long long restarts, double waitTime)
+{
+  t_readAheadHits += hits;
+  t_readAheadRestarts += restarts;
+  t_readAheadWaitTime += waitTime;
+}
+
+void ProcessStatistics::takeCounts(ModuleStatistics* stats)
+{
+  if (stats) {
+    stats->addCacheCounts(t_cacheHits, t_cacheMisses);
+    stats->addInputCounts(t_inputBytes);
+    stats->addReadAheadCounts(t_readAheadHits, t_readAheadRestarts, t_readAheadWaitTime);
+  }
+  t_cacheHits = 0;
+  t_cacheMisses = 0;
+  t_inputBytes = 0;
+  t_readAheadHits = 0;
+  t_readAheadRestarts = 0;
+  t_readAheadWaitTime = 0;
+}
+
 int ProcessStatistics::getIndex(const Module* module)
 {
   auto indexIt = m_modulesToStatsIndex.find(module);
@@ -113,6 +165,38 @@ string ProcessStatistics::getStatisticsString(ModuleStatistics::EStatisticCounte
   } else {
     out << "</tfoot></table>";
   }
+
+  //cache usage is only shown if any module used a cache of derived quantities
+  const bool usedCaches = any_of(modulesSortedByIndex.begin(), modulesSortedByIndex.end(), [](const ModuleStatistics & stats) {
+    return stats.getCacheHits() + stats.getCacheMisses() > 0;
+  });
+  if (usedCaches and !html) {
+    boost::format cacheOutput("%s %|" + numTabsModule + "t|| %10d | %10d\n");
+    out << cacheOutput % "Cached values" % "Hits" % "Misses";
+    out << boost::format("%|" + numWidth + "T=|\n");
+    for (const ModuleStatistics& stats : modulesSortedByIndex) {
+      if (stats.getCacheHits() + stats.getCacheMisses() == 0) continue;
+      out << cacheOutput % stats.getName() % stats.getCacheHits() % stats.getCacheMisses();
+    }
+    out << boost::format("%|" + numWidth + "T=|\n");
+  }
+
+  //same for the input read by the modules
+  const bool readInput = any_of(modulesSortedByIndex.begin(), modulesSortedByIndex.end(), [](const ModuleStatistics & stats) {
+    return stats.getInputBytes() > 0;
+  });
+  if (readInput and !html) {
+    boost::format inputHeader("%s %|" + numTabsModule + "t|| %10s | %10s | %10s | %17s\n");
+    boost::format inputOutput("%s %|" + numTabsModule + "t|| %10.2f | %10d | %10d | %17.2f\n");
+    out << inputHeader % "Input" % "Read(MB)" % "Read-ahead" % "Restarts" % "Waiting(s)";
+    out << boost::format("%|" + numWidth + "T=|\n");
+    for (const ModuleStatistics& stats : modulesSortedByIndex) {
+      if (stats.getInputBytes() == 0) continue;
+      out << inputOutput % stats.getName() % (stats.getInputBytes() / 1024. / 1024.) % stats.getReadAheadHits()
+          % stats.getReadAheadRestarts() % (stats.getReadAheadWaitTime() / Unit::s);
+    }
+    out << boost::format("%|" + numWidth + "T=|\n");
+  }
   return out.str();
 }
 
@@ -68,7 +68,8 @@ void SteerRootInputModule::initialize()
   if (m_eventMixing && InputController::getNextExperiment() >= 0 && InputController::getNextRun() >= 0
       && InputController::getNextEvent() >= 0) {
     B2ERROR("Event mixing not possible if you want to skip to a certain exp/run/evt with the RootInputModule."
-            " Please skip to a certain entry in the File instead (use parameter 'skipNEvents').");
+            " Please skip to a certain entry in the File instead (use parameter 'skipNEvents'), or provide an event index"
+            " (parameter 'eventIndex') so the RootInputModule can find the entry itself.");
   }
 
   // Tell the InputController that we are controlling it
@@ -286,6 +286,18 @@ namespace Belle2::Conditions {
     /** Get the timeout we try to lock a file in the download cache directory for downloading */
     size_t getDownloadLockTimeout() const { return m_downloadLockTimeout; }
 
+    /** Set the directory of the node-local payload cache shared between
+     * processes. Empty string disables the shared cache */
+    void setSharedPayloadCacheDirectory(const std::string& directory) { ensureEditable(); m_sharedPayloadCacheDirectory = directory; }
+    /** Get the directory of the node-local payload cache shared between
+     * processes. Empty string means no shared cache */
+    std::string getSharedPayloadCacheDirectory() const { return m_sharedPayloadCacheDirectory; }
+
+    /** Set whether payloads for the next run should be looked up in the background */
+    void setPrefetchPayloads(bool prefetch) { ensureEditable(); m_prefetchPayloads = prefetch; }
+    /** Get whether payloads for the next run should be looked up in the background */
+    bool getPrefetchPayloads() const { return m_prefetchPayloads; }
+
     /** Set the set of usable globaltag states to be allowed for processing.
      * The state INVALID will always be ignored and not permitted */
     void setUsableTagStates(const std::set<std::string>& states) { ensureEditable(); m_usableTagStates = states; }
@@ -339,6 +351,10 @@ namespace Belle2::Conditions {
     std::string m_downloadCacheDirectory{""};
     /** the timeout when trying to lock files in the download directory */
     size_t m_downloadLockTimeout{120};
+    /** the directory of the payload cache shared between processes, empty for none */
+    std::string m_sharedPayloadCacheDirectory{""};
+    /** whether to look up the payloads for the next run in the background */
+    bool m_prefetchPayloads{false};
     /** the tag states accepted for processing */
     std::set<std::string> m_usableTagStates{"TESTING", "VALIDATED", "PUBLISHED", "RUNNING"};
     /** the callback function to determine the final final list of globaltags */
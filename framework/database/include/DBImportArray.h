@@ -126,7 +126,7 @@ namespace Belle2 {
 
     /**
      * add time stamp dependency
-     * @param timeStamp time stamp
+     * @param timeStamp time stamp in ns since epoch, like EventMetaData::getTime()
      */
     void addTimeStampDependency(unsigned long long int timeStamp) override
     {
@@ -9,6 +9,7 @@
 
 #include <framework/database/DBStore.h>
 #include <framework/database/IntervalOfValidity.h>
+#include <framework/logging/Logger.h>
 
 namespace Belle2 {
 
@@ -47,7 +48,7 @@ namespace Belle2 {
 
     /**
      * add time stamp dependency
-     * @param timeStamp time stamp
+     * @param timeStamp time stamp in ns since epoch, like EventMetaData::getTime()
      */
     virtual void addTimeStampDependency(unsigned long long int timeStamp)
     {
@@ -113,11 +114,16 @@ namespace Belle2 {
       IntraRun intraRun(m_objects[0], false); // IntraRun must not own the objects
 
       if (m_object) m_objects.push_back(m_object);
-      for (unsigned i = 1; i < m_objects.size(); i++) {
-        intraRun.add(m_tags[i - 1], m_objects[i]);
+      bool ordered = true;
+      for (unsigned i = 1; i < m_objects.size() and ordered; i++) {
+        ordered = intraRun.add(m_tags[i - 1], m_objects[i]);
       }
       if (m_object) m_objects.pop_back(); // restore initial state (mandatory!)
 
+      if (!ordered) {
+        B2ERROR("DBImportBase::import: intra run dependent objects of " << m_name << " are not in increasing order, not importing it");
+        return false;
+      }
       return storeData(&intraRun, iov);
     }
 
@@ -115,10 +115,12 @@ namespace Belle2 {
     bool isIntraRunDependent() const { return (bool)m_intraRunDependency; }
     /** return the boundaries of the intra-run changes of the payload, if any */
     const std::vector<unsigned int> getIntraRunBoundaries() const { if (isIntraRunDependent()) return m_intraRunDependency->getBoundaries(); return std::vector<unsigned int> {}; }
-    /** Register an Accessor object to be notified on changes by calling DBAccessorBase::storeEntryChanged() */
-    void registerAccessor(DBAccessorBase* object) { m_accessors.insert(object); }
+    /** Register an Accessor object to be notified on changes by calling DBAccessorBase::storeEntryChanged().
+     * Accessors may be created and destroyed concurrently in the worker threads of the ThreadedEventProcessor,
+     * so the list of accessors is protected by a mutex. */
+    void registerAccessor(DBAccessorBase* object);
     /** Deregister an Accessor object and remove it from the list of registered objects */
-    void removeAccessor(DBAccessorBase* object) { m_accessors.erase(object); }
+    void removeAccessor(DBAccessorBase* object);
 
   private:
     /** reset the payload to nothing */
@@ -194,6 +196,8 @@ namespace Belle2 {
     /** If the payload has intra run dependency this will point to the whole
      * payload and m_object will just point to the part currently valid */
     IntraRunDependency* m_intraRunDependency{nullptr};
+    /** Index of the object of m_intraRunDependency found by the last lookup, checked first for the next event */
+    int m_intraRunIndex{0};
     /** Vector of all the accessors registered with this entry */
     std::unordered_set<DBAccessorBase*> m_accessors;
     /** Allow only the DBStore class to update the payload contents */
@@ -18,6 +18,8 @@
 #include <utility>
 #include <list>
 #include <memory>
+#include <future>
+#include <optional>
 
 class TObject;
 
@@ -27,6 +29,7 @@ namespace Belle2 {
   namespace Conditions {
     class MetadataProvider;
     class PayloadProvider;
+    class PayloadCache;
   }
 
   /**
@@ -213,15 +216,48 @@ namespace Belle2 {
     /** Initialize the database connection settings on first use */
     void initialize(const EDatabaseState target = c_Ready);
 
+    /**
+     * Look up the given payloads for the given run in the background, so
+     * that they are available without delay once the run starts.
+     *
+     * The metadata is requested and the payload files are located (and
+     * downloaded if necessary) in a separate thread which is started as soon
+     * as no update session (see createScopedUpdateSession()) is active
+     * anymore. Nothing is reported if the payloads cannot be found, this
+     * will happen when they are actually requested.
+     *
+     * Does nothing if prefetching is disabled in the configuration.
+     *
+     * @param experiment  The experiment number of the next run.
+     * @param run         The next run number.
+     * @param payloads    The payloads which are expected to change.
+     */
+    void prefetch(int experiment, int run, std::vector<DBQuery>&& payloads);
+
+    /** Wait until a running prefetch is finished. Called before anything else touches the payload providers */
+    void waitForPrefetch();
+
+    /** Return the shared payload cache or nullptr if it's not used */
+    const Conditions::PayloadCache* getPayloadCache() const { return m_payloadCache.get(); }
+
   protected:
+    /** Payloads to be prefetched, see prefetch() */
+    struct PrefetchRequest {
+      int experiment; /**< experiment number */
+      int run; /**< run number */
+      std::vector<DBQuery> payloads; /**< payloads to look up */
+    };
+
     /** Hidden constructor, as it is a singleton. */
-    Database() = default;
+    Database();
     /** No copy constructor, as it is a singleton. */
     Database(const Database&) = delete;
     /** Hidden destructor, as it is a singleton. */
     ~Database();
     /** Enable the next metadataprovider in the list */
     void nextMetadataProvider();
+    /** Start the background thread for a pending prefetch request, if any */
+    void startPrefetch();
     /** List of available metadata providers (which haven't been tried yet) */
     std::vector<std::string> m_metadataConfigurations;
     /** Name of the currently used metadata provider */
@@ -240,5 +276,15 @@ namespace Belle2 {
     std::vector<Conditions::TestingPayloadStorage> m_testingPayloads;
     /** Current configuration state of the database */
     EDatabaseState m_configState{c_PreInit};
+    /** optional payload cache shared between processes */
+    std::unique_ptr<Conditions::PayloadCache> m_payloadCache;
+    /** whether payloads should be prefetched for the next run */
+    bool m_prefetchPayloads{false};
+    /** prefetch request waiting for the end of the update session */
+    std::optional<PrefetchRequest> m_pendingPrefetch;
+    /** currently running prefetch */
+    std::future<void> m_prefetch;
+    /** number of active update sessions */
+    int m_updateSessions{0};
   };
 } // namespace Belle2
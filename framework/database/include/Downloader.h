@@ -13,6 +13,8 @@
 #include <iosfwd>
 #include <memory>
 #include <random>
+#include <string>
+#include <vector>
 
 namespace Belle2::Conditions {
   /** Forward declare internal curl session pointer to limit exposure to curl headers */
@@ -21,6 +23,20 @@ namespace Belle2::Conditions {
   /** Simple class to encapsulate libcurl as used by the ConditionsDatabase */
   class Downloader final {
   public:
+    /** A single transfer to be performed by downloadParallel() */
+    struct Transfer {
+      /** url to download */
+      std::string url;
+      /** stream to save the output to */
+      std::ostream* stream{nullptr};
+      /** true if the transfer was successful */
+      bool success{false};
+      /** HTTP response code of the transfer, 0 if there was no response */
+      long responseCode{0};
+      /** error message if the transfer was not successful */
+      std::string error;
+    };
+
     /** Create a new payload downloader */
     Downloader() = default;
     /** Destructor */
@@ -54,6 +70,8 @@ namespace Belle2::Conditions {
     unsigned int getMaxRetries() const { return m_maxRetries; }
     /** Get the backoff factor for retries in seconds */
     unsigned int getBackoffFactor() const { return m_backoffFactor; }
+    /** Get the maximum number of concurrent transfers in downloadParallel() */
+    unsigned int getMaxParallelDownloads() const { return m_maxParallelDownloads; }
     /** Set the timeout to wait for connections in seconds, 0 means built in curl default. */
     void setConnectionTimeout(unsigned int timeout);
     /** Set the timeout to wait for stalled connections (<10KB/s), 0 disables timeout */
@@ -62,6 +80,8 @@ namespace Belle2::Conditions {
     void setMaxRetries(unsigned int retries) { m_maxRetries = retries; }
     /** Set the backoff factor for retries in seconds. Minimum is 1 and 0 will be silently converted to 1 */
     void setBackoffFactor(unsigned int factor) { m_backoffFactor = std::max(1u, factor); }
+    /** Set the maximum number of concurrent transfers in downloadParallel(). Minimum is 1 and 0 will be silently converted to 1 */
+    void setMaxParallelDownloads(unsigned int transfers) { m_maxParallelDownloads = std::max(1u, transfers); }
     /** get an url and save the content to stream
      * This function raises exceptions when there are any problems
      * @warning any contents in the stream will be overwritten
@@ -73,6 +93,21 @@ namespace Belle2::Conditions {
      */
     bool download(const std::string& url, std::ostream& stream, bool silentOnMissing = false);
 
+    /** get a list of urls concurrently and save the content to the streams of
+     * the transfers.
+     *
+     * At most getMaxParallelDownloads() transfers are active at the same time
+     * and connections are kept open and reused for all transfers of the
+     * session, including the ones done by download(). Failed transfers are not
+     * retried, instead success is set to false and the response code and error
+     * are filled so that the caller can decide how to handle them, for example
+     * by calling download() which retries with backoff.
+     *
+     * @warning any contents in the streams will be overwritten
+     * @param transfers list of transfers to perform
+     */
+    void downloadParallel(std::vector<Transfer>& transfers);
+
     /** check the digest of a stream
      * @param input stream to check, make sure the stream is in a valid state pointing to the correct position
      * @param checksum expected hash digest of the data
@@ -92,6 +127,12 @@ namespace Belle2::Conditions {
      */
     static std::string calculateChecksum(std::istream& input);
 
+    /** Apply the options we want for all transfers to a curl handle
+     * @param curl the handle to set up
+     * @param errbuf buffer for the error messages of this handle
+     */
+    void setupHandle(void* curl, char* errbuf);
+
     /** curl session handle */
     std::unique_ptr<CurlSession> m_session;
     /** flag to indicate whether curl has been initialized already */
@@ -104,6 +145,8 @@ namespace Belle2::Conditions {
     unsigned int m_maxRetries{5};
     /** Backoff factor for retries in seconds */
     unsigned int m_backoffFactor{3};
+    /** Maximum number of concurrent transfers in downloadParallel() */
+    unsigned int m_maxParallelDownloads{8};
 
     /**
      * Initialize the seed of the internal random number generator. Do nothing if the seed is already set
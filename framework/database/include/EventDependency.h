@@ -28,10 +28,13 @@ namespace Belle2 {
     /**
      * Add an object to the intra run dependency.
      * Note that the EventDependency object takes ownership of the added object by default.
+     * The objects have to be added in the order of increasing event numbers, otherwise the object
+     * is not added (and deleted if the EventDependency is the owner) and false is returned.
      * @param event    the event number from which on the given conditions object is valid.
      * @param object   the object which is valid starting from the given event number.
+     * @return         true if the object was added.
      */
-    void add(unsigned int event, TObject* object);
+    bool add(unsigned int event, TObject* object);
 
     /**
      * Get a vector with event number boundaries
@@ -57,9 +60,10 @@ namespace Belle2 {
     /**
      * Get the index of the object that is valid for the given event.
      * @param event   meta data of the event for which we want to have the conditions.
+     * @param hint    array index of the object valid for a previous event, checked first.
      * @return        array index of the object valid for the given event.
      */
-    virtual int getIndex(const EventMetaData& event) const override;
+    virtual int getIndex(const EventMetaData& event, int hint) const override;
 
   private:
     /** Vector of event number boundaries. */
@@ -10,6 +10,9 @@
 #include <TObject.h>
 #include <TObjArray.h>
 
+#include <algorithm>
+#include <vector>
+
 
 namespace Belle2 {
   class EventMetaData;
@@ -40,7 +43,18 @@ namespace Belle2 {
      * @param event   meta data of the event for which we want to have the conditions.
      * @return        object valid for the given event.
      */
-    TObject* getObject(const EventMetaData& event) const {return m_objects.At(getIndex(event));};
+    TObject* getObject(const EventMetaData& event) const {return m_objects.At(getIndex(event, 0));};
+
+    /**
+     * Get the conditions object that is valid for the given event, using a lookup hint kept by the caller.
+     * As consecutive events almost always need the same or the next object the object found by the
+     * previous lookup is checked first. The IntraRunDependency itself is not modified by the lookup,
+     * so it can be shared by callers in different threads as long as each of them keeps its own hint.
+     * @param event   meta data of the event for which we want to have the conditions.
+     * @param hint    index of the object found by the previous lookup, updated to the index of the returned object.
+     * @return        object valid for the given event.
+     */
+    TObject* getObject(const EventMetaData& event, int& hint) const {hint = getIndex(event, hint); return m_objects.At(hint);};
 
     /**
      * Get any of the objects. To be used only by the DBStore for type checking.
@@ -68,9 +82,31 @@ namespace Belle2 {
     /**
      * Get the index of the object that is valid for the given event.
      * @param event   meta data of the event for which we want to have the conditions.
+     * @param hint    array index of the object valid for a previous event, checked first.
      * @return        array index of the object valid for the given event.
      */
-    virtual int getIndex(const EventMetaData& event) const = 0;
+    virtual int getIndex(const EventMetaData& event, int hint) const = 0;
+
+    /**
+     * Find the index of the object valid for the given value of sorted boundaries.
+     * Object 0 is valid below the first boundary and object i from boundary i-1 on.
+     * The hint and the index after it are checked first before doing a binary search.
+     * @param boundaries  non-decreasing boundaries between the objects.
+     * @param value       value for which we want to have the conditions.
+     * @param hint        array index of the object valid for a previous value.
+     * @return            array index of the object valid for the given value.
+     */
+    template<class T> static int findIndex(const std::vector<T>& boundaries, T value, int hint)
+    {
+      const int n = boundaries.size();
+      if (hint < 0 or hint > n) hint = 0;
+      for (int index = hint; index <= std::min(hint + 1, n); ++index) {
+        if ((index == 0 or boundaries[index - 1] <= value) and (index == n or value < boundaries[index])) {
+          return index;
+        }
+      }
+      return std::upper_bound(boundaries.begin(), boundaries.end(), value) - boundaries.begin();
+    }
 
     ClassDef(IntraRunDependency, 1);  /**< base class for intra run dependent conditions. */
   };
@@ -0,0 +1,93 @@
+/**************************************************************************
+ * basf2 (Belle II Analysis Software Framework)                           *
+ * Author: The Belle II Collaboration                                     *
+ *                                                                        *
+ * See git log for contributors and copyright holders.                    *
+ * This file is licensed under LGPL-3.0, see LICENSE.md.                  *
+ **************************************************************************/
+#pragma once
+
+#include <framework/database/PayloadMetadata.h>
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace Belle2::Conditions {
+  /** Node-local cache of payload files shared between processes.
+   *
+   * Payload files are copied into a directory (usually in `/dev/shm`) under
+   * a name containing their checksum. The files are only added once their
+   * checksum was verified and they are moved into place atomically, so a
+   * payload found in the cache can be used directly without checking the
+   * checksum again. All processes on a node using the same directory, like
+   * the workers of a parallel processing job, share one copy in memory and
+   * only the first process has to locate or download it.
+   *
+   * The number of cache hits, misses and added files is counted for this
+   * process and, in a small file in the cache directory, for all processes
+   * using the cache.
+   *
+   * Files are never removed from the cache as they stay valid forever.
+   */
+  class PayloadCache {
+  public:
+    /** Usage statistics of the cache */
+    struct Statistics {
+      uint64_t hits{0}; /**< number of payloads found in the cache */
+      uint64_t misses{0}; /**< number of payloads not found in the cache */
+      uint64_t inserted{0}; /**< number of payloads added to the cache */
+      uint64_t prefetched{0}; /**< number of payloads added to the cache by prefetching */
+    };
+
+    /** Use the given directory for the cache, creating it if necessary.
+     * Throws std::runtime_error if the directory cannot be used */
+    explicit PayloadCache(const std::string& directory);
+    /** Unmap the shared statistics */
+    ~PayloadCache();
+    /** No copying */
+    PayloadCache(const PayloadCache&) = delete;
+    /** No assignment */
+    PayloadCache& operator=(const PayloadCache&) = delete;
+
+    /** Look for the payload in the cache and set the filename member of the
+     * metadata on success.
+     * @param metadata the payload to look for, needs a valid checksum
+     * @param count if false don't count this lookup in the statistics
+     * @return true if the payload was found
+     */
+    bool find(PayloadMetadata& metadata, bool count = true);
+    /** Add the file of a payload to the cache and set the filename member of
+     * the metadata to the cached copy.
+     * @param metadata the payload to add, the filename member should point to
+     *    a file with verified checksum
+     * @param prefetched whether the payload is added by prefetching
+     * @return true on success, false if the file could not be copied
+     */
+    bool insert(PayloadMetadata& metadata, bool prefetched = false);
+    /** Get the directory of the cache */
+    const std::string& getDirectory() const { return m_directory; }
+    /** Get the usage statistics of this process */
+    const Statistics& getStatistics() const { return m_statistics; }
+    /** Get the usage statistics of all processes using this cache directory */
+    Statistics getSharedStatistics() const;
+
+  private:
+    /** Statistics in the shared memory mapped file */
+    struct SharedStatistics {
+      std::atomic<uint64_t> hits; /**< number of payloads found in the cache */
+      std::atomic<uint64_t> misses; /**< number of payloads not found in the cache */
+      std::atomic<uint64_t> inserted; /**< number of payloads added to the cache */
+      std::atomic<uint64_t> prefetched; /**< number of payloads added to the cache by prefetching */
+    };
+    /** Return the filename of the given payload in the cache */
+    std::string getFilename(const PayloadMetadata& metadata) const;
+
+    /** Directory of the cache */
+    std::string m_directory;
+    /** Statistics of this process */
+    Statistics m_statistics;
+    /** Statistics of all processes, nullptr if the statistics file could not be mapped */
+    SharedStatistics* m_shared{nullptr};
+  };
+} // Belle2::Conditions namespace
@@ -37,6 +37,13 @@ namespace Belle2::Conditions {
        * `AB/{NAME}_r{REVISION}.root` where A and B are the first to characters
        * of the md5 checksum of the payload file */
       c_hashed,
+      /** Content addressed directory structure containing the payloads in the
+       * form `AB/{CHECKSUM}.root` where A and B are the first two characters of
+       * the md5 checksum of the payload file. This is used for downloaded
+       * payloads so that payloads with identical content are shared between
+       * names, revisions and globaltags. If the checksum is not a valid md5
+       * checksum the c_hashed layout is used instead */
+      c_content,
     };
 
     /** Constructor for a given list of locations and optionally the location
@@ -56,10 +63,13 @@ namespace Belle2::Conditions {
      * - "hashed": Payloads in subdirectories named `/AB/{NAME}_r{REVISION}.root`
      *   where A and B are the first two characters of the md5 checksum of the
      *   payload file.
+     * - "content": Payloads in subdirectories named `/AB/{CHECKSUM}.root`
+     *   where A and B are the first two characters of the md5 checksum of the
+     *   payload file.
      *
      * If cachedir is empty a default value of `$TMPDIR/basf2-conditions`
      * is assumed. Downloaded payloads will be placed in the cachedir using the
-     * hashed directory structure.
+     * content addressed directory structure.
      */
     explicit PayloadProvider(const std::vector<std::string>& locations, const std::string& cachedir = "", int timeout = 60);
 
@@ -71,6 +81,15 @@ namespace Belle2::Conditions {
      * return true.
      */
     bool find(PayloadMetadata& meta);
+
+    /** Try to find a list of payloads, return true if all of them could be found.
+     *
+     * Like find() for a single payload but first all local locations are
+     * checked for all payloads and then the remaining payloads are downloaded
+     * in parallel from each remote location in turn. The filename member of
+     * all payloads which could be found is set.
+     */
+    bool find(const std::vector<PayloadMetadata*>& payloads);
   private:
     /** Look for a payload in the local directory location, set the filename
      * member of the metadata instance and return true on success */
@@ -78,6 +97,10 @@ namespace Belle2::Conditions {
     /** Look for a payload on a remote server and download if possible, set the
      * filename member of the metadata instance and return true on success */
     bool getRemoteFile(const PayloadLocation& loc, PayloadMetadata& meta);
+    /** Download a list of payloads in parallel from a remote server into the
+     * cache directory, set the filename member of the metadata instances we
+     * could get and return the ones which could not be found on this server */
+    std::vector<PayloadMetadata*> getRemoteFiles(const PayloadLocation& loc, const std::vector<PayloadMetadata*>& payloads);
     /** Try to download url into a temporary file, if successful set the
      * filename member of the metadata and return true. Otherwise return false.
      * If silentOnMissing is true a 404 error will not be treated as worthy of a
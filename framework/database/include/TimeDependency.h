@@ -0,0 +1,74 @@
+/**************************************************************************
+ * basf2 (Belle II Analysis Software Framework)                           *
+ * Author: The Belle II Collaboration                                     *
+ *                                                                        *
+ * See git log for contributors and copyright holders.                    *
+ * This file is licensed under LGPL-3.0, see LICENSE.md.                  *
+ **************************************************************************/
+#pragma once
+
+#include <framework/database/IntraRunDependency.h>
+#include <vector>
+
+namespace Belle2 {
+
+  /**
+   * Class for handling changing conditions as a function of the event time.
+   */
+  class TimeDependency: public IntraRunDependency {
+  public:
+
+    /**
+     * Constructor for time dependent conditions.
+     * @param object   the first valid object in the run.
+     * @param owner    flag that indicates whether the TimeDependency takes ownership of the payload objects or not.
+     */
+    explicit TimeDependency(TObject* object = 0, bool owner = true): IntraRunDependency(object, owner) {};
+
+    /**
+     * Add an object to the intra run dependency.
+     * Note that the TimeDependency object takes ownership of the added object by default.
+     * The objects have to be added in the order of increasing time, otherwise the object
+     * is not added (and deleted if the TimeDependency is the owner) and false is returned.
+     * @param time     the time in ns since epoch from which on the given conditions object is valid.
+     * @param object   the object which is valid starting from the given time.
+     * @return         true if the object was added.
+     */
+    bool add(unsigned long long int time, TObject* object);
+
+    /**
+     * Get a vector with the time boundaries in ns since epoch.
+     * In case of no intra-run dependence, the vector is empty
+     * In general for n payloads there are n-1 boundaries
+     */
+    const std::vector<ULong64_t>& getTimes() const { return m_times; }
+
+    /**
+     * Get the stored object according to indx
+     * @param indx index which can have values from 0 to getTimes() - 1
+     */
+    TObject* getObjectByIndex(int indx) const {return m_objects.At(indx);}
+
+    /**
+     * Get a vector with the intra-run boundaries in event numbers.
+     * The boundaries of time dependent conditions are not event numbers so
+     * the vector is always empty, use getTimes() instead.
+     */
+    const std::vector<unsigned int>& getBoundaries() const override;
+
+  protected:
+    /**
+     * Get the index of the object that is valid for the given event.
+     * @param event   meta data of the event for which we want to have the conditions.
+     * @param hint    array index of the object valid for a previous event, checked first.
+     * @return        array index of the object valid for the given event.
+     */
+    virtual int getIndex(const EventMetaData& event, int hint) const override;
+
+  private:
+    /** Vector of time boundaries in ns since epoch. */
+    std::vector<ULong64_t> m_times;
+
+    ClassDefOverride(TimeDependency, 1);  /**< class for time dependent conditions. */
+  };
+}
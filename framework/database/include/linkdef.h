@@ -8,6 +8,7 @@
 #pragma link C++ class Belle2::IntervalOfValidity+; // checksum=0x250d2a86, version=2
 #pragma link C++ class Belle2::IntraRunDependency+; // checksum=0x60107572, version=1
 #pragma link C++ class Belle2::EventDependency+; // checksum=0xdae025f0, version=1
+#pragma link C++ class Belle2::TimeDependency+; // checksum=0xcd00653d, version=1
 #pragma link C++ class Belle2::DBStore-;
 #pragma link C++ class Belle2::Database-;
 #pragma link C++ class Belle2::DBAccessorBase-;
@@ -333,6 +333,12 @@ namespace Belle2::Conditions {
       checkValue("download_lock_timeout",
       [&self](size_t timeout) { self.setDownloadLockTimeout(timeout);},
       [&self]() { return self.getDownloadLockTimeout();});
+      checkValue("shared_payload_cache",
+      [&self](const std::string & path) { self.setSharedPayloadCacheDirectory(path);},
+      [&self]() {return self.getSharedPayloadCacheDirectory();});
+      checkValue("prefetch_payloads",
+      [&self](bool prefetch) { self.setPrefetchPayloads(prefetch);},
+      [&self]() {return self.getPrefetchPayloads();});
       checkValue("usable_globaltag_states",
       [&self](const auto & states) { self.setUsableTagStates(states); },
       [&self]() { return self.getUsableTagStates(); });
@@ -348,6 +354,9 @@ namespace Belle2::Conditions {
       checkValue("backoff_factor",
       [&downloader](unsigned int factor) { downloader.setBackoffFactor(factor);},
       [&downloader]() { return downloader.getBackoffFactor();});
+      checkValue("max_parallel_downloads",
+      [&downloader](unsigned int transfers) { downloader.setMaxParallelDownloads(transfers);},
+      [&downloader]() { return downloader.getMaxParallelDownloads();});
       // And lastly check if there is something in the kwargs we don't understand ...
       if (py::len(kwargs) > 0) {
         std::string message = "Unrecognized keyword arguments: ";
@@ -525,7 +534,7 @@ the payloads on the server is the same as on the main payload server:
 The combination of given location and the relative url in the payload metadata
 field ``payloadUrl`` should point to the correct payload on the server.
 
-For local directories, two layouts are supported and will be auto detected:
+For local directories, three layouts are supported and will be auto detected:
 
 flat
     All payloads are in the same directory without any substructure with the name
@@ -534,6 +543,10 @@ hashed
     All payloads are stored in subdirectories in the form ``AB/{name}_r{revision}.root``
     where ``A`` and ``B`` are the first two characters of the md5 checksum of the
     payload file.
+content
+    All payloads are stored in subdirectories in the form ``AB/{checksum}.root``
+    where ``A`` and ``B`` are the first two characters of the md5 checksum of the
+    payload file. This is the layout used for downloaded payloads.
 
 Example:
   Given ``payload_locations = ["payload_dir/", "http://server.com/payloads"]``
@@ -541,9 +554,10 @@ Example:
   ``45`` (and checksum ``a34ce5...``) in the following places
 
 
-  1. ``payload_dir/a3/BeamParameters_r45.root``
-  2. ``payload_dir/dbstore_BeamParameters_rev_45.root``
-  3. ``http://server.com/payloads/dbstore/BeamParameters/dbstore_BeamParameters_rev_45.root``
+  1. ``payload_dir/a3/a34ce5....root``
+  2. ``payload_dir/a3/BeamParameters_r45.root``
+  3. ``payload_dir/dbstore_BeamParameters_rev_45.root``
+  4. ``http://server.com/payloads/dbstore/BeamParameters/dbstore_BeamParameters_rev_45.root``
      given the usual pattern of the ``payloadUrl`` metadata. But this could be
      changed on the central servers so mirrors should not depend on this convention
      but copy the actual structure of the central server.
@@ -551,6 +565,9 @@ Example:
 If the payload cannot be found in any of the given locations the framework will
 always attempt to download it directly from the central server and put it in a
 local cache directory.
+
+If several payloads are needed at the same time, all local directories are
+checked first and the payloads not found there are downloaded in parallel.
 )DOC")
     .def("expert_settings", expert, R"DOC(expert_settings(**kwargs)
 
@@ -563,11 +580,14 @@ function will return a dictionary containing all current settings.
     {'save_payloads': 'localdb/database.txt',
      'download_cache_location': '',
      'download_lock_timeout': 120,
+     'shared_payload_cache': '',
+     'prefetch_payloads': False,
      'usable_globaltag_states': {'PUBLISHED', 'RUNNING', 'TESTING', 'VALIDATED'},
      'connection_timeout': 5,
      'stalled_timeout': 60,
      'max_retries': 1,
-     'backoff_factor': 5}
+     'backoff_factor': 5,
+     'max_parallel_downloads': 8}
 
 Warning:
     Modification of these parameters should not be needed, in rare
@@ -582,11 +602,24 @@ Parameters:
       from the central server. This could be a user defined directory, otherwise
       empty string defaults to ``$TMPDIR/basf2-conditions`` where ``$TMPDIR`` is the
       temporary directories defined in the system. Newly downloaded payloads will
-      be stored in this directory in a hashed structure, see `payload_locations`
+      be stored in this directory in a content addressed structure, see
+      `payload_locations`, so payloads with identical content are only
+      downloaded once, even if they are used in different globaltags
   download_lock_timeout (int): How many seconds to wait for a write lock when
       concurrently downloading the same payload between different processes.
       If locking fails the payload will be downloaded to a temporary file
       separately for each process.
+  shared_payload_cache (str): Directory of a payload cache shared between all
+      processes on the same node, for example ``/dev/shm/basf2-payloads``.
+      Payload files are copied there once their checksum has been verified and
+      all processes using the same directory, like the workers of a parallel
+      processing job, will use this copy without checking or downloading it
+      again. Files in this directory are not removed automatically. Empty
+      string disables the shared cache.
+  prefetch_payloads (bool): If True the payloads which are not valid anymore
+      for the next run are looked up (and downloaded if necessary) in the
+      background while processing the current run. This is useful for jobs
+      processing many consecutive runs.
   usable_globaltag_states (set(str)): Names of globaltag states accepted for
       processing. This can be changed to make sure that only fully published
       globaltags are used or to enable running on an open tag. It is not possible
@@ -602,6 +635,9 @@ Parameters:
       and a ``backoff_factor`` :math:`f` we wait for a random time chosen
       uniformly from the interval :math:`[1, (2^{n} - 1) \times f]` in
       seconds.
+  max_parallel_downloads (int): maximum number of payloads to download at the
+      same time if several payloads are needed which are not available locally.
+      Connections to the servers are kept open and reused for all downloads.
 )DOC")
     .def("set_globaltag_callback", &Configuration::setGlobaltagCallbackPy, R"DOC(set_globaltag_callback(function)
 
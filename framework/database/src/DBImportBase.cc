@@ -8,6 +8,7 @@
 
 #include <framework/database/DBImportBase.h>
 #include <framework/database/EventDependency.h>
+#include <framework/database/TimeDependency.h>
 #include <framework/database/Database.h>
 #include <framework/logging/Logger.h>
 
@@ -40,9 +41,7 @@ bool DBImportBase::import(const IntervalOfValidity& iov)
     case c_Event:
       return import<EventDependency>(iov);
     case c_TimeStamp:
-      B2ERROR("DBImportBase::import: " <<
-              "intra run dependency of type 'time stamp' not supported yet");
-      return false;
+      return import<TimeDependency>(iov);
     case c_Subrun:
       B2ERROR("DBImportBase::import: " <<
               "intra run dependency of type 'subrun' not supported yet");
@@ -12,6 +12,13 @@
 
 #include <TClass.h>
 
+#include <mutex>
+
+namespace {
+  /** Protects the creation of entries by accessors constructed in the worker threads of the ThreadedEventProcessor. */
+  std::recursive_mutex s_entriesMutex;
+}
+
 namespace Belle2 {
 
   DBStore::~DBStore()
@@ -28,6 +35,8 @@ namespace Belle2 {
   DBStoreEntry* DBStore::getEntry(DBStoreEntry::EPayloadType type, const std::string& name,
                                   const TClass* objClass, bool array, bool required)
   {
+    std::lock_guard<std::recursive_mutex> lock(s_entriesMutex);
+
     // Check whether the map entry already exists
     const auto& entry = m_dbEntries.find(name);
     if (entry != m_dbEntries.end()) {
@@ -131,6 +140,16 @@ namespace Belle2 {
       dbEntry.updatePayload(query.revision, query.iov, query.filename, query.checksum, query.globaltag, event);
       if (dbEntry.isIntraRunDependent()) m_intraRunDependencies.insert(&dbEntry);
     }
+
+    // Payloads not valid for the next run anymore will most likely be needed
+    // soon, so let the database look for them while we process this run.
+    const EventMetaData next(1, event.getRun() + 1, event.getExperiment());
+    std::vector<Database::DBQuery> upcoming;
+    for (auto& entry : m_dbEntries) {
+      if (!entry.second.keepUntilExpired() and !entry.second.getIoV().contains(next))
+        upcoming.emplace_back(entry.first, false);
+    }
+    Database::Instance().prefetch(event.getExperiment(), event.getRun() + 1, std::move(upcoming));
   }
 
   void DBStore::updateEvent()
@@ -11,11 +11,15 @@
 #include <framework/dataobjects/EventMetaData.h>
 #include <framework/logging/Logger.h>
 #include <iomanip>
+#include <mutex>
 #include <TFile.h>
 #include <TClonesArray.h>
 #include <TClass.h>
 
 namespace {
+  /** Protects the lists of accessors of all entries, recursive since accessors may be created in the change callbacks. */
+  std::recursive_mutex s_accessorsMutex;
+
   /** do nothing, needed for variadic template below */
   void deleteAndSetNullptr() {}
   /** simple helper to delete a pointer and set it to nullptr. This can take
@@ -54,7 +58,7 @@ namespace Belle2 {
     if (!m_intraRunDependency) return;
     // otherwise update the object and call notify all accessors on change
     TObject* old = m_object;
-    m_object = m_intraRunDependency->getObject(event);
+    m_object = m_intraRunDependency->getObject(event, m_intraRunIndex);
     if (old != m_object) {
       B2DEBUG(35, "IntraRunDependency for " << m_name << ": new object (" << old << ", " << m_object << "), notifying accessors");
       notifyAccessors();
@@ -142,7 +146,8 @@ namespace Belle2 {
         // resolve run dependency
         if (m_object->InheritsFrom(IntraRunDependency::Class())) {
           m_intraRunDependency = static_cast<IntraRunDependency*>(m_object);
-          m_object = m_intraRunDependency->getObject(event);
+          m_intraRunIndex = 0;
+          m_object = m_intraRunDependency->getObject(event, m_intraRunIndex);
           B2DEBUG(34, "Found intra run dependency for " << m_name << ": " << m_intraRunDependency << ", " << m_object);
         }
         // TODO: depending on the object type we could now close the file. I
@@ -183,8 +188,21 @@ namespace Belle2 {
     notifyAccessors();
   }
 
+  void DBStoreEntry::registerAccessor(DBAccessorBase* object)
+  {
+    std::lock_guard<std::recursive_mutex> lock(s_accessorsMutex);
+    m_accessors.insert(object);
+  }
+
+  void DBStoreEntry::removeAccessor(DBAccessorBase* object)
+  {
+    std::lock_guard<std::recursive_mutex> lock(s_accessorsMutex);
+    m_accessors.erase(object);
+  }
+
   void DBStoreEntry::notifyAccessors(bool onDestruction)
   {
+    std::lock_guard<std::recursive_mutex> lock(s_accessorsMutex);
     // Just notify all registered accessors ...
     for (DBAccessorBase* object : m_accessors) object->storeEntryChanged(onDestruction);
     // on destruction we also should clear the list ... we will not call them again
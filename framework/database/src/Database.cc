@@ -21,9 +21,11 @@
 
 #include <framework/dataobjects/EventMetaData.h>
 #include <framework/logging/Logger.h>
+#include <framework/logging/LogSystem.h>
 #include <framework/database/DBStore.h>
 
 #include <framework/database/PayloadProvider.h>
+#include <framework/database/PayloadCache.h>
 #include <framework/database/MetadataProvider.h>
 #include <framework/database/LocalMetadataProvider.h>
 #include <framework/database/CentralMetadataProvider.h>
@@ -32,6 +34,8 @@
 #include <algorithm>
 #include <cstdlib>
 
+#include <pthread.h>
+
 namespace Belle2 {
 
   Database& Database::Instance()
@@ -40,13 +44,35 @@ namespace Belle2 {
     return instance;
   }
 
-  Database::~Database() = default;
+  Database::Database()
+  {
+    // a prefetch thread must not be running while forking, the child would
+    // inherit the providers in an undefined state.
+    pthread_atfork([] { Database::Instance().waitForPrefetch(); }, nullptr, nullptr);
+  }
+
+  Database::~Database()
+  {
+    waitForPrefetch();
+  }
 
   void Database::reset(bool keepConfig)
   {
     auto& conf = Conditions::Configuration::getInstance();
     conf.setInitialized(false);
     DBStore::Instance().reset(true);
+    Instance().waitForPrefetch();
+    Instance().m_pendingPrefetch.reset();
+    if (const auto& cache = Instance().m_payloadCache) {
+      const auto& local = cache->getStatistics();
+      const auto shared = cache->getSharedStatistics();
+      B2INFO("Conditions data: shared payload cache statistics"
+             << LogVar("directory", cache->getDirectory())
+             << LogVar("hits", local.hits) << LogVar("misses", local.misses)
+             << LogVar("inserted", local.inserted) << LogVar("prefetched", local.prefetched)
+             << LogVar("hits (all processes)", shared.hits) << LogVar("misses (all processes)", shared.misses));
+    }
+    Instance().m_payloadCache.reset();
     Instance().m_configState = c_PreInit;
     Instance().m_metadataProvider.reset();
     Instance().m_payloadCreation.reset();
@@ -56,12 +82,69 @@ namespace Belle2 {
 
   ScopeGuard Database::createScopedUpdateSession()
   {
+    // the downloader session must not be shared with a running prefetch
+    waitForPrefetch();
     // make sure we reread testing text files in case they got updated
     for (auto& testing : m_testingPayloads) {
       testing.reset();
     }
-    // and return a downloader session guard for the downloader we use
-    return Conditions::Downloader::getDefaultInstance().ensureSession();
+    // and return a guard for the downloader session we use, once the last
+    // session is done we can start prefetching
+    bool started = Conditions::Downloader::getDefaultInstance().startSession();
+    ++m_updateSessions;
+    return ScopeGuard([this, started] {
+      if (started) Conditions::Downloader::getDefaultInstance().finishSession();
+      if (--m_updateSessions == 0) startPrefetch();
+    });
+  }
+
+  void Database::prefetch(int experiment, int run, std::vector<DBQuery>&& payloads)
+  {
+    if (!m_prefetchPayloads or !m_metadataProvider or payloads.empty()) return;
+    waitForPrefetch();
+    // We only want to look, not complain if the next run doesn't exist
+    for (auto& payload : payloads) payload.required = false;
+    m_pendingPrefetch = PrefetchRequest{experiment, run, std::move(payloads)};
+    if (m_updateSessions == 0) startPrefetch();
+  }
+
+  void Database::startPrefetch()
+  {
+    if (!m_pendingPrefetch) return;
+    B2DEBUG(35, "Conditions data: prefetching payloads" << LogVar("experiment", m_pendingPrefetch->experiment)
+            << LogVar("run", m_pendingPrefetch->run) << LogVar("payloads", m_pendingPrefetch->payloads.size()));
+    m_prefetch = std::async(std::launch::async, [this, request = std::move(*m_pendingPrefetch)]() mutable {
+      // Problems will be reported once the payloads are actually requested,
+      // they should not show up (or count as errors) for a run which might not be processed.
+      LogConfig quiet(LogConfig::c_Fatal);
+      LogSystem::Instance().updateModule(&quiet, "ConditionsPrefetch");
+      try {
+        // this fills the metadata cache of the provider for the next run ...
+        m_metadataProvider->getPayloads(request.experiment, request.run, request.payloads);
+        // ... and this makes sure the files are available locally
+        std::vector<DBQuery*> missing;
+        for (auto& payload : request.payloads) {
+          if (payload.revision == 0 or !payload.filename.empty()) continue;
+          if (m_payloadCache and m_payloadCache->find(payload, false)) continue;
+          missing.push_back(&payload);
+        }
+        m_payloadProvider->find(missing);
+        if (m_payloadCache) {
+          for (auto* payload : missing) {
+            if (!payload->filename.empty()) m_payloadCache->insert(*payload, true);
+          }
+        }
+      } catch (std::exception&) {
+        // see above, nothing to report
+      }
+      LogSystem::Instance().updateModule(nullptr);
+    });
+    m_pendingPrefetch.reset();
+  }
+
+  void Database::waitForPrefetch()
+  {
+    if (m_prefetch.valid()) m_prefetch.get();
   }
 
   std::pair<TObject*, IntervalOfValidity> Database::getData(const EventMetaData& event, const std::string& name)
@@ -77,6 +160,8 @@ namespace Belle2 {
   {
     // initialize lazily ...
     if (!m_metadataProvider) initialize();
+    // and don't interfere with prefetching
+    waitForPrefetch();
     // So first go over the requested payloads once, reset the info and check for any
     // testing payloads we might want to use
     const size_t testingPayloads = std::count_if(query.begin(), query.end(), [this, &event](auto & payload) {
@@ -101,26 +186,38 @@ namespace Belle2 {
       nextMetadataProvider();
       return getData(event, query);
     }
-    // and if we could find the metadata lets also locate the payloads ...
-    const size_t payloadsLocated = std::count_if(query.begin(), query.end(), [this](auto & payload) {
+    // and if we could find the metadata lets also locate the payloads. We
+    // collect all the ones we don't have yet so that they can be downloaded in
+    // parallel
+    std::vector<DBQuery*> missing;
+    for (auto& payload : query) {
       // make sure we don't overwrite local payloads or otherwise already valid filenames;
-      if (!payload.filename.empty()) return true;
-      // but don't check for payloads we could not find. But this is only a
-      // problem if they are required so report success for not required
-      // payloads
-      if (payload.revision == 0) return not payload.required;
-      // and locate the payload.
-      if (not m_payloadProvider->find(payload)) {
+      if (!payload.filename.empty()) continue;
+      // but don't check for payloads we could not find.
+      if (payload.revision == 0) continue;
+      // the shared cache contains only verified files so no need to look further
+      if (m_payloadCache and m_payloadCache->find(payload)) continue;
+      missing.push_back(&payload);
+    }
+    // and locate the payloads.
+    if (not missing.empty()) m_payloadProvider->find(missing);
+    for (auto* payload : missing) {
+      if (payload->filename.empty()) {
         // if that fails lets let the user know: Even for optional payloads, if
         // we know the metadata but cannot find the file something is fishy and
         // should be reported.
-        auto loglevel = payload.required ? LogConfig::c_Error : LogConfig::c_Warning;
+        auto loglevel = payload->required ? LogConfig::c_Error : LogConfig::c_Warning;
         B2LOG(loglevel, 0, "Conditions data: Could not find file for payload"
-              << LogVar("name", payload.name) << LogVar("revision", payload.revision)
-              << LogVar("checksum", payload.checksum) << LogVar("globaltag", payload.globaltag));
-        return not payload.required;
+              << LogVar("name", payload->name) << LogVar("revision", payload->revision)
+              << LogVar("checksum", payload->checksum) << LogVar("globaltag", payload->globaltag));
+        continue;
       }
-      return true;
+      // and share it with other processes on this node
+      if (m_payloadCache) m_payloadCache->insert(*payload);
+    }
+    // Payloads we could not find are only a problem if they are required
+    const size_t payloadsLocated = std::count_if(query.begin(), query.end(), [](auto & payload) {
+      return not payload.filename.empty() or not payload.required;
     });
     // did we find all payloads?
     return payloadsLocated == query.size();
@@ -244,6 +341,18 @@ namespace Belle2 {
                             conf.getDownloadCacheDirectory(),
                             conf.getDownloadLockTimeout()
                           );
+      // Optionally share payloads between processes on this node
+      m_payloadCache.reset();
+      if (const auto directory = conf.getSharedPayloadCacheDirectory(); !directory.empty()) {
+        try {
+          m_payloadCache = std::make_unique<Conditions::PayloadCache>(directory);
+          B2INFO("Conditions data: using shared payload cache" << LogVar("directory", m_payloadCache->getDirectory()));
+        } catch (std::exception& e) {
+          B2WARNING("Conditions data: shared payload cache not usable, continuing without"
+                    << LogVar("directory", directory) << LogVar("error", e.what()));
+        }
+      }
+      m_prefetchPayloads = conf.getPrefetchPayloads();
       // Also we need to be able to create payloads ...
       m_payloadCreation = std::make_unique<Conditions::TestingPayloadStorage>(conf.getNewPayloadLocation());
       // And maaaybe we want to use testing payloads
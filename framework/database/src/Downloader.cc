@@ -19,9 +19,19 @@
 #include <boost/algorithm/string.hpp>
 
 #include <chrono>
+#include <cstring>
 #include <thread>
+#include <unordered_map>
 
 namespace Belle2::Conditions {
+  /** curl handle and error buffer for one of the concurrent transfers */
+  struct CurlTransfer {
+    /** curl handle */
+    CURL* curl{nullptr};
+    /** error buffer in case some error happens during downloading */
+    char errbuf[CURL_ERROR_SIZE];
+  };
+
   /** struct encapsulating all the state information needed by curl */
   struct CurlSession {
     /** curl session information */
@@ -32,6 +42,12 @@ namespace Belle2::Conditions {
     char errbuf[CURL_ERROR_SIZE];
     /** last time we printed the status (in ns) */
     double lasttime{0};
+    /** share handle to keep one cache of open connections for all handles of the session */
+    CURLSH* share{nullptr};
+    /** multi handle for concurrent transfers, created on first use */
+    CURLM* multi{nullptr};
+    /** handles for concurrent transfers, created on first use and reused afterwards */
+    std::vector<std::unique_ptr<CurlTransfer>> transfers;
   };
 
   namespace {
@@ -173,49 +189,64 @@ namespace Belle2::Conditions {
       B2FATAL("Cannot initialize libcurl");
     }
     m_session->headers = curl_slist_append(nullptr, "Accept: application/json");
-    curl_easy_setopt(m_session->curl, CURLOPT_HTTPHEADER, m_session->headers);
-    curl_easy_setopt(m_session->curl, CURLOPT_TCP_KEEPALIVE, 1L);
-    curl_easy_setopt(m_session->curl, CURLOPT_CONNECTTIMEOUT, m_connectionTimeout);
-    curl_easy_setopt(m_session->curl, CURLOPT_LOW_SPEED_LIMIT, 10 * 1024); //10 kB/s
-    curl_easy_setopt(m_session->curl, CURLOPT_LOW_SPEED_TIME, m_stalledTimeout);
-    curl_easy_setopt(m_session->curl, CURLOPT_WRITEFUNCTION, write_function);
-    curl_easy_setopt(m_session->curl, CURLOPT_VERBOSE, 1);
-    curl_easy_setopt(m_session->curl, CURLOPT_NOPROGRESS, 0);
-    curl_easy_setopt(m_session->curl, CURLOPT_DEBUGFUNCTION, debug_callback);
-    curl_easy_setopt(m_session->curl, CURLOPT_XFERINFOFUNCTION, progress_callback);
-    curl_easy_setopt(m_session->curl, CURLOPT_XFERINFODATA, m_session.get());
-    curl_easy_setopt(m_session->curl, CURLOPT_FAILONERROR, true);
-    curl_easy_setopt(m_session->curl, CURLOPT_ERRORBUFFER, m_session->errbuf);
+    // all handles of the session share the open connections so that they can be reused by every transfer
+    m_session->share = curl_share_init();
+    curl_share_setopt(m_session->share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+    setupHandle(m_session->curl, m_session->errbuf);
+    return true;
+  }
+
+  void Downloader::setupHandle(void* handle, char* errbuf)
+  {
+    CURL* curl = static_cast<CURL*>(handle);
+    curl_easy_setopt(curl, CURLOPT_SHARE, m_session->share);
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, m_session->headers);
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, m_connectionTimeout);
+    curl_easy_setopt(curl, CURLOPT_LOW_SPEED_LIMIT, 10 * 1024); //10 kB/s
+    curl_easy_setopt(curl, CURLOPT_LOW_SPEED_TIME, m_stalledTimeout);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_function);
+    curl_easy_setopt(curl, CURLOPT_VERBOSE, 1);
+    curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0);
+    curl_easy_setopt(curl, CURLOPT_DEBUGFUNCTION, debug_callback);
+    curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, progress_callback);
+    curl_easy_setopt(curl, CURLOPT_XFERINFODATA, m_session.get());
+    curl_easy_setopt(curl, CURLOPT_FAILONERROR, true);
+    curl_easy_setopt(curl, CURLOPT_ERRORBUFFER, errbuf);
     // enable transparent compression support
-    curl_easy_setopt(m_session->curl, CURLOPT_ACCEPT_ENCODING, "");
+    curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, "");
     // Set proxy if defined
     if (EnvironmentVariables::isSet("BELLE2_CONDB_PROXY")) {
       const std::string proxy = EnvironmentVariables::get("BELLE2_CONDB_PROXY");
-      curl_easy_setopt(m_session->curl, CURLOPT_PROXY, proxy.c_str());
+      curl_easy_setopt(curl, CURLOPT_PROXY, proxy.c_str());
     }
-    curl_easy_setopt(m_session->curl, CURLOPT_AUTOREFERER, 1L);
-    curl_easy_setopt(m_session->curl, CURLOPT_FOLLOWLOCATION, 1L);
-    curl_easy_setopt(m_session->curl, CURLOPT_MAXREDIRS, 10L);
-    curl_easy_setopt(m_session->curl, CURLOPT_TCP_FASTOPEN, 0L);
-    curl_easy_setopt(m_session->curl, CURLOPT_SSL_VERIFYPEER, 0L);
-    curl_easy_setopt(m_session->curl, CURLOPT_SSL_VERIFYHOST, 0L);
-    curl_easy_setopt(m_session->curl, CURLOPT_SSL_VERIFYSTATUS, 0L);
-    curl_easy_setopt(m_session->curl, CURLOPT_IPRESOLVE, CURL_IPRESOLVE_WHATEVER);
+    curl_easy_setopt(curl, CURLOPT_AUTOREFERER, 1L);
+    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(curl, CURLOPT_MAXREDIRS, 10L);
+    curl_easy_setopt(curl, CURLOPT_TCP_FASTOPEN, 0L);
+    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
+    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0L);
+    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYSTATUS, 0L);
+    curl_easy_setopt(curl, CURLOPT_IPRESOLVE, CURL_IPRESOLVE_WHATEVER);
     // Don't cache DNS entries, ask the system every time we need to connect ...
-    curl_easy_setopt(m_session->curl, CURLOPT_DNS_CACHE_TIMEOUT, 0L);
+    curl_easy_setopt(curl, CURLOPT_DNS_CACHE_TIMEOUT, 0L);
     // and shuffle the addresses so we try a different node, otherwise we might
     // always get the same address due to system caching and RFC 3484
-    curl_easy_setopt(m_session->curl, CURLOPT_DNS_SHUFFLE_ADDRESSES, 1L);
+    curl_easy_setopt(curl, CURLOPT_DNS_SHUFFLE_ADDRESSES, 1L);
     auto version = getUserAgent();
-    curl_easy_setopt(m_session->curl, CURLOPT_USERAGENT, version.c_str());
-    return true;
+    curl_easy_setopt(curl, CURLOPT_USERAGENT, version.c_str());
   }
 
   void Downloader::finishSession()
   {
     // if there's a session clean it ...
     if (m_session) {
+      for (auto& transfer : m_session->transfers) {
+        curl_easy_cleanup(transfer->curl);
+      }
+      if (m_session->multi) curl_multi_cleanup(m_session->multi);
       curl_easy_cleanup(m_session->curl);
+      curl_share_cleanup(m_session->share);
       curl_slist_free_all(m_session->headers);
       m_session.reset();
     }
@@ -244,6 +275,9 @@ namespace Belle2::Conditions {
     m_connectionTimeout = timeout;
     if (m_session) {
       curl_easy_setopt(m_session->curl, CURLOPT_CONNECTTIMEOUT, m_connectionTimeout);
+      for (auto& transfer : m_session->transfers) {
+        curl_easy_setopt(transfer->curl, CURLOPT_CONNECTTIMEOUT, m_connectionTimeout);
+      }
     }
   }
 
@@ -252,6 +286,9 @@ namespace Belle2::Conditions {
     m_stalledTimeout = timeout;
     if (m_session) {
       curl_easy_setopt(m_session->curl, CURLOPT_LOW_SPEED_TIME, m_stalledTimeout);
+      for (auto& transfer : m_session->transfers) {
+        curl_easy_setopt(transfer->curl, CURLOPT_LOW_SPEED_TIME, m_stalledTimeout);
+      }
     }
   }
 
@@ -327,6 +364,94 @@ namespace Belle2::Conditions {
     return true;
   }
 
+  void Downloader::downloadParallel(std::vector<Transfer>& transfers)
+  {
+    // make sure we have an active curl session ...
+    auto session = ensureSession();
+    if (!m_session->multi) {
+      m_session->multi = curl_multi_init();
+      if (!m_session->multi) {
+        B2FATAL("Cannot initialize libcurl");
+      }
+    }
+    curl_multi_setopt(m_session->multi, CURLMOPT_MAX_TOTAL_CONNECTIONS, static_cast<long>(m_maxParallelDownloads));
+    // use HTTP/2 multiplexing if the server supports it
+    curl_multi_setopt(m_session->multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+    // handles not used by any transfer at the moment
+    std::vector<CurlTransfer*> idle;
+    for (auto& transfer : m_session->transfers) idle.push_back(transfer.get());
+    // transfers in progress and the exception mask of their stream before we started
+    std::unordered_map<CURL*, std::pair<Transfer*, std::ios::iostate>> active;
+    auto next = transfers.begin();
+    B2DEBUG(37, "Parallel download started ..." << LogVar("transfers", transfers.size()));
+    while (next != transfers.end() or !active.empty()) {
+      // start new transfers while we are below the limit
+      for (; next != transfers.end() and active.size() < m_maxParallelDownloads; ++next) {
+        if (idle.empty()) {
+          auto& handle = m_session->transfers.emplace_back(std::make_unique<CurlTransfer>());
+          handle->curl = curl_easy_init();
+          if (!handle->curl) {
+            B2FATAL("Cannot initialize libcurl");
+          }
+          setupHandle(handle->curl, handle->errbuf);
+          idle.push_back(handle.get());
+        }
+        CurlTransfer* handle = idle.back();
+        idle.pop_back();
+        Transfer& transfer = *next;
+        transfer.success = false;
+        transfer.responseCode = 0;
+        transfer.error.clear();
+        //rewind the stream to the beginning
+        transfer.stream->clear();
+        transfer.stream->seekp(0, std::ios::beg);
+        if (!transfer.stream->good()) {
+          transfer.error = "cannot write to stream";
+          idle.push_back(handle);
+          continue;
+        }
+        // Set the exception flags to notify us of any problem during writing
+        active[handle->curl] = {&transfer, transfer.stream->exceptions()};
+        transfer.stream->exceptions(std::ios::failbit | std::ios::badbit);
+        handle->errbuf[0] = 0;
+        curl_easy_setopt(handle->curl, CURLOPT_URL, transfer.url.c_str());
+        curl_easy_setopt(handle->curl, CURLOPT_WRITEDATA, transfer.stream);
+        curl_easy_setopt(handle->curl, CURLOPT_PRIVATE, handle);
+        curl_multi_add_handle(m_session->multi, handle->curl);
+        B2DEBUG(37, "Download started ..." << LogVar("url", transfer.url));
+      }
+      // let curl do its work and wait for activity on any of the connections
+      int running{0};
+      curl_multi_perform(m_session->multi, &running);
+      // and collect all the finished transfers
+      int remaining{0};
+      while (CURLMsg* msg = curl_multi_info_read(m_session->multi, &remaining)) {
+        if (msg->msg != CURLMSG_DONE) continue;
+        // the message is invalid once the handle is removed from the multi handle
+        CURL* const easyHandle = msg->easy_handle;
+        const CURLcode result = msg->data.result;
+        CurlTransfer* handle{nullptr};
+        curl_easy_getinfo(easyHandle, CURLINFO_PRIVATE, &handle);
+        auto [transfer, exceptionMask] = active[handle->curl];
+        active.erase(handle->curl);
+        curl_multi_remove_handle(m_session->multi, handle->curl);
+        idle.push_back(handle);
+        // flush output
+        transfer->stream->exceptions(exceptionMask);
+        transfer->stream->flush();
+        curl_easy_getinfo(handle->curl, CURLINFO_RESPONSE_CODE, &transfer->responseCode);
+        transfer->success = result == CURLE_OK;
+        if (!transfer->success) {
+          transfer->error = strlen(handle->errbuf) ? handle->errbuf : curl_easy_strerror(result);
+          B2DEBUG(37, "Download failed" << LogVar("url", transfer->url) << LogVar("error", transfer->error));
+        } else {
+          B2DEBUG(37, "Download finished successfully." << LogVar("url", transfer->url));
+        }
+      }
+      if (running > 0) curl_multi_wait(m_session->multi, nullptr, 0, 1000, nullptr);
+    }
+  }
+
   void Downloader::initializeRandomGeneratorSeed()
   {
     if (not m_rndIsInitialized) {
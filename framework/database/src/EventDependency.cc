@@ -8,23 +8,26 @@
 
 #include <framework/database/EventDependency.h>
 #include <framework/dataobjects/EventMetaData.h>
+#include <framework/logging/Logger.h>
 
 using namespace Belle2;
 
-void EventDependency::add(unsigned int event, TObject* object)
+bool EventDependency::add(unsigned int event, TObject* object)
 {
+  if (!m_eventNumbers.empty() and event < m_eventNumbers.back()) {
+    B2ERROR("Event dependent conditions have to be added in the order of increasing event numbers"
+            << LogVar("event", event) << LogVar("previous event", m_eventNumbers.back()));
+    if (isOwner()) delete object;
+    return false;
+  }
   m_objects.Add(object);
   m_eventNumbers.push_back(event);
+  return true;
 }
 
 
-int EventDependency::getIndex(const EventMetaData& event) const
+int EventDependency::getIndex(const EventMetaData& event, int hint) const
 {
-  int result = 0;
-  for (unsigned int eventNumber : m_eventNumbers) {
-    if (eventNumber > event.getEvent()) return result;
-    result++;
-  }
-  return result;
+  return findIndex(m_eventNumbers, event.getEvent(), hint);
 }
 
@@ -0,0 +1,120 @@
+/**************************************************************************
+ * basf2 (Belle II Analysis Software Framework)                           *
+ * Author: The Belle II Collaboration                                     *
+ *                                                                        *
+ * See git log for contributors and copyright holders.                    *
+ * This file is licensed under LGPL-3.0, see LICENSE.md.                  *
+ **************************************************************************/
+
+#include <framework/database/PayloadCache.h>
+#include <framework/logging/Logger.h>
+#include <framework/utilities/ScopeGuard.h>
+
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace Belle2::Conditions {
+  static_assert(std::atomic<uint64_t>::is_always_lock_free, "Shared statistics need lock free atomics");
+
+  PayloadCache::PayloadCache(const std::string& directory): m_directory{fs::absolute(directory).string()}
+  {
+    // Make sure that we create directories and files writable for all users, the cache is shared
+    auto oldUmask = umask(0);
+    ScopeGuard umaskGuard([oldUmask] {umask(oldUmask);});
+    std::error_code ec;
+    fs::create_directories(m_directory, ec);
+    if (ec or access(m_directory.c_str(), R_OK | W_OK | X_OK) != 0) {
+      throw std::runtime_error("cannot use directory " + m_directory + ": " + (ec ? ec.message() : std::string(strerror(errno))));
+    }
+    // The statistics are kept in a small file mapped by all processes. A new
+    // file is filled with zeros by ftruncate() which is a valid initial state
+    // for the counters so it doesn't matter which process creates it.
+    const std::string statisticsFile = (fs::path(m_directory) / "statistics").string();
+    int fd = open(statisticsFile.c_str(), O_RDWR | O_CREAT, 0666);
+    if (fd < 0) {
+      B2WARNING("Conditions data: cannot open statistics of shared payload cache"
+                << LogVar("filename", statisticsFile) << LogVar("error", strerror(errno)));
+      return;
+    }
+    ScopeGuard closeGuard([fd] {close(fd);});
+    struct stat info;
+    if (fstat(fd, &info) != 0 or (info.st_size < (off_t)sizeof(SharedStatistics) and ftruncate(fd, sizeof(SharedStatistics)) != 0)) {
+      B2WARNING("Conditions data: cannot resize statistics of shared payload cache"
+                << LogVar("filename", statisticsFile) << LogVar("error", strerror(errno)));
+      return;
+    }
+    void* shared = mmap(nullptr, sizeof(SharedStatistics), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (shared == MAP_FAILED) {
+      B2WARNING("Conditions data: cannot map statistics of shared payload cache"
+                << LogVar("filename", statisticsFile) << LogVar("error", strerror(errno)));
+      return;
+    }
+    m_shared = static_cast<SharedStatistics*>(shared);
+  }
+
+  PayloadCache::~PayloadCache()
+  {
+    if (m_shared) munmap(m_shared, sizeof(SharedStatistics));
+  }
+
+  std::string PayloadCache::getFilename(const PayloadMetadata& metadata) const
+  {
+    return (fs::path(m_directory) / (metadata.name + "_" + metadata.checksum + ".root")).string();
+  }
+
+  bool PayloadCache::find(PayloadMetadata& metadata, bool count)
+  {
+    const std::string filename = getFilename(metadata);
+    const bool found = not metadata.checksum.empty() and fs::exists(filename);
+    if (found) metadata.filename = filename;
+    if (count) {
+      ++(found ? m_statistics.hits : m_statistics.misses);
+      if (m_shared) ++(found ? m_shared->hits : m_shared->misses);
+    }
+    B2DEBUG(37, "Looked for payload in shared payload cache" << LogVar("name", metadata.name)
+            << LogVar("checksum", metadata.checksum) << LogVar("found", found));
+    return found;
+  }
+
+  bool PayloadCache::insert(PayloadMetadata& metadata, bool prefetched)
+  {
+    if (metadata.filename.empty() or metadata.checksum.empty()) return false;
+    const std::string filename = getFilename(metadata);
+    if (!fs::exists(filename)) {
+      // copy to a temporary file first and rename it once complete so that no
+      // other process can see an incomplete file. If another process was
+      // faster the rename just replaces the identical file.
+      const std::string temporary = filename + ".tmp" + std::to_string(getpid());
+      std::error_code ec;
+      fs::copy_file(metadata.filename, temporary, fs::copy_options::overwrite_existing, ec);
+      if (!ec) fs::rename(temporary, filename, ec);
+      if (ec) {
+        B2WARNING("Conditions data: cannot add payload to shared payload cache"
+                  << LogVar("name", metadata.name) << LogVar("filename", metadata.filename)
+                  << LogVar("directory", m_directory) << LogVar("error", ec.message()));
+        fs::remove(temporary, ec);
+        return false;
+      }
+      ++(prefetched ? m_statistics.prefetched : m_statistics.inserted);
+      if (m_shared) ++(prefetched ? m_shared->prefetched : m_shared->inserted);
+      B2DEBUG(37, "Added payload to shared payload cache" << LogVar("name", metadata.name)
+              << LogVar("checksum", metadata.checksum) << LogVar("filename", filename));
+    }
+    metadata.filename = filename;
+    return true;
+  }
+
+  PayloadCache::Statistics PayloadCache::getSharedStatistics() const
+  {
+    if (!m_shared) return m_statistics;
+    return Statistics{m_shared->hits, m_shared->misses, m_shared->inserted, m_shared->prefetched};
+  }
+}
@@ -14,6 +14,7 @@
 
 #include <filesystem>
 #include <sys/stat.h>
+#include <unistd.h>
 
 namespace fs = std::filesystem;
 
@@ -69,10 +70,45 @@ namespace Belle2::Conditions {
     });
   }
 
+  bool PayloadProvider::find(const std::vector<PayloadMetadata*>& payloads)
+  {
+    // nothing to gain for a single payload
+    if (payloads.size() == 1) return find(*payloads.front());
+    // first look everywhere locally, only what we cannot find there needs to
+    // be downloaded. And payloads with the same checksum only once.
+    std::vector<PayloadMetadata*> missing;
+    std::vector<std::pair<PayloadMetadata*, PayloadMetadata*>> duplicates;
+    for (PayloadMetadata* metadata : payloads) {
+      const bool found = std::any_of(m_locations.begin(), m_locations.end(), [this, metadata](const auto & loc) {
+        return not loc.isRemote and getLocalFile(loc, *metadata);
+      });
+      if (found) continue;
+      auto same = std::find_if(missing.begin(), missing.end(), [metadata](const PayloadMetadata * other) {
+        return other->checksum == metadata->checksum;
+      });
+      if (same != missing.end()) {
+        duplicates.emplace_back(metadata, *same);
+      } else {
+        missing.push_back(metadata);
+      }
+    }
+    // and then download all missing ones at once from the remote locations in order
+    for (const auto& loc : m_locations) {
+      if (missing.empty()) break;
+      if (loc.isRemote) missing = getRemoteFiles(loc, missing);
+    }
+    bool allFound = missing.empty();
+    for (auto [metadata, same] : duplicates) {
+      metadata->filename = same->filename;
+      allFound &= not metadata->filename.empty();
+    }
+    return allFound;
+  }
+
   bool PayloadProvider::getLocalFile(const PayloadLocation& loc, PayloadMetadata& metadata) const
   {
-    // look in both flat and hashed directory structures.
-    for (EDirectoryLayout structure : {EDirectoryLayout::c_hashed, EDirectoryLayout::c_flat}) {
+    // look in all directory structures.
+    for (EDirectoryLayout structure : {EDirectoryLayout::c_content, EDirectoryLayout::c_hashed, EDirectoryLayout::c_flat}) {
       auto fullPath = fs::path(loc.base) / getFilename(structure, metadata);
       // No such file? nothing to do
       if (!fs::exists(fullPath)) continue;
@@ -92,8 +128,10 @@ namespace Belle2::Conditions {
 
   bool PayloadProvider::getRemoteFile(const PayloadLocation& loc, PayloadMetadata& metadata)
   {
-    // we want to download payloads in a hashed directory structure to keep amount of payloads per directory to a manageable level
-    const auto local = fs::path(m_cacheDir.base) / getFilename(EDirectoryLayout::c_hashed, metadata);
+    // we want to download payloads in a content addressed directory structure
+    // to share them between globaltags and to keep amount of payloads per
+    // directory to a manageable level
+    const auto local = fs::path(m_cacheDir.base) / getFilename(EDirectoryLayout::c_content, metadata);
     // empty location: use the central server supplied baseUrl from payload metadata
     const bool fallback = loc.base.empty();
     const auto base = fallback ? metadata.baseUrl : loc.base;
@@ -165,9 +203,98 @@ namespace Belle2::Conditions {
     }
   }
 
+  std::vector<PayloadMetadata*> PayloadProvider::getRemoteFiles(const PayloadLocation& loc,
+      const std::vector<PayloadMetadata*>& payloads)
+  {
+    /** All we need to know about one of the downloads */
+    struct Download {
+      /** the payload to download */
+      PayloadMetadata* metadata;
+      /** where we want to have the file in the end */
+      fs::path local;
+      /** where we download the file to */
+      fs::path partial;
+      /** the file we download to */
+      std::fstream stream;
+    };
+    // empty location: use the central server supplied baseUrl from payload metadata
+    const bool fallback = loc.base.empty();
+    // payloads which are not on this server
+    std::vector<PayloadMetadata*> notFound;
+    // payloads which failed for other reasons, we try again one by one to get all the retries and fallbacks
+    std::vector<PayloadMetadata*> failed;
+    std::vector<Download> downloads;
+    std::vector<Downloader::Transfer> transfers;
+    downloads.reserve(payloads.size());
+    transfers.reserve(payloads.size());
+    for (PayloadMetadata* metadata : payloads) {
+      const auto local = fs::path(m_cacheDir.base) / getFilename(EDirectoryLayout::c_content, *metadata);
+      // we download into a file only visible to this process and rename it
+      // once complete, so no locking is needed: if another process was faster
+      // the rename just replaces the identical file.
+      const auto partial = fs::path(local.string() + ".tmp" + std::to_string(getpid()));
+      std::error_code ec;
+      {
+        // Make sure that we create directories writable for all users
+        auto oldUmask = umask(0);
+        ScopeGuard umaskGuard([oldUmask] {umask(oldUmask);});
+        fs::create_directories(local.parent_path(), ec);
+      }
+      auto& download = downloads.emplace_back(Download{metadata, local, partial, {}});
+      if (!ec) download.stream.open(partial.string(), std::ios::binary | std::ios::in | std::ios::out | std::ios::trunc);
+      if (ec or !download.stream.good()) {
+        B2DEBUG(37, "Cannot create file for parallel download" << LogVar("filename", partial));
+        downloads.pop_back();
+        failed.push_back(metadata);
+        continue;
+      }
+      const auto base = fallback ? metadata->baseUrl : loc.base;
+      transfers.emplace_back(Downloader::Transfer{m_downloader.joinWithSlash(base, metadata->payloadUrl), &download.stream});
+    }
+    m_downloader.downloadParallel(transfers);
+    for (size_t i = 0; i < downloads.size(); ++i) {
+      auto& download = downloads[i];
+      const auto& transfer = transfers[i];
+      std::error_code ec;
+      bool success = transfer.success and m_downloader.verifyChecksum(download.stream, download.metadata->checksum);
+      download.stream.close();
+      if (success) {
+        // make sure it's readable for all and move it in place
+        fs::permissions(download.partial, fs::perms::all &
+                        ~(fs::perms::owner_exec | fs::perms::group_exec | fs::perms::others_exec), ec);
+        if (!ec) fs::rename(download.partial, download.local, ec);
+        success = !ec;
+      }
+      if (success) {
+        download.metadata->filename = download.local.string();
+        continue;
+      }
+      fs::remove(download.partial, ec);
+      // not found is only worth a message for the central server, all other problems get another try
+      if (transfer.responseCode == 404 and not fallback) {
+        B2DEBUG(37, "Payload not found ... trying next source" << LogVar("url", transfer.url));
+        notFound.push_back(download.metadata);
+      } else {
+        failed.push_back(download.metadata);
+      }
+    }
+    B2DEBUG(37, "Parallel download of payloads finished" << LogVar("payloads", payloads.size())
+            << LogVar("not found", notFound.size()) << LogVar("failed", failed.size()));
+    for (PayloadMetadata* metadata : failed) {
+      if (not getRemoteFile(loc, *metadata)) notFound.push_back(metadata);
+    }
+    return notFound;
+  }
+
   std::string PayloadProvider::getFilename(EDirectoryLayout structure,
                                            const PayloadMetadata& payload) const
   {
+    // the checksum comes from the server so only use it as a file name if it
+    // really is an md5 checksum, otherwise it could point anywhere
+    if (structure == EDirectoryLayout::c_content and
+        (payload.checksum.size() != 32 or not boost::algorithm::all(payload.checksum, boost::algorithm::is_xdigit()))) {
+      structure = EDirectoryLayout::c_hashed;
+    }
     fs::path path("");
     switch (structure) {
       case EDirectoryLayout::c_hashed:
@@ -177,6 +304,10 @@ namespace Belle2::Conditions {
       case EDirectoryLayout::c_flat:
         path /= "dbstore_" + payload.name + "_rev_" + std::to_string(payload.revision) + ".root";
         break;
+      case EDirectoryLayout::c_content:
+        path /= payload.checksum.substr(0, 2);
+        path /= payload.checksum + ".root";
+        break;
     };
     return path.string();
   }
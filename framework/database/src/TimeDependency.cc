@@ -0,0 +1,37 @@
+/**************************************************************************
+ * basf2 (Belle II Analysis Software Framework)                           *
+ * Author: The Belle II Collaboration                                     *
+ *                                                                        *
+ * See git log for contributors and copyright holders.                    *
+ * This file is licensed under LGPL-3.0, see LICENSE.md.                  *
+ **************************************************************************/
+
+#include <framework/database/TimeDependency.h>
+#include <framework/dataobjects/EventMetaData.h>
+#include <framework/logging/Logger.h>
+
+using namespace Belle2;
+
+bool TimeDependency::add(unsigned long long int time, TObject* object)
+{
+  if (!m_times.empty() and time < m_times.back()) {
+    B2ERROR("Time dependent conditions have to be added in the order of increasing time"
+            << LogVar("time", time) << LogVar("previous time", m_times.back()));
+    if (isOwner()) delete object;
+    return false;
+  }
+  m_objects.Add(object);
+  m_times.push_back(time);
+  return true;
+}
+
+const std::vector<unsigned int>& TimeDependency::getBoundaries() const
+{
+  static const std::vector<unsigned int> noEventBoundaries;
+  return noEventBoundaries;
+}
+
+int TimeDependency::getIndex(const EventMetaData& event, int hint) const
+{
+  return findIndex<ULong64_t>(m_times, event.getTime(), hint);
+}
@@ -0,0 +1,94 @@
+/**************************************************************************
+ * basf2 (Belle II Analysis Software Framework)                           *
+ * Author: The Belle II Collaboration                                     *
+ *                                                                        *
+ * See git log for contributors and copyright holders.                    *
+ * This file is licensed under LGPL-3.0, see LICENSE.md.                  *
+ **************************************************************************/
+
+#include <framework/database/EventDependency.h>
+#include <framework/dataobjects/EventMetaData.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <vector>
+
+using namespace Belle2;
+
+namespace {
+  /** Index of the object valid for the given event, by a linear scan as done before the binary search. */
+  unsigned int linearIndex(const std::vector<unsigned int>& boundaries, unsigned int event)
+  {
+    unsigned int index = 0;
+    while (index < boundaries.size() and boundaries[index] <= event) ++index;
+    return index;
+  }
+
+  /** Time the lookups for the given sequence of event numbers.
+   * @return false if the lookups give different objects than the linear scan
+   */
+  bool compare(const EventDependency& intraRunDep, const std::vector<unsigned int>& events, const char* order)
+  {
+    const auto& boundaries = intraRunDep.getEventNumbers();
+    unsigned long long sumLinear = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned int event : events) sumLinear += linearIndex(boundaries, event);
+    const std::chrono::duration<double, std::nano> linearTime = std::chrono::steady_clock::now() - start;
+
+    EventMetaData meta(0, 1, 1);
+    unsigned long long sumLookup = 0;
+    start = std::chrono::steady_clock::now();
+    for (unsigned int event : events) {
+      meta.setEvent(event);
+      sumLookup += intraRunDep.getObject(meta)->GetUniqueID();
+    }
+    const std::chrono::duration<double, std::nano> lookupTime = std::chrono::steady_clock::now() - start;
+
+    unsigned long long sumHint = 0;
+    int hint = 0;
+    start = std::chrono::steady_clock::now();
+    for (unsigned int event : events) {
+      meta.setEvent(event);
+      sumHint += intraRunDep.getObject(meta, hint)->GetUniqueID();
+    }
+    const std::chrono::duration<double, std::nano> hintTime = std::chrono::steady_clock::now() - start;
+
+    const double n = events.size();
+    std::cout << boundaries.size() + 1 << " intervals, " << order << " events: linear scan " << linearTime.count() / n <<
+              " ns, getObject " << lookupTime.count() / n << " ns, getObject with hint " << hintTime.count() / n << " ns per event\n";
+    return sumLinear == sumLookup and sumLinear == sumHint;
+  }
+}
+
+/** Compare the lookup of event dependent objects with a linear scan for different numbers of intervals.
+ *
+ * Usage: framework-database-intrarun_lookup
+ */
+int main()
+{
+  const unsigned int nEvents = 1000000;
+  std::vector<unsigned int> sequential(nEvents);
+  std::iota(sequential.begin(), sequential.end(), 0);
+  std::vector<unsigned int> shuffled = sequential;
+  std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(42));
+
+  int result = 0;
+  for (unsigned int nIntervals : {10u, 100u, 1000u}) {
+    EventDependency intraRunDep(new TObject);
+    for (unsigned int i = 1; i < nIntervals; ++i) {
+      auto* object = new TObject;
+      object->SetUniqueID(i);
+      intraRunDep.add(i * (nEvents / nIntervals), object);
+    }
+    for (const auto& [events, order] : {std::make_pair(&sequential, "sequential"), std::make_pair(&shuffled, "random")}) {
+      if (!compare(intraRunDep, *events, order)) {
+        std::cerr << "Lookup with " << nIntervals << " intervals gave different objects than the linear scan\n";
+        result = 1;
+      }
+    }
+  }
+  return result;
+}
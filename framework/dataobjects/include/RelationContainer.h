@@ -50,8 +50,8 @@ namespace Belle2 {
     /** Set durability of the StoreArray we relate to. */
     void setToDurability(int durability)        { m_toDurability = durability; }
 
-    /** check for modification since creation or deserialization. */
-    void setModified(bool modified)             { m_modified = modified; }
+    /** check for modification since creation or deserialization. Setting it also increases the revision. */
+    void setModified(bool modified)             { m_modified = modified; if (modified) ++m_revision; }
 
     /** Returns true if no information was set yet or Clear() was called. */
     bool isDefaultConstructed() const
@@ -78,6 +78,9 @@ namespace Belle2 {
     /** check for modification since creation or deserialization. */
     bool getModified() const { return m_modified; }
 
+    /** Number of modifications, lets caches of the relation (e.g. RelationGraph) detect changes independently of the modified flag. */
+    unsigned int getRevision() const { return m_revision; }
+
   protected:
 
     /** TClonesArray to store all elements. */
@@ -98,6 +101,9 @@ namespace Belle2 {
     /** check for modification since creation or deserialization. */
     bool m_modified; //!transient
 
+    /** number of modifications, see getRevision(). */
+    unsigned int m_revision; //!transient
+
     friend class RelationArray;
     friend class DataStore;
 
@@ -16,7 +16,7 @@ using namespace Belle2;
 RelationContainer::RelationContainer():
   m_elements(RelationElement::Class()),
   m_fromName(""), m_fromDurability(-1),
-  m_toName(""), m_toDurability(-1), m_modified(true)
+  m_toName(""), m_toDurability(-1), m_modified(true), m_revision(0)
 {
 }
 
@@ -29,6 +29,6 @@ void RelationContainer::Clear(Option_t*)
   m_elements.Delete();
   m_fromName.clear();
   m_toName.clear();
-  m_modified = true;
+  setModified(true);
   m_fromDurability = m_toDurability = -1;
 }
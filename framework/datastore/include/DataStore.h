@@ -18,9 +18,11 @@
 
 #include <regex>
 #include <array>
+#include <deque>
 #include <vector>
 #include <string>
 #include <map>
+#include <unordered_map>
 
 class TObject;
 class TClass;
@@ -31,6 +33,7 @@ namespace Belle2 {
   class RelationVectorBase;
   template <class T> class RelationVector;
   struct RelationEntry;
+  class RelationGraph;
 
   /** In the store you can park objects that have to be accessed by various modules.
    *
@@ -103,6 +106,27 @@ namespace Belle2 {
      */
     static DataStore& Instance();
 
+    /** Gives the calling thread its own, initially empty DataStore for the lifetime of this object.
+     *
+     *  While it exists, Instance() returns the thread's own DataStore when called from this thread,
+     *  all other threads continue to see their own (or the global) instance. Used for multi-threaded
+     *  event processing, where each worker thread processes events in a separate DataStore.
+     */
+    class ThreadLocalInstance {
+    public:
+      /** Create a new DataStore and make it the instance of the current thread. */
+      ThreadLocalInstance();
+      /** Free all contents of the thread's DataStore and restore the previous instance. */
+      ~ThreadLocalInstance();
+      /** no copy constructor */
+      ThreadLocalInstance(const ThreadLocalInstance&) = delete;
+      /** no assignment operator */
+      ThreadLocalInstance& operator=(const ThreadLocalInstance&) = delete;
+    private:
+      DataStore* m_dataStore; /**< DataStore owned by this object. */
+      DataStore* m_previous; /**< Thread-local instance active before this one, or nullptr. */
+    };
+
     //--------------------------------- default name stuff -----------------------------------------------------
 
     /** Tries to deduce the TClass from a default object name, which is generally the name of the C++ class.
@@ -289,6 +313,18 @@ namespace Belle2 {
      */
     StoreEntry* getEntry(const StoreAccessorBase& accessor);
 
+    /** Return the integer handle for the given (name, durability) key.
+     *
+     *  Handles are assigned once per key (the first time the key is registered or looked up) and stay valid
+     *  for the lifetime of the process, also across reset() and DataStore ID switches. They are used by
+     *  StoreAccessorBase to turn getEntry() into an index lookup instead of a string-keyed map search.
+     *
+     *  @param name       Name of the entry.
+     *  @param durability Durability of the entry.
+     *  @return           Non-negative handle.
+     */
+    static int getHandle(const std::string& name, EDurability durability) { return SwitchableDataStoreContents::getHandle(durability, name); }
+
     /** Get a pointer to a pointer of an object in the DataStore.
      *
      *  If the map of requested durability already contains an object under the key name with a DIFFERENT type
@@ -311,6 +347,7 @@ namespace Belle2 {
     /** For two StoreAccessors of same type, move all data in 'from' into 'to', discarding previous contents of 'to' and leaving 'from' empty.
      *
      * Meta-data like c_DontWriteOut flags or info about associated arrays for RelationContainers is not replaced.
+     * Starts a new cache generation, see getCacheGeneration().
      */
     void replaceData(const StoreAccessorBase& from, const StoreAccessorBase& to);
 
@@ -503,6 +540,21 @@ namespace Belle2 {
      */
     void invalidateData(EDurability durability);
 
+    /** Identifies the state of the event data for caches of quantities calculated from it.
+     *
+     *  A new generation is started for each event, i.e. when data is invalidated or reset, when the DataStore ID is switched,
+     *  when data is replaced (e.g. an array reduced in place by SelectSubset) and after the event() call of modules with the
+     *  Module::c_ModifiesObjectsInPlace flag, which change existing objects.
+     *  Generations are unique across all DataStore instances, so a cache only has to remember the generation it was filled in.
+     */
+    unsigned long long getCacheGeneration() const { return m_cacheGeneration; }
+
+    /** Start a new cache generation, see getCacheGeneration().
+     *
+     *  Called by the EventProcessor after the event() call of modules which change objects in place.
+     */
+    void newCacheGeneration();
+
     /** Frees memory occupied by data store items and removes all objects from the map.
      *
      *  Afterwards, m_storeEntryMap[durability] is empty.
@@ -564,6 +616,54 @@ namespace Belle2 {
     const std::vector<std::string>& getArrayNames(const std::string& arrayName, const TClass* arrayClass,
                                                   EDurability durability = c_Event) const;
 
+    /** A relation which could connect the objects of a relation search, see findRelations(). */
+    struct RelationSearchResult {
+      std::string name; /**< name of the relation. */
+      int handle; /**< handle of the relation, for c_Event durability. */
+    };
+    /** Key of relation searches: entry containing the object, search side and class of the other array(s). */
+    struct RelationSearchKey {
+      const StoreEntry* entry; /**< entry containing the object. */
+      int searchSide; /**< search side, see ESearchSide. */
+      const TClass* withClass; /**< class of the other array(s). */
+      /** Equal if all members are equal. */
+      bool operator==(const RelationSearchKey& other) const
+      {
+        return entry == other.entry and searchSide == other.searchSide and withClass == other.withClass;
+      }
+    };
+    /** Hash for RelationSearchKey, only uses the pointers and the search side. */
+    struct RelationSearchKeyHash {
+      /** Combine the hashes of the members. */
+      std::size_t operator()(const RelationSearchKey& key) const
+      {
+        const std::size_t hash = std::hash<const void*>()(key.entry) * 31 + std::hash<const void*>()(key.withClass);
+        return hash * 3 + key.searchSide;
+      }
+    };
+    /** Cached relation search for one name of the other array(s) and named relation, see findRelations(). */
+    struct RelationSearch {
+      std::string withName; /**< name of the other array(s). */
+      std::string namedRelation; /**< name of the relation. */
+      std::vector<RelationSearchResult> relations; /**< relations found. */
+    };
+
+    /** Returns the registered relations between the given entry and the store arrays matching withClass and withName.
+     *
+     *  The result only depends on the registered entries, so it is cached until the next registration or reset.
+     */
+    const std::vector<RelationSearchResult>& findRelations(ESearchSide searchSide, const StoreEntry* entry, const TClass* withClass,
+                                                           const std::string& withName, const std::string& namedRelation);
+
+    /** Returns the adjacency graph for the current contents of the relation with the given handle, building it if needed.
+     *
+     *  @return  nullptr if the relation was not created in this event.
+     */
+    const RelationGraph* getRelationGraph(int handle);
+
+    /** Forget cached relation searches, relation indices and graphs, e.g. because StoreEntry pointers may have changed. */
+    void clearRelationCaches();
+
     /** For an array containing RelationsObjects, update index and entry cache for entire contents.
      *
      * You must ensure the array actually contains objects inheriting from RelationsObject!
@@ -607,8 +707,48 @@ namespace Belle2 {
       void createNewDataStoreID(const std::string& id);
       /** creates empty datastore with given id. */
       void createEmptyDataStoreID(const std::string& id);
+
+      /** Get handle for given (durability, name) key, assigning a new one if the key is unknown.
+       *
+       *  Handles are shared by all DataStore instances, so an accessor can be used with the DataStore of any thread.
+       */
+      static int getHandle(int durability, const std::string& name);
+      /** Get StoreEntry for given handle (in current DataStore ID), or nullptr if there is no such entry.
+       *
+       *  The first lookup of a handle in a given DataStore ID falls back to the StoreEntry map,
+       *  afterwards the entry (or its absence) is found by indexing into m_entryTables.
+       */
+      StoreEntry* getEntry(int durability, int handle)
+      {
+        auto& table = m_entryTables[m_currentIdx][durability];
+        if ((unsigned int)handle < table.size() and table[handle])
+          return (table[handle] == &s_missingEntry) ? nullptr : table[handle];
+        return findAndCacheEntry(durability, handle);
+      }
+      /** Forget the cached lookup of the given handle (in current DataStore ID), needed after an entry was added. */
+      void forgetEntry(int durability, int handle)
+      {
+        auto& table = m_entryTables[m_currentIdx][durability];
+        if ((unsigned int)handle < table.size())
+          table[handle] = nullptr;
+      }
     private:
+      /** Slow path of getEntry(): search the StoreEntry map and remember the result in m_entryTables. */
+      StoreEntry* findAndCacheEntry(int durability, int handle);
+      /** Forget all cached StoreEntry pointers of the given durability (in all DataStore IDs). */
+      void clearEntryTables(int durability);
+
+      /** StoreEntry pointers indexed by handle, for each durability.
+       *
+       *  Entries are filled lazily, nullptr means 'not cached', &s_missingEntry means 'no such entry'.
+       */
+      typedef std::array<std::vector<StoreEntry*>, c_NDurabilityTypes> EntryTables;
+
+      /** Marks handles without StoreEntry in m_entryTables, so that absent optional objects don't search the map on every access. */
+      static StoreEntry s_missingEntry;
+
       std::vector<DataStoreContents> m_entries; /**< wrapped DataStoreContents. */
+      std::vector<EntryTables> m_entryTables; /**< handle-indexed StoreEntry lookup tables, same indices as m_entries. */
       std::map<std::string, int> m_idToIndexMap; /**< Maps DataStore ID to index in m_entries. */
       std::string m_currentID = ""; /**< currently active DataStore ID. */
       int m_currentIdx = 0; /**< index of currently active DataStore. */
@@ -616,6 +756,13 @@ namespace Belle2 {
     /** Maps (name, durability) key to StoreEntry objects. */
     SwitchableDataStoreContents m_storeEntryMap;
 
+    /** Cached results of findRelations().
+     *
+     *  Usually only a few searches with different names share a key, so they are compared one by one. A deque keeps the
+     *  returned results in place when searches are added.
+     */
+    std::unordered_map<RelationSearchKey, std::deque<RelationSearch>, RelationSearchKeyHash> m_relationSearches;
+
 
     /** True if modules are currently being initialized.
      *
@@ -623,6 +770,9 @@ namespace Belle2 {
      */
     bool m_initializeActive;
 
+    /** Current cache generation, see getCacheGeneration(). */
+    unsigned long long m_cacheGeneration;
+
     /**
      * Regular expression to check that no special characters and no
      * white spaces are in the string given for namedRelations.
@@ -0,0 +1,116 @@
+/**************************************************************************
+ * basf2 (Belle II Analysis Software Framework)                           *
+ * Author: The Belle II Collaboration                                     *
+ *                                                                        *
+ * See git log for contributors and copyright holders.                    *
+ * This file is licensed under LGPL-3.0, see LICENSE.md.                  *
+ **************************************************************************/
+
+#pragma once
+
+#include <framework/dataobjects/RelationElement.h>
+
+#include <vector>
+
+namespace Belle2 {
+  class RelationContainer;
+  struct StoreEntry;
+
+  /** Adjacency of a relation in compressed sparse row format, in both directions.
+   *
+   *  For every element of the from-array, the indices of the related elements in the to-array and the weights are stored
+   *  contiguously (and vice versa), so finding the neighbours of an element is a lookup of two offsets.
+   *  Indices are stored instead of pointers, the objects are looked up in the arrays when needed.
+   *
+   *  Relations added after the graph was built are kept in a short list which is searched in addition,
+   *  once it becomes too long the graph is rebuilt.
+   *
+   *  This class is only used internally by DataStore::getRelationsWith() and DataStore::getRelationWith(),
+   *  the graphs are kept by the RelationIndexManager.
+   */
+  class RelationGraph {
+  public:
+    /** Type of the indices. */
+    typedef RelationElement::index_type index_type;
+    /** Type of the weights. */
+    typedef RelationElement::weight_type weight_type;
+
+    /** Maximal number of elements added after building before the graph is rebuilt. */
+    static constexpr size_t c_maxAppended = 32;
+
+    /** Build the graph for the given relation.
+     *
+     *  @param relation   the relation
+     *  @param fromEntry  entry of the array the relation points from
+     *  @param toEntry    entry of the array the relation points to
+     */
+    void build(const RelationContainer& relation, StoreEntry* fromEntry, StoreEntry* toEntry);
+
+    /** Forget the relation, the graph has to be built again before it is used. Memory is kept for the next event. */
+    void clear();
+
+    /** Is the graph built for the current state of the given relation? */
+    bool isUpToDate(const RelationContainer& relation) const;
+
+    /** Add an element which was added to the relation after building, keeping the graph up to date.
+     *
+     *  @param relation  the relation, after adding the element
+     *  @param from      index of the element in the from-array
+     *  @param to        index of the element in the to-array
+     *  @param weight    weight of the relation
+     *  @param revision  revision of the relation before adding the element. If the graph was not up to date then, nothing is done.
+     */
+    void append(const RelationContainer& relation, index_type from, index_type to, weight_type weight, unsigned int revision);
+
+    /** Entry of the array the relation points from. */
+    StoreEntry* getFromEntry() const { return m_fromEntry; }
+    /** Entry of the array the relation points to. */
+    StoreEntry* getToEntry() const { return m_toEntry; }
+
+    /** Call f(toIndex, weight) for all elements the given element of the from-array is related to, in the order they were added. */
+    template<class F> void forEachTo(index_type from, F f) const
+    {
+      forEach(m_fromOffsets, m_toByFrom, m_weightByFrom, from, f);
+      for (const RelationElementTriple& e : m_appended)
+        if (e.from == from) f(e.to, e.weight);
+    }
+
+    /** Call f(fromIndex, weight) for all elements of the from-array related to the given element of the to-array, in the order they were added. */
+    template<class F> void forEachFrom(index_type to, F f) const
+    {
+      forEach(m_toOffsets, m_fromByTo, m_weightByTo, to, f);
+      for (const RelationElementTriple& e : m_appended)
+        if (e.to == to) f(e.from, e.weight);
+    }
+
+  private:
+    /** A single relation between two elements. */
+    struct RelationElementTriple {
+      index_type from; /**< index in the from-array. */
+      index_type to; /**< index in the to-array. */
+      weight_type weight; /**< weight. */
+    };
+
+    /** Call f(index, weight) for the neighbours of element i in one direction. */
+    template<class F> static void forEach(const std::vector<unsigned int>& offsets, const std::vector<index_type>& indices,
+                                          const std::vector<weight_type>& weights, index_type i, F& f)
+    {
+      if (i + 1 >= offsets.size()) return;
+      for (unsigned int j = offsets[i]; j < offsets[i + 1]; ++j)
+        f(indices[j], weights[j]);
+    }
+
+    const RelationContainer* m_relation{nullptr}; /**< the relation the graph was built for, nullptr if not built. */
+    unsigned int m_revision{0}; /**< revision of m_relation the graph corresponds to. */
+    StoreEntry* m_fromEntry{nullptr}; /**< entry of the array the relation points from. */
+    StoreEntry* m_toEntry{nullptr}; /**< entry of the array the relation points to. */
+
+    std::vector<unsigned int> m_fromOffsets; /**< neighbours of from-element i are at [m_fromOffsets[i], m_fromOffsets[i+1]). */
+    std::vector<index_type> m_toByFrom; /**< to-indices, grouped by from-element. */
+    std::vector<weight_type> m_weightByFrom; /**< weights, grouped by from-element. */
+    std::vector<unsigned int> m_toOffsets; /**< neighbours of to-element i are at [m_toOffsets[i], m_toOffsets[i+1]). */
+    std::vector<index_type> m_fromByTo; /**< from-indices, grouped by to-element. */
+    std::vector<weight_type> m_weightByTo; /**< weights, grouped by to-element. */
+    std::vector<RelationElementTriple> m_appended; /**< elements added after building. */
+  };
+}
@@ -9,10 +9,12 @@
 #pragma once
 
 #include <framework/datastore/RelationIndexContainer.h>
+#include <framework/datastore/RelationGraph.h>
 
 #include <array>
 #include <memory>
 #include <map>
+#include <vector>
 
 namespace Belle2 {
 
@@ -78,6 +80,7 @@ namespace Belle2 {
     {
       for (int i = 0; i < DataStore::c_NDurabilityTypes; i++)
         m_cache[i].clear();
+      m_graphs.clear();
     }
 
   protected:
@@ -112,6 +115,20 @@ namespace Belle2 {
       reset();
     }
 
+    /** Get the graph of the relation with the given handle (event durability). It has to be checked and built by the caller. */
+    RelationGraph& getGraph(int handle)
+    {
+      if ((size_t)handle >= m_graphs.size())
+        m_graphs.resize(handle + 1);
+      return m_graphs[handle];
+    }
+
+    /** Get the graph of the relation with the given handle if it was used before, otherwise nullptr. */
+    RelationGraph* getGraphIfExists(int handle)
+    {
+      return (size_t)handle < m_graphs.size() ? &m_graphs[handle] : nullptr;
+    }
+
     /** Maptype to keep track of all Containers of one durability */
     typedef std::map<std::string, std::shared_ptr<RelationIndexBase>> RelationMap;
     /** Cachetype for all Containers */
@@ -119,6 +136,9 @@ namespace Belle2 {
     /** Cache for all Containers */
     RelationCache m_cache;
 
+    /** Adjacency of the relations with event durability, indexed by handle. */
+    std::vector<RelationGraph> m_graphs;
+
     /** only DataStore should be able to get non-const indices. */
     friend class DataStore;
   };
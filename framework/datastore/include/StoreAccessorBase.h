@@ -31,7 +31,8 @@ namespace Belle2 {
      *  @param isArray    true if the entry in the DataStore is an array
      */
     StoreAccessorBase(const std::string& name, DataStore::EDurability durability, TClass* objClass, bool isArray):
-      m_name(name), m_durability(durability), m_class(objClass), m_isArray(isArray) {}
+      m_name(name), m_durability(durability), m_class(objClass), m_isArray(isArray),
+      m_handle(DataStore::getHandle(m_name, m_durability)) {}
 
     /** Destructor.
      *
@@ -60,7 +61,7 @@ namespace Belle2 {
     bool registerInDataStore(const std::string& name, DataStore::EStoreFlags storeFlags = DataStore::c_WriteOut)
     {
       if (!name.empty())
-        m_name = name;
+        setName(name);
       return DataStore::Instance().registerEntry(m_name, m_durability, getClass(), isArray(), storeFlags);
     }
 
@@ -74,7 +75,7 @@ namespace Belle2 {
     bool isRequired(const std::string& name = "")
     {
       if (!name.empty())
-        m_name = name;
+        setName(name);
       return DataStore::Instance().requireInput(*this);
     }
 
@@ -89,7 +90,7 @@ namespace Belle2 {
     bool isOptional(const std::string& name = "")
     {
       if (!name.empty())
-        m_name = name;
+        setName(name);
       return DataStore::Instance().optionalInput(*this);
     }
 
@@ -123,6 +124,12 @@ namespace Belle2 {
     /** Return name under which the object is saved in the DataStore. */
     const std::string& getName() const { return m_name; }
 
+    /** Return handle of the (name, durability) key of this accessor, for fast lookups in the DataStore.
+     *
+     *  Resolved whenever the name is set, so accessors shared between threads are only read.
+     */
+    int getHandle() const { return m_handle; }
+
     /** Return durability with which the object is saved in the DataStore. */
     DataStore::EDurability getDurability() const { return m_durability; }
 
@@ -158,6 +165,13 @@ namespace Belle2 {
     std::string readableName() const;
 
   protected:
+    /** Change name under which this object/array is saved, and resolve the handle of the new name. */
+    void setName(const std::string& name)
+    {
+      m_name = name;
+      m_handle = DataStore::getHandle(m_name, m_durability);
+    }
+
     /** Store name under which this object/array is saved. */
     std::string m_name;
 
@@ -170,5 +184,8 @@ namespace Belle2 {
     /** Is this an accessor for an array? */
     bool m_isArray;
 
+    /** Handle of (m_name, m_durability). See getHandle(). */
+    int m_handle;
+
   };
 }
@@ -14,6 +14,7 @@
 #include <framework/dataobjects/RelationContainer.h>
 #include <framework/datastore/RelationIndex.h>
 #include <framework/datastore/RelationIndexManager.h>
+#include <framework/datastore/RelationGraph.h>
 #include <framework/datastore/RelationsObject.h>
 #include <framework/datastore/StoreAccessorBase.h>
 #include <framework/dataobjects/EventExtraInfo.h>
@@ -21,7 +22,9 @@
 #include <TClonesArray.h>
 #include <TClass.h>
 
+#include <atomic>
 #include <unordered_map>
+#include <mutex>
 #include <algorithm>
 #include <cstdlib>
 
@@ -50,14 +53,37 @@ namespace {
 
 bool DataStore::s_DoCleanup = false;
 
+namespace {
+  /** DataStore of the current thread, if one was set up using DataStore::ThreadLocalInstance. */
+  thread_local DataStore* t_threadDataStore = nullptr;
+  /** Last cache generation handed out by any DataStore instance. */
+  std::atomic<unsigned long long> s_lastCacheGeneration{0};
+}
+
 DataStore& DataStore::Instance()
 {
+  if (t_threadDataStore)
+    return *t_threadDataStore;
   static DataStore instance;
   return instance;
 }
 
+DataStore::ThreadLocalInstance::ThreadLocalInstance():
+  m_dataStore(new DataStore), m_previous(t_threadDataStore)
+{
+  t_threadDataStore = m_dataStore;
+}
+
+DataStore::ThreadLocalInstance::~ThreadLocalInstance()
+{
+  //release all memory while this is still the current thread's instance
+  m_dataStore->reset();
+  t_threadDataStore = m_previous;
+  delete m_dataStore;
+}
+
 
-DataStore::DataStore() : m_initializeActive(true), m_dependencyMap(new DependencyMap)
+DataStore::DataStore() : m_initializeActive(true), m_cacheGeneration(++s_lastCacheGeneration), m_dependencyMap(new DependencyMap)
 {
 }
 
@@ -87,7 +113,13 @@ void DataStore::reset(EDurability durability)
   m_storeEntryMap.reset(durability);
 
   //invalidate any cached relations (expect RelationArrays to remain valid)
-  RelationIndexManager::Instance().reset();
+  clearRelationCaches();
+  newCacheGeneration();
+}
+
+void DataStore::newCacheGeneration()
+{
+  m_cacheGeneration = ++s_lastCacheGeneration;
 }
 
 void DataStore::setInitializeActive(bool active)
@@ -233,8 +265,12 @@ bool DataStore::registerEntry(const std::string& name, EDurability durability,
     return false;
   }
 
-  // Add the DataStore entry
+  // Add the DataStore entry, and make sure it has a handle for fast lookups
   m_storeEntryMap[durability][name] = StoreEntry(array, objClass, name, dontwriteout);
+  //the entry may have been cached as missing before
+  m_storeEntryMap.forgetEntry(durability, m_storeEntryMap.getHandle(durability, name));
+  //new arrays or relations may change the outcome of relation searches
+  m_relationSearches.clear();
 
   B2DEBUG(100, "Successfully registered " << accessor.readableName());
   return true;
@@ -292,10 +328,10 @@ bool DataStore::hasRelation(const StoreAccessorBase& fromArray, const StoreAcces
 
 DataStore::StoreEntry* DataStore::getEntry(const StoreAccessorBase& accessor)
 {
-  const auto& it = m_storeEntryMap[accessor.getDurability()].find(accessor.getName());
+  StoreEntry* entry = m_storeEntryMap.getEntry(accessor.getDurability(), accessor.getHandle());
 
-  if (it != m_storeEntryMap[accessor.getDurability()].end() and checkType((it->second), accessor)) {
-    return &(it->second);
+  if (entry and checkType(*entry, accessor)) {
+    return entry;
   } else {
     return nullptr;
   }
@@ -381,6 +417,9 @@ void DataStore::replaceData(const StoreAccessorBase& from, const StoreAccessorBa
 
     fromEntry->ptr = nullptr;
   }
+
+  //the replaced objects may reuse the memory of the old ones, e.g. when an array is compacted in place
+  newCacheGeneration();
 }
 
 void DataStore::updateRelationsObjectCache(StoreEntry& entry)
@@ -464,10 +503,10 @@ bool DataStore::findStoreEntry(const TObject* object, DataStore::StoreEntry*& en
 const std::vector<std::string>& DataStore::getArrayNames(const std::string& name, const TClass* arrayClass,
                                                          EDurability durability) const
 {
-  static vector<string> arrayNames;
+  static thread_local vector<string> arrayNames;
   arrayNames.clear();
   if (name.empty()) {
-    static std::unordered_map<const TClass*, string> classToArrayName;
+    static thread_local std::unordered_map<const TClass*, string> classToArrayName;
     const auto& it = classToArrayName.find(arrayClass);
     if (it != classToArrayName.end()) {
       arrayNames.emplace_back(it->second);
@@ -527,11 +566,13 @@ void DataStore::addRelation(const TObject* fromObject, StoreEntry*& fromEntry, i
   }
 
   // add relation
+  const unsigned int revision = relContainer->getRevision();
   TClonesArray& relations = relContainer->elements();
   new (relations.AddrAt(relations.GetLast() + 1)) RelationElement(fromIndex, toIndex, weight);
 
+  RelationIndexManager& relationIndexManager = RelationIndexManager::Instance();
   std::shared_ptr<RelationIndexContainer<TObject, TObject>> relIndex =
-                                                           RelationIndexManager::Instance().getIndexIfExists<TObject, TObject>(relationsName, c_Event);
+                                                           relationIndexManager.getIndexIfExists<TObject, TObject>(relationsName, c_Event);
   if (relIndex) {
     // add it to index (so we avoid expensive rebuilding later)
     relIndex->index().emplace(fromIndex, toIndex, fromObject, toObject, weight);
@@ -539,6 +580,67 @@ void DataStore::addRelation(const TObject* fromObject, StoreEntry*& fromEntry, i
     //mark for rebuilding later on
     relContainer->setModified(true);
   }
+
+  // also keep an existing adjacency graph up to date (if it was before)
+  if (!relationIndexManager.m_graphs.empty()) {
+    RelationGraph* graph = relationIndexManager.getGraphIfExists(m_storeEntryMap.getHandle(c_Event, relationsName));
+    if (graph)
+      graph->append(*relContainer, fromIndex, toIndex, weight, revision);
+  }
+}
+
+const std::vector<DataStore::RelationSearchResult>& DataStore::findRelations(ESearchSide searchSide, const StoreEntry* entry,
+    const TClass* withClass, const std::string& withName, const std::string& namedRelation)
+{
+  const RelationSearchKey key{entry, searchSide, withClass};
+  std::deque<RelationSearch>& searches = m_relationSearches[key];
+  for (const RelationSearch& search : searches) {
+    if (search.withName == withName and search.namedRelation == namedRelation)
+      return search.relations;
+  }
+
+  std::vector<RelationSearchResult> relations;
+  for (const std::string& name : getArrayNames(withName, withClass)) {
+    const string& relationsName = (searchSide == c_ToSide) ? relationName(entry->name, name, namedRelation) : relationName(name,
+                                  entry->name, namedRelation);
+    if (m_storeEntryMap[c_Event].count(relationsName) == 0)
+      continue;
+    relations.push_back({relationsName, m_storeEntryMap.getHandle(c_Event, relationsName)});
+  }
+  searches.push_back({withName, namedRelation, std::move(relations)});
+  return searches.back().relations;
+}
+
+const RelationGraph* DataStore::getRelationGraph(int handle)
+{
+  StoreEntry* relationEntry = m_storeEntryMap.getEntry(c_Event, handle);
+  if (!relationEntry or !relationEntry->ptr or relationEntry->objClass != RelationContainer::Class())
+    return nullptr;
+  const auto* relation = static_cast<const RelationContainer*>(relationEntry->ptr);
+
+  RelationGraph& graph = RelationIndexManager::Instance().getGraph(handle);
+  if (!graph.isUpToDate(*relation)) {
+    StoreEntry* fromEntry = nullptr;
+    StoreEntry* toEntry = nullptr;
+    if (!relation->isDefaultConstructed()) {
+      StoreEntryMap& fromMap = m_storeEntryMap[relation->getFromDurability()];
+      const StoreEntryIter& fromIt = fromMap.find(relation->getFromName());
+      if (fromIt != fromMap.end())
+        fromEntry = &fromIt->second;
+      StoreEntryMap& toMap = m_storeEntryMap[relation->getToDurability()];
+      const StoreEntryIter& toIt = toMap.find(relation->getToName());
+      if (toIt != toMap.end())
+        toEntry = &toIt->second;
+    }
+    graph.build(*relation, fromEntry, toEntry);
+  }
+  return &graph;
+}
+
+void DataStore::clearRelationCaches()
+{
+  m_relationSearches.clear();
+  RelationIndexManager::Instance().reset();
 }
 
 RelationVectorBase DataStore::getRelationsWith(ESearchSide searchSide, const TObject* object, DataStore::StoreEntry*& entry,
@@ -556,38 +658,41 @@ RelationVectorBase DataStore::getRelationsWith(ESearchSide searchSide, const TOb
   // get StoreEntry for 'object'
   if (!findStoreEntry(object, entry, index)) return RelationVectorBase();
 
-  // get names of store arrays to search
-  const std::vector<string>& names = getArrayNames(withName, withClass);
   vector<string> relationNames;
 
-  // loop over found store arrays
-  for (const std::string& name : names) {
-    // get the relations from -> to
-    const string& relationsName = (searchSide == c_ToSide) ? relationName(entry->name, name, namedRelation) : relationName(name,
-                                  entry->name, namedRelation);
-    RelationIndex<TObject, TObject> relIndex(relationsName, c_Event);
-    if (!relIndex)
+  // loop over the relations with the store arrays to search
+  for (const RelationSearchResult& relation : findRelations(searchSide, entry, withClass, withName, namedRelation)) {
+    const RelationGraph* graph = getRelationGraph(relation.handle);
+    if (!graph)
       continue;
 
     const size_t prevsize = result.size();
 
-    //get relations with object
+    //get relations with object, looking up the related objects by index
     if (searchSide == c_ToSide) {
-      for (const auto& rel : relIndex.getElementsFrom(object)) {
-        auto* const toObject = const_cast<TObject*>(rel.to);
-        if (toObject)
-          result.emplace_back(toObject, rel.weight);
+      const TClonesArray* toArray = (graph->getFromEntry() == entry and graph->getToEntry()) ? graph->getToEntry()->getPtrAsArray() :
+                                    nullptr;
+      if (toArray) {
+        graph->forEachTo(index, [&](RelationGraph::index_type idx, RelationGraph::weight_type weight) {
+          TObject* toObject = toArray->At(idx);
+          if (toObject)
+            result.emplace_back(toObject, weight);
+        });
       }
     } else {
-      for (const auto& rel : relIndex.getElementsTo(object)) {
-        auto* const fromObject = const_cast<TObject*>(rel.from);
-        if (fromObject)
-          result.emplace_back(fromObject, rel.weight);
+      const TClonesArray* fromArray = (graph->getToEntry() == entry and graph->getFromEntry()) ? graph->getFromEntry()->getPtrAsArray() :
+                                      nullptr;
+      if (fromArray) {
+        graph->forEachFrom(index, [&](RelationGraph::index_type idx, RelationGraph::weight_type weight) {
+          TObject* fromObject = fromArray->At(idx);
+          if (fromObject)
+            result.emplace_back(fromObject, weight);
+        });
       }
     }
 
     if (result.size() != prevsize)
-      relationNames.push_back(relationsName);
+      relationNames.push_back(relation.name);
   }
 
   return RelationVectorBase(entry->name, index, result, relationNames);
@@ -607,30 +712,31 @@ RelationEntry DataStore::getRelationWith(ESearchSide searchSide, const TObject*
   // get StoreEntry for 'object'
   if (!findStoreEntry(object, entry, index)) return RelationEntry(nullptr);
 
-  // get names of store arrays to search
-  const std::vector<string>& names = getArrayNames(withName, withClass);
-
-  // loop over found store arrays
-  for (const std::string& name : names) {
-    // get the relations from -> to
-    const string& relationsName = (searchSide == c_ToSide) ? relationName(entry->name, name, namedRelation) : relationName(name,
-                                  entry->name, namedRelation);
-    RelationIndex<TObject, TObject> relIndex(relationsName, c_Event);
-    if (!relIndex)
+  // loop over the relations with the store arrays to search
+  for (const RelationSearchResult& relation : findRelations(searchSide, entry, withClass, withName, namedRelation)) {
+    const RelationGraph* graph = getRelationGraph(relation.handle);
+    if (!graph)
       continue;
 
     // get first element
-    if (searchSide == c_ToSide) {
-      const RelationIndex<TObject, TObject>::Element* element = relIndex.getFirstElementFrom(object);
-      if (element && element->to) {
-        return RelationEntry(const_cast<TObject*>(element->to), element->weight);
-      }
-    } else {
-      const RelationIndex<TObject, TObject>::Element* element = relIndex.getFirstElementTo(object);
-      if (element && element->from) {
-        return RelationEntry(const_cast<TObject*>(element->from), element->weight);
-      }
-    }
+    const StoreEntry* otherEntry = (searchSide == c_ToSide) ? graph->getToEntry() : graph->getFromEntry();
+    const StoreEntry* objectEntry = (searchSide == c_ToSide) ? graph->getFromEntry() : graph->getToEntry();
+    if (!otherEntry or objectEntry != entry or !otherEntry->getPtrAsArray())
+      continue;
+    bool found = false;
+    RelationEntry first(nullptr);
+    auto getFirst = [&](RelationGraph::index_type idx, RelationGraph::weight_type weight) {
+      if (found)
+        return;
+      found = true;
+      first = RelationEntry(otherEntry->getPtrAsArray()->At(idx), weight);
+    };
+    if (searchSide == c_ToSide)
+      graph->forEachTo(index, getFirst);
+    else
+      graph->forEachFrom(index, getFirst);
+    if (first.object)
+      return first;
   }
 
   return RelationEntry(nullptr);
@@ -716,6 +822,7 @@ void DataStore::invalidateData(EDurability durability)
   B2DEBUG(100, "Invalidating objects for durability " << durability);
   m_storeEntryMap.invalidateData(durability);
   RelationIndexManager::Instance().clear();
+  newCacheGeneration();
 }
 
 bool DataStore::requireInput(const StoreAccessorBase& accessor)
@@ -778,11 +885,15 @@ bool DataStore::optionalRelation(const StoreAccessorBase& fromArray, const Store
 void DataStore::createNewDataStoreID(const std::string& id)
 {
   m_storeEntryMap.createNewDataStoreID(id);
+  //entries may have been moved
+  clearRelationCaches();
 }
 
 void DataStore::createEmptyDataStoreID(const std::string& id)
 {
   m_storeEntryMap.createEmptyDataStoreID(id);
+  //entries may have been moved
+  clearRelationCaches();
 }
 
 std::string DataStore::currentID() const
@@ -796,7 +907,8 @@ void DataStore::switchID(const std::string& id)
     return;
 
   //remember to clear caches
-  RelationIndexManager::Instance().reset();
+  clearRelationCaches();
+  newCacheGeneration();
 
   m_storeEntryMap.switchID(id);
 }
@@ -804,6 +916,8 @@ void DataStore::switchID(const std::string& id)
 void DataStore::copyEntriesTo(const std::string& id, const std::vector<std::string>& entrylist_event, bool mergeEntries)
 {
   m_storeEntryMap.copyEntriesTo(id, entrylist_event, mergeEntries);
+  //entries may have been moved
+  clearRelationCaches();
 }
 
 void DataStore::copyContentsTo(const std::string& id, const std::vector<std::string>& entrylist_event)
@@ -818,7 +932,7 @@ void DataStore::mergeContentsTo(const std::string& id, const std::vector<std::st
 
 
 DataStore::SwitchableDataStoreContents::SwitchableDataStoreContents():
-  m_entries(1)
+  m_entries(1), m_entryTables(1)
 {
   m_idToIndexMap[""] = 0;
 }
@@ -844,6 +958,10 @@ void DataStore::SwitchableDataStoreContents::createEmptyDataStoreID(const std::s
   m_idToIndexMap[id] = targetidx;
 
   m_entries.push_back(DataStoreContents());
+  //maps may have been moved, so don't trust any cached pointers
+  m_entryTables.resize(m_entries.size());
+  for (int i = 0; i < c_NDurabilityTypes; i++)
+    clearEntryTables(i);
 }
 
 void DataStore::SwitchableDataStoreContents::copyEntriesTo(const std::string& id, const std::vector<std::string>& entrylist_event,
@@ -877,8 +995,14 @@ void DataStore::SwitchableDataStoreContents::copyEntriesTo(const std::string& id
 
     //copy entries
     m_entries.push_back(m_entries[m_currentIdx]);
+    //maps may have been moved, so don't trust any cached pointers
+    m_entryTables.resize(m_entries.size());
+    for (int i = 0; i < c_NDurabilityTypes; i++)
+      clearEntryTables(i);
   } else if (!entrylist.empty()) {
     targetidx = m_idToIndexMap.at(id);
+    //entries are added to the target, so forget the cached missing ones
+    m_entryTables[targetidx][c_Event].clear();
     // if we are merging DataStores, we need to register a new object that stores at which indices the arrays have been merged
     if (mergeEntries) {
       if (m_entries[targetidx][c_Event].count("MergedArrayIndices") != 0) {
@@ -1157,6 +1281,8 @@ void DataStore::SwitchableDataStoreContents::clear()
 
   m_entries.clear();
   m_entries.resize(1);
+  m_entryTables.clear();
+  m_entryTables.resize(1);
   m_idToIndexMap.clear();
   m_idToIndexMap[""] = 0;
   m_currentID = "";
@@ -1171,6 +1297,7 @@ void DataStore::SwitchableDataStoreContents::reset(EDurability durability)
     }
     map[durability].clear();
   }
+  clearEntryTables(durability);
 }
 
 void DataStore::SwitchableDataStoreContents::invalidateData(EDurability durability)
@@ -1179,3 +1306,64 @@ void DataStore::SwitchableDataStoreContents::invalidateData(EDurability durabili
     for (auto& mapEntry : map[durability])
       mapEntry.second.invalidate();
 }
+
+DataStore::StoreEntry DataStore::SwitchableDataStoreContents::s_missingEntry;
+
+namespace {
+  /** Handles of all (durability, name) keys, shared by the DataStore instances of all threads. */
+  struct HandleRegistry {
+    std::mutex mutex; /**< protects handles and names. */
+    std::array<std::unordered_map<std::string, int>, DataStore::c_NDurabilityTypes> handles; /**< (durability, name) -> handle. */
+    std::array<std::vector<std::string>, DataStore::c_NDurabilityTypes> names; /**< (durability, handle) -> name. */
+  };
+
+  HandleRegistry& getHandleRegistry()
+  {
+    static HandleRegistry registry;
+    return registry;
+  }
+}
+
+int DataStore::SwitchableDataStoreContents::getHandle(int durability, const std::string& name)
+{
+  HandleRegistry& registry = getHandleRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  const auto& it = registry.handles[durability].find(name);
+  if (it != registry.handles[durability].end())
+    return it->second;
+
+  const int handle = registry.names[durability].size();
+  registry.handles[durability].emplace(name, handle);
+  registry.names[durability].push_back(name);
+  return handle;
+}
+
+DataStore::StoreEntry* DataStore::SwitchableDataStoreContents::findAndCacheEntry(int durability, int handle)
+{
+  std::string name;
+  {
+    HandleRegistry& registry = getHandleRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    name = registry.names[durability].at(handle);
+  }
+  auto& map = m_entries[m_currentIdx][durability];
+  const auto& it = map.find(name);
+
+  //map nodes are stable, so the pointer stays valid until the entry is removed in reset()
+  //missing entries are remembered as well, registerEntry() and copyEntriesTo() forget them again
+  auto& table = m_entryTables[m_currentIdx][durability];
+  if ((unsigned int)handle >= table.size())
+    table.resize(handle + 1, nullptr);
+  if (it == map.end()) {
+    table[handle] = &s_missingEntry;
+    return nullptr;
+  }
+  table[handle] = &(it->second);
+  return table[handle];
+}
+
+void DataStore::SwitchableDataStoreContents::clearEntryTables(int durability)
+{
+  for (auto& tables : m_entryTables)
+    tables[durability].clear();
+}
@@ -0,0 +1,111 @@
+/**************************************************************************
+ * basf2 (Belle II Analysis Software Framework)                           *
+ * Author: The Belle II Collaboration                                     *
+ *                                                                        *
+ * See git log for contributors and copyright holders.                    *
+ * This file is licensed under LGPL-3.0, see LICENSE.md.                  *
+ **************************************************************************/
+
+#include <framework/datastore/RelationGraph.h>
+
+#include <framework/dataobjects/RelationContainer.h>
+#include <framework/datastore/StoreEntry.h>
+#include <framework/logging/Logger.h>
+
+#include <TClonesArray.h>
+
+using namespace Belle2;
+
+namespace {
+  /** Number of elements in the array of the given entry, 0 if there is none. */
+  unsigned int getArraySize(const StoreEntry* entry)
+  {
+    const TClonesArray* array = entry ? entry->getPtrAsArray() : nullptr;
+    return array ? array->GetEntriesFast() : 0;
+  }
+
+  /** Turn the counts in offsets[1..n] into offsets of the groups. */
+  void accumulate(std::vector<unsigned int>& offsets)
+  {
+    for (size_t i = 1; i < offsets.size(); ++i)
+      offsets[i] += offsets[i - 1];
+  }
+}
+
+void RelationGraph::build(const RelationContainer& relation, StoreEntry* fromEntry, StoreEntry* toEntry)
+{
+  m_relation = &relation;
+  m_revision = relation.getRevision();
+  m_fromEntry = fromEntry;
+  m_toEntry = toEntry;
+  m_appended.clear();
+
+  const unsigned int nFrom = getArraySize(fromEntry);
+  const unsigned int nTo = getArraySize(toEntry);
+  const int nRel = relation.getEntries();
+
+  // count the neighbours of each element, checking the indices like RelationIndexContainer::rebuild()
+  m_fromOffsets.assign(nFrom + 1, 0);
+  m_toOffsets.assign(nTo + 1, 0);
+  for (int i = 0; i < nRel; ++i) {
+    const RelationElement& element = relation.getElement(i);
+    const index_type idxFrom = element.getFromIndex();
+    if (idxFrom >= nFrom)
+      B2FATAL("Relation " << relation.getFromName() << " -> " << relation.getToName() << " is inconsistent: from-index (" << idxFrom <<
+              ") out of range");
+    for (index_type idxTo : element.getToIndices()) {
+      if (idxTo >= nTo)
+        B2FATAL("Relation " << relation.getFromName() << " -> " << relation.getToName() << " is inconsistent: to-index (" << idxTo <<
+                ") out of range");
+      ++m_fromOffsets[idxFrom + 1];
+      ++m_toOffsets[idxTo + 1];
+    }
+  }
+  accumulate(m_fromOffsets);
+  accumulate(m_toOffsets);
+
+  // fill the groups in the order of the relation elements
+  const unsigned int nElements = m_fromOffsets.back();
+  m_toByFrom.resize(nElements);
+  m_weightByFrom.resize(nElements);
+  m_fromByTo.resize(nElements);
+  m_weightByTo.resize(nElements);
+  std::vector<unsigned int> fromFill(m_fromOffsets.begin(), m_fromOffsets.end() - 1);
+  std::vector<unsigned int> toFill(m_toOffsets.begin(), m_toOffsets.end() - 1);
+  for (int i = 0; i < nRel; ++i) {
+    const RelationElement& element = relation.getElement(i);
+    const index_type idxFrom = element.getFromIndex();
+    const auto& indices = element.getToIndices();
+    const auto& weights = element.getWeights();
+    for (size_t j = 0; j < indices.size(); ++j) {
+      const unsigned int posFrom = fromFill[idxFrom]++;
+      m_toByFrom[posFrom] = indices[j];
+      m_weightByFrom[posFrom] = weights[j];
+      const unsigned int posTo = toFill[indices[j]]++;
+      m_fromByTo[posTo] = idxFrom;
+      m_weightByTo[posTo] = weights[j];
+    }
+  }
+}
+
+void RelationGraph::clear()
+{
+  m_relation = nullptr;
+  m_fromEntry = nullptr;
+  m_toEntry = nullptr;
+  m_appended.clear();
+}
+
+bool RelationGraph::isUpToDate(const RelationContainer& relation) const
+{
+  return m_relation == &relation and m_revision == relation.getRevision() and m_appended.size() <= c_maxAppended;
+}
+
+void RelationGraph::append(const RelationContainer& relation, index_type from, index_type to, weight_type weight,
+                           unsigned int revision)
+{
+  if (m_relation != &relation or m_revision != revision)
+    return;
+  m_appended.push_back({from, to, weight});
+  m_revision = relation.getRevision();
+}
@@ -12,7 +12,8 @@ using namespace Belle2;
 
 RelationIndexManager& RelationIndexManager::Instance()
 {
-  static RelationIndexManager instance;
+  //one cache per thread, as each thread may use its own DataStore
+  static thread_local RelationIndexManager instance;
   return instance;
 }
 void RelationIndexManager::clear(DataStore::EDurability durability)
@@ -21,4 +22,8 @@ void RelationIndexManager::clear(DataStore::EDurability durability)
   for (auto& e : relations) {
     if (e.second) e.second->clear();
   }
+  if (durability == DataStore::c_Event) {
+    for (RelationGraph& graph : m_graphs)
+      graph.clear();
+  }
 }
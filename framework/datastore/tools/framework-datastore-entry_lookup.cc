@@ -0,0 +1,73 @@
+/**************************************************************************
+ * basf2 (Belle II Analysis Software Framework)                           *
+ * Author: The Belle II Collaboration                                     *
+ *                                                                        *
+ * See git log for contributors and copyright holders.                    *
+ * This file is licensed under LGPL-3.0, see LICENSE.md.                  *
+ **************************************************************************/
+
+#include <framework/datastore/DataStore.h>
+#include <framework/datastore/StoreArray.h>
+#include <framework/dataobjects/EventMetaData.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace Belle2;
+
+/** Compare the string-keyed map lookup of DataStore entries with the handle lookup used by the accessors.
+ *
+ * Usage: framework-datastore-entry_lookup [number of arrays]
+ */
+int main(int argc, char* argv[])
+{
+  const int nArrays = (argc > 1) ? std::atoi(argv[1]) : 200;
+  if (nArrays <= 0) {
+    std::cerr << "Usage: " << argv[0] << " [number of arrays]\n";
+    return 1;
+  }
+  const int nRepetitions = std::max(1, 10000000 / nArrays);
+
+  std::vector<StoreArray<EventMetaData>> arrays;
+  arrays.reserve(nArrays);
+  DataStore::Instance().setInitializeActive(true);
+  for (int i = 0; i < nArrays; i++) {
+    arrays.emplace_back("LookupArray" + std::to_string(i));
+    arrays.back().registerInDataStore();
+  }
+  DataStore::Instance().setInitializeActive(false);
+
+  // combine the addresses of all entries found so the lookups cannot be optimized away
+  const auto& map = DataStore::Instance().getStoreEntryMap(DataStore::c_Event);
+  uintptr_t mapChecksum = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int rep = 0; rep < nRepetitions; rep++) {
+    for (const auto& array : arrays) {
+      mapChecksum += reinterpret_cast<uintptr_t>(&map.find(array.getName())->second);
+    }
+  }
+  const std::chrono::duration<double, std::nano> mapTime = std::chrono::steady_clock::now() - start;
+
+  uintptr_t handleChecksum = 0;
+  start = std::chrono::steady_clock::now();
+  for (int rep = 0; rep < nRepetitions; rep++) {
+    for (const auto& array : arrays) {
+      handleChecksum += reinterpret_cast<uintptr_t>(DataStore::Instance().getEntry(array));
+    }
+  }
+  const std::chrono::duration<double, std::nano> handleTime = std::chrono::steady_clock::now() - start;
+
+  if (mapChecksum != handleChecksum) {
+    std::cerr << "The handle lookup found different entries than the map lookup\n";
+    return 1;
+  }
+  const double nLookups = double(nArrays) * nRepetitions;
+  std::cout << nArrays << " arrays: map " << mapTime.count() / nLookups << " ns, handle " << handleTime.count() / nLookups <<
+            " ns per lookup\n";
+  return 0;
+}
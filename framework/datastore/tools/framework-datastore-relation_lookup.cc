@@ -0,0 +1,79 @@
+/**************************************************************************
+ * basf2 (Belle II Analysis Software Framework)                           *
+ * Author: The Belle II Collaboration                                     *
+ *                                                                        *
+ * See git log for contributors and copyright holders.                    *
+ * This file is licensed under LGPL-3.0, see LICENSE.md.                  *
+ **************************************************************************/
+
+#include <framework/datastore/DataStore.h>
+#include <framework/datastore/StoreArray.h>
+#include <framework/datastore/RelationsObject.h>
+#include <framework/datastore/RelationIndex.h>
+#include <framework/datastore/RelationVector.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+using namespace Belle2;
+
+/** Compare relation lookups through RelationsObject (adjacency graph) with the RelationIndex for each object of an event.
+ *
+ * Usage: framework-datastore-relation_lookup [number of objects] [relations per object]
+ */
+int main(int argc, char* argv[])
+{
+  const int nObjects = (argc > 1) ? std::atoi(argv[1]) : 100;
+  const int nRelationsPerObject = (argc > 2) ? std::atoi(argv[2]) : 3;
+  if (nObjects <= 0 or nRelationsPerObject <= 0) {
+    std::cerr << "Usage: " << argv[0] << " [number of objects] [relations per object]\n";
+    return 1;
+  }
+  const int nEvents = 1000;
+
+  StoreArray<RelationsObject> from("From");
+  StoreArray<RelationsObject> to("To");
+  DataStore::Instance().setInitializeActive(true);
+  from.registerInDataStore();
+  to.registerInDataStore();
+  from.registerRelationTo(to);
+  DataStore::Instance().setInitializeActive(false);
+
+  std::chrono::duration<double, std::nano> indexTime{0};
+  std::chrono::duration<double, std::nano> graphTime{0};
+  size_t nIndex = 0;
+  size_t nGraph = 0;
+  for (int event = 0; event < nEvents; event++) {
+    DataStore::Instance().invalidateData(DataStore::c_Event);
+    for (int i = 0; i < nObjects; i++) {
+      from.appendNew();
+      to.appendNew();
+    }
+    for (int i = 0; i < nObjects; i++)
+      for (int j = 0; j < nRelationsPerObject; j++)
+        from[i]->addRelationTo(to[(i * 7 + j + event) % nObjects], j);
+
+    // both lookups include building their index or graph once per event
+    auto start = std::chrono::steady_clock::now();
+    RelationIndex<RelationsObject, RelationsObject> relIndex(from, to);
+    for (const RelationsObject& obj : from)
+      for (const auto& element : relIndex.getElementsFrom(obj))
+        nIndex += (element.to != nullptr);
+    indexTime += std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    for (const RelationsObject& obj : from)
+      nGraph += obj.getRelationsTo<RelationsObject>("To").size();
+    graphTime += std::chrono::steady_clock::now() - start;
+  }
+
+  if (nIndex != nGraph or nGraph != size_t(nEvents) * nObjects * nRelationsPerObject) {
+    std::cerr << "Found " << nIndex << " relations with the RelationIndex and " << nGraph << " with getRelationsTo\n";
+    return 1;
+  }
+  const double nLookups = double(nObjects) * nEvents;
+  std::cout << nObjects << " objects with " << nRelationsPerObject << " relations each: RelationIndex " << indexTime.count() / nLookups <<
+            " ns, getRelationsTo " << graphTime.count() / nLookups << " ns per object\n";
+  return 0;
+}
@@ -0,0 +1,218 @@
+/**************************************************************************
+ * basf2 (Belle II Analysis Software Framework)                           *
+ * Author: The Belle II Collaboration                                     *
+ *                                                                        *
+ * See git log for contributors and copyright holders.                    *
+ * This file is licensed under LGPL-3.0, see LICENSE.md.                  *
+ **************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class TClass;
+class TObject;
+
+namespace Belle2 {
+  /** Columnar, memory-mappable file format for DataStore objects and arrays.
+   *
+   * Every member of basic type (or fixed size array of basic type) of the stored classes, including members of
+   * base classes and of embedded objects, is stored as a plain array of values ("column") for many events at once.
+   * Members of other types (STL containers, strings, pointers) and the TObject base class are not stored.
+   *
+   * File layout (all numbers little endian, all blocks aligned to 8 bytes):
+   *  - Header: magic "B2COLUMN", format version, offset of the directory, number of events.
+   *  - Clusters of consecutive events, for each branch: the object offsets (number of objects in the cluster before
+   *    each event, nEvents + 1 values of uint64_t) followed by the data of each column (nObjects * length values).
+   *  - Directory: description of branches and columns, position of all blocks of all clusters.
+   *
+   * Reading a single column of a cluster thus only touches the bytes of this column.
+   */
+  namespace Columnar {
+    /** Type of the values in a column. */
+    enum class EType : uint8_t {
+      c_Bool = 1,
+      c_Int8 = 2,
+      c_UInt8 = 3,
+      c_Int16 = 4,
+      c_UInt16 = 5,
+      c_Int32 = 6,
+      c_UInt32 = 7,
+      c_Int64 = 8,
+      c_UInt64 = 9,
+      c_Float = 10,
+      c_Double = 11,
+    };
+
+    /** Size of one value of the given type in bytes. */
+    size_t getTypeSize(EType type);
+
+    /** One column: a member of basic type. */
+    struct Column {
+      std::string name; /**< name of the member, members of embedded objects are separated by '.' */
+      EType type{EType::c_Int32}; /**< type of the values. */
+      uint32_t length{1}; /**< number of values per object (> 1 for fixed size arrays). */
+      long memoryOffset{0}; /**< offset of the member in an object of the class (not stored in the file). */
+
+      /** Number of bytes per object. */
+      size_t getSize() const { return length * getTypeSize(type); }
+    };
+
+    /** One stored DataStore entry. */
+    struct Branch {
+      std::string name; /**< name of the DataStore entry. */
+      std::string className; /**< name of the class of the objects. */
+      bool isArray{false}; /**< true for StoreArrays, false for StoreObjPtrs. */
+      std::vector<Column> columns; /**< the stored members. */
+    };
+
+    /** Get the columns for the members of the given class.
+     *
+     * @param cl the class, must inherit from TObject
+     * @param skipped names of members which cannot be stored are added
+     */
+    std::vector<Column> getColumns(TClass* cl, std::vector<std::string>* skipped = nullptr);
+
+    /** Get the start address of the object (which might differ from the TObject pointer for multiple inheritance). */
+    char* getObjectStart(TObject* object);
+  }
+
+  /** Write DataStore objects to a columnar file, see Columnar.
+   *
+   * Branches must be added before the first object. For each event, the objects of all branches are added
+   * and the event is finished with endEvent(). The events are kept in memory until a cluster is complete.
+   */
+  class ColumnarFileWriter {
+  public:
+    /** Create the file, throws std::runtime_error on errors.
+     *
+     * @param filename name of the file
+     * @param clusterSize number of events per cluster
+     */
+    ColumnarFileWriter(const std::string& filename, unsigned int clusterSize);
+    /** Close the file. */
+    ~ColumnarFileWriter();
+    /** No copies */
+    ColumnarFileWriter(const ColumnarFileWriter&) = delete;
+    /** No assignment */
+    ColumnarFileWriter& operator=(const ColumnarFileWriter&) = delete;
+
+    /** Add a branch, returns its index. Only members which can be stored are written, see Columnar::getColumns(). */
+    size_t addBranch(const std::string& name, TClass* cl, bool isArray);
+    /** Get the description of the branch with the given index. */
+    const Columnar::Branch& getBranch(size_t branch) const { return m_branches[branch].branch; }
+
+    /** Add an object of the current event to the branch with the given index. */
+    void addObject(size_t branch, TObject* object);
+    /** Finish the current event. */
+    void endEvent();
+
+    /** Write the remaining events and the directory and close the file, throws std::runtime_error on errors. */
+    void close();
+
+    /** Number of events written so far. */
+    uint64_t getNEvents() const { return m_nEvents; }
+
+  private:
+    /** A branch and the data of the current cluster. */
+    struct BranchBuffer {
+      Columnar::Branch branch; /**< description. */
+      std::vector<uint64_t> offsets{0}; /**< number of objects before each event of the cluster. */
+      std::vector<std::vector<char>> columns; /**< data of each column. */
+    };
+
+    /** Positions of the blocks of one cluster. */
+    struct ClusterInfo {
+      uint64_t firstEvent{0}; /**< first event in the cluster. */
+      uint64_t nEvents{0}; /**< number of events in the cluster. */
+      std::vector<uint64_t> blocks; /**< position and size of the offsets and each column, for each branch. */
+    };
+
+    /** Write a block at the current position, padded to 8 bytes, and remember its position. */
+    void writeBlock(const void* data, size_t size, ClusterInfo& cluster);
+    /** Write raw bytes, throws on errors. */
+    void write(const void* data, size_t size);
+    /** Write the current cluster. */
+    void writeCluster();
+    /** Write the directory and update the header. */
+    void writeDirectory();
+
+    int m_fd{ -1}; /**< file descriptor. */
+    std::string m_filename; /**< file name. */
+    unsigned int m_clusterSize; /**< number of events per cluster. */
+    uint64_t m_position{0}; /**< current position in the file. */
+    uint64_t m_nEvents{0}; /**< number of finished events. */
+    uint64_t m_clusterEvents{0}; /**< number of events in the current cluster. */
+    std::vector<BranchBuffer> m_branches; /**< branches with their data. */
+    std::vector<ClusterInfo> m_clusters; /**< written clusters. */
+  };
+
+  /** Read a columnar file written by ColumnarFileWriter.
+   *
+   * The file is mapped into memory, the column data of each cluster can be accessed without copies.
+   */
+  class ColumnarFileReader {
+  public:
+    /** Position of the data of a cluster. */
+    struct Cluster {
+      uint64_t firstEvent{0}; /**< first event in the cluster. */
+      uint64_t nEvents{0}; /**< number of events in the cluster. */
+      std::vector<uint64_t> blocks; /**< position and size of the offsets and each column, for each branch. */
+    };
+
+    /** Map the file, throws std::runtime_error on errors. */
+    explicit ColumnarFileReader(const std::string& filename);
+    /** Unmap the file. */
+    ~ColumnarFileReader();
+    /** No copies */
+    ColumnarFileReader(const ColumnarFileReader&) = delete;
+    /** No assignment */
+    ColumnarFileReader& operator=(const ColumnarFileReader&) = delete;
+
+    /** Total number of events. */
+    uint64_t getNEvents() const { return m_nEvents; }
+    /** Description of all branches. */
+    const std::vector<Columnar::Branch>& getBranches() const { return m_branches; }
+    /** Index of the branch with the given name, -1 if there is none. */
+    int getBranchIndex(const std::string& name) const;
+    /** Index of the column with the given name in the given branch, -1 if there is none. */
+    int getColumnIndex(size_t branch, const std::string& name) const;
+
+    /** Number of clusters. */
+    size_t getNClusters() const { return m_clusters.size(); }
+    /** Get the cluster with the given index. */
+    const Cluster& getCluster(size_t cluster) const { return m_clusters[cluster]; }
+    /** Index of the cluster containing the given event. */
+    size_t findCluster(uint64_t event) const;
+
+    /** Number of objects of the branch before each event of the cluster (nEvents + 1 values). */
+    const uint64_t* getObjectOffsets(size_t cluster, size_t branch) const;
+    /** Values of a column for all objects in the cluster, see getObjectOffsets(). */
+    const char* getColumnData(size_t cluster, size_t branch, size_t column) const;
+    /** Typed access to the values of a column, throws std::invalid_argument if the type size doesn't match. */
+    template<class T> const T* getColumn(size_t cluster, size_t branch, size_t column) const
+    {
+      checkTypeSize(branch, column, sizeof(T));
+      return reinterpret_cast<const T*>(getColumnData(cluster, branch, column));
+    }
+
+  private:
+    /** Throw std::invalid_argument if the values of the column don't have the given size. */
+    void checkTypeSize(size_t branch, size_t column, size_t size) const;
+    /** Get a pointer to the given block of a cluster, checking the file boundaries. */
+    const char* getBlock(size_t cluster, size_t block, size_t size) const;
+    /** Read the directory. */
+    void readDirectory(uint64_t position);
+
+    std::string m_filename; /**< file name. */
+    const char* m_data{nullptr}; /**< the mapped file. */
+    size_t m_size{0}; /**< size of the file. */
+    uint64_t m_nEvents{0}; /**< number of events. */
+    std::vector<Columnar::Branch> m_branches; /**< branches. */
+    std::vector<size_t> m_firstBlock; /**< index of the offsets block of each branch in Cluster::blocks / 2. */
+    std::vector<Cluster> m_clusters; /**< clusters. */
+  };
+}
@@ -0,0 +1,79 @@
+/**************************************************************************
+ * basf2 (Belle II Analysis Software Framework)                           *
+ * Author: The Belle II Collaboration                                     *
+ *                                                                        *
+ * See git log for contributors and copyright holders.                    *
+ * This file is licensed under LGPL-3.0, see LICENSE.md.                  *
+ **************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Belle2 {
+  /** Compact index of the events in a set of files, stored in a separate file next to the data.
+   *
+   * For each event the experiment, run and event number, the file and the entry in the file and up to 64
+   * skim flags are stored. RootInput uses it to look up events by experiment, run and event number across
+   * files and to read only the entries with given skim flags set, without opening files without selected events.
+   *
+   * Files are written by RootOutput (eventIndexFileName parameter) or by b2file-index, which can also
+   * merge the indices of many files.
+   */
+  class EventIndex {
+  public:
+    /** One event, 32 bytes in memory and in the file. */
+    struct Entry {
+      int32_t experiment; /**< experiment number. */
+      int32_t run; /**< run number. */
+      uint32_t event; /**< event number. */
+      uint32_t file; /**< index of the file, see getFiles(). */
+      uint64_t entry; /**< entry in the event tree of the file. */
+      uint64_t skimBits; /**< skim flags, bit i corresponds to getSkims()[i]. */
+    };
+
+    /** Maximal number of skim flags. */
+    static constexpr size_t c_maxSkims = 64;
+
+    /** Read an index file, throws std::runtime_error on errors. */
+    static EventIndex read(const std::string& filename);
+    /** Write the index (sorted by experiment, run and event number), throws std::runtime_error on errors. */
+    void write(const std::string& filename);
+
+    /** Add a file, returns its index. Adding the same file twice returns the same index. */
+    uint32_t addFile(const std::string& name);
+    /** Add a skim flag, returns its bit. Throws std::length_error if there are more than c_maxSkims flags. */
+    unsigned int addSkim(const std::string& name);
+    /** Add an event. */
+    void addEvent(int experiment, int run, unsigned int event, uint32_t file, uint64_t entry, uint64_t skimBits = 0);
+    /** Add all events of another index, mapping its files and skim flags to ours. */
+    void merge(const EventIndex& other);
+    /** Sort the events by experiment, run and event number (and file and entry). */
+    void sort();
+
+    /** Names of the files. */
+    const std::vector<std::string>& getFiles() const { return m_files; }
+    /** Names of the skim flags. */
+    const std::vector<std::string>& getSkims() const { return m_skims; }
+    /** All events. */
+    const std::vector<Entry>& getEntries() const { return m_entries; }
+
+    /** Index of the given file, -1 if there is none. Tries the full name first, then only the file name without directory. */
+    int findFile(const std::string& name) const;
+    /** Bit of the given skim flag, -1 if there is none. */
+    int getSkimBit(const std::string& name) const;
+
+    /** Get all events with the given experiment, run and event number. The index must be sorted. */
+    std::vector<Entry> find(int experiment, int run, unsigned int event) const;
+    /** Get the sorted entry numbers of the events with any of the skim flags in the mask set (all events if the mask is 0), for each file. */
+    std::vector<std::vector<uint64_t>> selectEntries(uint64_t skimMask) const;
+
+  private:
+    std::vector<std::string> m_files; /**< file names. */
+    std::vector<std::string> m_skims; /**< skim flag names. */
+    std::vector<Entry> m_entries; /**< events. */
+    bool m_sorted{true}; /**< true if m_entries is sorted. */
+  };
+}
@@ -0,0 +1,126 @@
+/**************************************************************************
+ * basf2 (Belle II Analysis Software Framework)                           *
+ * Author: The Belle II Collaboration                                     *
+ *                                                                        *
+ * See git log for contributors and copyright holders.                    *
+ * This file is licensed under LGPL-3.0, see LICENSE.md.                  *
+ **************************************************************************/
+
+#pragma once
+
+#include <framework/datastore/StoreEntry.h>
+#include <framework/utilities/TaskPool.h>
+
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+class TChain;
+class TObject;
+
+namespace Belle2 {
+  /** Reads the entries of a TChain ahead of time in a background thread.
+   *
+   * A TTree cannot be read from two threads, so the prefetcher opens its own TChain over the
+   * files of the given chain and reads (and decompresses) the next entries into separate sets of
+   * objects. getEntry() hands the objects of a prefetched entry to the DataStore entries by
+   * swapping the object pointers, the previous objects are cleared and reused for later entries.
+   * If ROOT's implicit multi-threading is enabled the branches of each entry are decompressed in
+   * parallel as well.
+   *
+   * Entries are read in sequence, requesting any other entry than the next one discards the
+   * prefetched entries and restarts reading at the requested entry.
+   */
+  class RootEntryPrefetcher {
+  public:
+    /** Counters to monitor the read-ahead. All times are in seconds. */
+    struct Statistics {
+      long entries{0}; /**< number of entries read in the background. */
+      long hits{0}; /**< number of entries that were already read when they were requested. */
+      long restarts{0}; /**< number of times the prefetched entries had to be discarded. */
+      long bytes{0}; /**< number of uncompressed bytes read. */
+      double readTime{0}; /**< time spent reading and decompressing in the background. */
+      double waitTime{0}; /**< time getEntry() spent waiting for entries. */
+
+      /** string suitable for printing. */
+      std::string getString() const;
+    };
+
+    /** Prepare reading ahead, the files are only opened by the background thread.
+     *
+     * @param chain chain to take the file names and entry numbers from, its entry list is used to map entry indices to entries.
+     *        The chain must outlive the prefetcher.
+     * @param entries DataStore entries to fill, the branch names are the entry names.
+     * @param depth number of entries to read ahead.
+     * @param cacheSize TTreeCache size in bytes, negative to use the ROOT default.
+     */
+    RootEntryPrefetcher(TChain* chain, const std::vector<StoreEntry*>& entries, unsigned int depth, long cacheSize);
+    /** Wait for the background thread and delete all prefetched objects. */
+    ~RootEntryPrefetcher();
+    /** No copies */
+    RootEntryPrefetcher(const RootEntryPrefetcher&) = delete;
+    /** No assignment */
+    RootEntryPrefetcher& operator=(const RootEntryPrefetcher&) = delete;
+
+    /** Put the objects of the given entry into the DataStore entries given to the constructor.
+     *
+     * The previous objects of the entries are taken over by the prefetcher. Entries of branches
+     * which don't exist in the current file are set to nullptr.
+     *
+     * @param index entry index, as passed to TChain::GetEntryNumber()
+     * @return number of bytes read, 0 or negative on errors (like TTree::GetEntry())
+     */
+    int getEntry(long index);
+
+    /** Get the counters. */
+    const Statistics& getStatistics() const { return m_statistics; }
+
+  private:
+    /** One entry, read by the background thread. */
+    struct Entry {
+      std::vector<TObject*> objects; /**< the objects of all branches, in the order of the DataStore entries. */
+      int bytes{0}; /**< return value of TTree::GetEntry(). */
+      double readTime{0}; /**< time needed to read the entry. */
+    };
+
+    /** Queue reading the entry with the given index, reusing the given objects. */
+    void submit(long index, std::vector<TObject*> objects);
+
+    /** Discard all prefetched entries and start reading at the given index. */
+    void restart(long index);
+
+    /** Read the given chain entry, called by the background thread. */
+    Entry read(long chainEntry, std::vector<TObject*> objects);
+
+    /** Open the chain and connect the branches, called by the background thread. */
+    void open();
+
+    /** Delete the given objects. */
+    static void deleteObjects(std::vector<TObject*>& objects);
+
+    TChain* m_inputChain; /**< chain providing files and entry list, only used by the calling thread. */
+    std::vector<StoreEntry*> m_entries; /**< the DataStore entries to fill. */
+    std::string m_treeName; /**< name of the tree. */
+    std::vector<std::pair<std::string, long>> m_files; /**< file names and number of entries. */
+    unsigned int m_depth; /**< number of entries to read ahead. */
+    long m_cacheSize; /**< TTreeCache size in bytes, < 0 for the ROOT default. */
+
+    //members only used by the background thread
+    std::unique_ptr<TChain> m_chain; /**< our own chain over the input files. */
+    std::vector<TObject*> m_addresses; /**< branch addresses of m_chain. */
+    int m_treeNumber{ -1}; /**< tree number for which the branches were enabled. */
+
+    //members only used by the calling thread
+    std::deque<std::pair<long, std::future<Entry>>> m_pending; /**< entry indices and their results, in reading order. */
+    std::vector<std::vector<TObject*>> m_spareObjects; /**< objects of discarded entries, to be reused. */
+    long m_nextIndex{0}; /**< index of the next entry to submit. */
+    Statistics m_statistics; /**< counters. */
+
+    /** the background thread, destroyed first. */
+    std::unique_ptr<TaskPool> m_pool;
+  };
+}
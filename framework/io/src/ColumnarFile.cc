@@ -0,0 +1,496 @@
+/**************************************************************************
+ * basf2 (Belle II Analysis Software Framework)                           *
+ * Author: The Belle II Collaboration                                     *
+ *                                                                        *
+ * See git log for contributors and copyright holders.                    *
+ * This file is licensed under LGPL-3.0, see LICENSE.md.                  *
+ **************************************************************************/
+
+#include <framework/io/ColumnarFile.h>
+#include <framework/logging/Logger.h>
+
+#include <TClass.h>
+#include <TObjArray.h>
+#include <TObject.h>
+#include <TStreamerElement.h>
+#include <TVirtualStreamerInfo.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace Belle2;
+using namespace Belle2::Columnar;
+
+namespace {
+  /** Identifies columnar files. */
+  const char c_magic[8] = {'B', '2', 'C', 'O', 'L', 'U', 'M', 'N'};
+  /** Current version of the format. */
+  const uint64_t c_version = 1;
+  /** Size of the header: magic, version, directory position, number of events. */
+  const uint64_t c_headerSize = 32;
+
+  /** Round up to a multiple of 8. */
+  uint64_t align(uint64_t size) { return (size + 7) & ~uint64_t(7); }
+
+  /** Map the streamer type of a basic type to our column type, returns false for other types. */
+  bool getType(int streamerType, EType& type)
+  {
+    switch (streamerType) {
+      case TVirtualStreamerInfo::kBool: type = EType::c_Bool; return true;
+      case TVirtualStreamerInfo::kChar: type = EType::c_Int8; return true;
+      case TVirtualStreamerInfo::kUChar: type = EType::c_UInt8; return true;
+      case TVirtualStreamerInfo::kShort: type = EType::c_Int16; return true;
+      case TVirtualStreamerInfo::kUShort: type = EType::c_UInt16; return true;
+      case TVirtualStreamerInfo::kInt:
+      case TVirtualStreamerInfo::kCounter: type = EType::c_Int32; return true;
+      case TVirtualStreamerInfo::kUInt:
+      case TVirtualStreamerInfo::kBits: type = EType::c_UInt32; return true;
+      case TVirtualStreamerInfo::kLong:
+        type = sizeof(long) == 8 ? EType::c_Int64 : EType::c_Int32; return true;
+      case TVirtualStreamerInfo::kULong:
+        type = sizeof(long) == 8 ? EType::c_UInt64 : EType::c_UInt32; return true;
+      case TVirtualStreamerInfo::kLong64: type = EType::c_Int64; return true;
+      case TVirtualStreamerInfo::kULong64: type = EType::c_UInt64; return true;
+      //Float16_t and Double32_t only differ when streamed, in memory they are float and double
+      case TVirtualStreamerInfo::kFloat:
+      case TVirtualStreamerInfo::kFloat16: type = EType::c_Float; return true;
+      case TVirtualStreamerInfo::kDouble:
+      case TVirtualStreamerInfo::kDouble32: type = EType::c_Double; return true;
+      default: return false;
+    }
+  }
+
+  /** Add the columns of the given class at the given offset, names are prefixed with the given prefix. */
+  void addColumns(TClass* cl, long offset, const std::string& prefix, std::vector<Column>& columns,
+                  std::vector<std::string>* skipped)
+  {
+    TVirtualStreamerInfo* info = cl->GetStreamerInfo();
+    if (!info) {
+      if (skipped) skipped->push_back(prefix + "*");
+      return;
+    }
+    TIter next(info->GetElements());
+    while (auto* element = static_cast<TStreamerElement*>(next())) {
+      const std::string name = prefix + element->GetName();
+      const long elementOffset = element->GetOffset();
+      if (elementOffset == TVirtualStreamerInfo::kMissing) continue;
+      const int streamerType = element->GetType();
+      if (streamerType == TVirtualStreamerInfo::kBase) {
+        TClass* base = element->GetClassPointer();
+        //the TObject members (unique id and bits) are not interesting for analysis
+        if (base and base != TObject::Class())
+          addColumns(base, offset + elementOffset, prefix, columns, skipped);
+        continue;
+      }
+      Column column;
+      column.name = name;
+      column.memoryOffset = offset + elementOffset;
+      if (getType(streamerType, column.type)) {
+        column.length = 1;
+        columns.push_back(column);
+      } else if (streamerType > TVirtualStreamerInfo::kOffsetL and streamerType < TVirtualStreamerInfo::kOffsetP
+                 and getType(streamerType - TVirtualStreamerInfo::kOffsetL, column.type)) {
+        //fixed size array of basic type
+        column.length = element->GetArrayLength();
+        columns.push_back(column);
+      } else if ((streamerType == TVirtualStreamerInfo::kObject or streamerType == TVirtualStreamerInfo::kAny
+                  or streamerType == TVirtualStreamerInfo::kTObject)
+                 and element->GetArrayLength() == 0 and element->GetClassPointer()
+                 and !element->GetClassPointer()->GetCollectionProxy()) {
+        //embedded object (e.g. TVector3, ROOT::Math::XYZVector)
+        addColumns(element->GetClassPointer(), offset + elementOffset, name + ".", columns, skipped);
+      } else if (skipped) {
+        skipped->push_back(name);
+      }
+    }
+  }
+
+  /** Serialise the directory. */
+  class DirectoryWriter {
+  public:
+    /** Add a value of basic type. */
+    template<class T> void add(T value)
+    {
+      const char* bytes = reinterpret_cast<const char*>(&value);
+      m_data.insert(m_data.end(), bytes, bytes + sizeof(T));
+    }
+    /** Add a string. */
+    void add(const std::string& value)
+    {
+      add<uint32_t>(value.size());
+      m_data.insert(m_data.end(), value.begin(), value.end());
+    }
+    /** The serialised data. */
+    const std::vector<char>& getData() const { return m_data; }
+  private:
+    std::vector<char> m_data; /**< serialised data. */
+  };
+
+  /** Deserialise the directory, throws std::runtime_error if reading beyond the end. */
+  class DirectoryReader {
+  public:
+    /** Read from the given range. */
+    DirectoryReader(const char* begin, const char* end, const std::string& filename):
+      m_pos(begin), m_end(end), m_filename(filename) {}
+    /** Get a value of basic type. */
+    template<class T> T get()
+    {
+      check(sizeof(T));
+      T value;
+      std::memcpy(&value, m_pos, sizeof(T));
+      m_pos += sizeof(T);
+      return value;
+    }
+    /** Get a string. */
+    std::string getString()
+    {
+      const uint32_t size = get<uint32_t>();
+      check(size);
+      std::string value(m_pos, size);
+      m_pos += size;
+      return value;
+    }
+  private:
+    /** Check that the given number of bytes can be read. */
+    void check(size_t size) const
+    {
+      if (size > size_t(m_end - m_pos))
+        throw std::runtime_error("Corrupt directory in columnar file " + m_filename);
+    }
+    const char* m_pos; /**< current position. */
+    const char* m_end; /**< end of the directory. */
+    const std::string& m_filename; /**< file name, for error messages. */
+  };
+}
+
+size_t Columnar::getTypeSize(EType type)
+{
+  switch (type) {
+    case EType::c_Bool:
+    case EType::c_Int8:
+    case EType::c_UInt8: return 1;
+    case EType::c_Int16:
+    case EType::c_UInt16: return 2;
+    case EType::c_Int32:
+    case EType::c_UInt32:
+    case EType::c_Float: return 4;
+    case EType::c_Int64:
+    case EType::c_UInt64:
+    case EType::c_Double: return 8;
+  }
+  return 0;
+}
+
+std::vector<Column> Columnar::getColumns(TClass* cl, std::vector<std::string>* skipped)
+{
+  std::vector<Column> columns;
+  addColumns(cl, 0, "", columns, skipped);
+  return columns;
+}
+
+char* Columnar::getObjectStart(TObject* object)
+{
+  //see StoreEntry::recreate(), TObject is not necessarily the first base class
+  return reinterpret_cast<char*>(object) - object->IsA()->GetBaseClassOffset(TObject::Class());
+}
+
+ColumnarFileWriter::ColumnarFileWriter(const std::string& filename, unsigned int clusterSize):
+  m_filename(filename), m_clusterSize(std::max(clusterSize, 1u))
+{
+  m_fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0664);
+  if (m_fd < 0)
+    throw std::runtime_error("Cannot open " + filename + " for writing: " + std::strerror(errno));
+  //directory position and number of events are updated in close()
+  const uint64_t header[3] = {c_version, 0, 0};
+  write(c_magic, sizeof(c_magic));
+  write(header, sizeof(header));
+}
+
+ColumnarFileWriter::~ColumnarFileWriter()
+{
+  if (m_fd < 0) return;
+  try {
+    close();
+  } catch (const std::exception& e) {
+    B2ERROR(e.what());
+  }
+}
+
+size_t ColumnarFileWriter::addBranch(const std::string& name, TClass* cl, bool isArray)
+{
+  if (m_nEvents > 0 or m_clusterEvents > 0)
+    throw std::logic_error("Cannot add branch " + name + " after the first event");
+  BranchBuffer buffer;
+  buffer.branch.name = name;
+  buffer.branch.className = cl->GetName();
+  buffer.branch.isArray = isArray;
+  buffer.branch.columns = Columnar::getColumns(cl);
+  buffer.columns.resize(buffer.branch.columns.size());
+  m_branches.push_back(std::move(buffer));
+  return m_branches.size() - 1;
+}
+
+void ColumnarFileWriter::addObject(size_t branch, TObject* object)
+{
+  BranchBuffer& buffer = m_branches[branch];
+  const char* start = Columnar::getObjectStart(object);
+  for (size_t i = 0; i < buffer.columns.size(); i++) {
+    const Column& column = buffer.branch.columns[i];
+    const char* member = start + column.memoryOffset;
+    buffer.columns[i].insert(buffer.columns[i].end(), member, member + column.getSize());
+  }
+  buffer.offsets.back()++;
+}
+
+void ColumnarFileWriter::endEvent()
+{
+  for (BranchBuffer& buffer : m_branches)
+    buffer.offsets.push_back(buffer.offsets.back());
+  m_clusterEvents++;
+  m_nEvents++;
+  if (m_clusterEvents >= m_clusterSize)
+    writeCluster();
+}
+
+void ColumnarFileWriter::write(const void* data, size_t size)
+{
+  const char* bytes = static_cast<const char*>(data);
+  while (size > 0) {
+    const ssize_t written = ::write(m_fd, bytes, size);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      throw std::runtime_error("Cannot write to " + m_filename + ": " + std::strerror(errno));
+    }
+    bytes += written;
+    size -= written;
+    m_position += written;
+  }
+}
+
+void ColumnarFileWriter::writeBlock(const void* data, size_t size, ClusterInfo& cluster)
+{
+  static const char padding[8] = {0};
+  cluster.blocks.push_back(m_position);
+  cluster.blocks.push_back(size);
+  write(data, size);
+  write(padding, align(size) - size);
+}
+
+void ColumnarFileWriter::writeCluster()
+{
+  if (m_clusterEvents == 0) return;
+  ClusterInfo cluster;
+  cluster.firstEvent = m_nEvents - m_clusterEvents;
+  cluster.nEvents = m_clusterEvents;
+  for (BranchBuffer& buffer : m_branches) {
+    writeBlock(buffer.offsets.data(), buffer.offsets.size() * sizeof(uint64_t), cluster);
+    for (auto& column : buffer.columns) {
+      writeBlock(column.data(), column.size(), cluster);
+      column.clear();
+    }
+    buffer.offsets.assign(1, 0);
+  }
+  m_clusters.push_back(std::move(cluster));
+  m_clusterEvents = 0;
+}
+
+void ColumnarFileWriter::writeDirectory()
+{
+  DirectoryWriter directory;
+  directory.add<uint32_t>(m_branches.size());
+  for (const BranchBuffer& buffer : m_branches) {
+    const Branch& branch = buffer.branch;
+    directory.add(branch.name);
+    directory.add(branch.className);
+    directory.add<uint8_t>(branch.isArray);
+    directory.add<uint32_t>(branch.columns.size());
+    for (const Column& column : branch.columns) {
+      directory.add(column.name);
+      directory.add<uint8_t>(static_cast<uint8_t>(column.type));
+      directory.add<uint32_t>(column.length);
+    }
+  }
+  directory.add<uint64_t>(m_clusters.size());
+  for (const ClusterInfo& cluster : m_clusters) {
+    directory.add<uint64_t>(cluster.firstEvent);
+    directory.add<uint64_t>(cluster.nEvents);
+    for (uint64_t value : cluster.blocks)
+      directory.add<uint64_t>(value);
+  }
+
+  const uint64_t position = m_position;
+  write(directory.getData().data(), directory.getData().size());
+  const uint64_t header[2] = {position, m_nEvents};
+  if (::pwrite(m_fd, header, sizeof(header), sizeof(c_magic) + sizeof(c_version)) != sizeof(header))
+    throw std::runtime_error("Cannot write to " + m_filename + ": " + std::strerror(errno));
+}
+
+void ColumnarFileWriter::close()
+{
+  if (m_fd < 0) return;
+  const int fd = m_fd;
+  try {
+    writeCluster();
+    writeDirectory();
+  } catch (...) {
+    ::close(fd);
+    m_fd = -1;
+    throw;
+  }
+  m_fd = -1;
+  if (::close(fd) != 0)
+    throw std::runtime_error("Cannot close " + m_filename + ": " + std::strerror(errno));
+}
+
+ColumnarFileReader::ColumnarFileReader(const std::string& filename): m_filename(filename)
+{
+  const int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw std::runtime_error("Cannot open " + filename + ": " + std::strerror(errno));
+  struct stat status;
+  if (::fstat(fd, &status) != 0 or size_t(status.st_size) < c_headerSize) {
+    ::close(fd);
+    throw std::runtime_error(filename + " is not a columnar file");
+  }
+  m_size = status.st_size;
+  void* data = ::mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+  //the mapping stays valid after closing the file
+  ::close(fd);
+  if (data == MAP_FAILED)
+    throw std::runtime_error("Cannot map " + filename + ": " + std::strerror(errno));
+  m_data = static_cast<const char*>(data);
+
+  try {
+    if (std::memcmp(m_data, c_magic, sizeof(c_magic)) != 0)
+      throw std::runtime_error(filename + " is not a columnar file");
+    uint64_t header[3];
+    std::memcpy(header, m_data + sizeof(c_magic), sizeof(header));
+    if (header[0] != c_version)
+      throw std::runtime_error(filename + " has unsupported format version " + std::to_string(header[0]));
+    if (header[1] < c_headerSize or header[1] > m_size)
+      throw std::runtime_error(filename + " was not closed properly");
+    m_nEvents = header[2];
+    readDirectory(header[1]);
+  } catch (...) {
+    ::munmap(const_cast<char*>(m_data), m_size);
+    throw;
+  }
+}
+
+ColumnarFileReader::~ColumnarFileReader()
+{
+  ::munmap(const_cast<char*>(m_data), m_size);
+}
+
+void ColumnarFileReader::readDirectory(uint64_t position)
+{
+  DirectoryReader directory(m_data + position, m_data + m_size, m_filename);
+  const uint32_t nBranches = directory.get<uint32_t>();
+  size_t nBlocks = 0;
+  for (uint32_t i = 0; i < nBranches; i++) {
+    Branch branch;
+    branch.name = directory.getString();
+    branch.className = directory.getString();
+    branch.isArray = directory.get<uint8_t>();
+    const uint32_t nColumns = directory.get<uint32_t>();
+    for (uint32_t j = 0; j < nColumns; j++) {
+      Column column;
+      column.name = directory.getString();
+      column.type = static_cast<EType>(directory.get<uint8_t>());
+      column.length = directory.get<uint32_t>();
+      if (getTypeSize(column.type) == 0)
+        throw std::runtime_error("Unknown column type in columnar file " + m_filename);
+      branch.columns.push_back(column);
+    }
+    m_firstBlock.push_back(nBlocks);
+    nBlocks += 1 + nColumns;
+    m_branches.push_back(std::move(branch));
+  }
+
+  const uint64_t nClusters = directory.get<uint64_t>();
+  for (uint64_t i = 0; i < nClusters; i++) {
+    Cluster cluster;
+    cluster.firstEvent = directory.get<uint64_t>();
+    cluster.nEvents = directory.get<uint64_t>();
+    cluster.blocks.resize(2 * nBlocks);
+    for (uint64_t& value : cluster.blocks)
+      value = directory.get<uint64_t>();
+    for (size_t block = 0; block < nBlocks; block++) {
+      if (cluster.blocks[2 * block] > m_size or cluster.blocks[2 * block + 1] > m_size - cluster.blocks[2 * block])
+        throw std::runtime_error("Corrupt directory in columnar file " + m_filename);
+    }
+    m_clusters.push_back(std::move(cluster));
+  }
+  //check the object offsets once, so the column accessors don't have to
+  for (size_t cluster = 0; cluster < m_clusters.size(); cluster++) {
+    for (size_t branch = 0; branch < m_branches.size(); branch++) {
+      const uint64_t* offsets = getObjectOffsets(cluster, branch);
+      const uint64_t nObjects = offsets[m_clusters[cluster].nEvents];
+      for (size_t column = 0; column < m_branches[branch].columns.size(); column++) {
+        if (m_clusters[cluster].blocks[2 * (m_firstBlock[branch] + 1 + column) + 1] != nObjects * m_branches[branch].columns[column].getSize())
+          throw std::runtime_error("Corrupt directory in columnar file " + m_filename);
+      }
+    }
+  }
+}
+
+int ColumnarFileReader::getBranchIndex(const std::string& name) const
+{
+  for (size_t i = 0; i < m_branches.size(); i++) {
+    if (m_branches[i].name == name) return i;
+  }
+  return -1;
+}
+
+int ColumnarFileReader::getColumnIndex(size_t branch, const std::string& name) const
+{
+  const std::vector<Column>& columns = m_branches[branch].columns;
+  for (size_t i = 0; i < columns.size(); i++) {
+    if (columns[i].name == name) return i;
+  }
+  return -1;
+}
+
+size_t ColumnarFileReader::findCluster(uint64_t event) const
+{
+  if (event >= m_nEvents)
+    throw std::out_of_range("Event " + std::to_string(event) + " not in columnar file " + m_filename);
+  auto it = std::upper_bound(m_clusters.begin(), m_clusters.end(), event,
+  [](uint64_t value, const Cluster & cluster) { return value < cluster.firstEvent; });
+  return (it - m_clusters.begin()) - 1;
+}
+
+const char* ColumnarFileReader::getBlock(size_t cluster, size_t block, size_t size) const
+{
+  const std::vector<uint64_t>& blocks = m_clusters[cluster].blocks;
+  if (blocks[2 * block + 1] < size)
+    throw std::runtime_error("Corrupt directory in columnar file " + m_filename);
+  return m_data + blocks[2 * block];
+}
+
+const uint64_t* ColumnarFileReader::getObjectOffsets(size_t cluster, size_t branch) const
+{
+  const size_t size = (m_clusters[cluster].nEvents + 1) * sizeof(uint64_t);
+  //blocks are aligned to 8 bytes, the cast is fine
+  return reinterpret_cast<const uint64_t*>(getBlock(cluster, m_firstBlock[branch], size));
+}
+
+const char* ColumnarFileReader::getColumnData(size_t cluster, size_t branch, size_t column) const
+{
+  return m_data + m_clusters[cluster].blocks[2 * (m_firstBlock[branch] + 1 + column)];
+}
+
+void ColumnarFileReader::checkTypeSize(size_t branch, size_t column, size_t size) const
+{
+  const Column& c = m_branches[branch].columns[column];
+  if (getTypeSize(c.type) != size)
+    throw std::invalid_argument("Column " + c.name + " of " + m_branches[branch].name + " has values of "
+                                + std::to_string(getTypeSize(c.type)) + " bytes, not " + std::to_string(size));
+}
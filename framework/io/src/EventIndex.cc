@@ -0,0 +1,221 @@
+/**************************************************************************
+ * basf2 (Belle II Analysis Software Framework)                           *
+ * Author: The Belle II Collaboration                                     *
+ *                                                                        *
+ * See git log for contributors and copyright holders.                    *
+ * This file is licensed under LGPL-3.0, see LICENSE.md.                  *
+ **************************************************************************/
+
+#include <framework/io/EventIndex.h>
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <tuple>
+
+using namespace Belle2;
+
+namespace {
+  /** Identifies event index files. */
+  const char c_magic[8] = {'B', '2', 'E', 'V', 'T', 'I', 'D', 'X'};
+  /** Current version of the format. */
+  const uint64_t c_version = 1;
+
+  static_assert(sizeof(EventIndex::Entry) == 32, "Entries are written as they are in memory");
+
+  /** Order of the events in the index. */
+  bool lessThan(const EventIndex::Entry& a, const EventIndex::Entry& b)
+  {
+    return std::tie(a.experiment, a.run, a.event, a.file, a.entry) < std::tie(b.experiment, b.run, b.event, b.file, b.entry);
+  }
+
+  /** Write a value of basic type. */
+  template<class T> void writeValue(std::ostream& out, T value)
+  {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  /** Read a value of basic type. */
+  template<class T> T readValue(std::istream& in)
+  {
+    T value{};
+    in.read(reinterpret_cast<char*>(&value), sizeof(T));
+    return value;
+  }
+
+  /** Write a list of strings. */
+  void writeStrings(std::ostream& out, const std::vector<std::string>& strings)
+  {
+    writeValue<uint32_t>(out, strings.size());
+    for (const std::string& s : strings) {
+      writeValue<uint32_t>(out, s.size());
+      out.write(s.data(), s.size());
+    }
+  }
+
+  /** Read a list of strings. */
+  std::vector<std::string> readStrings(std::istream& in)
+  {
+    std::vector<std::string> strings(readValue<uint32_t>(in));
+    for (std::string& s : strings) {
+      const uint32_t size = readValue<uint32_t>(in);
+      if (!in) break;
+      s.resize(size);
+      in.read(&s[0], size);
+    }
+    return strings;
+  }
+}
+
+EventIndex EventIndex::read(const std::string& filename)
+{
+  std::ifstream in(filename, std::ios::binary);
+  if (!in)
+    throw std::runtime_error("Cannot open event index " + filename);
+  char magic[sizeof(c_magic)];
+  in.read(magic, sizeof(magic));
+  if (!in or std::memcmp(magic, c_magic, sizeof(magic)) != 0)
+    throw std::runtime_error(filename + " is not an event index");
+  const uint64_t version = readValue<uint64_t>(in);
+  if (version != c_version)
+    throw std::runtime_error(filename + " has unsupported format version " + std::to_string(version));
+
+  EventIndex index;
+  index.m_files = readStrings(in);
+  index.m_skims = readStrings(in);
+  const uint64_t nEntries = readValue<uint64_t>(in);
+  if (!in or index.m_skims.size() > c_maxSkims)
+    throw std::runtime_error("Corrupt event index " + filename);
+  index.m_entries.resize(nEntries);
+  in.read(reinterpret_cast<char*>(index.m_entries.data()), nEntries * sizeof(Entry));
+  if (!in)
+    throw std::runtime_error("Corrupt event index " + filename);
+  for (const Entry& entry : index.m_entries) {
+    if (entry.file >= index.m_files.size())
+      throw std::runtime_error("Corrupt event index " + filename);
+  }
+  //written sorted, but don't rely on it
+  index.m_sorted = std::is_sorted(index.m_entries.begin(), index.m_entries.end(), lessThan);
+  index.sort();
+  return index;
+}
+
+void EventIndex::write(const std::string& filename)
+{
+  sort();
+  std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+  if (!out)
+    throw std::runtime_error("Cannot open " + filename + " for writing");
+  out.write(c_magic, sizeof(c_magic));
+  writeValue(out, c_version);
+  writeStrings(out, m_files);
+  writeStrings(out, m_skims);
+  writeValue<uint64_t>(out, m_entries.size());
+  out.write(reinterpret_cast<const char*>(m_entries.data()), m_entries.size() * sizeof(Entry));
+  out.close();
+  if (!out)
+    throw std::runtime_error("Cannot write event index " + filename);
+}
+
+uint32_t EventIndex::addFile(const std::string& name)
+{
+  auto it = std::find(m_files.begin(), m_files.end(), name);
+  if (it != m_files.end())
+    return it - m_files.begin();
+  m_files.push_back(name);
+  return m_files.size() - 1;
+}
+
+unsigned int EventIndex::addSkim(const std::string& name)
+{
+  const int bit = getSkimBit(name);
+  if (bit >= 0)
+    return bit;
+  if (m_skims.size() >= c_maxSkims)
+    throw std::length_error("Event index cannot store more than " + std::to_string(c_maxSkims) + " skim flags");
+  m_skims.push_back(name);
+  return m_skims.size() - 1;
+}
+
+void EventIndex::addEvent(int experiment, int run, unsigned int event, uint32_t file, uint64_t entry, uint64_t skimBits)
+{
+  const Entry e{experiment, run, event, file, entry, skimBits};
+  if (m_sorted and !m_entries.empty() and lessThan(e, m_entries.back()))
+    m_sorted = false;
+  m_entries.push_back(e);
+}
+
+void EventIndex::merge(const EventIndex& other)
+{
+  std::vector<uint32_t> files;
+  for (const std::string& file : other.m_files)
+    files.push_back(addFile(file));
+  std::vector<unsigned int> bits;
+  for (const std::string& skim : other.m_skims)
+    bits.push_back(addSkim(skim));
+  m_entries.reserve(m_entries.size() + other.m_entries.size());
+  for (const Entry& entry : other.m_entries) {
+    uint64_t skimBits = 0;
+    for (size_t i = 0; i < bits.size(); i++) {
+      if (entry.skimBits & (uint64_t(1) << i))
+        skimBits |= uint64_t(1) << bits[i];
+    }
+    addEvent(entry.experiment, entry.run, entry.event, files[entry.file], entry.entry, skimBits);
+  }
+}
+
+void EventIndex::sort()
+{
+  if (!m_sorted)
+    std::sort(m_entries.begin(), m_entries.end(), lessThan);
+  m_sorted = true;
+}
+
+int EventIndex::findFile(const std::string& name) const
+{
+  auto it = std::find(m_files.begin(), m_files.end(), name);
+  if (it != m_files.end())
+    return it - m_files.begin();
+  //the index may have been created with different paths, accept a unique match of the file name
+  const std::string filename = std::filesystem::path(name).filename().string();
+  int found = -1;
+  for (size_t i = 0; i < m_files.size(); i++) {
+    if (std::filesystem::path(m_files[i]).filename().string() == filename) {
+      if (found >= 0) return -1;
+      found = i;
+    }
+  }
+  return found;
+}
+
+int EventIndex::getSkimBit(const std::string& name) const
+{
+  auto it = std::find(m_skims.begin(), m_skims.end(), name);
+  return it != m_skims.end() ? it - m_skims.begin() : -1;
+}
+
+std::vector<EventIndex::Entry> EventIndex::find(int experiment, int run, unsigned int event) const
+{
+  if (!m_sorted)
+    throw std::logic_error("EventIndex::find() needs a sorted index");
+  const Entry lower{experiment, run, event, 0, 0, 0};
+  auto it = std::lower_bound(m_entries.begin(), m_entries.end(), lower, lessThan);
+  std::vector<Entry> result;
+  for (; it != m_entries.end() and it->experiment == experiment and it->run == run and it->event == event; ++it)
+    result.push_back(*it);
+  return result;
+}
+
+std::vector<std::vector<uint64_t>> EventIndex::selectEntries(uint64_t skimMask) const
+{
+  std::vector<std::vector<uint64_t>> entries(m_files.size());
+  for (const Entry& entry : m_entries) {
+    if (skimMask == 0 or (entry.skimBits & skimMask))
+      entries[entry.file].push_back(entry.entry);
+  }
+  for (auto& fileEntries : entries)
+    std::sort(fileEntries.begin(), fileEntries.end());
+  return entries;
+}
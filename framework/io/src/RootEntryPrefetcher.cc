@@ -0,0 +1,173 @@
+/**************************************************************************
+ * basf2 (Belle II Analysis Software Framework)                           *
+ * Author: The Belle II Collaboration                                     *
+ *                                                                        *
+ * See git log for contributors and copyright holders.                    *
+ * This file is licensed under LGPL-3.0, see LICENSE.md.                  *
+ **************************************************************************/
+
+#include <framework/io/RootEntryPrefetcher.h>
+#include <framework/io/RootIOUtilities.h>
+#include <framework/dataobjects/RelationContainer.h>
+
+#include <TChain.h>
+#include <TChainElement.h>
+#include <TClonesArray.h>
+#include <TDirectory.h>
+#include <TROOT.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+
+using namespace Belle2;
+
+std::string RootEntryPrefetcher::Statistics::getString() const
+{
+  std::stringstream s;
+  s << std::fixed << std::setprecision(3);
+  s << "entries read ahead: " << entries << ", ready when requested: " << hits << ", restarts: " << restarts;
+  s << ", uncompressed: " << bytes << " Bytes";
+  s << ", reading: " << readTime << " s, waiting: " << waitTime << " s";
+  return s.str();
+}
+
+RootEntryPrefetcher::RootEntryPrefetcher(TChain* chain, const std::vector<StoreEntry*>& entries, unsigned int depth,
+                                         long cacheSize):
+  m_inputChain(chain), m_entries(entries), m_treeName(chain->GetName()), m_depth(std::max(depth, 1u)), m_cacheSize(cacheSize)
+{
+  TIter next(chain->GetListOfFiles());
+  while (auto* element = static_cast<TChainElement*>(next())) {
+    m_files.emplace_back(element->GetTitle(), element->GetEntries());
+  }
+  ROOT::EnableThreadSafety();
+  //a single thread, so the entries are read in sequence
+  m_pool.reset(new TaskPool(1));
+}
+
+RootEntryPrefetcher::~RootEntryPrefetcher()
+{
+  for (auto& pending : m_pending) {
+    Entry entry = pending.second.get();
+    deleteObjects(entry.objects);
+  }
+  for (auto& objects : m_spareObjects)
+    deleteObjects(objects);
+  m_pool.reset();
+}
+
+void RootEntryPrefetcher::deleteObjects(std::vector<TObject*>& objects)
+{
+  for (TObject* object : objects)
+    delete object;
+  objects.clear();
+}
+
+void RootEntryPrefetcher::open()
+{
+  // make sure TDirectory is reset after this function
+  TDirectory::TContext directoryGuard;
+  m_chain.reset(new TChain(m_treeName.c_str()));
+  for (const auto& file : m_files)
+    m_chain->AddFile(file.first.c_str(), file.second);
+  if (m_cacheSize >= 0) m_chain->SetCacheSize(m_cacheSize);
+  m_addresses.assign(m_entries.size(), nullptr);
+  for (size_t i = 0; i < m_entries.size(); i++)
+    m_chain->SetBranchAddress(m_entries[i]->name.c_str(), &m_addresses[i]);
+}
+
+RootEntryPrefetcher::Entry RootEntryPrefetcher::read(long chainEntry, std::vector<TObject*> objects)
+{
+  const auto start = std::chrono::steady_clock::now();
+  if (!m_chain)
+    open();
+
+  //same as StoreEntry::resetForGetEntry()
+  objects.resize(m_entries.size(), nullptr);
+  for (size_t i = 0; i < objects.size(); i++) {
+    if (!objects[i])
+      continue;
+    if (m_entries[i]->isArray) {
+      static_cast<TClonesArray*>(objects[i])->Delete();
+    } else if (objects[i]->IsA() == RelationContainer::Class()) {
+      static_cast<RelationContainer*>(objects[i])->Clear();
+    } else {
+      delete objects[i];
+      objects[i] = nullptr;
+    }
+  }
+
+  Entry entry;
+  const long localEntry = chainEntry >= 0 ? m_chain->LoadTree(chainEntry) : -1;
+  if (localEntry >= 0) {
+    TTree* tree = m_chain->GetTree();
+    if (m_chain->GetTreeNumber() != m_treeNumber) {
+      //new file, only read the branches we want (see RootInputModule::connectBranches())
+      m_treeNumber = m_chain->GetTreeNumber();
+      const TObjArray* branches = tree->GetListOfBranches();
+      for (int i = 0; i < branches->GetEntriesFast(); i++)
+        RootIOUtilities::setBranchStatus(static_cast<TBranch*>(branches->At(i)), false);
+      for (const StoreEntry* storeEntry : m_entries) {
+        if (TBranch* branch = tree->GetBranch(storeEntry->name.c_str()))
+          RootIOUtilities::setBranchStatus(branch, true);
+      }
+    }
+    m_addresses = objects;
+    entry.bytes = tree->GetEntry(localEntry);
+    objects = m_addresses;
+  }
+  entry.objects = std::move(objects);
+  entry.readTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return entry;
+}
+
+void RootEntryPrefetcher::submit(long index, std::vector<TObject*> objects)
+{
+  const long chainEntry = m_inputChain->GetEntryNumber(index);
+  auto task = [this, chainEntry, objects = std::move(objects)]() mutable { return read(chainEntry, std::move(objects)); };
+  m_pending.emplace_back(index, m_pool->submit(std::move(task)));
+  m_nextIndex = index + 1;
+}
+
+void RootEntryPrefetcher::restart(long index)
+{
+  if (!m_pending.empty())
+    m_statistics.restarts++;
+  for (auto& pending : m_pending)
+    m_spareObjects.push_back(pending.second.get().objects);
+  m_pending.clear();
+
+  m_nextIndex = index;
+  for (unsigned int i = 0; i < m_depth; i++) {
+    std::vector<TObject*> objects;
+    if (!m_spareObjects.empty()) {
+      objects = std::move(m_spareObjects.back());
+      m_spareObjects.pop_back();
+    }
+    submit(m_nextIndex, std::move(objects));
+  }
+}
+
+int RootEntryPrefetcher::getEntry(long index)
+{
+  if (m_pending.empty() or m_pending.front().first != index)
+    restart(index);
+
+  std::future<Entry> result = std::move(m_pending.front().second);
+  m_pending.pop_front();
+  if (result.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+    m_statistics.hits++;
+  const auto start = std::chrono::steady_clock::now();
+  Entry entry = result.get();
+  m_statistics.waitTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  m_statistics.entries++;
+  m_statistics.bytes += std::max(entry.bytes, 0);
+  m_statistics.readTime += entry.readTime;
+
+  for (size_t i = 0; i < m_entries.size(); i++)
+    std::swap(m_entries[i]->object, entry.objects[i]);
+  //keep reading ahead, reusing the objects of the previous entry
+  submit(m_nextIndex, std::move(entry.objects));
+  return entry.bytes;
+}
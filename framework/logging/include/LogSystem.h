@@ -14,6 +14,7 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <mutex>
 #include <unordered_map>
 
 
@@ -184,7 +185,7 @@ namespace Belle2 {
      *                        Set to NULL to use the global log configuration.
      * @param moduleName Name of the module.
      */
-    void updateModule(const LogConfig* moduleLogConfig = nullptr, const std::string& moduleName = "") { m_moduleLogConfig = moduleLogConfig; m_moduleName = moduleName; }
+    void updateModule(const LogConfig* moduleLogConfig = nullptr, const std::string& moduleName = "") { s_moduleLogConfig = moduleLogConfig; s_moduleName = moduleName; }
 
     /**
      * Enable debug output.
@@ -201,10 +202,12 @@ namespace Belle2 {
     std::vector<LogConnectionBase*> m_logConnections;
     /** The global log system configuration. */
     LogConfig m_logConfig;
-    /** log config of current module */
-    const LogConfig* m_moduleLogConfig;
-    /** The current module name. */
-    std::string m_moduleName;
+    /** log config of current module (separately for each thread, as threads may execute different modules) */
+    static thread_local const LogConfig* s_moduleLogConfig;
+    /** The current module name (separately for each thread). */
+    static thread_local std::string s_moduleName;
+    /** Serializes sendMessage() calls from different threads. Recursive since sending may trigger further messages. */
+    std::recursive_mutex m_sendMutex;
     /** Stores the log configuration objects for packages. */
     std::map<std::string, LogConfig> m_packageLogConfigs;
     /** Whether to re-print errors-warnings encountered during execution at the end. */
@@ -254,8 +257,8 @@ namespace Belle2 {
   inline const LogConfig& LogSystem::getCurrentLogConfig(const char* package) const
   {
     //module specific config?
-    if (m_moduleLogConfig && (m_moduleLogConfig->getLogLevel() != LogConfig::c_Default)) {
-      return *m_moduleLogConfig;
+    if (s_moduleLogConfig && (s_moduleLogConfig->getLogLevel() != LogConfig::c_Default)) {
+      return *s_moduleLogConfig;
     }
     //package specific config?
     if (package && !m_packageLogConfigs.empty()) {
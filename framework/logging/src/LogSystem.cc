@@ -23,6 +23,8 @@ using namespace std;
 
 
 bool LogSystem::s_debugEnabled = false;
+thread_local const LogConfig* LogSystem::s_moduleLogConfig = nullptr;
+thread_local std::string LogSystem::s_moduleName;
 
 
 LogSystem& LogSystem::Instance()
@@ -69,13 +71,15 @@ bool LogSystem::sendMessage(LogMessage&& message)
   auto packageLogConfig = m_packageLogConfigs.find(message.getPackage());
   if ((packageLogConfig != m_packageLogConfigs.end()) && packageLogConfig->second.getLogInfo(logLevel)) {
     message.setLogInfo(packageLogConfig->second.getLogInfo(logLevel));
-  } else if (m_moduleLogConfig && m_moduleLogConfig->getLogInfo(logLevel)) {
-    message.setLogInfo(m_moduleLogConfig->getLogInfo(logLevel));
+  } else if (s_moduleLogConfig && s_moduleLogConfig->getLogInfo(logLevel)) {
+    message.setLogInfo(s_moduleLogConfig->getLogInfo(logLevel));
   } else {
     message.setLogInfo(m_logConfig.getLogInfo(logLevel));
   }
 
-  message.setModule(m_moduleName);
+  message.setModule(s_moduleName);
+
+  std::lock_guard<std::recursive_mutex> lock(m_sendMutex);
 
   // We want to count it whether we've seen it or not
   incMessageCounter(logLevel);
@@ -167,7 +171,6 @@ int LogSystem::getMessageCounter(LogConfig::ELogLevel logLevel) const
 
 LogSystem::LogSystem() :
   m_logConfig(LogConfig::c_Info),
-  m_moduleLogConfig(nullptr),
   m_printErrorSummary(false),
   m_messageCounter{0}
 {
@@ -178,7 +181,7 @@ void LogSystem::resetLogging()
 {
   m_logConfig.setLogLevel(LogConfig::c_Info);
   m_logConfig.setDebugLevel(LogConfig::c_DefaultDebugLevel);
-  m_moduleLogConfig = nullptr;
+  s_moduleLogConfig = nullptr;
   m_packageLogConfigs.clear();
   constexpr unsigned int logInfo = LogConfig::c_Level + LogConfig::c_Message;
   constexpr unsigned int warnLogInfo = LogConfig::c_Level + LogConfig::c_Message + LogConfig::c_Module;
@@ -227,7 +230,7 @@ void LogSystem::printErrorSummary()
   const LogConfig oldConfig = m_logConfig;
   // and make sure module configuration is bypassed, otherwise changing the settings in m_logConfig would be ignored
   const LogConfig* oldModuleConfig {nullptr};
-  std::swap(m_moduleLogConfig, oldModuleConfig);
+  std::swap(s_moduleLogConfig, oldModuleConfig);
   // similar for package configuration
   map<string, LogConfig> oldPackageConfig;
   std::swap(m_packageLogConfigs, oldPackageConfig);
@@ -282,7 +285,7 @@ void LogSystem::printErrorSummary()
 
   // restore old configuration
   m_logConfig = oldConfig;
-  std::swap(m_moduleLogConfig, oldModuleConfig);
+  std::swap(s_moduleLogConfig, oldModuleConfig);
   std::swap(m_packageLogConfigs, oldPackageConfig);
 }
 
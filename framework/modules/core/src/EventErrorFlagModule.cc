@@ -23,7 +23,7 @@ EventErrorFlagModule::EventErrorFlagModule() : Module()
 {
   setDescription("Returns error flags of the EventMetaData and can add further error flags.");
 
-  setPropertyFlags(c_ParallelProcessingCertified);
+  setPropertyFlags(c_ParallelProcessingCertified | c_ThreadSafe);
 
   addParam("errorFlag", m_ErrorFlag, "Error flags to add", 0);
 }
@@ -41,7 +41,7 @@ PruneDataStoreModule::PruneDataStoreModule() :
            "If true, all entries matched by the regular expression are kept. "
            "If false, matched entries will be removed.",
            m_keepMatchedEntries);
-  setPropertyFlags(c_ParallelProcessingCertified);
+  setPropertyFlags(c_ParallelProcessingCertified | c_ThreadSafe);
 
 }
 
@@ -0,0 +1,72 @@
+/**************************************************************************
+ * basf2 (Belle II Analysis Software Framework)                           *
+ * Author: The Belle II Collaboration                                     *
+ *                                                                        *
+ * See git log for contributors and copyright holders.                    *
+ * This file is licensed under LGPL-3.0, see LICENSE.md.                  *
+ **************************************************************************/
+
+#pragma once
+
+#include <framework/core/Module.h>
+#include <framework/io/ColumnarFile.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Belle2 {
+  struct StoreEntry;
+
+  /** Read files written by ColumnarOutput into the DataStore.
+   *
+   * The files are memory mapped, so only the pages of the columns which are restored are read from disk.
+   * With the columnNames parameter the restored members can be restricted to the ones needed by the job,
+   * all other members keep the values set by the default constructor.
+   */
+  class ColumnarInputModule : public Module {
+  public:
+    /** Constructor. */
+    ColumnarInputModule();
+
+    /** Open the first file and register the DataStore entries. */
+    virtual void initialize() override;
+    /** Restore the next event. */
+    virtual void event() override;
+    /** Close the file. */
+    virtual void terminate() override;
+
+    /** Get list of input files, taking -i command line overrides into account. */
+    virtual std::vector<std::string> getFileNames(bool outputFiles = false) override;
+
+  private:
+    /** A restored member. */
+    struct ColumnMap {
+      size_t column; /**< column index in the file. */
+      long memoryOffset; /**< offset of the member in the object. */
+      size_t size; /**< size of the member in bytes. */
+    };
+    /** A restored branch. */
+    struct BranchMap {
+      StoreEntry* entry{nullptr}; /**< the DataStore entry. */
+      std::string className; /**< class of the objects. */
+      bool isArray{false}; /**< StoreArray or StoreObjPtr. */
+      std::vector<ColumnMap> columns; /**< restored members. */
+      int branch{ -1}; /**< index of the branch in the current file, -1 if it doesn't exist. */
+    };
+
+    /** Open the given file and map its branches and columns to the DataStore entries. */
+    void openFile(size_t index);
+
+    std::vector<std::string> m_inputFileNames; /**< names of the input files. */
+    std::vector<std::string> m_branchNames; /**< branches to read, all if empty. */
+    std::vector<std::string> m_columnNames; /**< members to restore as "branch.member", all if empty. */
+
+    std::unique_ptr<ColumnarFileReader> m_reader; /**< the current file. */
+    size_t m_fileIndex{0}; /**< index of the current file. */
+    uint64_t m_event{0}; /**< next event in the current file. */
+    size_t m_cluster{0}; /**< cluster of the current event. */
+    std::vector<BranchMap> m_branches; /**< restored branches. */
+    long m_bytes{0}; /**< number of bytes restored. */
+  };
+}
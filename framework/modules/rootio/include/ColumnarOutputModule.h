@@ -0,0 +1,49 @@
+/**************************************************************************
+ * basf2 (Belle II Analysis Software Framework)                           *
+ * Author: The Belle II Collaboration                                     *
+ *                                                                        *
+ * See git log for contributors and copyright holders.                    *
+ * This file is licensed under LGPL-3.0, see LICENSE.md.                  *
+ **************************************************************************/
+
+#pragma once
+
+#include <framework/core/Module.h>
+#include <framework/io/ColumnarFile.h>
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Belle2 {
+  struct StoreEntry;
+
+  /** Write event durability objects and arrays to a columnar file (see ColumnarFileWriter).
+   *
+   * Only members of basic type (and fixed size arrays and embedded objects of those) are stored, so
+   * reading a few members of many events only touches the bytes of these members. Relations are not stored.
+   * Use ColumnarInput to read the files, or ColumnarFileReader to access the columns directly.
+   */
+  class ColumnarOutputModule : public Module {
+  public:
+    /** Constructor. */
+    ColumnarOutputModule();
+
+    /** Open the file and set up the branches. */
+    virtual void initialize() override;
+    /** Add the objects of the event. */
+    virtual void event() override;
+    /** Close the file. */
+    virtual void terminate() override;
+
+  private:
+    std::string m_outputFileName; /**< name of the output file. */
+    std::vector<std::string> m_branchNames; /**< branches to write, all if empty. */
+    std::vector<std::string> m_excludeBranchNames; /**< branches not to write. */
+    unsigned int m_clusterSize{1000}; /**< number of events per cluster. */
+
+    std::unique_ptr<ColumnarFileWriter> m_writer; /**< the file. */
+    std::vector<std::pair<StoreEntry*, size_t>> m_entries; /**< DataStore entries and their branch index. */
+  };
+}
@@ -14,6 +14,7 @@
 #include <framework/dataobjects/FileMetaData.h>
 #include <framework/dataobjects/EventMetaData.h>
 
+#include <memory>
 #include <string>
 #include <vector>
 #include <set>
@@ -23,6 +24,9 @@
 
 
 namespace Belle2 {
+  class EventIndex;
+  class RootEntryPrefetcher;
+
   /** Module to read TTree data from file into the data store.
    *
    *  For more information consult the `basf2 Software Portal XWiki page <https://xwiki.desy.de/xwiki/rest/p/899ba>`_.
@@ -105,6 +109,12 @@ namespace Belle2 {
     /** Correct isMC flag for raw data recorded before experiment 8 run 2364. */
     void realDataWorkaround(FileMetaData& metaData);
 
+    /** Keep only the input files with events selected by m_eventIndexSkims and set the entry sequences for them. */
+    void selectFromEventIndex();
+
+    /** Entry of the given event in m_tree (taking the entry sequences into account) according to the event index, -1 if not found. */
+    long findEntryInEventIndex(long experiment, long run, long event) const;
+
     //first the steerable variables:
     /** File to read from. Cannot be used together with m_inputFileNames. */
     std::string m_inputFileName;
@@ -148,6 +158,12 @@ namespace Belle2 {
     /** experiment, run, event number of first event to load */
     std::vector<int> m_skipToEvent;
 
+    /** Name of an event index file (see EventIndex) for the input files, empty for none */
+    std::string m_eventIndexFileName;
+
+    /** Only read events with any of these skim flags set in the event index */
+    std::vector<std::string> m_eventIndexSkims;
+
     //then those for purely internal use:
 
     /** Next entry to be read in event tree.  */
@@ -216,6 +232,27 @@ namespace Belle2 {
     /** Input ROOT File Cache size in MB, <0 means default */
     int m_cacheSize{0};
 
+    /** Number of entries to read ahead in a background thread, 0 to read synchronously */
+    unsigned int m_readAheadEntries{0};
+
+    /** Number of threads for parallel decompression of branches, 0 to disable */
+    unsigned int m_decompressionThreads{0};
+
+    /** Set once the first entry is read, which may happen before the processes are forked */
+    bool m_firstEntryRead{false};
+
+    /** Set once read-ahead and parallel decompression are set up (when reading the second entry) */
+    bool m_readAheadStarted{false};
+
+    /** Reads entries of m_tree ahead of time, if enabled */
+    std::unique_ptr<RootEntryPrefetcher> m_prefetcher;
+
+    /** The event index, if m_eventIndexFileName is set */
+    std::unique_ptr<EventIndex> m_eventIndex;
+
+    /** Tree number in m_tree of each file in the event index, -1 for files which are not read */
+    std::vector<int> m_eventIndexTrees;
+
     /** Discard events that have an error flag != 0 */
     bool m_discardErrorEvents{true};
     /** Don't issue a warning when discarding events if the error flag consists exclusively of flags in this mask */
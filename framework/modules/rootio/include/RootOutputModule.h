@@ -14,14 +14,21 @@
 #include <framework/datastore/StoreObjPtr.h>
 #include <framework/dataobjects/FileMetaData.h>
 #include <framework/dataobjects/EventMetaData.h>
+#include <framework/io/EventIndex.h>
+#include <framework/utilities/TaskPool.h>
 
 #include <TFile.h>
 #include <TTree.h>
 
+#include <deque>
+#include <future>
+#include <memory>
 #include <optional>
 #include <string>
 #include <vector>
 
+class TBufferFile;
+
 namespace Belle2 {
   /** Write objects from DataStore into a ROOT file.
    *
@@ -95,6 +102,25 @@ namespace Belle2 {
     /** Create and fill FileMetaData object. */
     void fillFileMetaData();
 
+    /** Abort if writing to the output file failed. */
+    void checkWriteError();
+
+    /** Result of writing one event in the output thread. */
+    struct WriteResult {
+      std::unique_ptr<TBufferFile> buffer; /**< the buffer holding the event, to be reused. */
+      uint64_t fileSize{0}; /**< size of the output file after writing the event. */
+      bool writeError{false}; /**< true if writing failed. */
+    };
+
+    /** Stream the event durability objects into a buffer and queue them for the output thread. */
+    void queueEvent();
+
+    /** Fill the event tree with the objects streamed into the given buffer, called by the output thread. */
+    WriteResult writeEvent(std::unique_ptr<TBufferFile> buffer);
+
+    /** Wait for the oldest queued event to be written. */
+    void finishWrite();
+
     //first the steerable variables:
 
     /** Name for output file.
@@ -155,6 +181,15 @@ namespace Belle2 {
      * if the event tree in output file has reached the given size in MB */
     std::optional<uint64_t> m_outputSplitSize{std::nullopt};
 
+    /** Number of events that can be queued for the output thread, 0 to write in the event thread. */
+    unsigned int m_writeQueueDepth{0};
+
+    /** Name of the event index file to write, empty to write none. */
+    std::string m_eventIndexFileName;
+
+    /** Names of event objects/arrays which set the skim flags in the event index. */
+    std::vector<std::string> m_eventIndexSkimBranches;
+
     //then those for purely internal use:
 
     /** Keep track of the file index: if we split files than we add '.f{fileIndex:05d}' in front of the ROOT extension */
@@ -217,5 +252,27 @@ namespace Belle2 {
     StoreObjPtr<FileMetaData> m_fileMetaData{"", DataStore::c_Persistent};
     /** File meta data stored in the output file */
     FileMetaData* m_outputFileMetaData;
+
+    /** Set once the output thread is set up (in the first event) */
+    bool m_threadsStarted{false};
+    /** Size of the output file after the last event written by the output thread. */
+    uint64_t m_writtenFileSize{0};
+    /** Copies of the event durability objects filled by the output thread, their addresses are set as the event tree branch addresses. */
+    std::vector<TObject*> m_writeObjects;
+    /** Events queued for the output thread, oldest first. */
+    std::deque<std::future<WriteResult>> m_pendingWrites;
+    /** Buffers of written events, to be reused. */
+    std::vector<std::unique_ptr<TBufferFile>> m_freeBuffers;
+    /** The output thread, if m_writeQueueDepth > 0. */
+    std::unique_ptr<TaskPool> m_writer;
+
+    /** Event index of all output files, if m_eventIndexFileName is set. */
+    std::unique_ptr<EventIndex> m_eventIndex;
+    /** DataStore entries setting the skim flags, in the order of the skim flags in the event index. */
+    std::vector<DataStore::StoreEntry*> m_eventIndexSkimEntries;
+    /** Index of the current output file in the event index. */
+    uint32_t m_eventIndexFile{0};
+    /** Number of events written to the current output file. */
+    uint64_t m_fileEntries{0};
   };
 } // end namespace Belle2
@@ -0,0 +1,193 @@
+/**************************************************************************
+ * basf2 (Belle II Analysis Software Framework)                           *
+ * Author: The Belle II Collaboration                                     *
+ *                                                                        *
+ * See git log for contributors and copyright holders.                    *
+ * This file is licensed under LGPL-3.0, see LICENSE.md.                  *
+ **************************************************************************/
+
+#include <framework/modules/rootio/ColumnarInputModule.h>
+
+#include <framework/core/Environment.h>
+#include <framework/datastore/DataStore.h>
+
+#include <TClass.h>
+#include <TClonesArray.h>
+
+#include <algorithm>
+#include <cstring>
+#include <set>
+#include <stdexcept>
+
+using namespace std;
+using namespace Belle2;
+
+//-----------------------------------------------------------------
+//                 Register the Module
+//-----------------------------------------------------------------
+REG_MODULE(ColumnarInput);
+
+//-----------------------------------------------------------------
+//                 Implementation
+//-----------------------------------------------------------------
+
+ColumnarInputModule::ColumnarInputModule() : Module()
+{
+  setDescription("Read files written by ColumnarOutput. The files are memory mapped and only the members "
+                 "selected with columnNames are restored, so only their bytes are read from disk.");
+  setPropertyFlags(c_Input);
+
+  addParam("inputFileNames", m_inputFileNames, "Input file names, read in the given order. Can be overridden "
+           "using the -i argument to basf2.", m_inputFileNames);
+  addParam("branchNames", m_branchNames, "Names of the event objects/arrays to read, all if empty. "
+           "EventMetaData is always read.", m_branchNames);
+  addParam("columnNames", m_columnNames, "Members to restore, as 'branch.member' (e.g. 'Tracks.m_pValue', "
+           "members of embedded objects are separated by '.'). For branches with at least one member in this list "
+           "all other members keep the values of the default constructor. All members are restored if empty.",
+           m_columnNames);
+}
+
+vector<string> ColumnarInputModule::getFileNames(bool outputFiles)
+{
+  B2ASSERT("ColumnarInput is not an output module", !outputFiles);
+  const vector<string>& inputFiles = Environment::Instance().getInputFilesOverride();
+  if (!inputFiles.empty())
+    return inputFiles;
+  return m_inputFileNames;
+}
+
+void ColumnarInputModule::initialize()
+{
+  m_inputFileNames = getFileNames();
+  if (m_inputFileNames.empty())
+    B2FATAL("No input files specified");
+
+  try {
+    m_reader.reset(new ColumnarFileReader(m_inputFileNames[0]));
+  } catch (const std::exception& e) {
+    B2FATAL(e.what());
+  }
+  if (m_reader->getBranchIndex("EventMetaData") < 0)
+    B2FATAL("No EventMetaData in input file" << LogVar("file", m_inputFileNames[0]));
+
+  const set<string> wanted(m_branchNames.begin(), m_branchNames.end());
+  for (const Columnar::Branch& branch : m_reader->getBranches()) {
+    if (!wanted.empty() and wanted.count(branch.name) == 0 and branch.name != "EventMetaData")
+      continue;
+    TClass* cl = TClass::GetClass(branch.className.c_str());
+    if (!cl)
+      B2FATAL("No dictionary for class" << LogVar("class", branch.className) << LogVar("branch", branch.name));
+    if (!DataStore::Instance().registerEntry(branch.name, DataStore::c_Event, cl, branch.isArray, DataStore::c_WriteOut))
+      B2FATAL("Cannot register entry" << LogVar("branch", branch.name));
+    BranchMap map;
+    map.entry = &DataStore::Instance().getStoreEntryMap(DataStore::c_Event).at(branch.name);
+    map.className = branch.className;
+    map.isArray = branch.isArray;
+    m_branches.push_back(std::move(map));
+  }
+  for (const string& name : m_branchNames) {
+    if (m_reader->getBranchIndex(name) < 0)
+      B2WARNING("Branch not found in input file" << LogVar("branch", name) << LogVar("file", m_inputFileNames[0]));
+  }
+
+  openFile(0);
+}
+
+void ColumnarInputModule::openFile(size_t index)
+{
+  if (index > 0) {
+    try {
+      m_reader.reset(new ColumnarFileReader(m_inputFileNames[index]));
+    } catch (const std::exception& e) {
+      B2FATAL(e.what());
+    }
+  }
+  m_fileIndex = index;
+  m_event = 0;
+  m_cluster = 0;
+  B2INFO("ColumnarInput: Open " << m_inputFileNames[index] << LogVar("events", m_reader->getNEvents()));
+
+  set<string> unusedColumns(m_columnNames.begin(), m_columnNames.end());
+  for (BranchMap& map : m_branches) {
+    map.columns.clear();
+    map.branch = m_reader->getBranchIndex(map.entry->name);
+    if (map.branch < 0) {
+      B2WARNING("Branch not found in input file, it will be empty" << LogVar("branch", map.entry->name)
+                << LogVar("file", m_inputFileNames[index]));
+      continue;
+    }
+    const Columnar::Branch& branch = m_reader->getBranches()[map.branch];
+    if (branch.className != map.className or branch.isArray != map.isArray)
+      B2FATAL("Branch has a different type than in the first file" << LogVar("branch", branch.name)
+              << LogVar("file", m_inputFileNames[index]));
+
+    //only restore the selected members, if there are any for this branch
+    const string prefix = branch.name + ".";
+    const bool selected = any_of(m_columnNames.begin(), m_columnNames.end(),
+    [&prefix](const string & name) { return name.compare(0, prefix.size(), prefix) == 0; });
+
+    //the class might have changed since the file was written, so match the members by name, type and length
+    const vector<Columnar::Column> current = Columnar::getColumns(map.entry->objClass);
+    for (size_t i = 0; i < branch.columns.size(); i++) {
+      const Columnar::Column& column = branch.columns[i];
+      if (selected and find(m_columnNames.begin(), m_columnNames.end(), prefix + column.name) == m_columnNames.end())
+        continue;
+      unusedColumns.erase(prefix + column.name);
+      auto it = find_if(current.begin(), current.end(), [&column](const Columnar::Column & c) { return c.name == column.name; });
+      if (it == current.end() or it->type != column.type or it->length != column.length) {
+        B2WARNING("Member in input file does not match the current class, it will not be restored"
+                  << LogVar("class", branch.className) << LogVar("member", column.name));
+        continue;
+      }
+      map.columns.push_back({i, it->memoryOffset, column.getSize()});
+    }
+  }
+  if (index == 0) {
+    for (const string& name : unusedColumns)
+      B2ERROR("Member given in columnNames not found in input file" << LogVar("member", name));
+  }
+}
+
+void ColumnarInputModule::event()
+{
+  while (m_event >= m_reader->getNEvents()) {
+    //end of data if there are no more files, the missing EventMetaData stops the processing
+    if (m_fileIndex + 1 >= m_inputFileNames.size())
+      return;
+    openFile(m_fileIndex + 1);
+  }
+  while (m_event >= m_reader->getCluster(m_cluster).firstEvent + m_reader->getCluster(m_cluster).nEvents)
+    m_cluster++;
+  const uint64_t local = m_event - m_reader->getCluster(m_cluster).firstEvent;
+
+  for (const BranchMap& map : m_branches) {
+    if (map.branch < 0)
+      continue;
+    const uint64_t* offsets = m_reader->getObjectOffsets(m_cluster, map.branch);
+    const uint64_t first = offsets[local];
+    const uint64_t n = offsets[local + 1] - first;
+    if (!map.isArray and n == 0)
+      continue;
+
+    StoreEntry* entry = map.entry;
+    entry->recreate();
+    TClonesArray* array = map.isArray ? static_cast<TClonesArray*>(entry->ptr) : nullptr;
+    for (uint64_t k = 0; k < n; k++) {
+      TObject* object = array ? array->ConstructedAt(k) : entry->ptr;
+      char* start = Columnar::getObjectStart(object);
+      for (const ColumnMap& column : map.columns) {
+        const char* data = m_reader->getColumnData(m_cluster, map.branch, column.column);
+        std::memcpy(start + column.memoryOffset, data + (first + k) * column.size, column.size);
+        m_bytes += column.size;
+      }
+    }
+  }
+  m_event++;
+}
+
+void ColumnarInputModule::terminate()
+{
+  B2INFO("ColumnarInput: restored " << m_bytes << " bytes");
+  m_reader.reset();
+  m_branches.clear();
+}
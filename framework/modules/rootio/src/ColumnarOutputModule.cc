@@ -0,0 +1,135 @@
+/**************************************************************************
+ * basf2 (Belle II Analysis Software Framework)                           *
+ * Author: The Belle II Collaboration                                     *
+ *                                                                        *
+ * See git log for contributors and copyright holders.                    *
+ * This file is licensed under LGPL-3.0, see LICENSE.md.                  *
+ **************************************************************************/
+
+#include <framework/modules/rootio/ColumnarOutputModule.h>
+
+#include <framework/core/Environment.h>
+#include <framework/datastore/DataStore.h>
+#include <framework/dataobjects/RelationContainer.h>
+#include <framework/io/RootIOUtilities.h>
+
+#include <TClass.h>
+#include <TClonesArray.h>
+
+#include <algorithm>
+#include <set>
+#include <stdexcept>
+
+using namespace std;
+using namespace Belle2;
+
+//-----------------------------------------------------------------
+//                 Register the Module
+//-----------------------------------------------------------------
+REG_MODULE(ColumnarOutput);
+
+//-----------------------------------------------------------------
+//                 Implementation
+//-----------------------------------------------------------------
+
+ColumnarOutputModule::ColumnarOutputModule() : Module()
+{
+  setDescription("Write the members of basic type of event objects and arrays as plain arrays (columns) to a "
+                 "memory-mappable file, to be read with ColumnarInput. Analysis jobs using only a few members of "
+                 "large arrays read only the bytes of these members. Relations, strings, STL containers and "
+                 "pointers are not stored.");
+  setPropertyFlags(c_Output);
+
+  addParam("outputFileName", m_outputFileName, "Name of the output file. Can be overridden using the -o argument to basf2.",
+           string("ColumnarOutput.b2col"));
+  addParam("branchNames", m_branchNames, "Names of the event objects/arrays to write, all if empty. "
+           "EventMetaData is always written.", m_branchNames);
+  addParam("excludeBranchNames", m_excludeBranchNames, "Names of the event objects/arrays not to write.",
+           m_excludeBranchNames);
+  addParam("clusterSize", m_clusterSize, "Number of events which are written together. The columns of one "
+           "cluster are contiguous in the file, larger values need more memory while writing.", m_clusterSize);
+}
+
+void ColumnarOutputModule::initialize()
+{
+  const std::string& outputFileArgument = Environment::Instance().consumeOutputFileOverride(getName());
+  if (!outputFileArgument.empty())
+    m_outputFileName = outputFileArgument;
+
+  try {
+    m_writer.reset(new ColumnarFileWriter(m_outputFileName, m_clusterSize));
+  } catch (const std::exception& e) {
+    B2FATAL(e.what());
+  }
+
+  DataStore::StoreEntryMap& map = DataStore::Instance().getStoreEntryMap(DataStore::c_Event);
+  set<string> branchList;
+  for (const auto& pair : map)
+    branchList.insert(pair.first);
+  branchList = RootIOUtilities::filterBranches(branchList, m_branchNames, m_excludeBranchNames, DataStore::c_Event);
+
+  for (auto& iter : map) {
+    const string& branchName = iter.first;
+    StoreEntry& entry = iter.second;
+    if (branchName != "EventMetaData") {
+      //skip transient entries (allow overriding via branchNames)
+      if (entry.dontWriteOut and find(m_branchNames.begin(), m_branchNames.end(), branchName) == m_branchNames.end())
+        continue;
+      if (branchList.count(branchName) == 0)
+        continue;
+    }
+    if (!entry.isArray and entry.objClass == RelationContainer::Class()) {
+      B2DEBUG(20, "Relations are not stored in columnar files" << LogVar("branch", branchName));
+      continue;
+    }
+
+    vector<string> skipped;
+    Columnar::getColumns(entry.objClass, &skipped);
+    for (const string& member : skipped) {
+      B2DEBUG(20, "Member cannot be stored in columnar files" << LogVar("class", entry.objClass->GetName())
+              << LogVar("member", member));
+    }
+    const size_t branch = m_writer->addBranch(branchName, entry.objClass, entry.isArray);
+    if (m_writer->getBranch(branch).columns.empty()) {
+      B2WARNING("No members of this class can be stored, only the number of objects is written"
+                << LogVar("class", entry.objClass->GetName()) << LogVar("branch", branchName));
+    }
+    m_entries.emplace_back(&entry, branch);
+  }
+}
+
+void ColumnarOutputModule::event()
+{
+  for (const auto& pair : m_entries) {
+    const StoreEntry* entry = pair.first;
+    if (!entry->ptr)
+      continue;
+    if (entry->isArray) {
+      const TClonesArray* array = static_cast<TClonesArray*>(entry->ptr);
+      const int n = array->GetEntriesFast();
+      for (int i = 0; i < n; i++)
+        m_writer->addObject(pair.second, array->At(i));
+    } else {
+      m_writer->addObject(pair.second, entry->ptr);
+    }
+  }
+  try {
+    m_writer->endEvent();
+  } catch (const std::exception& e) {
+    B2FATAL(e.what());
+  }
+}
+
+void ColumnarOutputModule::terminate()
+{
+  if (!m_writer)
+    return;
+  try {
+    m_writer->close();
+    B2INFO("ColumnarOutput: file closed" << LogVar("file", m_outputFileName) << LogVar("events", m_writer->getNEvents()));
+  } catch (const std::exception& e) {
+    B2ERROR(e.what());
+  }
+  m_writer.reset();
+  m_entries.clear();
+}
@@ -11,8 +11,11 @@
 
 #include <framework/io/RootIOUtilities.h>
 #include <framework/io/RootFileInfo.h>
+#include <framework/io/RootEntryPrefetcher.h>
+#include <framework/io/EventIndex.h>
 #include <framework/core/FileCatalog.h>
 #include <framework/core/InputController.h>
+#include <framework/core/ProcessStatistics.h>
 #include <framework/pcore/Mergeable.h>
 #include <framework/datastore/StoreObjPtr.h>
 #include <framework/datastore/DataStore.h>
@@ -21,12 +24,14 @@
 #include <framework/utilities/NumberSequence.h>
 #include <framework/utilities/ScopeGuard.h>
 #include <framework/database/Configuration.h>
+#include <framework/gearbox/Unit.h>
 
 #include <TClonesArray.h>
 #include <TEventList.h>
 #include <TObjArray.h>
 #include <TChainElement.h>
 #include <TError.h>
+#include <TROOT.h>
 
 #include <iomanip>
 
@@ -61,6 +66,12 @@ RootInputModule::RootInputModule() : Module(), m_nextEntry(0), m_lastPersistentE
   addParam("skipToEvent", m_skipToEvent, "Skip events until the event with "
            "the specified (experiment, run, event number) occurs. This parameter "
            "is useful for debugging to start with a specific event.", m_skipToEvent);
+  addParam("eventIndex", m_eventIndexFileName, "Name of an event index file for the input files, as written by "
+           "RootOutput (eventIndexFileName) or b2file-index. It is used to find the events given by skipToEvent or requested "
+           "during processing in all input files, and to select events with eventIndexSkims.", m_eventIndexFileName);
+  addParam("eventIndexSkims", m_eventIndexSkims, "Only read events with any of these skim flags set in the event index. "
+           "Input files without selected events are not opened at all. Cannot be used together with entrySequences.",
+           m_eventIndexSkims);
 
   addParam(c_SteerBranchNames[0], m_branchNames[0],
            "Names of event durability branches to be read. Empty means all branches. (EventMetaData is always read)", emptyvector);
@@ -78,10 +89,18 @@ RootInputModule::RootInputModule() : Module(), m_nextEntry(0), m_lastPersistentE
            0);
 
   addParam("collectStatistics", m_collectStatistics,
-           "Collect statistics on amount of data read and print statistics (separate for input & parent files) after processing. Data is collected from TFile using GetBytesRead(), GetBytesReadExtra(), GetReadCalls()",
+           "Collect statistics on amount of data read and print statistics (separate for input & parent files) after processing. Data is collected from TFile using GetBytesRead(), GetBytesReadExtra(), GetReadCalls(). "
+           "The uncompressed bytes read and the read-ahead counters are always available in the module statistics (input_bytes, read_ahead_hits, read_ahead_restarts, read_ahead_wait_time).",
            false);
   addParam("cacheSize", m_cacheSize,
            "file cache size in Mbytes. If negative, use root default", 0);
+  addParam("readAheadEntries", m_readAheadEntries,
+           "Number of entries to read and decompress ahead of time in a background thread. 0 reads every entry when it is "
+           "requested. Read-ahead is most useful if decompression takes a large fraction of the processing time, like for "
+           "skimming. Each prefetched entry needs its own copy of all objects in memory.", m_readAheadEntries);
+  addParam("decompressionThreads", m_decompressionThreads,
+           "Number of threads to decompress the branches of an entry in parallel (ROOT implicit multi-threading). 0 to "
+           "decompress in the reading thread.", m_decompressionThreads);
 
   addParam("discardErrorEvents", m_discardErrorEvents,
            "Discard events with an error flag != 0", m_discardErrorEvents);
@@ -124,6 +143,18 @@ void RootInputModule::initialize()
     B2FATAL("No valid files specified!");
   }
 
+  if (!m_eventIndexFileName.empty()) {
+    try {
+      m_eventIndex.reset(new EventIndex(EventIndex::read(m_eventIndexFileName)));
+    } catch (const std::exception& e) {
+      B2FATAL("Could not read event index " << std::quoted(m_eventIndexFileName) << ": " << e.what());
+    }
+    if (!m_eventIndexSkims.empty())
+      selectFromEventIndex();
+  } else if (!m_eventIndexSkims.empty()) {
+    B2FATAL("eventIndexSkims can only be used together with an event index (eventIndex parameter)");
+  }
+
   if (m_entrySequences.size() > 0 and m_inputFileNames.size() != m_entrySequences.size()) {
     B2FATAL("Number of provided filenames does not match the number of given entrySequences parameters: len(inputFileNames) = "
             << m_inputFileNames.size() << " len(entrySequences) = " << m_entrySequences.size());
@@ -279,6 +310,19 @@ void RootInputModule::initialize()
     m_tree->SetEventList(elist);
   }
 
+  if (m_eventIndex) {
+    // find the files of the event index in the chain
+    m_eventIndexTrees.assign(m_eventIndex->getFiles().size(), -1);
+    TIter next(m_tree->GetListOfFiles());
+    int treeNumber = 0;
+    while (auto* element = static_cast<TChainElement*>(next())) {
+      const int file = m_eventIndex->findFile(element->GetTitle());
+      if (file >= 0 and m_eventIndexTrees[file] < 0)
+        m_eventIndexTrees[file] = treeNumber;
+      treeNumber++;
+    }
+  }
+
   B2DEBUG(33, "Opened tree '" + c_treeNames[DataStore::c_Persistent] + "'" << LogVar("entries", m_persistent->GetEntriesFast()));
   B2DEBUG(33, "Opened tree '" + c_treeNames[DataStore::c_Event] + "'" << LogVar("entries", m_tree->GetEntriesFast()));
 
@@ -316,7 +360,7 @@ void RootInputModule::initialize()
       B2ERROR("skipToEvent must be a list of three values: experiment, run, event number");
       // ignore the value
       m_skipToEvent.clear();
-    } else {
+    } else if (!m_eventIndex) {
       InputController::setNextEntry(m_skipToEvent[0], m_skipToEvent[1], m_skipToEvent[2]);
     }
     if (m_nextEntry > 0) {
@@ -325,6 +369,16 @@ void RootInputModule::initialize()
       //force the number of skipped events to be zero
       m_nextEntry = 0;
     }
+    if (m_eventIndex and !m_skipToEvent.empty()) {
+      // the event index knows the entries in all files, so we can start there directly
+      const long entry = findEntryInEventIndex(m_skipToEvent[0], m_skipToEvent[1], m_skipToEvent[2]);
+      if (entry >= 0) {
+        m_nextEntry = entry;
+      } else {
+        B2ERROR("Couldn't find event given by skipToEvent in the event index, starting with the first event"
+                << LogVar("experiment", m_skipToEvent[0]) << LogVar("run", m_skipToEvent[1]) << LogVar("event", m_skipToEvent[2]));
+      }
+    }
   }
 
   // Tell the InputController which event will be processed first
@@ -355,6 +409,17 @@ void RootInputModule::event()
         B2INFO("RootInput: will read entry " << nextEntry << " next.");
       }
       m_nextEntry = nextEntry;
+    } else if (InputController::getNextExperiment() >= 0 && InputController::getNextRun() >= 0
+               && InputController::getNextEvent() >= 0 && m_eventIndex) {
+      const long entry = findEntryInEventIndex(InputController::getNextExperiment(), InputController::getNextRun(),
+                                               InputController::getNextEvent());
+      if (entry >= 0) {
+        B2INFO("RootInput: will read entry " << entry << " (found in event index) next.");
+        m_nextEntry = entry;
+      } else {
+        B2ERROR("Couldn't find entry (" << InputController::getNextEvent() << ", " << InputController::getNextRun() << ", " <<
+                InputController::getNextExperiment() << ") in event index! Loading entry " << m_nextEntry << " instead.");
+      }
     } else if (InputController::getNextExperiment() >= 0 && InputController::getNextRun() >= 0
                && InputController::getNextEvent() >= 0) {
       const long entry = RootIOUtilities::getEntryNumberWithEvtRunExp(m_tree->GetTree(), InputController::getNextEvent(),
@@ -398,6 +463,11 @@ void RootInputModule::terminate()
     //add stats for last file
     m_readStats.addFromFile(m_tree->GetFile());
   }
+  if (m_prefetcher) {
+    if (m_collectStatistics)
+      B2INFO("Statistics for event tree read-ahead: " << m_prefetcher->getStatistics().getString());
+    m_prefetcher.reset();
+  }
   delete m_tree;
   delete m_persistent;
   ReadStats parentReadStats;
@@ -451,9 +521,28 @@ void RootInputModule::readTree()
   }
   B2DEBUG(39, "Reading file entry " << m_nextEntry);
 
-  //Make sure transient members of objects are reinitialised
-  for (auto entry : m_storeEntries) {
-    entry->resetForGetEntry();
+  if (!m_firstEntryRead) {
+    // The first entry is read by EventProcessor::processInitialize(), which for multiprocessing happens before
+    // the input process is forked. Threads don't survive fork(), so read-ahead and parallel decompression
+    // are only started when reading the second entry.
+    m_firstEntryRead = true;
+  } else if (!m_readAheadStarted) {
+    m_readAheadStarted = true;
+    if (m_decompressionThreads > 0) {
+      ROOT::EnableImplicitMT(m_decompressionThreads);
+      m_tree->SetImplicitMT(true);
+    }
+    if (m_readAheadEntries > 0) {
+      const long cacheSize = m_cacheSize >= 0 ? m_cacheSize * 1024L * 1024L : -1;
+      m_prefetcher.reset(new RootEntryPrefetcher(m_tree, m_storeEntries, m_readAheadEntries, cacheSize));
+    }
+  }
+
+  //Make sure transient members of objects are reinitialised (the prefetcher does that for its own objects)
+  if (!m_prefetcher) {
+    for (auto entry : m_storeEntries) {
+      entry->resetForGetEntry();
+    }
   }
   for (const auto& storeEntries : m_parentStoreEntries) {
     for (auto entry : storeEntries) {
@@ -461,10 +550,20 @@ void RootInputModule::readTree()
     }
   }
 
-  int bytesRead = m_tree->GetTree()->GetEntry(localEntryNumber);
+  int bytesRead = 0;
+  if (m_prefetcher) {
+    const RootEntryPrefetcher::Statistics before = m_prefetcher->getStatistics();
+    bytesRead = m_prefetcher->getEntry(m_nextEntry);
+    const RootEntryPrefetcher::Statistics& after = m_prefetcher->getStatistics();
+    ProcessStatistics::countReadAhead(after.hits - before.hits, after.restarts - before.restarts,
+                                      (after.waitTime - before.waitTime) * Unit::s);
+  } else {
+    bytesRead = m_tree->GetTree()->GetEntry(localEntryNumber);
+  }
   if (bytesRead <= 0) {
     B2FATAL("Could not read 'tree' entry " << m_nextEntry << " in file " << m_tree->GetCurrentFile()->GetName());
   }
+  ProcessStatistics::countInput(bytesRead);
 
   //In case someone is tempted to change this:
   // TTree::GetCurrentFile() returns a TFile pointer to a fixed location,
@@ -798,3 +897,76 @@ void RootInputModule::realDataWorkaround(FileMetaData& metaData)
     metaData.declareRealData();
   }
 }
+
+void RootInputModule::selectFromEventIndex()
+{
+  if (!m_entrySequences.empty())
+    B2FATAL("Cannot use entrySequences and eventIndexSkims at the same time");
+
+  uint64_t skimMask = 0;
+  for (const std::string& skim : m_eventIndexSkims) {
+    const int bit = m_eventIndex->getSkimBit(skim);
+    if (bit < 0)
+      B2FATAL("Skim flag not found in event index" << LogVar("skim", skim) << LogVar("eventIndex", m_eventIndexFileName));
+    skimMask |= uint64_t(1) << bit;
+  }
+
+  const std::vector<std::vector<uint64_t>> selected = m_eventIndex->selectEntries(skimMask);
+  std::vector<std::string> fileNames;
+  std::vector<std::string> sequences;
+  uint64_t nSelected = 0;
+  for (const std::string& fileName : m_inputFileNames) {
+    const int file = m_eventIndex->findFile(fileName);
+    if (file < 0) {
+      B2WARNING("Input file not found in event index, reading all its events" << LogVar("filename", fileName));
+      fileNames.push_back(fileName);
+      sequences.emplace_back(":");
+      continue;
+    }
+    const std::vector<uint64_t>& entries = selected[file];
+    if (entries.empty())
+      continue;
+    // the selected entries as number sequence, consecutive entries as intervals
+    std::string sequence;
+    for (size_t i = 0; i < entries.size();) {
+      size_t last = i;
+      while (last + 1 < entries.size() and entries[last + 1] == entries[last] + 1)
+        ++last;
+      if (!sequence.empty())
+        sequence += ",";
+      sequence += std::to_string(entries[i]);
+      if (last > i)
+        sequence += ":" + std::to_string(entries[last]);
+      i = last + 1;
+    }
+    fileNames.push_back(fileName);
+    sequences.push_back(sequence);
+    nSelected += entries.size();
+  }
+  B2INFO("RootInput: selected events using the event index" << LogVar("events", nSelected)
+         << LogVar("files", fileNames.size()) << LogVar("skipped files", m_inputFileNames.size() - fileNames.size()));
+  if (fileNames.empty())
+    B2FATAL("No events selected by eventIndexSkims");
+  m_inputFileNames = fileNames;
+  m_entrySequences = sequences;
+}
+
+long RootInputModule::findEntryInEventIndex(long experiment, long run, long event) const
+{
+  if (!m_tree)
+    return -1;
+  for (const EventIndex::Entry& found : m_eventIndex->find(experiment, run, event)) {
+    const int tree = m_eventIndexTrees[found.file];
+    if (tree < 0)
+      continue;
+    long entry = m_tree->GetTreeOffset()[tree] + found.entry;
+    if (const TEventList* list = m_tree->GetEventList()) {
+      // with entry sequences the entries are counted in the event list
+      entry = list->GetIndex(entry);
+      if (entry < 0)
+        continue;
+    }
+    return entry;
+  }
+  return -1;
+}
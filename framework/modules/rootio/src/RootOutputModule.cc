@@ -22,8 +22,11 @@
 #include <boost/format.hpp>
 #include <boost/algorithm/string.hpp>
 
+#include <TBufferFile.h>
 #include <TClonesArray.h>
+#include <TROOT.h>
 
+#include <chrono>
 #include <regex>
 #include <filesystem>
 
@@ -123,6 +126,22 @@ Warning:
 
 .. versionadded:: release-03-00-00
 )DOC", m_outputSplitSize);
+  addParam("writeQueueDepth", m_writeQueueDepth, R"DOC(
+Number of events that can be queued for a dedicated output thread. If larger
+than zero the event data is copied to a buffer and filled into the tree,
+compressed and written by the output thread, so the event loop doesn't stall
+while baskets are compressed. The file content and layout are the same as
+when writing in the event thread. 0 to write in the event thread.)DOC", m_writeQueueDepth);
+  addParam("eventIndexFileName", m_eventIndexFileName, R"DOC(
+Name of an event index file to write next to the output. It contains the
+experiment, run and event number and the entry of each event in all output
+files and can be used by RootInput (``eventIndex`` parameter) to find events
+or to read only the events with given skim flags. Index files of many jobs can
+be merged with ``b2file-index``. Empty to write no index.)DOC", m_eventIndexFileName);
+  addParam("eventIndexSkimBranches", m_eventIndexSkimBranches, R"DOC(
+Names of event objects or arrays which define skim flags in the event index.
+The flag of an event is set if the object exists, or if the array is not empty.
+At most 64 flags are supported.)DOC", m_eventIndexSkimBranches);
 
   m_outputFileMetaData = new FileMetaData;
 }
@@ -151,6 +170,26 @@ void RootOutputModule::initialize()
     *m_outputSplitSize *= 1024 * 1024;
   }
 
+  if (!m_eventIndexFileName.empty()) {
+    m_eventIndex.reset(new EventIndex);
+    DataStore::StoreEntryMap& map = DataStore::Instance().getStoreEntryMap(DataStore::c_Event);
+    for (const std::string& name : m_eventIndexSkimBranches) {
+      auto it = map.find(name);
+      if (it == map.end()) {
+        B2ERROR("Object or array for skim flag not found in DataStore" << LogVar("name", name));
+        continue;
+      }
+      try {
+        m_eventIndex->addSkim(name);
+        m_eventIndexSkimEntries.push_back(&it->second);
+      } catch (const std::length_error& e) {
+        B2ERROR(e.what());
+      }
+    }
+  } else if (!m_eventIndexSkimBranches.empty()) {
+    B2WARNING("eventIndexSkimBranches has no effect without eventIndexFileName");
+  }
+
   getFileNames();
 
   // Now check if the file has a protocol like file:// or http:// in front
@@ -171,6 +210,7 @@ void RootOutputModule::openFile()
 {
   // Since we open a new file, we also have to reset the number of full events
   m_nFullEvents = 0;
+  m_fileEntries = 0;
   // Continue with opening the file
   TDirectory* dir = gDirectory;
   std::filesystem::path out{m_outputFileName};
@@ -202,6 +242,9 @@ void RootOutputModule::openFile()
   if (!m_file || m_file->IsZombie()) {
     B2FATAL("Couldn't open file " << out << " for writing!");
   }
+  if (m_eventIndex) {
+    m_eventIndexFile = m_eventIndex->addFile(m_file->GetName());
+  }
   m_file->SetCompressionAlgorithm(m_compressionAlgorithm);
   m_file->SetCompressionLevel(m_compressionLevel);
 
@@ -304,6 +347,15 @@ void RootOutputModule::event()
   if (!m_file)
     openFile();
 
+  if (!m_threadsStarted) {
+    // only done in the first event: threads must not be started before the processes are forked
+    m_threadsStarted = true;
+    if (m_writeQueueDepth > 0) {
+      ROOT::EnableThreadSafety();
+      m_writer.reset(new TaskPool(1));
+    }
+  }
+
   if (!m_keepParents) {
     if (m_fileMetaData) {
       m_eventMetaData->setParentLfn(m_fileMetaData->getLfn());
@@ -311,7 +363,10 @@ void RootOutputModule::event()
   }
 
   //fill Event data
-  fillTree(DataStore::c_Event);
+  if (m_writer)
+    queueEvent();
+  else
+    fillTree(DataStore::c_Event);
 
   if (m_fileMetaData) {
     if (m_keepParents) {
@@ -356,8 +411,21 @@ void RootOutputModule::event()
   if (m_eventMetaData->getErrorFlag() == 0) // no error flag -> this is a full event
     m_nFullEvents++;
 
-  // check if we need to split the file
-  if (m_outputSplitSize and (uint64_t)m_file->GetEND() > *m_outputSplitSize) {
+  if (m_eventIndex) {
+    uint64_t skimBits = 0;
+    for (size_t i = 0; i < m_eventIndexSkimEntries.size(); i++) {
+      const DataStore::StoreEntry* entry = m_eventIndexSkimEntries[i];
+      if (entry->ptr and (!entry->isArray or static_cast<TClonesArray*>(entry->ptr)->GetEntriesFast() > 0))
+        skimBits |= uint64_t(1) << i;
+    }
+    m_eventIndex->addEvent(experiment, run, event, m_eventIndexFile, m_fileEntries, skimBits);
+  }
+  m_fileEntries++;
+
+  // check if we need to split the file. The output thread might still be writing, so we check the size
+  // after the last event it finished: the file can grow by up to m_writeQueueDepth events beyond the limit
+  const uint64_t fileSize = m_writer ? m_writtenFileSize : m_file->GetEND();
+  if (m_outputSplitSize and fileSize > *m_outputSplitSize) {
     // close file and open new one
     B2INFO(getName() << ": Output size limit reached, closing file ...");
     closeFile();
@@ -433,12 +501,25 @@ void RootOutputModule::fillFileMetaData()
 void RootOutputModule::terminate()
 {
   closeFile();
+  m_writer.reset();
+  m_freeBuffers.clear();
+  if (m_eventIndex) {
+    try {
+      m_eventIndex->write(m_eventIndexFileName);
+    } catch (const std::exception& e) {
+      B2ERROR("Could not write event index" << LogVar("filename", m_eventIndexFileName) << LogVar("error", e.what()));
+    }
+    m_eventIndex.reset();
+  }
 }
 
 void RootOutputModule::closeFile()
 {
   if(!m_file) return;
 
+  while (!m_pendingWrites.empty())
+    finishWrite();
+
   fillFileMetaData();
 
   //fill Persistent data
@@ -471,6 +552,11 @@ void RootOutputModule::closeFile()
   for (auto & entry : m_entries) {
     entry.clear();
   }
+  for (TObject* object : m_writeObjects) {
+    delete object;
+  }
+  m_writeObjects.clear();
+  m_writtenFileSize = 0;
   m_parentLfns.clear();
   m_experimentLow = 1;
   m_experimentHigh = 0;
@@ -506,6 +592,11 @@ void RootOutputModule::fillTree(DataStore::EDurability durability)
     entry->object->ResetBit(kInvalidObject);
   }
 
+  checkWriteError();
+}
+
+void RootOutputModule::checkWriteError()
+{
   const bool writeError = m_file->TestBit(TFile::kWriteError);
   if (writeError) {
     //m_file deleted first so we have a chance of closing it (though that will probably fail)
@@ -514,3 +605,78 @@ void RootOutputModule::fillTree(DataStore::EDurability durability)
     B2FATAL("A write error occurred while saving '" << filename << "', please check if enough disk space is available.");
   }
 }
+
+void RootOutputModule::queueEvent()
+{
+  // collect the events already written and limit the number of queued events
+  while (!m_pendingWrites.empty() and (m_pendingWrites.size() >= m_writeQueueDepth or
+                                       m_pendingWrites.front().wait_for(std::chrono::seconds(0)) == std::future_status::ready)) {
+    finishWrite();
+  }
+
+  if (m_writeObjects.empty()) {
+    // the objects the output thread fills into the tree, we copy the contents of the DataStore objects into them
+    for (auto* entry : m_entries[DataStore::c_Event]) {
+      TObject* object = entry->object->Clone();
+      if (entry->isArray) {
+        static_cast<TClonesArray*>(object)->BypassStreamer(static_cast<TClonesArray*>(entry->object)->CanBypassStreamer());
+      }
+      m_writeObjects.push_back(object);
+    }
+    // the objects stay in place until the file is closed, so the branch addresses only need to be set once
+    TTree& tree = *m_tree[DataStore::c_Event];
+    for (size_t i = 0; i < m_writeObjects.size(); i++) {
+      tree.SetBranchAddress(m_entries[DataStore::c_Event][i]->name.c_str(), &m_writeObjects[i]);
+    }
+  }
+
+  std::unique_ptr<TBufferFile> buffer;
+  if (m_freeBuffers.empty()) {
+    buffer.reset(new TBufferFile(TBuffer::kWrite));
+  } else {
+    buffer = std::move(m_freeBuffers.back());
+    m_freeBuffers.pop_back();
+    buffer->SetBufferOffset(0);
+    buffer->ResetMap();
+  }
+  for (auto* entry : m_entries[DataStore::c_Event]) {
+    // same as in fillTree()
+    if (!entry->ptr) {
+      entry->object->SetBit(kInvalidObject);
+    }
+    entry->object->Streamer(*buffer);
+    entry->object->ResetBit(kInvalidObject);
+  }
+  auto task = [this, buffer = std::move(buffer)]() mutable { return writeEvent(std::move(buffer)); };
+  m_pendingWrites.push_back(m_writer->submit(std::move(task)));
+}
+
+RootOutputModule::WriteResult RootOutputModule::writeEvent(std::unique_ptr<TBufferFile> buffer)
+{
+  TBufferFile reader(TBuffer::kRead, buffer->Length(), buffer->Buffer(), kFALSE);
+  for (TObject* object : m_writeObjects) {
+    object->Streamer(reader);
+  }
+  m_tree[DataStore::c_Event]->Fill();
+
+  WriteResult result;
+  result.buffer = std::move(buffer);
+  result.fileSize = m_file->GetEND();
+  result.writeError = m_file->TestBit(TFile::kWriteError);
+  return result;
+}
+
+void RootOutputModule::finishWrite()
+{
+  WriteResult result = m_pendingWrites.front().get();
+  m_pendingWrites.pop_front();
+  m_freeBuffers.push_back(std::move(result.buffer));
+  m_writtenFileSize = result.fileSize;
+  if (result.writeError) {
+    // the output thread must be done with the file before it is deleted
+    for (auto& pending : m_pendingWrites) {
+      pending.wait();
+    }
+    checkWriteError();
+  }
+}
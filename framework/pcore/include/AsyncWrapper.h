@@ -13,7 +13,7 @@
 namespace Belle2 {
   class RxModule;
   class TxModule;
-  class RingBuffer;
+  class LockFreeRingBuffer;
 
   /** Wraps a given Module to execute it asynchronously.
    *
@@ -61,7 +61,7 @@ namespace Belle2 {
     ModulePtr m_wrappedModule;
 
     /** shared memory buffer */
-    RingBuffer* m_ringBuffer;
+    LockFreeRingBuffer* m_ringBuffer;
 
     /** receiving module. */
     RxModule* m_rx;
@@ -76,6 +76,6 @@ namespace Belle2 {
     static bool s_isAsync;
 
     /** if s_isAsync is true, this contains the corresponding RingBuffer, see numAvailableEvents(). */
-    static RingBuffer* s_currentRingBuffer;
+    static LockFreeRingBuffer* s_currentRingBuffer;
   };
 }
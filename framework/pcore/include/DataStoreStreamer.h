@@ -9,11 +9,15 @@
 #pragma once
 
 #include <framework/pcore/EvtMessage.h>
+#include <framework/utilities/TaskPool.h>
 
 #include <Rtypes.h> //for BIT()
 
-#include <pthread.h>
-
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
 #include <vector>
 #include <string>
 
@@ -29,9 +33,7 @@ namespace Belle2 {
    */
   class DataStoreStreamer {
   public:
-    /** global maximum number of threads (cannot set higher number). */
-    static const unsigned int c_maxThreads = 16;
-    /** Ask Itoh-san. */
+    /** Default maximal number of events queued for decoding or waiting to be restored. */
     static const unsigned int c_maxQueueDepth = 64;
 
     /** Constructor
@@ -57,6 +59,14 @@ namespace Belle2 {
      */
     EvtMessage* streamDataStore(bool addPersistentDurability, bool streamTransientObjects = false);
 
+    /** Store DataStore objects in EvtMessage without copying the serialized data into a new buffer.
+     *
+     *  Same as streamDataStore(), but the returned message is owned by the streamer and only
+     *  valid until the next call to streamDataStore*() or restoreDataStore(). Use this if the
+     *  message is copied to its destination (e.g. a ring buffer) right away.
+     */
+    EvtMessage* streamDataStoreInPlace(bool addPersistentDurability, bool streamTransientObjects = false);
+
 
     // EvtMessage->DataStore
     /** Restore DataStore objects from EvtMessage
@@ -67,30 +77,34 @@ namespace Belle2 {
     /** Set names of objects to be streamed/destreamed. */
     void setStreamingObjects(const std::vector<std::string>& list);
 
-    // Pipelined destreaming of EvtMessage using thread
+    // Pipelined destreaming of EvtMessage using threads
 
-    /** Queue EvtMessage for destreaming
-     *  @param msg        Event buffer to be restored.
+    /** Queue EvtMessage for destreaming in the decoder threads.
+     *
+     *  Blocks while c_maxQueueDepth events are already queued or decoded but not yet restored.
+     *  Can be called from a different thread than restoreDataStoreAsync().
+     *  @param msg        Event buffer to be restored, allocated with new[]. Ownership is taken.
+     *                    nullptr marks the end of the input.
+     *  @return 0 for the end of input, 1 otherwise.
      */
     int queueEvtMessage(char* msg);
 
-    /** Decode EvtMessage and store objects in temporary buffer
-     *  @param id         Thread id
-     */
-    void* decodeEvtMessage(int id);
-
-    /** Restore objects in DataStore from temporary buffer
+    /** Restore objects in DataStore from the next decoded event, in the order the events were queued.
+     *
+     *  Blocks until the event is decoded.
+     *  @return 0 at the end of input, 1 otherwise.
      */
     int restoreDataStoreAsync();
 
-    /** maximum number of threads. */
+    /** Set the number of decoder threads. Only has an effect before the first call to queueEvtMessage(). */
     void setMaxThreads(int);
-    /** maximum number of threads. */
+    /** Number of decoder threads. */
     int  getMaxThreads();
-    /** Ask Itoh-san about this. */
-    void setDecoderStatus(int);
-    /** Ask Itoh-san about this. */
-    int  getDecoderStatus();
+
+    /** Number of events queued for decoding or decoded and waiting for restoreDataStoreAsync(). */
+    int getDecoderQueueDepth();
+    /** Counters of the decoder threads, to tune the number of threads. Zero if decoding didn't start yet. */
+    TaskPool::Statistics getDecoderStatistics();
 
     /** Is the given object of a type that can be merged? */
     static bool isMergeable(const TObject* object);
@@ -108,6 +122,11 @@ namespace Belle2 {
     static void removeSideEffects();
 
   private:
+    /** Add the DataStore objects to m_msghandler and encode them, see streamDataStore().
+     *
+     *  @param inPlace if true, use MsgHandler::encode_msg_inplace()
+     */
+    EvtMessage* stream(bool addPersistentDurability, bool streamTransientObjects, bool inPlace);
 
     /** restore StreamerInfo from data in a file */
     int restoreStreamerInfos(const TList* list);
@@ -146,31 +165,28 @@ namespace Belle2 {
      */
     std::vector<std::string> m_streamobjnames;
 
-    /** Max. number of threads for asynchronous processing
-     *
-     * 4 for default
-     */
+    /** Max. number of threads for asynchronous processing. */
     int m_maxthread;
 
-    /** thread pointer
-     */
-    pthread_t m_pt[c_maxThreads];
-    /** thread index. */
-    int m_id[c_maxThreads];
-    /** current thread? */
-    int m_threadin;
-    //int m_threadout;
-    /** thread decoder status. */
-    int m_decoderStatus[c_maxThreads] {0};
-    //MsgHandler* m_pmsghandler[c_maxThreads];
-    //    char* m_evtbuf[c_maxThreads];
-    //std::queue<char*> m_evtbuf[c_maxThreads];
+    /** Objects decoded from one EvtMessage, see queueEvtMessage(). */
+    struct DecodedEvent {
+      int nobjs = -1; /**< number of objects, -1 for the end of input. */
+      int narrays = 0; /**< number of arrays. */
+      std::vector<TObject*> objlist; /**< decoded objects. */
+      std::vector<std::string> namelist; /**< names of the decoded objects. */
+    };
 
+    /** Decode the given event buffer (and delete it). Executed in the decoder threads. */
+    static DecodedEvent decodeEvtMessage(char* evtbuf);
+
+    /** Decoder threads, started by the first queueEvtMessage() call. */
+    std::unique_ptr<TaskPool> m_decoder;
+    /** Decoded events (or events being decoded), in input order. */
+    std::deque<std::future<DecodedEvent>> m_decodedEvents;
+    /** Protects m_decodedEvents. */
+    std::mutex m_decodedMutex;
+    /** Notified when an event is added to or taken from m_decodedEvents. */
+    std::condition_variable m_decodedChanged;
   };
 
-  // Function to hook DataStoreStreamer::decodeEvtMessage to pthread
-
-  //  void* RunDecodeEvtMessage ( void* );
-
-
 } // namespace Belle2
@@ -0,0 +1,81 @@
+/**************************************************************************
+ * basf2 (Belle II Analysis Software Framework)                           *
+ * Author: The Belle II Collaboration                                     *
+ *                                                                        *
+ * See git log for contributors and copyright holders.                    *
+ * This file is licensed under LGPL-3.0, see LICENSE.md.                  *
+ **************************************************************************/
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+namespace Belle2 {
+
+  class EvtMessage;
+
+  /**
+   * Bounded queue of serialized events to pass events between threads of the same process.
+   *
+   * This is the in-memory counterpart of the RingBuffer used by the ThreadedEventProcessor.
+   * All producers and consumers have to be registered before any of the threads using the
+   * queue are started. Once the last producer or the last consumer has left, the queue is
+   * closed: push() will then discard new messages and pop() returns the remaining messages
+   * followed by nullptr.
+   */
+  class EventQueue {
+  public:
+    /** Create a queue holding at most 'capacity' messages. */
+    explicit EventQueue(unsigned int capacity);
+    /** Delete all messages still in the queue. */
+    ~EventQueue();
+    /** no copy constructor */
+    EventQueue(const EventQueue&) = delete;
+    /** no assignment operator */
+    EventQueue& operator=(const EventQueue&) = delete;
+
+    /** Register a thread which will push() messages. */
+    void addProducer();
+    /** Unregister a producer, closes the queue if it was the last one. */
+    void removeProducer();
+    /** Register a thread which will pop() messages. */
+    void addConsumer();
+    /** Unregister a consumer, closes the queue and drops all messages if it was the last one. */
+    void removeConsumer();
+
+    /** Append a message, waiting while the queue is full. Takes ownership of msg.
+     *
+     * @return false if the queue is closed and the message was discarded.
+     */
+    bool push(EvtMessage* msg);
+
+    /** Take the next message, waiting while the queue is empty.
+     *
+     * @return the message (to be deleted by the caller) or nullptr if the queue is closed and empty.
+     */
+    EvtMessage* pop();
+
+    /** Close the queue and wake up all waiting threads. */
+    void close();
+
+    /** True if the queue is empty and all consumers are waiting for new messages,
+     * i.e. all events passed through this queue have been processed. */
+    bool isIdle() const;
+
+    /** Wait until isIdle() is true or the queue is closed. */
+    void waitUntilIdle() const;
+
+  private:
+    mutable std::mutex m_mutex; /**< protects all members below. */
+    std::condition_variable m_notEmpty; /**< signalled when a message was added or the queue closed. */
+    std::condition_variable m_notFull; /**< signalled when a message was removed or the queue closed. */
+    mutable std::condition_variable m_idle; /**< signalled when the queue might have become idle or was closed. */
+    std::deque<EvtMessage*> m_messages; /**< messages in the queue. */
+    unsigned int m_capacity; /**< maximum number of messages in the queue. */
+    int m_producers = 0; /**< number of registered producers. */
+    int m_consumers = 0; /**< number of registered consumers. */
+    int m_waitingConsumers = 0; /**< number of consumers currently waiting in pop(). */
+    bool m_closed = false; /**< true once the queue was closed. */
+  };
+}
@@ -0,0 +1,72 @@
+/**************************************************************************
+ * basf2 (Belle II Analysis Software Framework)                           *
+ * Author: The Belle II Collaboration                                     *
+ *                                                                        *
+ * See git log for contributors and copyright holders.                    *
+ * This file is licensed under LGPL-3.0, see LICENSE.md.                  *
+ **************************************************************************/
+#pragma once
+
+namespace Belle2 {
+
+  /** Interface of the shared memory ring buffers used by TxModule and RxModule to pass events between processes.
+   *
+   * Implemented by LockFreeRingBuffer for the buffers between the processes of one basf2 job and by
+   * SysVRingBuffer for named buffers which external programs attach to.
+   */
+  class EventRingBuffer {
+  public:
+    /** Destructor */
+    virtual ~EventRingBuffer() = default;
+
+    /** Append a buffer to the ring buffer.
+     *
+     * @param buf data to append
+     * @param size size of the data in integers
+     * @param checkTx if true, exit if a safe abort was requested (see kill())
+     * @return size if successful, -1 if there is not enough space
+     */
+    virtual int insq(const int* buf, int size, bool checkTx = false) = 0;
+    /** Pick up a buffer from the ring buffer.
+     *
+     * @param buf destination of the data, which is discarded if nullptr.
+     * @return size of the buffer in integers, 0 if the ring buffer is empty.
+     */
+    virtual int remq(int* buf) = 0;
+    /** Pick up a buffer from the ring buffer, without copying it if the implementation allows.
+     *
+     * The returned data stays valid until releaseInPlace() or the next readInPlace()/remq() call of this instance.
+     *
+     * @param nwords set to the size of the buffer in integers, 0 if the ring buffer is empty.
+     * @return pointer to the data, nullptr if the ring buffer is empty.
+     */
+    virtual const int* readInPlace(int& nwords) = 0;
+    /** Give back the buffer obtained with readInPlace(), if any. */
+    virtual void releaseInPlace() = 0;
+    /** Returns number of entries/buffers in the ring buffer */
+    virtual int numq() const = 0;
+
+    /** Wait until the ring buffer contains data, it is killed, or at most the given time has passed. */
+    virtual void waitForEntries(int timeoutMicroSeconds) const = 0;
+    /** Wait until a buffer was removed from the ring buffer or at most the given time has passed. */
+    virtual void waitForSpace(int timeoutMicroSeconds) const = 0;
+
+    /** Increase the number of attached Tx counter. */
+    virtual void txAttached() = 0;
+    /** Decrease the number of attached Tx counter. */
+    virtual void txDetached() = 0;
+    /** Cause termination of reading processes (if they use isDead()). Async-signal-safe. */
+    virtual void kill() = 0;
+
+    /** If True, the ring buffer is empty and has no attached Tx modules (i.e. no new data is going to be added). Processes should then stop. */
+    virtual bool isDead() const = 0;
+    /** True if and only if buffer is empty and no reading process is busy with an event.
+     *
+     * Called in Tx to see if all events of the current run
+     * have been processed */
+    virtual bool allRxWaiting() const = 0;
+
+    /** Return ID of the ring buffer, used in the names of the Tx and Rx modules. */
+    virtual int shmid() const = 0;
+  };
+}
@@ -0,0 +1,192 @@
+/**************************************************************************
+ * basf2 (Belle II Analysis Software Framework)                           *
+ * Author: The Belle II Collaboration                                     *
+ *                                                                        *
+ * See git log for contributors and copyright holders.                    *
+ * This file is licensed under LGPL-3.0, see LICENSE.md.                  *
+ **************************************************************************/
+#pragma once
+
+#include <framework/pcore/EventRingBuffer.h>
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include <pthread.h>
+
+namespace Belle2 {
+
+  /** Internal metadata structure for LockFreeRingBuffer. Placed on top of the shared memory.
+   *
+   * All positions are byte offsets which only ever increase, the position in the data area is
+   * obtained modulo 'size'. Records are [nwords, consumed flag, claiming process, payload] padded to 8 bytes.
+   */
+  struct LockFreeRingBufInfo {
+    std::atomic<uint32_t> magic; /**< set to c_Magic once the buffer is initialized. */
+    uint32_t unused; /**< padding. */
+    uint64_t size; /**< size of the data area in bytes (multiple of 8). */
+    alignas(64) std::atomic<uint64_t> head; /**< end of the last published record (written by producers). */
+    alignas(64) std::atomic<uint64_t> readClaim; /**< start of the next record to be claimed by a consumer. */
+    alignas(64) std::atomic<uint64_t> tail; /**< all records before this position are consumed, the space can be reused. */
+    alignas(64) std::atomic<uint32_t> headSeq; /**< futex word, incremented for every published record. */
+    std::atomic<uint32_t> readWaiters; /**< number of consumers waiting on headSeq. */
+    alignas(64) std::atomic<uint32_t> tailSeq; /**< futex word, incremented for every consumed record. */
+    std::atomic<uint32_t> writeWaiters; /**< number of producers waiting on tailSeq. */
+    alignas(64) pthread_mutex_t producerLock; /**< robust process-shared mutex serializing producers, recovered if its owner dies. */
+    std::atomic<int32_t> nbuf; /**< Number of entries in ring buffer. */
+    std::atomic<int32_t> nattached; /**< Number of LockFreeRingBuffer instances currently attached to this buffer. */
+    std::atomic<int32_t> nbusy; /**< Number of attached _reading_ processes currently processing events. */
+    std::atomic<int32_t> numAttachedTx; /**< number of attached sending processes. 0: Processes reading from this buffer should terminate once it's empty. -1: attach pending (initial state) */
+    std::atomic<int32_t> ninsq; /**< Count insq() calls for this buffer. */
+    std::atomic<int32_t> nremq; /**< Count remq() calls for this buffer. */
+  };
+
+  /** Lock-free EventRingBuffer in shared memory, used between the processes of one basf2 job.
+   *
+   * Consumers never lock: a record is claimed with a single compare-and-swap on the read position
+   * and marked as consumed after it has been copied out, so any number of processes can read
+   * concurrently. Producers reclaim the space of consumed records; concurrent producers (e.g.
+   * several workers writing into the output buffer) are serialized with a robust process-shared
+   * mutex, which is uncontended for a single producer and released by the kernel if a producer
+   * dies while holding it. Consumers record their PID in each record they claim, so a producer
+   * running out of space drops the records of consumers which died before releasing them.
+   * Waiting for data or free space uses futexes in the shared memory instead of polling.
+   *
+   * Private buffers use anonymous shared memory inherited by forked processes, named buffers are
+   * created in POSIX shared memory so unrelated processes can attach to them.
+   */
+  class LockFreeRingBuffer : public EventRingBuffer {
+  public:
+    /** Standard size of buffer, in integers (~60MB). Needs to be large enough to contain any event. */
+    const static int c_DefaultSize = 15000000;
+
+    /** Constructor to create a new shared memory in private space, shared with forked processes.
+     *
+     * @param nwords Ring buffer size in integers
+     */
+    explicit LockFreeRingBuffer(int nwords = c_DefaultSize);
+    /** Constructor to create/attach named shared memory in global space */
+    explicit LockFreeRingBuffer(const std::string& name, unsigned int nwords = 0);
+    /** Destructor */
+    ~LockFreeRingBuffer() override;
+    /** no copy constructor */
+    LockFreeRingBuffer(const LockFreeRingBuffer&) = delete;
+    /** no assignment operator */
+    LockFreeRingBuffer& operator=(const LockFreeRingBuffer&) = delete;
+
+    /** Detach from the shared memory and remove it if we created it. */
+    void cleanup();
+
+    /** Append a buffer to the ring buffer.
+     *
+     * @param buf data to append
+     * @param size size of the data in integers
+     * @param checkTx if true, exit if a safe abort was requested (see kill())
+     * @return size if successful, -1 if there is not enough space
+     */
+    int insq(const int* buf, int size, bool checkTx = false) override;
+    /** Pick up a buffer from the ring buffer.
+     *
+     * @param buf destination of the data, which is discarded if nullptr.
+     * @return size of the buffer in integers, 0 if the ring buffer is empty.
+     */
+    int remq(int* buf) override;
+    /** Pick up a buffer from the ring buffer without copying it.
+     *
+     * The returned data stays valid (and its space in the ring buffer is not reused)
+     * until releaseInPlace() or the next readInPlace()/remq() call of this instance.
+     *
+     * @param nwords set to the size of the buffer in integers, 0 if the ring buffer is empty.
+     * @return pointer to the data, nullptr if the ring buffer is empty.
+     */
+    const int* readInPlace(int& nwords) override;
+    /** Give back the buffer obtained with readInPlace(), if any. */
+    void releaseInPlace() override;
+    /** Returns number of entries/buffers in the ring buffer */
+    int numq() const override;
+
+    /** Wait until the ring buffer contains data, it is killed, or the given time has passed. */
+    void waitForEntries(int timeoutMicroSeconds) const override;
+    /** Wait until a buffer was removed from the ring buffer or the given time has passed. */
+    void waitForSpace(int timeoutMicroSeconds) const override;
+
+    /** Increase the number of attached Tx counter. */
+    void txAttached() override;
+    /** Decrease the number of attached Tx counter. */
+    void txDetached() override;
+    /** Cause termination of reading processes (if they use isDead()) and discard all entries. Async-signal-safe. */
+    void kill() override;
+
+    /** If True, the ring buffer is empty and has no attached Tx modules (i.e. no new data is going to be added). Processes should then stop. */
+    bool isDead() const override;
+    /** True if and only if buffer is empty and nbusy == 0.
+     *
+     * Called in Tx to see if all events of the current run
+     * have been processed */
+    bool allRxWaiting() const override;
+
+    /** Discard all entries of the ring buffer. */
+    int clear();
+
+    /** Return ID of the ring buffer, unique within the process which created it. */
+    int shmid() const override;
+
+    /** Return number of insq() calls for current buffer. */
+    int ninsq() const;
+    /** Return number of remq() calls for current buffer. */
+    int nremq() const;
+
+    /** Dump contents of LockFreeRingBufInfo metadata */
+    void dumpInfo() const;
+
+  private:
+    /** Map the shared memory (creating it if needed) and initialize the control structure. */
+    void openSHM(int nwords);
+
+    /** Claim the next record. No other reader will get it, its space is reused only after releaseRecord().
+     *
+     * @param nwords set to the size of the record in integers, 0 if there is none.
+     * @return start of the record (including its header), nullptr if there is none.
+     */
+    char* claimRecord(int& nwords);
+    /** Mark a record returned by claimRecord() as consumed. */
+    void releaseRecord(char* record);
+    /** Claim and release the next record without reading it. Async-signal-safe.
+     *
+     * @return size of the record in integers, 0 if there is none.
+     */
+    int discard();
+
+    /** Move the tail past all consumed records. Called by producers with the producer lock held.
+     *
+     * @param dropDeadClaims if true, also move past records claimed by processes which died before releasing them.
+     *                       Needs a system call per claimed record, so only done if there is not enough space.
+     */
+    uint64_t reclaim(bool dropDeadClaims);
+
+    /** Lock the producer mutex, recovering it if its previous owner died. */
+    void lockProducers();
+    /** Unlock the producer mutex. */
+    void unlockProducers();
+
+    bool m_new{true}; /**< True if we created the ring buffer ourselves (and need to clean it). */
+    std::string m_pathname{""}; /**< POSIX shared memory name for named ring buffers, empty for private ones. */
+    int m_id{ -1}; /**< ID returned by shmid(). */
+
+    /** Is this process currently processing events from this ring buffer?
+     *
+     * set during remq() with value depending on whether data was returned.
+     * Always false for a process that is only using insq().
+     */
+    bool m_procIsBusy{false};
+
+    char* m_inPlaceRecord{nullptr}; /**< Record returned by readInPlace() which was not released yet. */
+
+    void* m_shmadr{nullptr}; /**< Address of the mapped shared memory. */
+    size_t m_shmsize{0}; /**< Size of the mapped shared memory, in bytes. */
+    LockFreeRingBufInfo* m_bufinfo {nullptr}; /**< structure to manage ring buffer. Placed on top of the shared memory. */
+    char* m_buftop{nullptr}; /**< Start of the data area after m_bufinfo. */
+  };
+
+}
@@ -13,6 +13,7 @@
 
 #include <string>
 #include <memory>
+#include <optional>
 
 class TObject;
 
@@ -119,14 +120,27 @@ namespace Belle2 {
 
     /** Stream object list into an EvtMessage. Caller is responsible for deletion. */
     virtual EvtMessage* encode_msg(ERecordType rectype);
+    /** Stream object list into an EvtMessage without copying the serialized data.
+     *
+     * The returned message points to the internal buffer of this MsgHandler and
+     * is only valid until the next call to clear(), add() or encode_msg*(). Do not delete it.
+     */
+    EvtMessage* encode_msg_inplace(ERecordType rectype);
     /** Decode an EvtMessage into a vector list of objects with names */
     virtual void decode_msg(EvtMessage* msg, std::vector<TObject*>& objlist, std::vector<std::string>& namelist);
 
   private:
-    CharBuffer m_buf; /**< EvtMessage character buffer for encode_msg(). */
+    /** Write the EvtHeader in front of the (compressed) object list and pad it to full integers.
+     *
+     * @return buffer containing the complete message.
+     */
+    CharBuffer& finalize(ERecordType rectype);
+
+    CharBuffer m_buf; /**< EvtMessage character buffer for encode_msg(), starts with space for the EvtHeader. */
     CharBuffer m_compBuf; /**< EvtMessage character buffer for compressing/decompressing. */
     std::unique_ptr<TMessage> m_msg; /**< Used for serialising objects into m_buf. */
     InMessage m_inMsg; /**< Used for deserializing in decode_msg() */
+    std::optional<EvtMessage> m_encodedMsg; /**< Message returned by encode_msg_inplace(), doesn't own its buffer. */
     int m_complevel; /**< compression algorithm * 100 + compression level.
                       level can be 0 for no compression to 9 for highest
                       compression, algorithm can be one of default (0), zlib
@@ -9,7 +9,7 @@
 #pragma once
 
 #include <framework/core/Module.h>
-#include <framework/pcore/RingBuffer.h>
+#include <framework/pcore/EventRingBuffer.h>
 #include <framework/datastore/StoreObjPtr.h>
 #include <framework/core/RandomGenerator.h>
 
@@ -25,7 +25,7 @@ namespace Belle2 {
      *
      * @param rbuf Use the given RingBuffer for data
      */
-    explicit RxModule(RingBuffer* rbuf);
+    explicit RxModule(EventRingBuffer* rbuf);
     virtual ~RxModule();
 
     //! Module functions to be called from main process
@@ -47,7 +47,7 @@ namespace Belle2 {
 
   private:
     /** attached RingBuffer. */
-    RingBuffer* m_rbuf;
+    EventRingBuffer* m_rbuf;
 
     /** Used for serialization. */
     DataStoreStreamer* m_streamer;
@@ -0,0 +1,66 @@
+/**************************************************************************
+ * basf2 (Belle II Analysis Software Framework)                           *
+ * Author: The Belle II Collaboration                                     *
+ *                                                                        *
+ * See git log for contributors and copyright holders.                    *
+ * This file is licensed under LGPL-3.0, see LICENSE.md.                  *
+ **************************************************************************/
+#pragma once
+
+#include <framework/pcore/EventRingBuffer.h>
+#include <framework/pcore/RingBuffer.h>
+
+#include <memory>
+#include <string>
+
+namespace Belle2 {
+
+  /** EventRingBuffer in SysV shared memory, using RingBuffer.
+   *
+   * Used for the named buffers given by BASF2_RBIN/BASF2_RBOUT, since external producers and
+   * consumers (e.g. the HLT and express reco tools) attach to them as RingBuffer.
+   * Waiting for data or space polls, like TxModule and RxModule did before LockFreeRingBuffer.
+   */
+  class SysVRingBuffer : public EventRingBuffer {
+  public:
+    /** Create or attach the named RingBuffer, see RingBuffer::RingBuffer(const std::string&, unsigned int). */
+    explicit SysVRingBuffer(const std::string& name, unsigned int nwords = 0);
+
+    /** Append a buffer, see RingBuffer::insq(). */
+    int insq(const int* buf, int size, bool checkTx = false) override { return m_rbuf.insq(buf, size, checkTx); }
+    /** Pick up a buffer, see RingBuffer::remq(). */
+    int remq(int* buf) override { return m_rbuf.remq(buf); }
+    /** Pick up a buffer, it is copied into a buffer owned by this object. */
+    const int* readInPlace(int& nwords) override;
+    /** Nothing to do, the buffer from readInPlace() is reused by the next call. */
+    void releaseInPlace() override {}
+    /** Returns number of entries/buffers in the ring buffer */
+    int numq() const override { return m_rbuf.numq(); }
+
+    /** Sleep for a short time, RingBuffer offers no notification. */
+    void waitForEntries(int timeoutMicroSeconds) const override;
+    /** Sleep for a short time, RingBuffer offers no notification. */
+    void waitForSpace(int timeoutMicroSeconds) const override;
+
+    /** Increase the number of attached Tx counter. */
+    void txAttached() override { m_rbuf.txAttached(); }
+    /** Decrease the number of attached Tx counter. */
+    void txDetached() override { m_rbuf.txDetached(); }
+    /** Cause termination of reading processes, see RingBuffer::kill(). */
+    void kill() override { m_rbuf.kill(); }
+
+    /** If True, the ring buffer is empty and has no attached Tx modules. */
+    bool isDead() const override { return m_rbuf.isDead(); }
+    /** True if and only if buffer is empty and no reading process is busy. */
+    bool allRxWaiting() const override { return m_rbuf.allRxWaiting(); }
+
+    /** Return ID of the shared memory */
+    int shmid() const override { return m_rbuf.shmid(); }
+
+  private:
+    /** The ring buffer in SysV shared memory. */
+    RingBuffer m_rbuf;
+    /** Destination of readInPlace(), large enough for any event and allocated on first use. */
+    std::unique_ptr<int[]> m_readBuffer;
+  };
+}
@@ -0,0 +1,151 @@
+/**************************************************************************
+ * basf2 (Belle II Analysis Software Framework)                           *
+ * Author: The Belle II Collaboration                                     *
+ *                                                                        *
+ * See git log for contributors and copyright holders.                    *
+ * This file is licensed under LGPL-3.0, see LICENSE.md.                  *
+ **************************************************************************/
+#pragma once
+
+#include <framework/core/EventProcessor.h>
+#include <framework/core/ModuleStatistics.h>
+#include <framework/core/Path.h>
+
+#include <exception>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+class TClass;
+
+namespace Belle2 {
+
+  class DataStore;
+  class EventQueue;
+
+  /**
+   * Event processing loop running the thread safe part of a path in several threads of the same process.
+   *
+   * The path is split like for parallel processing, but using the c_ThreadSafe module flag:
+   * the modules before the first thread safe module form the input stage and everything
+   * after the last one the output stage. Both run in the main and one additional thread,
+   * respectively, and are serialized against each other. The thread safe modules in between
+   * are cloned for each worker thread, and each worker processes complete events in its own
+   * DataStore (see DataStore::ThreadLocalInstance). Events are passed between the stages as
+   * serialized EvtMessages through in-memory EventQueues, so the same restrictions as for
+   * parallel processing apply to the objects which can be used in the worker threads.
+   *
+   * Conditions payloads, random numbers and job metadata are only updated by the input stage,
+   * which waits for all events of the previous run to be processed before starting a new run.
+   * Payloads with intra-run dependencies are updated by the input stage while the workers still
+   * process earlier events, so modules relying on them should not be flagged as thread safe.
+   * The same holds for modules using the global random number generator.
+   *
+   * Python modules can only run in the input stage since the main thread holds the Python
+   * interpreter lock. If there are Python modules in the output stage, the path is processed
+   * in a single thread instead.
+   *
+   * @note Only a few modules are flagged as thread safe so far (the common analysis modules for
+   * loading, selecting, combining and MC matching particles, EventErrorFlag and PruneDataStore).
+   * BestCandidateSelection is not flagged because it is often used with the random variable.
+   * Paths without any of them fall back to single-core processing with just a warning.
+   */
+  class ThreadedEventProcessor : public EventProcessor {
+  public:
+    /** Constructor */
+    ThreadedEventProcessor();
+
+    /** Destructor */
+    virtual ~ThreadedEventProcessor();
+
+    /** Processes the full module chain, starting with the first module in the given path.
+     *
+     * @param spath The processing starts with the first module of this path.
+     * @param maxEvent The maximum number of events that will be processed.
+     *        If the number is smaller or equal 0, all events will be processed.
+     */
+    void process(const PathPtr& spath, long maxEvent);
+
+  private:
+    /** Event loop of one stage, defined in the implementation. */
+    class Stage;
+
+    /** Statistics of one stage, by the module in the original path, copied out before the stage is destroyed. */
+    typedef std::vector<std::pair<const Module*, ModuleStatistics>> StageStatistics;
+
+    /** One DataStore registration, passed from a stage to the next one. */
+    struct Registration {
+      std::string name; /**< name of the entry. */
+      int durability; /**< durability of the entry. */
+      TClass* objClass; /**< class of the object or of the array elements. */
+      bool isArray; /**< true for arrays. */
+      bool dontWriteOut; /**< true if the entry is not written out. */
+    };
+
+    /** Snapshot of all registrations in a DataStore, not modified once it is taken. */
+    typedef std::vector<Registration> Registrations;
+
+    /** Everything needed to run one stage in its own thread. */
+    struct StageContext {
+      PathPtr path; /**< path to process (including the internal queue modules). */
+      std::map<const Module*, const Module*> originals; /**< original module for each cloned module in path. */
+      EventQueue* input = nullptr; /**< queue the stage receives events from. */
+      EventQueue* output = nullptr; /**< queue the stage sends events to, or nullptr. */
+      std::shared_ptr<const Registrations> registrations; /**< registrations to copy into the DataStore of the stage. */
+      std::shared_ptr<const Registrations> registered; /**< registrations of the stage, taken once it is initialized. */
+      bool serial = false; /**< serialize module calls with the input stage. */
+      int signal = 0; /**< signal which stopped the processing of the stage, or 0. */
+      StageStatistics statistics; /**< module statistics collected by the stage. */
+      std::exception_ptr exception; /**< exception thrown by the stage, rethrown in the main thread. */
+    };
+
+    /** Analyze given path. Fills m_*path objects. */
+    void analyzePath(const PathPtr& path);
+
+    /** Create the path processed by a worker thread: a clone of the main path between the internal queue modules. */
+    std::unique_ptr<StageContext> createWorkerContext() const;
+
+    /** Create the path processed by the output thread: the output path after the internal queue module. */
+    std::unique_ptr<StageContext> createOutputContext() const;
+
+    /** Take a snapshot of all registrations in the DataStore of the current thread. */
+    static std::shared_ptr<const Registrations> snapshotRegistrations();
+
+    /** Register the given entries in the DataStore of the current thread.
+     *
+     * Replaces reading the first event in RxModule::initialize(): the stage knows all objects
+     * it will receive before its modules are initialized.
+     */
+    static void copyRegistrations(const Registrations& registrations);
+
+    /** Thread function: initialize, process and terminate one worker or output stage.
+     *
+     * @param context stage to run.
+     * @param initialized called once the stage is initialized and waits for events.
+     */
+    void runStage(StageContext& context, const std::function<void()>& initialized);
+
+    /** Wait until all events sent by the input stage have been processed by all other stages. */
+    void waitUntilIdle() const;
+
+    /** Input path, processed in the main thread. */
+    PathPtr m_inputPath;
+    /** Thread safe part of the path, cloned for each worker thread. */
+    PathPtr m_mainPath;
+    /** Output path, processed in its own thread. */
+    PathPtr m_outputPath;
+
+    /** Events from the input stage to the workers. */
+    std::unique_ptr<EventQueue> m_inputQueue;
+    /** Events from the workers to the output stage, nullptr if there is no output stage. */
+    std::unique_ptr<EventQueue> m_outputQueue;
+
+    /** Serializes all calls to modules of the input and output stages. */
+    std::mutex m_serialMutex;
+  };
+
+}
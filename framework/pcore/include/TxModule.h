@@ -9,7 +9,7 @@
 #pragma once
 
 #include <framework/core/Module.h>
-#include <framework/pcore/RingBuffer.h>
+#include <framework/pcore/EventRingBuffer.h>
 #include <framework/datastore/StoreObjPtr.h>
 #include <framework/core/RandomGenerator.h>
 
@@ -27,7 +27,7 @@ namespace Belle2 {
      *
      * @param rbuf Use the given RingBuffer for data
      */
-    explicit TxModule(RingBuffer* rbuf);
+    explicit TxModule(EventRingBuffer* rbuf);
     virtual ~TxModule();
 
     //! Module functions to be called from main process
@@ -56,7 +56,7 @@ namespace Belle2 {
     int m_compressionLevel;
 
     //! RingBuffer (not owned by us)
-    RingBuffer* m_rbuf;
+    EventRingBuffer* m_rbuf;
 
     //! DataStoreStreamer
     DataStoreStreamer* m_streamer;
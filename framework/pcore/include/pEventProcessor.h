@@ -16,7 +16,7 @@
 namespace Belle2 {
 
   class ProcHandler;
-  class RingBuffer;
+  class EventRingBuffer;
 
   /**
     This class provides the core event processing loop for parallel processing.
@@ -65,7 +65,7 @@ namespace Belle2 {
     void preparePaths();
 
     /** Create RingBuffer with name from given environment variable, add Tx and Rx modules to a and b. */
-    RingBuffer* connectViaRingBuffer(const char* name, const PathPtr& a, PathPtr& b);
+    EventRingBuffer* connectViaRingBuffer(const char* name, const PathPtr& a, PathPtr& b);
 
     /** Dump module names in the ModulePtrList */
     void dump_modules(const std::string&, const ModulePtrList&);
@@ -96,9 +96,9 @@ namespace Belle2 {
     PathPtr m_outputPath;
 
     /** input RingBuffer */
-    RingBuffer* m_rbin = nullptr;
+    EventRingBuffer* m_rbin = nullptr;
     /** output RingBuffer */
-    RingBuffer* m_rbout = nullptr;;
+    EventRingBuffer* m_rbout = nullptr;
 
     /** Pointer to HistoManagerModule, or nullptr if not found. */
     ModulePtr m_histoman;
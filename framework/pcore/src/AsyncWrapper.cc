@@ -12,7 +12,7 @@
 #include <framework/core/EventProcessor.h>
 #include <framework/core/ModuleManager.h>
 #include <framework/pcore/GlobalProcHandler.h>
-#include <framework/pcore/RingBuffer.h>
+#include <framework/pcore/LockFreeRingBuffer.h>
 #include <framework/pcore/RxModule.h>
 #include <framework/pcore/TxModule.h>
 #include <framework/datastore/StoreObjPtr.h>
@@ -25,13 +25,13 @@
 using namespace Belle2;
 
 bool AsyncWrapper::s_isAsync = false;
-RingBuffer* AsyncWrapper::s_currentRingBuffer = nullptr;
+LockFreeRingBuffer* AsyncWrapper::s_currentRingBuffer = nullptr;
 namespace {
-  static std::vector<RingBuffer*> rbList;
+  static std::vector<LockFreeRingBuffer*> rbList;
   void cleanupIPC()
   {
     if (!AsyncWrapper::isAsync()) {
-      for (RingBuffer* rb : rbList)
+      for (LockFreeRingBuffer* rb : rbList)
         delete rb;
       rbList.clear();
     }
@@ -66,8 +66,8 @@ void AsyncWrapper::initialize()
   B2INFO("Initializing AsyncWrapper...");
 
   GlobalProcHandler::initialize(1);
-  const int bufferSizeInts = 8000000; //~32M, within Ubuntu's shmmax limit
-  m_ringBuffer = new RingBuffer(bufferSizeInts);
+  const int bufferSizeInts = 8000000; //~32M
+  m_ringBuffer = new LockFreeRingBuffer(bufferSizeInts);
   rbList.push_back(m_ringBuffer);
   m_rx = new RxModule(m_ringBuffer);
   m_rx->disableMergeableHandling();
@@ -124,7 +124,7 @@ void AsyncWrapper::terminate()
     delete m_tx;
     delete m_rx;
     delete m_ringBuffer;
-    for (RingBuffer*& rb : rbList)
+    for (LockFreeRingBuffer*& rb : rbList)
       if (rb == m_ringBuffer)
         rb = nullptr;
   }
@@ -20,81 +20,33 @@
 #include <TStreamerInfo.h>
 #include <TList.h>
 
-#include <unistd.h>
-#include <cstdio>                      // for NULL, printf
+#include <TROOT.h>
 
 #include <algorithm>
-#include <queue>
+#include <cstring>
 
 using namespace Belle2;
 
-namespace {
-// Thread related
-  static DataStoreStreamer* s_streamer = nullptr;
-
-  static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
-  static pthread_mutex_t mutex_thread[DataStoreStreamer::c_maxThreads];
-//static char* evtbuf_thread[DataStoreStreamer::c_maxThreads];
-  static int msg_compLevel[DataStoreStreamer::c_maxThreads];
-
-  static std::queue<char*> my_evtbuf[DataStoreStreamer::c_maxThreads];
-
-  static std::queue<int> my_nobjs;
-  static std::queue<int> my_narrays;
-  static std::queue<std::vector<TObject*>> my_objlist;
-  static std::queue<std::vector<std::string>> my_namelist;
-
-  static int my_decstat[DataStoreStreamer::c_maxThreads];
-};
-
-void* RunDecodeEvtMessage(void* targ)
-{
-  auto* id = (int*)targ;
-  //  DataStoreStreamer::Instance().decodeEvtMessage(*id);
-  s_streamer->decodeEvtMessage(*id);
-  return nullptr;
-}
-
 DataStoreStreamer::DataStoreStreamer(int complevel, bool handleMergeable, int maxthread):
   m_compressionLevel(complevel),
   m_handleMergeable(handleMergeable),
   m_initStatus(0),
-  m_maxthread(maxthread),
-  m_threadin(0)
-  //, m_threadout(0)
+  m_maxthread(maxthread)
 {
-  if ((unsigned int)m_maxthread > c_maxThreads) {
-    B2FATAL("DataStoreStreamer : Too many threads " << m_maxthread);
-    m_maxthread = c_maxThreads;
-  }
   m_msghandler = new MsgHandler(m_compressionLevel);
-
-  if (m_maxthread > 0) {
-    // Run decoder threads as sustainable detached threads
-    pthread_attr_t thread_attr;
-    pthread_attr_init(&thread_attr);
-    //    pthread_attr_setschedpolicy(&thread_attr , SCHED_FIFO);
-    //    pthread_attr_setdetachstate(&thread_attr , PTHREAD_CREATE_DETACHED);
-    for (int i = 0; i < m_maxthread; i++) {
-      my_decstat[i] = 0;
-      m_pt[i] = (pthread_t)0;
-      m_id[i] = i;
-      //      m_pmsghandler[i] = new MsgHandler ( m_compressionLevel );
-      mutex_thread[i] = PTHREAD_MUTEX_INITIALIZER;
-      msg_compLevel[i] = m_compressionLevel;
-    }
-    for (int i = 0; i < m_maxthread; i++) {
-      //      args.evtbuf = m_evtbuf[i];
-      pthread_create(&m_pt[i], nullptr, RunDecodeEvtMessage, (void*)&m_id[i]);
-    }
-    pthread_attr_destroy(&thread_attr);
-  }
-  s_streamer = this;
 }
 
 // Destructor
 DataStoreStreamer::~DataStoreStreamer()
 {
+  if (m_decoder) {
+    //finish decoding and clean up objects that were never restored
+    m_decoder->wait();
+    for (auto& decoded : m_decodedEvents) {
+      for (TObject* obj : decoded.get().objlist)
+        delete obj;
+    }
+  }
   delete m_msghandler;
 }
 
@@ -132,6 +84,16 @@ void DataStoreStreamer::removeSideEffects()
 
 // Stream DataStore
 EvtMessage* DataStoreStreamer::streamDataStore(bool addPersistentDurability, bool streamTransientObjects)
+{
+  return stream(addPersistentDurability, streamTransientObjects, false);
+}
+
+EvtMessage* DataStoreStreamer::streamDataStoreInPlace(bool addPersistentDurability, bool streamTransientObjects)
+{
+  return stream(addPersistentDurability, streamTransientObjects, true);
+}
+
+EvtMessage* DataStoreStreamer::stream(bool addPersistentDurability, bool streamTransientObjects, bool inPlace)
 {
   // Clear Message Handler
   m_msghandler->clear();
@@ -196,7 +158,7 @@ EvtMessage* DataStoreStreamer::streamDataStore(bool addPersistentDurability, boo
   }
 
   // Encode EvtMessage
-  EvtMessage* msg = m_msghandler->encode_msg(MSG_EVENT);
+  EvtMessage* msg = inPlace ? m_msghandler->encode_msg_inplace(MSG_EVENT) : m_msghandler->encode_msg(MSG_EVENT);
   (msg->header())->nObjects = nobjs;
   (msg->header())->nArrays = narrays;
 
@@ -291,130 +253,77 @@ int DataStoreStreamer::restoreDataStore(EvtMessage* msg)
   return 0;
 }
 
-// Parallel EvtMessage Destreamer implemented using thread
+// Parallel EvtMessage Destreamer implemented using threads
 
 int DataStoreStreamer::queueEvtMessage(char* evtbuf)
 {
-  // EOF case
+  std::future<DecodedEvent> decoded;
   if (evtbuf == nullptr) {
-    printf("queueEvtMessage : NULL evtbuf detected. \n");
-    for (int i = 0; i < m_maxthread; i++) {
-      while (my_evtbuf[i].size() >= c_maxQueueDepth) usleep(10);
-      my_evtbuf[m_threadin].push(evtbuf);
+    // EOF case
+    B2DEBUG(100, "queueEvtMessage : NULL evtbuf detected.");
+    std::promise<DecodedEvent> eof;
+    eof.set_value(DecodedEvent());
+    decoded = eof.get_future();
+  } else {
+    if (!m_decoder) {
+      //objects are created by ROOT streamers in several threads
+      ROOT::EnableThreadSafety();
+      m_decoder.reset(new TaskPool(std::max(m_maxthread, 1), c_maxQueueDepth));
     }
-    return 0;
-  }
-
-  // Put the event buffer in the queue of current thread
-  for (;;) {
-    if (my_evtbuf[m_threadin].size() < c_maxQueueDepth) {
-      pthread_mutex_lock(&mutex_thread[m_threadin]);
-      my_evtbuf[m_threadin].push(evtbuf);
-      pthread_mutex_unlock(&mutex_thread[m_threadin]);
-      break;
+    // Wait until the restoring side catches up
+    {
+      std::unique_lock<std::mutex> lock(m_decodedMutex);
+      m_decodedChanged.wait(lock, [this]() { return m_decodedEvents.size() < c_maxQueueDepth; });
     }
-    usleep(20);
+    decoded = m_decoder->submit([evtbuf]() { return decodeEvtMessage(evtbuf); });
   }
 
-  // Switch to next thread
-  my_decstat[m_threadin] = 1; // Event queued for decoding
-  m_threadin++;
-  if (m_threadin >= m_maxthread) m_threadin = 0;
-  return 1;
+  {
+    std::lock_guard<std::mutex> lock(m_decodedMutex);
+    m_decodedEvents.push_back(std::move(decoded));
+  }
+  m_decodedChanged.notify_all();
+  return (evtbuf == nullptr) ? 0 : 1;
 }
 
-void* DataStoreStreamer::decodeEvtMessage(int id)
+DataStoreStreamer::DecodedEvent DataStoreStreamer::decodeEvtMessage(char* evtbuf)
 {
-  printf("decodeEvtMessge : started. Thread ID = %d\n", id);
-  // Clear Message Handler
-  //  m_msghandler->clear();
-  //  MsgHandler* msghandler = new MsgHandler(m_compressionLevel);
-  //  MsgHandler* msghandler = m_pmsghandler[id];
-
-  pthread_mutex_lock(&mutex);     // Lock thread
-  MsgHandler msghandler(msg_compLevel[id]);
-  pthread_mutex_unlock(&mutex);    // Unlock thread
-
-  for (;;) {
-    // Clear message handler event by event
-    //    MsgHandler msghandler(m_compressionLevel);
-    //    m_pmsghandler[id]->clear();
-    // Wait for event in queue becomes ready
-    msghandler.clear();
-
-    while (my_evtbuf[id].size() <= 0) usleep(10);
-
-    // Pick up event buffer
-    pthread_mutex_lock(&mutex_thread[id]);
-    int nqueue = my_evtbuf[id].size();
-    if (nqueue <= 0) printf("!!!!! Nqueue = %d\n", nqueue);
-    char* evtbuf = my_evtbuf[id].front(); my_evtbuf[id].pop();
-    pthread_mutex_unlock(&mutex_thread[id]);
-
-    // In case of EOF
-    if (evtbuf == nullptr) {
-      printf("decodeEvtMessage: NULL evtbuf detected, nq = %d\n", nqueue);
-      my_nobjs.push(-1);
-      return nullptr;
-    }
-
-    // Construct EvtMessage
-    auto* msg = new EvtMessage(evtbuf);
-
-    // Decode EvtMessage into Objects
-    std::vector<TObject*> objlist;
-    std::vector<std::string> namelist;
-
-    //    pthread_mutex_lock(&mutex);     // Lock test
-    msghandler.decode_msg(msg, objlist, namelist);
-    //    pthread_mutex_unlock(&mutex);    // Unlock test
-
-
-    // Queue them for the registration in DataStore
-    while (my_nobjs.size() >= c_maxQueueDepth) usleep(10);
-    pthread_mutex_lock(&mutex);     // Lock queueing
-    my_objlist.push(objlist);
-    my_namelist.push(namelist);
-    my_nobjs.push((msg->header())->nObjects);
-    my_narrays.push((msg->header())->nArrays);
-    pthread_mutex_unlock(&mutex);    // Unlock queueing
-
-    // Release EvtMessage
-    delete msg;
-    delete[] evtbuf;
-
-    // Preparation for next event
-    my_decstat[id]  = 0; // Ready to read next event
-
-  }
-
-  return nullptr;
+  //each decoder thread reuses its own buffers
+  thread_local MsgHandler msghandler;
+  msghandler.clear();
+
+  DecodedEvent decoded;
+  EvtMessage msg(evtbuf);
+  msghandler.decode_msg(&msg, decoded.objlist, decoded.namelist);
+  decoded.nobjs = (msg.header())->nObjects;
+  decoded.narrays = (msg.header())->nArrays;
+  delete[] evtbuf;
+  return decoded;
 }
 
 int DataStoreStreamer::restoreDataStoreAsync()
 {
-// Wait for the queue to become ready
-  while (my_nobjs.empty()) usleep(10);
-
-  // Register decoded objects in DataStore
-
-  // Pick up event on the top and remove it from the queue
-  pthread_mutex_lock(&mutex);
-  int nobjs = my_nobjs.front(); my_nobjs.pop();
-  if (nobjs == -1) {
-    printf("restoreDataStore: EOF detected. exiting with status 0\n");
-    pthread_mutex_unlock(&mutex);
+  // Pick up the oldest event, waiting until it is decoded
+  std::future<DecodedEvent> next;
+  {
+    std::unique_lock<std::mutex> lock(m_decodedMutex);
+    m_decodedChanged.wait(lock, [this]() { return !m_decodedEvents.empty(); });
+    next = std::move(m_decodedEvents.front());
+    m_decodedEvents.pop_front();
+  }
+  m_decodedChanged.notify_all();
+  DecodedEvent decoded = next.get();
+  if (decoded.nobjs == -1) {
+    B2DEBUG(100, "restoreDataStore: EOF detected.");
     return 0;
   }
-  int narrays = my_narrays.front(); my_narrays.pop();
-  std::vector<TObject*> objlist = my_objlist.front(); my_objlist.pop();
-  std::vector<std::string> namelist = my_namelist.front(); my_namelist.pop();
-  pthread_mutex_unlock(&mutex);
+  const int nobjs = decoded.nobjs;
+  const int narrays = decoded.narrays;
+  const std::vector<TObject*>& objlist = decoded.objlist;
+  const std::vector<std::string>& namelist = decoded.namelist;
 
   // Restore objects in DataStore
-  //TODO refactor, just copied & pasted right now
   for (int i = 0; i < nobjs + narrays; i++) {
-    //    printf ( "restoring object %d = %s\n", i, namelist.at(i).c_str() );
     bool array = (dynamic_cast<TClonesArray*>(objlist.at(i)) != nullptr);
     if (objlist.at(i) != nullptr) {
       TObject* obj = objlist.at(i);
@@ -448,8 +357,6 @@ int DataStoreStreamer::restoreDataStoreAsync()
     }
   }
 
-  //  printf ( "Objects restored in DataStore\n" );
-
   return 1;
 }
 
@@ -463,16 +370,15 @@ int DataStoreStreamer::getMaxThreads()
   return m_maxthread;
 }
 
-int DataStoreStreamer::getDecoderStatus()
+int DataStoreStreamer::getDecoderQueueDepth()
 {
-  //  printf ( "Decode thread %d = %d\n", m_threadin, m_done_decode[m_threadin] );
-  return (my_decstat[m_threadin]);
+  std::lock_guard<std::mutex> lock(m_decodedMutex);
+  return m_decodedEvents.size();
 }
 
-void DataStoreStreamer::setDecoderStatus(int val)
+TaskPool::Statistics DataStoreStreamer::getDecoderStatistics()
 {
-  //  printf ( "Decode thread %d = %d\n", m_threadin, m_done_decode[m_threadin] );
-  m_decoderStatus[m_threadin] = val;
+  return m_decoder ? m_decoder->getStatistics() : TaskPool::Statistics();
 }
 
 
@@ -0,0 +1,113 @@
+/**************************************************************************
+ * basf2 (Belle II Analysis Software Framework)                           *
+ * Author: The Belle II Collaboration                                     *
+ *                                                                        *
+ * See git log for contributors and copyright holders.                    *
+ * This file is licensed under LGPL-3.0, see LICENSE.md.                  *
+ **************************************************************************/
+
+#include <framework/pcore/EventQueue.h>
+#include <framework/pcore/EvtMessage.h>
+
+using namespace Belle2;
+
+EventQueue::EventQueue(unsigned int capacity) : m_capacity(capacity > 0 ? capacity : 1)
+{
+}
+
+EventQueue::~EventQueue()
+{
+  for (EvtMessage* msg : m_messages)
+    delete msg;
+}
+
+void EventQueue::addProducer()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_producers++;
+}
+
+void EventQueue::removeProducer()
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  if (--m_producers > 0)
+    return;
+  lock.unlock();
+  close();
+}
+
+void EventQueue::addConsumer()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_consumers++;
+}
+
+void EventQueue::removeConsumer()
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  if (--m_consumers > 0) {
+    lock.unlock();
+    m_idle.notify_all();
+    return;
+  }
+  //nobody is going to read the remaining events
+  for (EvtMessage* msg : m_messages)
+    delete msg;
+  m_messages.clear();
+  lock.unlock();
+  close();
+}
+
+bool EventQueue::push(EvtMessage* msg)
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_notFull.wait(lock, [this] { return m_closed or m_messages.size() < m_capacity; });
+  if (m_closed) {
+    delete msg;
+    return false;
+  }
+  m_messages.push_back(msg);
+  lock.unlock();
+  m_notEmpty.notify_one();
+  return true;
+}
+
+EvtMessage* EventQueue::pop()
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_waitingConsumers++;
+  if (m_messages.empty() and m_waitingConsumers == m_consumers)
+    m_idle.notify_all();
+  m_notEmpty.wait(lock, [this] { return m_closed or !m_messages.empty(); });
+  m_waitingConsumers--;
+  if (m_messages.empty())
+    return nullptr;
+  EvtMessage* msg = m_messages.front();
+  m_messages.pop_front();
+  lock.unlock();
+  m_notFull.notify_one();
+  return msg;
+}
+
+void EventQueue::close()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_closed = true;
+  }
+  m_notEmpty.notify_all();
+  m_notFull.notify_all();
+  m_idle.notify_all();
+}
+
+bool EventQueue::isIdle() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_messages.empty() and m_waitingConsumers == m_consumers;
+}
+
+void EventQueue::waitUntilIdle() const
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_idle.wait(lock, [this] { return m_closed or (m_messages.empty() and m_waitingConsumers == m_consumers); });
+}
@@ -0,0 +1,473 @@
+/**************************************************************************
+ * basf2 (Belle II Analysis Software Framework)                           *
+ * Author: The Belle II Collaboration                                     *
+ *                                                                        *
+ * See git log for contributors and copyright holders.                    *
+ * This file is licensed under LGPL-3.0, see LICENSE.md.                  *
+ **************************************************************************/
+
+#include <framework/pcore/LockFreeRingBuffer.h>
+#include <framework/logging/Logger.h>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <csignal>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <stdexcept>
+#include <unistd.h>
+
+using namespace std;
+using namespace Belle2;
+
+namespace {
+  /** Value of LockFreeRingBufInfo::magic once the buffer is initialized. */
+  const uint32_t c_Magic = 0x4c465242;
+
+  /** Value of RecordHeader::nwords marking unused space at the end of the data area. */
+  const uint32_t c_Padding = 0xffffffff;
+
+  /** Header in front of each record in the data area. */
+  struct RecordHeader {
+    std::atomic<uint32_t> nwords; /**< size of the payload in integers, or c_Padding. */
+    std::atomic<uint32_t> consumed; /**< set once the payload was copied out by a consumer. */
+    std::atomic<int32_t> owner; /**< PID of the consumer which claimed the record, 0 if not recorded yet. */
+    uint32_t unused; /**< padding to 8 bytes. */
+  };
+
+  /** True if the process with the given PID is known to have exited. */
+  bool hasDied(pid_t pid)
+  {
+    return ::kill(pid, 0) != 0 and errno == ESRCH;
+  }
+
+  /** Size of a record with the given payload, including the header and padding to 8 bytes. */
+  uint64_t recordBytes(uint64_t nwords)
+  {
+    return sizeof(RecordHeader) + ((nwords * sizeof(int) + 7) & ~uint64_t(7));
+  }
+
+  /** Wait until *addr != expected, a wake-up, or the timeout (negative: no timeout). Works across processes. */
+  void futexWait(const std::atomic<uint32_t>& addr, uint32_t expected, int timeoutMicroSeconds)
+  {
+    struct timespec timeout;
+    timeout.tv_sec = timeoutMicroSeconds / 1000000;
+    timeout.tv_nsec = (timeoutMicroSeconds % 1000000) * 1000;
+    syscall(SYS_futex, reinterpret_cast<const uint32_t*>(&addr), FUTEX_WAIT, expected,
+            timeoutMicroSeconds >= 0 ? &timeout : nullptr, nullptr, 0);
+  }
+
+  /** Wake up to 'count' processes waiting on addr. Async-signal-safe. */
+  void futexWake(const std::atomic<uint32_t>& addr, int count)
+  {
+    syscall(SYS_futex, reinterpret_cast<const uint32_t*>(&addr), FUTEX_WAKE, count, nullptr, nullptr, 0);
+  }
+
+  /** Counter for LockFreeRingBuffer::shmid(). */
+  std::atomic<int> s_bufferCounter{0};
+}
+
+LockFreeRingBuffer::LockFreeRingBuffer(int nwords)
+{
+  openSHM(nwords);
+  B2DEBUG(32, "LockFreeRingBuffer initialization done");
+}
+
+LockFreeRingBuffer::LockFreeRingBuffer(const std::string& name, unsigned int nwords)
+{
+  if (name != "private") {
+    const char* user = getenv("USER");
+    m_pathname = "/" + std::string(user ? user : "basf2") + "_LFRB_" + name;
+  }
+  openSHM(nwords > 0 ? nwords : c_DefaultSize);
+  B2DEBUG(32, "LockFreeRingBuffer initialization done with name=" << m_pathname);
+}
+
+LockFreeRingBuffer::~LockFreeRingBuffer()
+{
+  cleanup();
+}
+
+void LockFreeRingBuffer::openSHM(int nwords)
+{
+  m_shmsize = std::max<size_t>(size_t(nwords) * sizeof(int), sizeof(LockFreeRingBufInfo) + 64);
+  m_id = s_bufferCounter++;
+
+  // 1. Map shared memory
+  int fd = -1;
+  if (!m_pathname.empty()) {
+    fd = shm_open(m_pathname.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd >= 0) {
+      B2DEBUG(32, "[LockFreeRingBuffer] Creating a ring buffer with name " << m_pathname);
+      m_new = true;
+      if (ftruncate(fd, m_shmsize) != 0) {
+        close(fd);
+        B2FATAL("LockFreeRingBuffer: ftruncate(" << m_shmsize << ") failed for " << m_pathname << ": " << strerror(errno));
+      }
+    } else if (errno == EEXIST) {
+      B2DEBUG(32, "[LockFreeRingBuffer] Attaching the ring buffer with name " << m_pathname);
+      m_new = false;
+      fd = shm_open(m_pathname.c_str(), O_RDWR, 0644);
+      struct stat info;
+      if (fd < 0 or fstat(fd, &info) != 0) {
+        B2FATAL("LockFreeRingBuffer: error opening shared memory " << m_pathname << ": " << strerror(errno));
+      }
+      m_shmsize = info.st_size;
+    } else {
+      B2FATAL("LockFreeRingBuffer: error opening shared memory " << m_pathname << ": " << strerror(errno));
+    }
+    m_shmadr = mmap(nullptr, m_shmsize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+  } else {
+    //anonymous shared memory stays shared with forked processes and vanishes with the last of them
+    m_shmadr = mmap(nullptr, m_shmsize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  }
+  if (m_shmadr == MAP_FAILED) {
+    m_shmadr = nullptr;
+    B2FATAL("LockFreeRingBuffer: mmap(" << m_shmsize << ") failed: " << strerror(errno));
+  }
+
+  // 2. Initialize control parameters (the memory is zeroed by the kernel)
+  m_bufinfo = reinterpret_cast<LockFreeRingBufInfo*>(m_shmadr);
+  m_buftop = reinterpret_cast<char*>(m_shmadr) + sizeof(LockFreeRingBufInfo);
+  if (m_new) {
+    m_bufinfo->size = (m_shmsize - sizeof(LockFreeRingBufInfo)) & ~uint64_t(7);
+    //the lock has to work across processes and must not stay locked if a producer is killed while holding it
+    pthread_mutexattr_t attributes;
+    pthread_mutexattr_init(&attributes);
+    pthread_mutexattr_setpshared(&attributes, PTHREAD_PROCESS_SHARED);
+    pthread_mutexattr_setrobust(&attributes, PTHREAD_MUTEX_ROBUST);
+    const int result = pthread_mutex_init(&m_bufinfo->producerLock, &attributes);
+    pthread_mutexattr_destroy(&attributes);
+    if (result != 0) {
+      B2FATAL("LockFreeRingBuffer: cannot initialize the producer lock: " << strerror(result));
+    }
+    m_bufinfo->nattached = 1;
+    m_bufinfo->numAttachedTx = -1;
+    m_bufinfo->magic.store(c_Magic, std::memory_order_release);
+  } else {
+    while (m_bufinfo->magic.load(std::memory_order_acquire) != c_Magic)
+      usleep(100);
+    m_bufinfo->nattached++;
+    B2DEBUG(32, "[LockFreeRingBuffer] check entries = " << m_bufinfo->nbuf);
+    B2DEBUG(32, "[LockFreeRingBuffer] check size = " << m_bufinfo->size);
+  }
+}
+
+void LockFreeRingBuffer::cleanup()
+{
+  if (!m_shmadr)
+    return;
+
+  releaseInPlace();
+  if (m_procIsBusy) {
+    m_bufinfo->nbusy--;
+    m_procIsBusy = false;
+  }
+  m_bufinfo->nattached--;
+
+  B2DEBUG(32, "LockFreeRingBuffer: Cleaning up shared memory");
+  munmap(m_shmadr, m_shmsize);
+  m_shmadr = nullptr;
+  m_bufinfo = nullptr;
+  m_buftop = nullptr;
+  if (m_new and !m_pathname.empty())
+    shm_unlink(m_pathname.c_str());
+}
+
+void LockFreeRingBuffer::lockProducers()
+{
+  const int result = pthread_mutex_lock(&m_bufinfo->producerLock);
+  if (result == EOWNERDEAD) {
+    //records are only published at the end of insq(), so whatever the dead producer wrote is simply overwritten.
+    //Only the entry count might be off by one.
+    B2WARNING("LockFreeRingBuffer: a process died while writing to the ring buffer, recovering the producer lock");
+    pthread_mutex_consistent(&m_bufinfo->producerLock);
+  } else if (result != 0) {
+    B2FATAL("LockFreeRingBuffer: cannot lock the producer lock: " << strerror(result));
+  }
+}
+
+void LockFreeRingBuffer::unlockProducers()
+{
+  pthread_mutex_unlock(&m_bufinfo->producerLock);
+}
+
+uint64_t LockFreeRingBuffer::reclaim(bool dropDeadClaims)
+{
+  const uint64_t size = m_bufinfo->size;
+  uint64_t tail = m_bufinfo->tail.load(std::memory_order_relaxed);
+  const uint64_t claimed = m_bufinfo->readClaim.load(std::memory_order_acquire);
+  while (tail < claimed) {
+    auto* record = reinterpret_cast<RecordHeader*>(m_buftop + tail % size);
+    if (!record->consumed.load(std::memory_order_acquire)) {
+      //a consumer which dies between claimRecord() and releaseRecord() would block the tail forever.
+      //If it died right after the claim, before recording its PID, the record stays blocked.
+      const pid_t owner = record->owner.load(std::memory_order_acquire);
+      if (!dropDeadClaims or owner == 0 or !hasDied(owner))
+        break;
+      B2WARNING("LockFreeRingBuffer: a process died while reading from the ring buffer, its event is lost"
+                << LogVar("pid", owner));
+      m_bufinfo->nbuf--;
+      //a reader holding a record is busy, see readInPlace()
+      int32_t busy = m_bufinfo->nbusy;
+      while (busy > 0 and !m_bufinfo->nbusy.compare_exchange_weak(busy, busy - 1)) { }
+      record->consumed.store(1, std::memory_order_relaxed);
+    }
+    const uint32_t nwords = record->nwords.load(std::memory_order_relaxed);
+    tail += (nwords == c_Padding) ? size - tail % size : recordBytes(nwords);
+  }
+  m_bufinfo->tail.store(tail, std::memory_order_release);
+  return tail;
+}
+
+int LockFreeRingBuffer::insq(const int* buf, int size, bool checkTx)
+{
+  if (size <= 0) {
+    B2FATAL("LockFreeRingBuffer::insq() failed: invalid buffer size = " << size);
+  }
+  if (m_bufinfo->numAttachedTx == 0 and checkTx) {
+    //safe abort was requested
+    B2WARNING("Number of attached Tx is 0, so I will not go on with the processing.");
+    exit(0);
+  }
+  const uint64_t bufferSize = m_bufinfo->size;
+  const uint64_t recordSize = recordBytes(size);
+  if (recordSize > bufferSize) {
+    throw std::runtime_error("[LockFreeRingBuffer::insq ()] Inserted item (size: " + std::to_string(size) +
+                             ") is larger than LockFreeRingBuffer (size: " + std::to_string((bufferSize - sizeof(RecordHeader)) / sizeof(int)) + ")!");
+  }
+
+  lockProducers();
+  uint64_t tail = reclaim(false);
+  uint64_t head = m_bufinfo->head.load(std::memory_order_relaxed);
+  //records are contiguous, skip the rest of the data area if the record doesn't fit
+  const uint64_t offset = head % bufferSize;
+  const uint64_t padding = (offset + recordSize > bufferSize) ? bufferSize - offset : 0;
+  if (head + padding + recordSize - tail > bufferSize)
+    tail = reclaim(true);
+  if (head + padding + recordSize - tail > bufferSize) {
+    unlockProducers();
+    return -1;
+  }
+  if (padding > 0) {
+    auto* record = reinterpret_cast<RecordHeader*>(m_buftop + offset);
+    record->nwords.store(c_Padding, std::memory_order_relaxed);
+    record->consumed.store(1, std::memory_order_relaxed);
+    head += padding;
+  }
+  auto* record = reinterpret_cast<RecordHeader*>(m_buftop + head % bufferSize);
+  record->nwords.store(size, std::memory_order_relaxed);
+  record->consumed.store(0, std::memory_order_relaxed);
+  record->owner.store(0, std::memory_order_relaxed);
+  memcpy(reinterpret_cast<char*>(record) + sizeof(RecordHeader), buf, size * sizeof(int));
+  m_bufinfo->nbuf++;
+  //publish the record to the consumers
+  m_bufinfo->head.store(head + recordSize, std::memory_order_release);
+  m_bufinfo->ninsq++;
+  unlockProducers();
+
+  m_bufinfo->headSeq++;
+  if (m_bufinfo->readWaiters > 0)
+    futexWake(m_bufinfo->headSeq, 1);
+  return size;
+}
+
+char* LockFreeRingBuffer::claimRecord(int& nwords)
+{
+  const uint64_t size = m_bufinfo->size;
+  uint64_t claim = m_bufinfo->readClaim.load(std::memory_order_acquire);
+  while (claim < m_bufinfo->head.load(std::memory_order_acquire)) {
+    //if another consumer already took this record, the header may be overwritten, but then the CAS fails
+    auto* record = reinterpret_cast<RecordHeader*>(m_buftop + claim % size);
+    const uint32_t recordWords = record->nwords.load(std::memory_order_relaxed);
+    const uint64_t next = (recordWords == c_Padding) ? claim + size - claim % size : claim + recordBytes(recordWords);
+    if (!m_bufinfo->readClaim.compare_exchange_weak(claim, next, std::memory_order_acq_rel, std::memory_order_acquire))
+      continue;
+    if (recordWords == c_Padding) {
+      claim = next;
+      continue;
+    }
+
+    //the record is ours, and its space is not reused before we mark it as consumed (or die, see reclaim())
+    record->owner.store(getpid(), std::memory_order_release);
+    nwords = recordWords;
+    return reinterpret_cast<char*>(record);
+  }
+  nwords = 0;
+  return nullptr;
+}
+
+void LockFreeRingBuffer::releaseRecord(char* recordStart)
+{
+  auto* record = reinterpret_cast<RecordHeader*>(recordStart);
+  m_bufinfo->nbuf--;
+  record->consumed.store(1, std::memory_order_release);
+  m_bufinfo->tailSeq++;
+  if (m_bufinfo->writeWaiters > 0)
+    futexWake(m_bufinfo->tailSeq, INT_MAX);
+}
+
+int LockFreeRingBuffer::discard()
+{
+  int nwords = 0;
+  char* record = claimRecord(nwords);
+  if (record)
+    releaseRecord(record);
+  return nwords;
+}
+
+int LockFreeRingBuffer::remq(int* buf)
+{
+  if (!buf) {
+    //discarding entries doesn't make the caller a reading process
+    return discard();
+  }
+  int nwords = 0;
+  const int* data = readInPlace(nwords);
+  if (data) {
+    memcpy(buf, data, nwords * sizeof(int));
+    releaseInPlace();
+  }
+  return nwords;
+}
+
+const int* LockFreeRingBuffer::readInPlace(int& nwords)
+{
+  releaseInPlace();
+  //announce that we're busy before taking the record, so allRxWaiting() never sees an empty buffer without busy readers
+  if (not m_procIsBusy) {
+    m_bufinfo->nbusy++;
+    m_procIsBusy = true;
+  }
+  m_inPlaceRecord = claimRecord(nwords);
+  if (!m_inPlaceRecord) {
+    m_bufinfo->nbusy--;
+    m_procIsBusy = false;
+    return nullptr;
+  }
+  m_bufinfo->nremq++;
+  return reinterpret_cast<const int*>(m_inPlaceRecord + sizeof(RecordHeader));
+}
+
+void LockFreeRingBuffer::releaseInPlace()
+{
+  if (m_inPlaceRecord) {
+    releaseRecord(m_inPlaceRecord);
+    m_inPlaceRecord = nullptr;
+  }
+}
+
+int LockFreeRingBuffer::numq() const
+{
+  return m_bufinfo->nbuf;
+}
+
+void LockFreeRingBuffer::waitForEntries(int timeoutMicroSeconds) const
+{
+  const uint32_t seq = m_bufinfo->headSeq;
+  if (m_bufinfo->readClaim.load() < m_bufinfo->head.load() or m_bufinfo->numAttachedTx == 0)
+    return;
+  m_bufinfo->readWaiters++;
+  futexWait(m_bufinfo->headSeq, seq, timeoutMicroSeconds);
+  m_bufinfo->readWaiters--;
+}
+
+void LockFreeRingBuffer::waitForSpace(int timeoutMicroSeconds) const
+{
+  const uint32_t seq = m_bufinfo->tailSeq;
+  m_bufinfo->writeWaiters++;
+  futexWait(m_bufinfo->tailSeq, seq, timeoutMicroSeconds);
+  m_bufinfo->writeWaiters--;
+}
+
+void LockFreeRingBuffer::txAttached()
+{
+  int32_t expected = -1; //first attach
+  if (!m_bufinfo->numAttachedTx.compare_exchange_strong(expected, 1))
+    m_bufinfo->numAttachedTx++;
+}
+
+void LockFreeRingBuffer::txDetached()
+{
+  int32_t attached = m_bufinfo->numAttachedTx;
+  while (attached > 0 and !m_bufinfo->numAttachedTx.compare_exchange_weak(attached, attached - 1)) { }
+  if (attached <= 0)
+    m_bufinfo->numAttachedTx = 0;
+
+  //readers waiting for data need to check isDead()
+  m_bufinfo->headSeq++;
+  futexWake(m_bufinfo->headSeq, INT_MAX);
+}
+
+void LockFreeRingBuffer::kill()
+{
+  m_bufinfo->numAttachedTx = 0;
+  clear();
+}
+
+bool LockFreeRingBuffer::isDead() const
+{
+  //NOTE: numAttachedTx == -1 also means we should read data (i.e. initialization pending)
+  return (m_bufinfo->numAttachedTx == 0) and (m_bufinfo->readClaim.load() >= m_bufinfo->head.load());
+}
+
+bool LockFreeRingBuffer::allRxWaiting() const
+{
+  //check for entries first: readers increase nbusy before they take an entry
+  const bool empty = m_bufinfo->readClaim.load() >= m_bufinfo->head.load();
+  return empty and (m_bufinfo->nbusy == 0);
+}
+
+int LockFreeRingBuffer::clear()
+{
+  while (discard() > 0) { }
+  m_bufinfo->ninsq = 0;
+  m_bufinfo->nremq = 0;
+
+  m_bufinfo->headSeq++;
+  futexWake(m_bufinfo->headSeq, INT_MAX);
+  return 0;
+}
+
+int LockFreeRingBuffer::shmid() const
+{
+  return m_id;
+}
+
+int LockFreeRingBuffer::ninsq() const
+{
+  return m_bufinfo->ninsq;
+}
+
+int LockFreeRingBuffer::nremq() const
+{
+  return m_bufinfo->nremq;
+}
+
+void LockFreeRingBuffer::dumpInfo() const
+{
+  // Dump control parameters
+  printf("***** Lock-free Ring Buffer Information ***\n");
+  printf("path = %s\n", m_pathname.c_str());
+  printf("shmsize = %zu\n", m_shmsize);
+  printf("[Buffer Info]\n");
+  printf("bufsize = %lu\n", (unsigned long)m_bufinfo->size);
+  printf("head = %lu\n", (unsigned long)m_bufinfo->head.load());
+  printf("readClaim = %lu\n", (unsigned long)m_bufinfo->readClaim.load());
+  printf("tail = %lu\n", (unsigned long)m_bufinfo->tail.load());
+  printf("nbuf = %d\n", m_bufinfo->nbuf.load());
+  printf("nattached = %d\n", m_bufinfo->nattached.load());
+  printf("nbusy = %d\n", m_bufinfo->nbusy.load());
+  printf("numAttachedTx = %d\n", m_bufinfo->numAttachedTx.load());
+  printf("ninsq = %d\n", m_bufinfo->ninsq.load());
+  printf("nremq = %d\n", m_bufinfo->nremq.load());
+}
@@ -13,6 +13,11 @@
 #include <TMessage.h>
 #include <RZip.h>
 
+#include <sys/time.h>
+
+#include <cstring>
+#include <new>
+
 using namespace std;
 using namespace Belle2;
 
@@ -33,18 +38,25 @@ MsgHandler::MsgHandler(int complevel):
   //If disabled, streamers will crash when reading data.
   TMessage::EnableSchemaEvolutionForAll();
   m_msg->SetWriteMode();
+  clear();
 }
 
 MsgHandler::~MsgHandler()  = default;
 
 void MsgHandler::clear()
 {
-  m_buf.clear();
+  //the objects are added behind the space for the EvtHeader, so encode_msg_inplace() doesn't need to copy them
+  m_buf.resize(sizeof(EvtHeader));
   m_compBuf.clear();
+  m_encodedMsg.reset();
 }
 
 void MsgHandler::add(const TObject* obj, const string& name)
 {
+  //start a new message after encode_msg_inplace(), like after encode_msg()
+  if (m_encodedMsg)
+    clear();
+
   m_msg->WriteObject(obj);
 
   int len = m_msg->Length();
@@ -64,31 +76,30 @@ void MsgHandler::add(const TObject* obj, const string& name)
   m_msg->Reset();
 }
 
-EvtMessage* MsgHandler::encode_msg(ERecordType rectype)
+CharBuffer& MsgHandler::finalize(ERecordType rectype)
 {
-  if (rectype == MSG_TERMINATE) {
-    auto* eod = new EvtMessage(nullptr, 0, rectype);
-    return eod;
-  }
+  // termination messages have no content
+  if (rectype == MSG_TERMINATE)
+    m_buf.resize(sizeof(EvtHeader));
 
   // which buffer to send? defaults to uncompressed
   auto buf = &m_buf;
   unsigned int flags = 0;
   // but if we have compression enabled then please compress.
-  if (m_complevel > 0) {
+  if (m_complevel > 0 and rectype != MSG_TERMINATE) {
     // make sure buffer for the compression is big enough.
     m_compBuf.resize(m_buf.size());
     // And call the root compression function
     const int algorithm = m_complevel / 100;
     const int level = m_complevel % 100;
-    int irep{0}, nin{(int)m_buf.size()}, nout{nin};
-    R__zipMultipleAlgorithm(level, &nin, m_buf.data(), &nout, m_compBuf.data(), &irep,
+    int irep{0}, nin{(int)(m_buf.size() - sizeof(EvtHeader))}, nout{nin};
+    R__zipMultipleAlgorithm(level, &nin, m_buf.data() + sizeof(EvtHeader), &nout, m_compBuf.data() + sizeof(EvtHeader), &irep,
                             (ROOT::RCompressionSetting::EAlgorithm::EValues) algorithm);
     // it returns the number of bytes of the output in irep. If that is zero or
     // to big compression failed and we transmit uncompressed.
     if (irep > 0 && irep <= nin) {
       //set correct size of compressed message
-      m_compBuf.resize(irep);
+      m_compBuf.resize(sizeof(EvtHeader) + irep);
       // and set pointer to correct buffer for creating message
       buf = &m_compBuf;
       // also add a flag indicating it's compressed
@@ -96,13 +107,37 @@ EvtMessage* MsgHandler::encode_msg(ERecordType rectype)
     }
   }
 
-  auto* evtmsg = new EvtMessage(buf->data(), buf->size(), rectype);
-  evtmsg->setMsgFlags(flags);
+  // zero the bytes up to the next integer boundary
+  const size_t size = buf->size();
+  const size_t paddedSize = sizeof(int) * ((size + sizeof(int) - 1) / sizeof(int));
+  buf->resize(paddedSize);
+  memset(buf->data() + size, 0, paddedSize - size);
+
+  //initialize message header properly
+  new (buf->data()) EvtHeader(size, rectype);
+  EvtMessage evtmsg(buf->data());
+  struct timeval tv;
+  gettimeofday(&tv, nullptr);
+  evtmsg.setTime(tv);
+  evtmsg.setMsgFlags(flags);
+  return *buf;
+}
+
+EvtMessage* MsgHandler::encode_msg(ERecordType rectype)
+{
+  auto* evtmsg = new EvtMessage();
+  evtmsg->buffer(finalize(rectype).data()); //copies the message
   clear();
 
   return evtmsg;
 }
 
+EvtMessage* MsgHandler::encode_msg_inplace(ERecordType rectype)
+{
+  m_encodedMsg.emplace(finalize(rectype).data());
+  return &m_encodedMsg.value();
+}
+
 void MsgHandler::decode_msg(EvtMessage* msg, vector<TObject*>& objlist,
                             vector<string>& namelist)
 {
@@ -16,7 +16,7 @@
 using namespace std;
 using namespace Belle2;
 
-RxModule::RxModule(RingBuffer* rbuf) : Module(), m_streamer(nullptr), m_nrecv(-1)
+RxModule::RxModule(EventRingBuffer* rbuf) : Module(), m_streamer(nullptr), m_nrecv(-1)
 {
   //Set module properties
   setDescription("Decode data from RingBuffer into DataStore");
@@ -43,25 +43,25 @@ void RxModule::initStreamer()
 
 void RxModule::readEvent()
 {
-  auto* evtbuf = new char[EvtMessage::c_MaxEventSize];
   while (!m_rbuf->isDead()) {
-    int size = m_rbuf->remq((int*)evtbuf);
-    if (size != 0) {
+    int size = 0;
+    //restore directly from the ring buffer, the space is only reused after releaseInPlace()
+    const int* evtbuf = m_rbuf->readInPlace(size);
+    if (evtbuf) {
       B2DEBUG(35, "Rx: got an event from RingBuffer, size=" << size);
 
       // Restore objects in DataStore
-      EvtMessage evtmsg(evtbuf);
+      EvtMessage evtmsg(reinterpret_cast<char*>(const_cast<int*>(evtbuf)));
       m_streamer->restoreDataStore(&evtmsg);
+      m_rbuf->releaseInPlace();
       // Restore the event dependent random number object from Datastore
       if (m_randomgenerator.isValid()) {
         RandomNumbers::getEventRandomGenerator() = *m_randomgenerator;
       }
       break;
     }
-    usleep(20);
+    m_rbuf->waitForEntries(1000);
   }
-
-  delete[] evtbuf;
 }
 
 void RxModule::initialize()
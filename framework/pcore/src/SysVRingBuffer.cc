@@ -0,0 +1,44 @@
+/**************************************************************************
+ * basf2 (Belle II Analysis Software Framework)                           *
+ * Author: The Belle II Collaboration                                     *
+ *                                                                        *
+ * See git log for contributors and copyright holders.                    *
+ * This file is licensed under LGPL-3.0, see LICENSE.md.                  *
+ **************************************************************************/
+
+#include <framework/pcore/SysVRingBuffer.h>
+#include <framework/pcore/EvtMessage.h>
+
+#include <algorithm>
+
+#include <unistd.h>
+
+using namespace Belle2;
+
+namespace {
+  /** Polling interval of the original TxModule and RxModule. */
+  const int c_pollMicroSeconds = 20;
+}
+
+SysVRingBuffer::SysVRingBuffer(const std::string& name, unsigned int nwords) : m_rbuf(name, nwords)
+{
+}
+
+const int* SysVRingBuffer::readInPlace(int& nwords)
+{
+  //not initialized, only the pages actually used are touched
+  if (!m_readBuffer)
+    m_readBuffer.reset(new int[EvtMessage::c_MaxEventSize / sizeof(int)]);
+  nwords = m_rbuf.remq(m_readBuffer.get());
+  return (nwords != 0) ? m_readBuffer.get() : nullptr;
+}
+
+void SysVRingBuffer::waitForEntries(int timeoutMicroSeconds) const
+{
+  usleep(std::min(timeoutMicroSeconds, c_pollMicroSeconds));
+}
+
+void SysVRingBuffer::waitForSpace(int timeoutMicroSeconds) const
+{
+  usleep(std::min(timeoutMicroSeconds, c_pollMicroSeconds));
+}
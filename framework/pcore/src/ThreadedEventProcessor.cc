@@ -0,0 +1,468 @@
+/**************************************************************************
+ * basf2 (Belle II Analysis Software Framework)                           *
+ * Author: The Belle II Collaboration                                     *
+ *                                                                        *
+ * See git log for contributors and copyright holders.                    *
+ * This file is licensed under LGPL-3.0, see LICENSE.md.                  *
+ **************************************************************************/
+
+#include <framework/pcore/ThreadedEventProcessor.h>
+#include <framework/pcore/EventQueue.h>
+#include <framework/pcore/EvtMessage.h>
+#include <framework/pcore/DataStoreStreamer.h>
+
+#include <framework/core/Environment.h>
+#include <framework/datastore/DataStore.h>
+#include <framework/logging/LogSystem.h>
+#include <framework/utilities/ScopeGuard.h>
+
+#include <TROOT.h>
+
+#include <csignal>
+#include <future>
+#include <thread>
+
+using namespace std;
+using namespace Belle2;
+
+namespace {
+  /** Sends the DataStore contents to the next stage (in-memory counterpart of TxModule). */
+  class ThreadTxModule : public Module {
+  public:
+    /** Constructor */
+    explicit ThreadTxModule(EventQueue* queue) : m_queue(queue)
+    {
+      setDescription("Encode DataStore into EventQueue");
+      setPropertyFlags(c_Input | c_InternalSerializer);
+      setType("Tx");
+      setName("Tx");
+    }
+
+    /** Create the streamer */
+    void initialize() override
+    {
+      m_streamer.reset(new DataStoreStreamer());
+      if (!Environment::Instance().getStreamingObjects().empty())
+        m_streamer->setStreamingObjects(Environment::Instance().getStreamingObjects());
+    }
+
+    /** Stream event and persistent objects and pass them on */
+    void event() override { m_queue->push(m_streamer->streamDataStore(true, true)); }
+
+    /** Delete the streamer */
+    void terminate() override { m_streamer.reset(); }
+
+  private:
+    EventQueue* m_queue; /**< queue to the next stage. */
+    std::unique_ptr<DataStoreStreamer> m_streamer; /**< DataStore streamer. */
+  };
+
+  /** Restores the DataStore contents sent by the previous stage (in-memory counterpart of RxModule).
+   *
+   *  Leaves the DataStore empty once the queue is closed, which ends the event loop of the stage.
+   */
+  class ThreadRxModule : public Module {
+  public:
+    /** Constructor */
+    explicit ThreadRxModule(EventQueue* queue) : m_queue(queue)
+    {
+      setDescription("Decode data from EventQueue into DataStore");
+      setPropertyFlags(c_Input | c_InternalSerializer);
+      setType("Rx");
+      setName("Rx");
+    }
+
+    /** Create the streamer */
+    void initialize() override { m_streamer.reset(new DataStoreStreamer()); }
+
+    /** Wait for the next event and restore it */
+    void event() override
+    {
+      EvtMessage* msg = m_queue->pop();
+      if (!msg)
+        return;
+      m_streamer->restoreDataStore(msg);
+      delete msg;
+    }
+
+    /** Delete the streamer */
+    void terminate() override { m_streamer.reset(); }
+
+  private:
+    EventQueue* m_queue; /**< queue from the previous stage. */
+    std::unique_ptr<DataStoreStreamer> m_streamer; /**< DataStore streamer. */
+  };
+}
+
+/** Event loop of one stage. Only the input stage updates the process wide state. */
+class ThreadedEventProcessor::Stage : public EventProcessor {
+public:
+  /** Constructor
+   *
+   * @param serialMutex if not nullptr, all calls to modules (except the internal queue modules) lock this mutex.
+   * @param beforeBeginRun called before a new run is started, if set.
+   * @param updateGlobalState see EventProcessor::m_updateGlobalState.
+   */
+  Stage(std::mutex* serialMutex, std::function<void()> beforeBeginRun, bool updateGlobalState):
+    m_serialMutex(serialMutex), m_beforeBeginRun(std::move(beforeBeginRun))
+  {
+    m_updateGlobalState = updateGlobalState;
+  }
+
+  /** Initialize all modules. */
+  void initialize(const ModulePtrList& modules, bool setEventInfo) { processInitialize(modules, setEventInfo); }
+
+  /** Process events until the master module stops.
+   *
+   * @return signal which stopped the processing, or 0.
+   */
+  int run(const PathPtr& path, const ModulePtrList& modules, long maxEvent, bool isInputStage)
+  {
+    try {
+      processCore(path, modules, maxEvent, isInputStage);
+    } catch (StoppedBySignalException& e) {
+      return e.signal;
+    }
+    return 0;
+  }
+
+  /** Terminate all modules. */
+  void terminate(const ModulePtrList& modules) { processTerminate(modules); }
+
+  /** Module providing the EventMetaData, if any. */
+  const Module* getMaster() const { return m_master; }
+
+  /** Statistics collected by this stage. */
+  ProcessStatistics& getStatistics() { return *m_processStatisticsPtr; }
+
+protected:
+  /** Serialize calls to modules not running in worker threads. */
+  void callEvent(Module* module) override
+  {
+    if (!m_serialMutex or module->hasProperties(Module::c_InternalSerializer)) {
+      EventProcessor::callEvent(module);
+      return;
+    }
+    std::lock_guard<std::mutex> lock(*m_serialMutex);
+    EventProcessor::callEvent(module);
+  }
+
+  /** Wait for the previous run to be finished if requested, then call beginRun() of all modules. */
+  void processBeginRun(bool skipDB) override
+  {
+    if (m_beforeBeginRun)
+      m_beforeBeginRun();
+    std::unique_lock<std::mutex> lock = lockSerial();
+    EventProcessor::processBeginRun(skipDB);
+  }
+
+  /** Call endRun() of all modules. */
+  void processEndRun() override
+  {
+    std::unique_lock<std::mutex> lock = lockSerial();
+    EventProcessor::processEndRun();
+  }
+
+private:
+  /** Lock m_serialMutex, if set. */
+  std::unique_lock<std::mutex> lockSerial() const
+  {
+    return m_serialMutex ? std::unique_lock<std::mutex>(*m_serialMutex) : std::unique_lock<std::mutex>();
+  }
+
+  std::mutex* m_serialMutex; /**< mutex shared by the serial stages, or nullptr. */
+  std::function<void()> m_beforeBeginRun; /**< called before a new run is started. */
+};
+
+
+ThreadedEventProcessor::ThreadedEventProcessor() = default;
+
+ThreadedEventProcessor::~ThreadedEventProcessor() = default;
+
+void ThreadedEventProcessor::process(const PathPtr& spath, long maxEvent)
+{
+  if (spath->getModules().size() == 0) return;
+
+  const int numThreads = Environment::Instance().getNumberThreads();
+  if (numThreads <= 0)
+    B2FATAL("ThreadedEventProcessor::process() called for serial processing! Most likely a bug in Framework.");
+
+  maxEvent = getMaximumEventNumber(maxEvent);
+
+  // 1. Analyze start path and split it into the stages
+  analyzePath(spath);
+
+  B2INFO("Input Path " << m_inputPath->getPathString());
+  if (m_mainPath) {
+    if (m_mainPath->getModules().size() <= 5) {
+      B2INFO("Main Path " << m_mainPath->getPathString());
+    } else {
+      B2INFO("Main Path [" << m_mainPath->getModules().front()->getName() << " -> ... (" << m_mainPath->getModules().size() - 2 <<
+             " further modules) ... -> " << m_mainPath->getModules().back()->getName() << " ]");
+    }
+  }
+  if (m_outputPath) {
+    B2INFO("Output Path " << m_outputPath->getPathString());
+  }
+  if (not m_mainPath) {
+    B2WARNING("Cannot run any modules in multiple threads since none of them is flagged as thread safe, falling back to single-core mode."
+              << LogVar("number of threads", numThreads));
+    EventProcessor::process(spath, maxEvent);
+    return;
+  }
+  if (m_outputPath) {
+    //the main thread holds the python interpreter lock while processing
+    for (const ModulePtr& module : m_outputPath->buildModulePathList()) {
+      if (module->getType() == "PyModule") {
+        B2WARNING("Python modules can only run before the thread safe modules, but " << module->getName()
+                  << " comes after them, falling back to single-core mode.");
+        EventProcessor::process(spath, maxEvent);
+        return;
+      }
+    }
+  }
+
+  //must be done before any thread is started
+  ROOT::EnableThreadSafety();
+
+  //each stage holds at most a few events more than it is processing
+  m_inputQueue.reset(new EventQueue(2 * numThreads));
+  m_inputPath->addModule(ModulePtr(new ThreadTxModule(m_inputQueue.get())));
+  if (m_outputPath)
+    m_outputQueue.reset(new EventQueue(2 * numThreads));
+
+  // 2. init statistics in the order of the original path
+  {
+    m_processStatisticsPtr.registerInDataStore();
+    if (!m_processStatisticsPtr)
+      m_processStatisticsPtr.create();
+    Path mergedPath;
+    mergedPath.addPath(m_inputPath);
+    mergedPath.addPath(m_mainPath);
+    if (m_outputPath)
+      mergedPath.addPath(m_outputPath);
+    for (const ModulePtr& module : mergedPath.buildModulePathList())
+      m_processStatisticsPtr->initModule(module.get());
+  }
+
+  // 3. Initialization: input stage in this thread, then all other stages one after the other
+  Stage input(&m_serialMutex, [this] { waitUntilIdle(); }, true);
+  const ModulePtrList inputModules = m_inputPath->buildModulePathList();
+  m_inputQueue->addProducer();
+  input.initialize(inputModules, true);
+
+  if (!input.getMaster()) {
+    B2ERROR("There is no module that provides event and run numbers (EventMetaData). You must add either the EventInfoSetter or an input module (e.g. RootInput) to the beginning of your path.");
+  }
+
+  //the workers receive everything registered by the input stage
+  const std::shared_ptr<const Registrations> inputRegistrations = snapshotRegistrations();
+
+  std::vector<std::unique_ptr<StageContext>> stages;
+  std::vector<std::thread> threads;
+  bool inputDone = false;
+  //make sure all threads are stopped, also when leaving with an exception
+  ScopeGuard stopThreads([&]() {
+    if (!inputDone)
+      m_inputQueue->removeProducer();
+    for (std::thread& thread : threads)
+      thread.join();
+  });
+
+  for (int i = 0; i < numThreads; i++)
+    stages.push_back(createWorkerContext());
+  if (m_outputPath)
+    stages.push_back(createOutputContext());
+
+  for (auto& stage : stages) {
+    //the output stage receives everything registered by the workers. The snapshot of the first worker
+    //is complete once it signalled its initialization, and never modified afterwards.
+    stage->registrations = stage->serial ? stages.front()->registered : inputRegistrations;
+    //register with the queues before the thread is started, they are closed once all of them have left
+    if (stage->input) stage->input->addConsumer();
+    if (stage->output) stage->output->addProducer();
+
+    std::promise<void> initialized;
+    std::future<void> initializedFuture = initialized.get_future();
+    threads.emplace_back(&ThreadedEventProcessor::runStage, this, std::ref(*stage), [&initialized]() { initialized.set_value(); });
+    initializedFuture.wait();
+    if (stage->exception or LogSystem::Instance().getMessageCounter(LogConfig::c_Error) != 0)
+      break;
+  }
+
+  //Check if errors appeared. If yes, don't start the event processing.
+  const int numLogError = LogSystem::Instance().getMessageCounter(LogConfig::c_Error);
+  bool initFailed = (numLogError != 0) or !input.getMaster();
+  for (auto& stage : stages)
+    initFailed |= bool(stage->exception);
+
+  // 4. Event loop of the input stage
+  int signal = 0;
+  if (!initFailed) {
+    installMainSignalHandlers();
+    signal = input.run(m_inputPath, inputModules, maxEvent, true);
+  }
+  m_inputQueue->removeProducer();
+  inputDone = true;
+  for (std::thread& thread : threads)
+    thread.join();
+  threads.clear();
+
+  // 5. collect results of all threads
+  for (auto& stage : stages) {
+    if (stage->exception)
+      std::rethrow_exception(stage->exception);
+    for (const auto& moduleStatistics : stage->statistics)
+      m_processStatisticsPtr->getStatistics(moduleStatistics.first).update(moduleStatistics.second);
+    if (signal == 0)
+      signal = stage->signal;
+  }
+  if (initFailed) {
+    B2FATAL(numLogError << " ERROR(S) occurred! The processing of events will not be started.");
+  }
+  if (signal != 0 and signal != SIGINT) {
+    // close all open ROOT files, ROOT's exit handler will crash otherwise
+    gROOT->GetListOfFiles()->Delete();
+    B2FATAL("Execution stopped by signal " << signal << "!");
+  }
+
+  input.terminate(inputModules);
+
+  LogSystem::Instance().printErrorSummary();
+
+  if (signal == SIGINT) {
+    B2ERROR("Processing aborted via SIGINT, terminating. Output files have been closed safely and should be readable. "
+            "However processing was NOT COMPLETE. The output files do contain only events processed until this point.");
+    installSignalHandler(SIGINT, SIG_DFL);
+    raise(SIGINT);
+  }
+}
+
+void ThreadedEventProcessor::analyzePath(const PathPtr& path)
+{
+  PathPtr inpath(new Path);
+  PathPtr mainpath(new Path);
+  PathPtr outpath(new Path);
+
+  int stage = 0; //0: in, 1: event/main, 2: out
+  for (const ModulePtr& module : path->getModules()) {
+    //the main path is cloned for each thread, but clones share condition paths and python modules
+    bool threadSafe = module->hasProperties(Module::c_ThreadSafe) and !module->hasCondition() and module->getType() != "PyModule";
+    //the input stage provides the events, it needs at least one module
+    if (inpath->isEmpty())
+      threadSafe = false;
+
+    //update stage?
+    if ((stage == 0 and threadSafe) or (stage == 1 and !threadSafe))
+      stage++;
+
+    if (stage == 0)
+      inpath->addModule(module);
+    if (stage == 1)
+      mainpath->addModule(module);
+    if (stage == 2)
+      outpath->addModule(module);
+  }
+
+  m_inputPath = inpath;
+  if (!mainpath->isEmpty())
+    m_mainPath = mainpath;
+  if (!outpath->isEmpty())
+    m_outputPath = outpath;
+}
+
+std::unique_ptr<ThreadedEventProcessor::StageContext> ThreadedEventProcessor::createWorkerContext() const
+{
+  std::unique_ptr<StageContext> context(new StageContext);
+  context->input = m_inputQueue.get();
+  context->output = m_outputQueue.get();
+
+  context->path.reset(new Path);
+  context->path->addModule(ModulePtr(new ThreadRxModule(context->input)));
+  for (const ModulePtr& module : m_mainPath->getModules()) {
+    ModulePtr clone = std::static_pointer_cast<Module>(module->clone());
+    context->originals[clone.get()] = module.get();
+    context->path->addModule(clone);
+  }
+  if (context->output)
+    context->path->addModule(ModulePtr(new ThreadTxModule(context->output)));
+  return context;
+}
+
+std::unique_ptr<ThreadedEventProcessor::StageContext> ThreadedEventProcessor::createOutputContext() const
+{
+  std::unique_ptr<StageContext> context(new StageContext);
+  context->input = m_outputQueue.get();
+  context->serial = true;
+
+  context->path.reset(new Path);
+  context->path->addModule(ModulePtr(new ThreadRxModule(context->input)));
+  context->path->addPath(m_outputPath);
+  return context;
+}
+
+std::shared_ptr<const ThreadedEventProcessor::Registrations> ThreadedEventProcessor::snapshotRegistrations()
+{
+  auto registrations = std::make_shared<Registrations>();
+  for (auto durability : {DataStore::c_Event, DataStore::c_Persistent}) {
+    for (const auto& entry : DataStore::Instance().getStoreEntryMap(durability)) {
+      const StoreEntry& storeEntry = entry.second;
+      registrations->push_back({entry.first, durability, storeEntry.objClass, storeEntry.isArray, storeEntry.dontWriteOut});
+    }
+  }
+  return registrations;
+}
+
+void ThreadedEventProcessor::copyRegistrations(const Registrations& registrations)
+{
+  DataStore& store = DataStore::Instance();
+  for (const Registration& registration : registrations) {
+    store.registerEntry(registration.name, DataStore::EDurability(registration.durability), registration.objClass,
+                        registration.isArray, registration.dontWriteOut ? DataStore::c_DontWriteOut : DataStore::c_WriteOut);
+  }
+}
+
+void ThreadedEventProcessor::runStage(StageContext& context, const std::function<void()>& initialized)
+{
+  bool isInitialized = false;
+  try {
+    DataStore::ThreadLocalInstance dataStore;
+    copyRegistrations(*context.registrations);
+
+    Stage stage(context.serial ? &m_serialMutex : nullptr, nullptr, false);
+    const ModulePtrList modules = context.path->buildModulePathList();
+    stage.initialize(modules, false);
+    context.registered = snapshotRegistrations();
+    isInitialized = true;
+    initialized();
+
+    context.signal = stage.run(context.path, modules, 0, false);
+    stage.terminate(modules);
+
+    for (const ModulePtr& module : modules) {
+      if (module->hasProperties(Module::c_InternalSerializer))
+        continue;
+      const auto original = context.originals.find(module.get());
+      const Module* statisticsModule = (original != context.originals.end()) ? original->second : module.get();
+      context.statistics.emplace_back(statisticsModule, stage.getStatistics().getStatistics(module.get()));
+    }
+  } catch (...) {
+    context.exception = std::current_exception();
+  }
+
+  //let the other stages know we're gone
+  if (context.input) context.input->removeConsumer();
+  if (context.output) context.output->removeProducer();
+
+  if (!isInitialized)
+    initialized();
+}
+
+void ThreadedEventProcessor::waitUntilIdle() const
+{
+  //same as TxModule::beginRun(): wait until all events of the previous run have been processed.
+  //Workers only wait for new events after passing on their last one, so the output queue is complete once the input queue is idle.
+  m_inputQueue->waitUntilIdle();
+  if (m_outputQueue)
+    m_outputQueue->waitUntilIdle();
+}
@@ -14,10 +14,12 @@
 #include <framework/core/RandomNumbers.h>
 #include <framework/core/Environment.h>
 
+#include <unistd.h>
+
 using namespace std;
 using namespace Belle2;
 
-TxModule::TxModule(RingBuffer* rbuf) : Module(), m_streamer(nullptr), m_blockingInsert(true)
+TxModule::TxModule(EventRingBuffer* rbuf) : Module(), m_streamer(nullptr), m_blockingInsert(true)
 {
   //Set module properties
   setDescription("Encode DataStore into RingBuffer");
@@ -80,7 +82,8 @@ void TxModule::event()
   }
 
   // Stream DataStore in EvtMessage, also stream transient objects and objects of durability c_Persistent
-  EvtMessage* msg = m_streamer->streamDataStore(true, true);
+  // The message stays in the streamer's buffer and is copied only once, into the ring buffer
+  EvtMessage* msg = m_streamer->streamDataStoreInPlace(true, true);
 
   // Put the message in ring buffer
   for (;;) {
@@ -89,16 +92,14 @@ void TxModule::event()
     if (!m_blockingInsert) {
       B2WARNING("Ring buffer seems full, removing some previous data.");
       m_rbuf->remq(nullptr);
+      continue;
     }
-    //    usleep(200);
-    usleep(20);
+    //wake up as soon as a reader takes an entry out
+    m_rbuf->waitForSpace(1000);
   }
   m_nsent++;
 
   B2DEBUG(35, "Tx: objs sent in buffer. Size = " << msg->size());
-
-  // Release EvtMessage buffer
-  delete msg;
 }
 
 void TxModule::endRun()
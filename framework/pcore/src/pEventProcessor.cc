@@ -8,7 +8,8 @@
 
 #include <framework/pcore/pEventProcessor.h>
 #include <framework/pcore/ProcHandler.h>
-#include <framework/pcore/RingBuffer.h>
+#include <framework/pcore/LockFreeRingBuffer.h>
+#include <framework/pcore/SysVRingBuffer.h>
 #include <framework/pcore/RxModule.h>
 #include <framework/pcore/TxModule.h>
 #include <framework/pcore/DataStoreStreamer.h>
@@ -91,9 +92,9 @@ void pEventProcessor::gotSigINT()
 
 void pEventProcessor::killRingBuffers()
 {
+  //kill() is async-signal-safe for all ring buffers
   m_rbin->kill();
-  //these might be locked by _this_ process, so we cannot escape
-  m_rbout->kill(); //atomic, so doesn't lock
+  m_rbout->kill();
 }
 
 void pEventProcessor::clearFileList()
@@ -370,16 +371,17 @@ void pEventProcessor::analyzePath(const PathPtr& path)
     m_outputPath = outpath;
 }
 
-RingBuffer* pEventProcessor::connectViaRingBuffer(const char* name, const PathPtr& a, PathPtr& b)
+EventRingBuffer* pEventProcessor::connectViaRingBuffer(const char* name, const PathPtr& a, PathPtr& b)
 {
   //create ringbuffers and add rx/tx where needed
   const char* inrbname = getenv(name);
-  RingBuffer* rbuf;
+  EventRingBuffer* rbuf;
   if (inrbname == nullptr) {
-    rbuf = new RingBuffer();
+    rbuf = new LockFreeRingBuffer();
   } else {
+    //named buffers are attached to by external programs, which expect a SysV RingBuffer
     string rbname(inrbname + to_string(0)); //currently at most one input, one output buffer
-    rbuf = new RingBuffer(rbname.c_str(), RingBuffer::c_DefaultSize);
+    rbuf = new SysVRingBuffer(rbname, RingBuffer::c_DefaultSize);
   }
 
   // Insert Tx at the end of current path
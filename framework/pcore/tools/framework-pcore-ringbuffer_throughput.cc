@@ -0,0 +1,109 @@
+/**************************************************************************
+ * basf2 (Belle II Analysis Software Framework)                           *
+ * Author: The Belle II Collaboration                                     *
+ *                                                                        *
+ * See git log for contributors and copyright holders.                    *
+ * This file is licensed under LGPL-3.0, see LICENSE.md.                  *
+ **************************************************************************/
+
+#include <framework/pcore/LockFreeRingBuffer.h>
+#include <framework/pcore/RingBuffer.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+using namespace Belle2;
+
+namespace {
+  /** Sleep until the ring buffer is likely to contain data. */
+  void waitForData(RingBuffer&) { usleep(20); }
+  /** Sleep until the ring buffer is likely to contain data. */
+  void waitForData(LockFreeRingBuffer& rb) { rb.waitForEntries(1000); }
+  /** Sleep until the ring buffer is likely to have space. */
+  void waitForSpace(RingBuffer&) { usleep(20); }
+  /** Sleep until the ring buffer is likely to have space. */
+  void waitForSpace(LockFreeRingBuffer& rb) { rb.waitForSpace(1000); }
+
+  /** Send nMessages messages of the given size from one thread to nReaders threads, like TxModule/RxModule.
+   *
+   * Every reader attaches to the named buffer with its own instance.
+   * @return number of messages received by all readers, the elapsed time is stored in seconds.
+   */
+  template<class Buffer> int transfer(const std::string& name, int nwords, int messageWords, int nMessages, int nReaders,
+                                      double& seconds)
+  {
+    Buffer writer(name, nwords);
+    writer.txAttached();
+    std::atomic<int> received{0};
+    std::atomic<int> started{0};
+    std::vector<std::thread> readers;
+    for (int i = 0; i < nReaders; i++) {
+      readers.emplace_back([&]() {
+        Buffer reader(name);
+        std::vector<int> buffer(messageWords);
+        started++;
+        while (!reader.isDead()) {
+          if (reader.remq(buffer.data()) == 0) {
+            waitForData(reader);
+            continue;
+          }
+          received++;
+        }
+      });
+    }
+    while (started < nReaders)
+      std::this_thread::yield();
+
+    std::vector<int> message(messageWords);
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < nMessages; i++) {
+      message[0] = i;
+      while (writer.insq(message.data(), messageWords) < 0)
+        waitForSpace(writer);
+    }
+    writer.txDetached();
+    for (std::thread& reader : readers)
+      reader.join();
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return received;
+  }
+}
+
+/** Compare the throughput of the semaphore based and the lock-free ring buffer for different message sizes.
+ *
+ * Usage: framework-pcore-ringbuffer_throughput [number of readers]
+ */
+int main(int argc, char* argv[])
+{
+  const int nReaders = (argc > 1) ? std::atoi(argv[1]) : 2;
+  if (nReaders <= 0) {
+    std::cerr << "Usage: " << argv[0] << " [number of readers]\n";
+    return 1;
+  }
+  const int nwords = 4000000; //16 MB
+  const std::string prefix = "throughput_" + std::to_string(getpid()) + "_";
+  int result = 0;
+  for (int messageBytes : {64, 1024, 16 * 1024, 256 * 1024}) {
+    const int messageWords = messageBytes / sizeof(int);
+    const int nMessages = std::min(50000, 256 * 1024 * 1024 / messageBytes);
+    double oldSeconds = 0;
+    double newSeconds = 0;
+    const int oldReceived = transfer<RingBuffer>(prefix + "old", nwords, messageWords, nMessages, nReaders, oldSeconds);
+    const int newReceived = transfer<LockFreeRingBuffer>(prefix + "new", nwords, messageWords, nMessages, nReaders, newSeconds);
+    if (oldReceived != nMessages or newReceived != nMessages) {
+      std::cerr << "Lost messages: sent " << nMessages << ", received " << oldReceived << " (RingBuffer), " << newReceived <<
+                " (LockFreeRingBuffer)\n";
+      result = 1;
+    }
+    std::cout << messageBytes << " byte messages, " << nReaders << " readers: RingBuffer " << nMessages / oldSeconds <<
+              " msg/s, LockFreeRingBuffer " << nMessages / newSeconds << " msg/s\n";
+  }
+  return result;
+}
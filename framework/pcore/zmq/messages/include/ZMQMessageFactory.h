@@ -27,6 +27,14 @@ namespace Belle2 {
       return createMessage<ZMQIdMessage>(msgIdentity, msgType, eventMessage);
     }
 
+    /// Create an ID Message out of an identity, the type and an event message, which is sent without copying
+    static auto createMessage(const std::string& msgIdentity,
+                              const EMessageTypes msgType,
+                              std::unique_ptr<EvtMessage>&& eventMessage)
+    {
+      return createMessage<ZMQIdMessage>(msgIdentity, msgType, std::move(eventMessage));
+    }
+
     /// Create an ID Message out of an identity, the type and a string
     static auto createMessage(const std::string& msgIdentity,
                               const EMessageTypes msgType,
@@ -101,6 +109,13 @@ namespace Belle2 {
       return createMessage<ZMQNoIdMessage>(msgType, eventMessage);
     }
 
+    /// Create a No-ID Message out of the type and an event message, which is sent without copying
+    static auto createMessage(const EMessageTypes msgType,
+                              std::unique_ptr<EvtMessage>&& eventMessage)
+    {
+      return createMessage<ZMQNoIdMessage>(msgType, std::move(eventMessage));
+    }
+
     /// Create a No-ID Message out of an identity, the type, an event message, and and additional message
     static auto createMessage(const EMessageTypes msgType,
                               const std::unique_ptr<EvtMessage>& eventMessage,
@@ -52,12 +52,19 @@ namespace Belle2 {
       return zmq::message_t(message.c_str(), message.length());
     }
 
-    /// Create a message out of an event message.
+    /// Create a message out of an event message (copies the message).
     static zmq::message_t createZMQMessage(const std::unique_ptr<EvtMessage>& evtMessage)
     {
-      // TODO: here are the messages copied
       return zmq::message_t(evtMessage->buffer(), evtMessage->size());
     }
 
+    /// Create a message out of an event message without copying. ZMQ takes over the event message and deletes it once sent.
+    static zmq::message_t createZMQMessage(std::unique_ptr<EvtMessage>&& evtMessage)
+    {
+      EvtMessage* message = evtMessage.release();
+      return zmq::message_t(message->buffer(), message->size(),
+      [](void*, void* hint) { delete static_cast<EvtMessage*>(hint); }, message);
+    }
+
   };
 }
@@ -186,8 +186,15 @@ void ZMQTxInputModule::event()
     auto eventMessage = m_streamer.stream();
 
     if (eventMessage->size() > 0) {
-      auto message = ZMQMessageFactory::createMessage(std::to_string(nextWorker), EMessageTypes::c_eventMessage, eventMessage);
-      m_zmqClient.send(std::move(message));
+      if (m_param_useEventBackup) {
+        //the message is kept in the backup list, so send a copy
+        auto message = ZMQMessageFactory::createMessage(std::to_string(nextWorker), EMessageTypes::c_eventMessage, eventMessage);
+        m_zmqClient.send(std::move(message));
+      } else {
+        auto message = ZMQMessageFactory::createMessage(std::to_string(nextWorker), EMessageTypes::c_eventMessage,
+                                                        std::move(eventMessage));
+        m_zmqClient.send(std::move(message));
+      }
       B2DEBUG(30, "Having send message to worker " << nextWorker);
 
       if (m_param_useEventBackup) {
@@ -35,8 +35,8 @@ void ZMQTxWorkerModule::event()
       m_firstEvent = false;
     }
 
-    const auto& evtMessage = m_streamer.stream();
-    auto message = ZMQMessageFactory::createMessage(EMessageTypes::c_eventMessage, evtMessage);
+    auto evtMessage = m_streamer.stream();
+    auto message = ZMQMessageFactory::createMessage(EMessageTypes::c_eventMessage, std::move(evtMessage));
     m_zmqClient.send(std::move(message));
     //    B2INFO ( "ZMQTxWorker : an event sent" );
   } catch (zmq::error_t& ex) {
@@ -100,6 +100,16 @@ namespace Belle2 {
     */
     static int getNumberProcesses();
 
+    /**
+     * Function to set number of worker threads for multi-threaded processing.
+    */
+    static void setNumberThreads(int numThreads);
+
+    /**
+     * Function to get number of worker threads for multi-threaded processing.
+    */
+    static int getNumberThreads();
+
     /**
      * Function to set the path to the file where the pickled path is stored
      *
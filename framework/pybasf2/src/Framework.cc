@@ -17,6 +17,7 @@
 #include <framework/database/DBStore.h>
 #include <framework/database/Database.h>
 #include <framework/pcore/pEventProcessor.h>
+#include <framework/pcore/ThreadedEventProcessor.h>
 #include <framework/pcore/ZMQEventProcessor.h>
 #include <framework/pcore/zmq/utils/ZMQAddressUtils.h>
 #include <framework/utilities/FileSystem.h>
@@ -128,7 +129,10 @@ void Framework::process(PathPtr startPath, long maxEvent)
     auto& environment = Environment::Instance();
 
     already_executed = true;
-    if (environment.getNumberProcesses() == 0) {
+    if (environment.getNumberProcesses() == 0 and environment.getNumberThreads() > 0) {
+      ThreadedEventProcessor processor;
+      processor.process(startPath, maxEvent);
+    } else if (environment.getNumberProcesses() == 0) {
       EventProcessor processor;
       processor.setProfileModuleName(environment.getProfileModuleName());
       processor.process(startPath, maxEvent);
@@ -177,6 +181,18 @@ int Framework::getNumberProcesses()
 }
 
 
+void Framework::setNumberThreads(int numThreads)
+{
+  Environment::Instance().setNumberThreads(numThreads);
+}
+
+
+int Framework::getNumberThreads()
+{
+  return Environment::Instance().getNumberThreads();
+}
+
+
 void Framework::setPicklePath(const std::string& path)
 {
   Environment::Instance().setPicklePath(path);
@@ -388,6 +404,31 @@ Parameters:
 )DOCSTRING");
   def("get_nprocesses", &Framework::getNumberProcesses, R"DOCSTRING(
 Gets number of worker processes for parallel processing. 0 disables parallel processing
+)DOCSTRING");
+  def("set_nthreads", &Framework::setNumberThreads, R"DOCSTRING(
+Sets number of worker threads for multi-threaded event processing.
+
+Only modules flagged as thread safe (`ModulePropFlags.THREADSAFE`) are run in
+the worker threads, each of which processes complete events in its own
+DataStore. All other modules at the beginning and the end of the path run
+serially in the input and output stages. Ignored if parallel processing with
+`set_nprocesses` is enabled.
+
+.. warning:: Only few modules are flagged as thread safe so far: the common
+   analysis modules (ParticleLoader, ParticleListManipulator, ParticleSelector,
+   ParticleCombiner, MCMatcherParticles, VariablesToExtraInfo and
+   VariablesToEventExtraInfo), EventErrorFlag and PruneDataStore. If the path
+   contains no thread safe module, or a Python module after the first thread
+   safe one, the whole path is processed in a single thread and only a warning
+   is printed. Cuts and variables which use random numbers are not thread safe,
+   so BestCandidateSelection, which often ranks by ``random``, always runs in
+   the serial stages.
+
+Parameters:
+  nthreads (int): number of worker threads. 0 to disable multi-threaded processing.
+)DOCSTRING");
+  def("get_nthreads", &Framework::getNumberThreads, R"DOCSTRING(
+Gets number of worker threads for multi-threaded processing. 0 disables multi-threaded processing
 )DOCSTRING");
   def("set_streamobjs", &Framework::setStreamingObjects, R"DOCSTRING(
 Set the names of all DataStore objects which should be sent between the
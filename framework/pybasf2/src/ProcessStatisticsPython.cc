@@ -265,6 +265,22 @@ Parameters:
        "time_memory_corr(counter=StatisticCounters.TOTAL)\nReturn the correlaction factor between time and memory consumption")
   .def("calls", &ModuleStatistics::getCalls, bp::arg("counter") = ModuleStatistics::c_Total,
        "calls(counter=StatisticCounters.TOTAL)\nReturn the total number of calls")
+  .add_property("cache_hits", &ModuleStatistics::getCacheHits,
+                "property to get the number of values the module took from caches of derived quantities, "
+                "e.g. variables cached with ``variables.variables.enableCache()``, during event processing")
+  .add_property("cache_misses", &ModuleStatistics::getCacheMisses,
+                "property to get the number of values the module calculated and added to caches of derived quantities "
+                "during event processing")
+  .add_property("input_bytes", &ModuleStatistics::getInputBytes,
+                "property to get the number of uncompressed bytes the module read from its input, e.g. for `RootInput`")
+  .add_property("read_ahead_hits", &ModuleStatistics::getReadAheadHits,
+                "property to get the number of input entries which were already read ahead in the background when "
+                "the module requested them, see the ``readAheadEntries`` parameter of `RootInput`")
+  .add_property("read_ahead_restarts", &ModuleStatistics::getReadAheadRestarts,
+                "property to get the number of times the module had to discard the input entries read ahead, "
+                "e.g. because another entry was requested")
+  .add_property("read_ahead_wait_time", &ModuleStatistics::getReadAheadWaitTime,
+                "property to get the time the module waited for input entries read ahead in the background")
   ;
 
   //Expose ProcessStatisticsPython instance as "statistics" object in pybasf2 module
@@ -0,0 +1,84 @@
+#!/usr/bin/env python3
+
+##########################################################################
+# basf2 (Belle II Analysis Software Framework)                           #
+# Author: The Belle II Collaboration                                     #
+#                                                                        #
+# See git log for contributors and copyright holders.                    #
+# This file is licensed under LGPL-3.0, see LICENSE.md.                  #
+##########################################################################
+
+"""Check that ColumnarOutput and ColumnarInput restore objects and arrays, also when only some members are read"""
+
+import basf2
+from ROOT import Belle2
+from b2test_utils import clean_working_directory, safe_process
+
+# @cond internal_test
+
+
+class CreateArray(basf2.Module):
+    """Fill an array with a different number of objects in each event"""
+
+    def initialize(self):
+        self.array = Belle2.PyStoreArray(Belle2.EventMetaData.Class(), "Metas")
+        self.array.registerInDataStore()
+        self.event_meta_data = Belle2.PyStoreObj("EventMetaData")
+
+    def event(self):
+        event = self.event_meta_data.obj().getEvent()
+        for i in range(event % 4):
+            meta = self.array.appendNew()
+            meta.setEvent(100 * event + i)
+            meta.setRun(event)
+            meta.setGeneratedWeight(0.5 * i)
+
+
+class CheckArray(basf2.Module):
+    """Check the restored objects"""
+
+    def __init__(self, all_members):
+        super().__init__()
+        self.all_members = all_members
+        self.events = []
+
+    def initialize(self):
+        self.array = Belle2.PyStoreArray("Metas")
+        self.event_meta_data = Belle2.PyStoreObj("EventMetaData")
+
+    def event(self):
+        event = self.event_meta_data.obj().getEvent()
+        self.events.append(event)
+        assert self.array.getEntries() == event % 4, "Wrong number of objects"
+        for i, meta in enumerate(self.array):
+            assert meta.getEvent() == 100 * event + i, "Wrong value"
+            assert meta.getRun() == (event if self.all_members else 0), "Member restored or not restored"
+            assert meta.getGeneratedWeight() == (0.5 * i if self.all_members else 1.), "Member restored or not restored"
+
+
+def read(filenames, all_members, **parameters):
+    """Read the given files and return the event numbers"""
+    check = CheckArray(all_members)
+    path = basf2.Path()
+    path.add_module("ColumnarInput", inputFileNames=filenames, **parameters)
+    path.add_module(check)
+    assert safe_process(path) == 0, "ColumnarInput failed"
+    return check.events
+
+
+if __name__ == "__main__":
+    basf2.logging.log_level = basf2.LogLevel.ERROR
+    basf2.logging.enable_summary(False)
+    with clean_working_directory():
+        for filename, events in [("first.b2col", 25), ("second.b2col", 3)]:
+            path = basf2.Path()
+            path.add_module("EventInfoSetter", evtNumList=events)
+            path.add_module(CreateArray())
+            path.add_module("ColumnarOutput", outputFileName=filename, clusterSize=10)
+            assert safe_process(path) == 0, "ColumnarOutput failed"
+
+        expected = list(range(1, 26)) + list(range(1, 4))
+        assert read(["first.b2col", "second.b2col"], True) == expected, "Wrong events"
+        assert read(["first.b2col", "second.b2col"], False, columnNames=["Metas.m_event"]) == expected, "Wrong events"
+
+# @endcond
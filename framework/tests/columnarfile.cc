@@ -0,0 +1,163 @@
+/**************************************************************************
+ * basf2 (Belle II Analysis Software Framework)                           *
+ * Author: The Belle II Collaboration                                     *
+ *                                                                        *
+ * See git log for contributors and copyright holders.                    *
+ * This file is licensed under LGPL-3.0, see LICENSE.md.                  *
+ **************************************************************************/
+#include <framework/io/ColumnarFile.h>
+#include <framework/dataobjects/EventMetaData.h>
+#include <framework/utilities/TestHelpers.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace Belle2;
+
+namespace {
+  /** Find the column with the given name, nullptr if there is none. */
+  const Columnar::Column* findColumn(const vector<Columnar::Column>& columns, const string& name)
+  {
+    auto it = find_if(columns.begin(), columns.end(), [&name](const Columnar::Column & column) { return column.name == name; });
+    return (it == columns.end()) ? nullptr : &(*it);
+  }
+
+  /** Members of basic type are stored, the TObject members and strings are not. */
+  TEST(ColumnarFileTest, Columns)
+  {
+    vector<string> skipped;
+    const vector<Columnar::Column> columns = Columnar::getColumns(EventMetaData::Class(), &skipped);
+
+    const Columnar::Column* event = findColumn(columns, "m_event");
+    ASSERT_NE(event, nullptr);
+    EXPECT_EQ(event->type, Columnar::EType::c_UInt32);
+    EXPECT_EQ(event->length, 1u);
+    EXPECT_EQ(event->getSize(), sizeof(unsigned int));
+    const Columnar::Column* time = findColumn(columns, "m_time");
+    ASSERT_NE(time, nullptr);
+    EXPECT_EQ(time->type, Columnar::EType::c_UInt64);
+    const Columnar::Column* weight = findColumn(columns, "m_generatedWeight");
+    ASSERT_NE(weight, nullptr);
+    EXPECT_EQ(weight->type, Columnar::EType::c_Double);
+
+    EXPECT_EQ(findColumn(columns, "m_parentLfn"), nullptr);
+    EXPECT_EQ(findColumn(columns, "fUniqueID"), nullptr);
+    EXPECT_NE(find(skipped.begin(), skipped.end(), "m_parentLfn"), skipped.end());
+  }
+
+  /** Write an object and an array with a varying number of entries and read the columns back. */
+  TEST(ColumnarFileTest, RoundTrip)
+  {
+    TestHelpers::TempDirCreator tempDir;
+    const string filename = "roundtrip.b2col";
+    const unsigned int nEvents = 7;
+    {
+      ColumnarFileWriter writer(filename, 3);
+      const size_t objBranch = writer.addBranch("EventMetaData", EventMetaData::Class(), false);
+      const size_t arrayBranch = writer.addBranch("Metas", EventMetaData::Class(), true);
+      for (unsigned int event = 1; event <= nEvents; event++) {
+        EventMetaData meta(event, 2, 3);
+        writer.addObject(objBranch, &meta);
+        for (unsigned int i = 0; i < event % 4; i++) {
+          EventMetaData entry(100 * event + i, event);
+          entry.setGeneratedWeight(0.5 * i);
+          writer.addObject(arrayBranch, &entry);
+        }
+        writer.endEvent();
+      }
+      EXPECT_EQ(writer.getNEvents(), nEvents);
+      EXPECT_THROW(writer.addBranch("Late", EventMetaData::Class(), false), std::logic_error);
+      writer.close();
+    }
+
+    ColumnarFileReader reader(filename);
+    EXPECT_EQ(reader.getNEvents(), nEvents);
+    ASSERT_EQ(reader.getBranches().size(), 2u);
+    EXPECT_EQ(reader.getBranchIndex("Late"), -1);
+    const int objBranch = reader.getBranchIndex("EventMetaData");
+    const int arrayBranch = reader.getBranchIndex("Metas");
+    ASSERT_EQ(objBranch, 0);
+    ASSERT_EQ(arrayBranch, 1);
+    EXPECT_FALSE(reader.getBranches()[objBranch].isArray);
+    EXPECT_TRUE(reader.getBranches()[arrayBranch].isArray);
+    EXPECT_EQ(reader.getBranches()[arrayBranch].className, "Belle2::EventMetaData");
+    const int eventColumn = reader.getColumnIndex(arrayBranch, "m_event");
+    const int runColumn = reader.getColumnIndex(arrayBranch, "m_run");
+    const int weightColumn = reader.getColumnIndex(arrayBranch, "m_generatedWeight");
+    ASSERT_GE(eventColumn, 0);
+    ASSERT_GE(runColumn, 0);
+    ASSERT_GE(weightColumn, 0);
+    EXPECT_EQ(reader.getColumnIndex(arrayBranch, "m_parentLfn"), -1);
+
+    //clusters of 3, 3 and 1 events
+    ASSERT_EQ(reader.getNClusters(), 3u);
+    EXPECT_EQ(reader.getCluster(2).firstEvent, 6u);
+    EXPECT_EQ(reader.getCluster(2).nEvents, 1u);
+    EXPECT_EQ(reader.findCluster(0), 0u);
+    EXPECT_EQ(reader.findCluster(5), 1u);
+    EXPECT_EQ(reader.findCluster(6), 2u);
+    EXPECT_THROW(reader.findCluster(nEvents), std::out_of_range);
+
+    for (unsigned int event = 1; event <= nEvents; event++) {
+      const size_t cluster = reader.findCluster(event - 1);
+      const size_t iEvent = event - 1 - reader.getCluster(cluster).firstEvent;
+
+      const uint64_t* objOffsets = reader.getObjectOffsets(cluster, objBranch);
+      ASSERT_EQ(objOffsets[iEvent + 1] - objOffsets[iEvent], 1u);
+      const int objEventColumn = reader.getColumnIndex(objBranch, "m_event");
+      const int objSubrunColumn = reader.getColumnIndex(objBranch, "m_subrun");
+      EXPECT_EQ(reader.getColumn<unsigned int>(cluster, objBranch, objEventColumn)[objOffsets[iEvent]], event);
+      EXPECT_EQ(reader.getColumn<int>(cluster, objBranch, objSubrunColumn)[objOffsets[iEvent]], 0);
+
+      const uint64_t* offsets = reader.getObjectOffsets(cluster, arrayBranch);
+      ASSERT_EQ(offsets[iEvent + 1] - offsets[iEvent], event % 4);
+      const unsigned int* events = reader.getColumn<unsigned int>(cluster, arrayBranch, eventColumn);
+      const int* runs = reader.getColumn<int>(cluster, arrayBranch, runColumn);
+      const double* weights = reader.getColumn<double>(cluster, arrayBranch, weightColumn);
+      for (unsigned int i = 0; i < event % 4; i++) {
+        EXPECT_EQ(events[offsets[iEvent] + i], 100 * event + i);
+        EXPECT_EQ(runs[offsets[iEvent] + i], static_cast<int>(event));
+        EXPECT_DOUBLE_EQ(weights[offsets[iEvent] + i], 0.5 * i);
+      }
+    }
+
+    EXPECT_THROW(reader.getColumn<double>(0, arrayBranch, eventColumn), std::invalid_argument);
+  }
+
+  /** Files which are not columnar files or which were not closed are rejected. */
+  TEST(ColumnarFileTest, InvalidFiles)
+  {
+    TestHelpers::TempDirCreator tempDir;
+    EXPECT_THROW(ColumnarFileReader("missing.b2col"), std::runtime_error);
+    {
+      ofstream file("invalid.b2col");
+      file << "This is not a columnar file, but it is long enough to contain a header.";
+    }
+    EXPECT_THROW(ColumnarFileReader("invalid.b2col"), std::runtime_error);
+
+    //cut off the second half of a valid file, including the directory
+    {
+      ColumnarFileWriter writer("valid.b2col", 1);
+      const size_t branch = writer.addBranch("EventMetaData", EventMetaData::Class(), false);
+      for (unsigned int event = 1; event <= 2; event++) {
+        EventMetaData meta(event);
+        writer.addObject(branch, &meta);
+        writer.endEvent();
+      }
+    }
+    {
+      ifstream valid("valid.b2col", ios::binary);
+      const string contents((istreambuf_iterator<char>(valid)), istreambuf_iterator<char>());
+      ofstream truncated("truncated.b2col", ios::binary);
+      truncated << contents.substr(0, contents.size() / 2);
+    }
+    EXPECT_NO_THROW(ColumnarFileReader("valid.b2col"));
+    EXPECT_THROW(ColumnarFileReader("truncated.b2col"), std::runtime_error);
+  }
+}  // namespace
@@ -0,0 +1,218 @@
+/**************************************************************************
+ * basf2 (Belle II Analysis Software Framework)                           *
+ * Author: The Belle II Collaboration                                     *
+ *                                                                        *
+ * See git log for contributors and copyright holders.                    *
+ * This file is licensed under LGPL-3.0, see LICENSE.md.                  *
+ **************************************************************************/
+
+#include <framework/database/Downloader.h>
+#include <framework/database/PayloadProvider.h>
+#include <framework/utilities/FileSystem.h>
+#include <framework/utilities/ScopeGuard.h>
+#include <framework/utilities/TestHelpers.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <thread>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace Belle2;
+using namespace Conditions;
+
+namespace {
+  /** Minimal HTTP/1.1 server with keep-alive serving a fixed set of files
+   * from memory to test downloading without a real conditions database. It
+   * counts the connections and requests so that we can check that connections
+   * are reused. */
+  class TestHTTPServer {
+  public:
+    /** Start listening on a free port on localhost */
+    explicit TestHTTPServer(const std::map<std::string, std::string>& files): m_files(files)
+    {
+      m_socket = socket(AF_INET, SOCK_STREAM, 0);
+      sockaddr_in address{};
+      address.sin_family = AF_INET;
+      address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+      address.sin_port = 0;
+      socklen_t length = sizeof(address);
+      if (bind(m_socket, reinterpret_cast<sockaddr*>(&address), length) != 0 or listen(m_socket, 64) != 0 or
+          getsockname(m_socket, reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+        throw std::runtime_error("cannot start test http server");
+      }
+      m_port = ntohs(address.sin_port);
+      m_thread = std::thread([this] { serve(); });
+    }
+    /** Stop the server and wait for all connections to be closed */
+    ~TestHTTPServer()
+    {
+      m_stop = true;
+      m_thread.join();
+      for (auto& connection : m_connectionThreads) connection.join();
+      close(m_socket);
+    }
+    /** Url of the server */
+    std::string getUrl() const { return "http://127.0.0.1:" + std::to_string(m_port) + "/"; }
+    /** Number of connections accepted so far */
+    int getConnections() const { return m_connections; }
+    /** Number of requests answered so far */
+    int getRequests() const { return m_requests; }
+
+  private:
+    /** Accept connections until we are asked to stop */
+    void serve()
+    {
+      while (!m_stop) {
+        pollfd fd{m_socket, POLLIN, 0};
+        if (poll(&fd, 1, 10) <= 0) continue;
+        int connection = accept(m_socket, nullptr, nullptr);
+        if (connection < 0) continue;
+        ++m_connections;
+        m_connectionThreads.emplace_back([this, connection] { handle(connection); });
+      }
+    }
+    /** Answer all requests on one connection until it is closed */
+    void handle(int connection)
+    {
+      std::string buffer;
+      char data[4096];
+      while (!m_stop) {
+        pollfd fd{connection, POLLIN, 0};
+        if (poll(&fd, 1, 10) <= 0) continue;
+        const ssize_t size = read(connection, data, sizeof(data));
+        if (size <= 0) break;
+        buffer.append(data, size);
+        // we only get GET requests without body so the end of the header is the end of the request
+        for (size_t end = buffer.find("\r\n\r\n"); end != std::string::npos; end = buffer.find("\r\n\r\n")) {
+          std::istringstream request(buffer.substr(0, end));
+          buffer.erase(0, end + 4);
+          std::string method, path;
+          request >> method >> path;
+          ++m_requests;
+          std::ostringstream reply;
+          if (auto it = m_files.find(path); it != m_files.end()) {
+            reply << "HTTP/1.1 200 OK\r\nContent-Length: " << it->second.size() << "\r\n\r\n" << it->second;
+          } else {
+            reply << "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n\r\n";
+          }
+          const std::string response = reply.str();
+          if (write(connection, response.data(), response.size()) != static_cast<ssize_t>(response.size())) break;
+        }
+      }
+      close(connection);
+    }
+
+    /** files to serve by path */
+    std::map<std::string, std::string> m_files;
+    /** listening socket */
+    int m_socket{ -1};
+    /** port we listen on */
+    int m_port{0};
+    /** set to true to stop serving */
+    std::atomic<bool> m_stop{false};
+    /** number of accepted connections */
+    std::atomic<int> m_connections{0};
+    /** number of answered requests */
+    std::atomic<int> m_requests{0};
+    /** thread accepting connections */
+    std::thread m_thread;
+    /** threads handling the connections */
+    std::vector<std::thread> m_connectionThreads;
+  };
+
+  /** Download many files in parallel and check that the connections are reused */
+  TEST(DownloaderTest, downloadParallel)
+  {
+    std::map<std::string, std::string> files;
+    for (int i = 0; i < 50; ++i) files["/file" + std::to_string(i)] = std::string(1000 * i, 'a' + i % 26);
+    TestHTTPServer server(files);
+
+    Downloader& downloader = Downloader::getDefaultInstance();
+    const unsigned int maxParallelDownloads = downloader.getMaxParallelDownloads();
+    ScopeGuard guard([&] {downloader.setMaxParallelDownloads(maxParallelDownloads);});
+    // start with fresh connections which are kept open as long as the session is active
+    downloader.finishSession();
+    auto session = downloader.ensureSession();
+    downloader.setMaxParallelDownloads(4);
+    std::vector<std::stringstream> streams(files.size() + 1);
+    std::vector<Downloader::Transfer> transfers;
+    for (int i = 0; i < 50; ++i) transfers.push_back({server.getUrl() + "file" + std::to_string(i), &streams[i]});
+    transfers.push_back({server.getUrl() + "missing", &streams.back()});
+    downloader.downloadParallel(transfers);
+
+    for (int i = 0; i < 50; ++i) {
+      EXPECT_TRUE(transfers[i].success) << transfers[i].url << ": " << transfers[i].error;
+      EXPECT_EQ(transfers[i].responseCode, 200);
+      EXPECT_EQ(streams[i].str(), files["/file" + std::to_string(i)]);
+    }
+    EXPECT_FALSE(transfers.back().success);
+    EXPECT_EQ(transfers.back().responseCode, 404);
+    EXPECT_FALSE(transfers.back().error.empty());
+    EXPECT_EQ(server.getRequests(), 51);
+    // the connections are kept open ... but a 404 might close one
+    EXPECT_LE(server.getConnections(), 5);
+    // ... and reused for the next transfers, also by single downloads
+    std::stringstream again;
+    EXPECT_TRUE(downloader.download(server.getUrl() + "file1", again));
+    EXPECT_EQ(again.str(), files["/file1"]);
+    transfers.resize(4);
+    downloader.downloadParallel(transfers);
+    for (const auto& transfer : transfers) EXPECT_TRUE(transfer.success);
+    EXPECT_EQ(server.getRequests(), 56);
+    EXPECT_LE(server.getConnections(), 5);
+  }
+
+  /** Download payloads in parallel into the content addressed cache */
+  TEST(PayloadProviderTest, parallelDownload)
+  {
+    TestHelpers::TempDirCreator tempDir;
+    std::map<std::string, std::string> files{{"/A", "payload A"}, {"/B", "payload A"}, {"/C", "payload C"}};
+    std::map<std::string, std::string> checksums;
+    for (const auto& [path, content] : files) {
+      std::ofstream("payload") << content;
+      checksums[path] = FileSystem::calculateMD5("payload");
+    }
+    TestHTTPServer server(files);
+
+    auto makePayload = [&](const std::string & name, int revision) {
+      PayloadMetadata payload(name);
+      payload.revision = revision;
+      payload.checksum = checksums["/" + name];
+      payload.payloadUrl = name;
+      payload.baseUrl = server.getUrl();
+      return payload;
+    };
+    std::vector<PayloadMetadata> payloads{makePayload("A", 1), makePayload("B", 1), makePayload("C", 1)};
+    std::vector<PayloadMetadata*> query;
+    for (auto& payload : payloads) query.push_back(&payload);
+
+    PayloadProvider provider({server.getUrl()}, "cache");
+    EXPECT_TRUE(provider.find(query));
+    for (auto& payload : payloads) {
+      EXPECT_EQ(payload.filename, std::filesystem::absolute("cache/" + payload.checksum.substr(0, 2) + "/" + payload.checksum +
+                                                            ".root").string());
+      EXPECT_EQ(FileSystem::calculateMD5(payload.filename), payload.checksum);
+    }
+    // identical content is only downloaded once
+    EXPECT_EQ(payloads[0].filename, payloads[1].filename);
+    EXPECT_EQ(server.getRequests(), 2);
+
+    // and found in the cache afterwards, independent of the name and revision
+    PayloadProvider other({server.getUrl()}, "cache");
+    std::vector<PayloadMetadata> cached{makePayload("C", 1), makePayload("A", 5)};
+    cached[1].name = "D";
+    EXPECT_TRUE(other.find({&cached[0], &cached[1]}));
+    EXPECT_EQ(cached[0].filename, payloads[2].filename);
+    EXPECT_EQ(cached[1].filename, payloads[0].filename);
+    EXPECT_EQ(server.getRequests(), 2);
+  }
+}
@@ -0,0 +1,83 @@
+/**************************************************************************
+ * basf2 (Belle II Analysis Software Framework)                           *
+ * Author: The Belle II Collaboration                                     *
+ *                                                                        *
+ * See git log for contributors and copyright holders.                    *
+ * This file is licensed under LGPL-3.0, see LICENSE.md.                  *
+ **************************************************************************/
+
+#include <framework/database/PayloadCache.h>
+#include <framework/utilities/TestHelpers.h>
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+
+using namespace Belle2;
+using namespace Conditions;
+
+namespace {
+  /** Test adding and finding payloads in the shared payload cache */
+  TEST(PayloadCacheTest, findAndInsert)
+  {
+    TestHelpers::TempDirCreator tempDir;
+    {
+      std::ofstream payloadFile("payload.root");
+      payloadFile << "not really a root file";
+    }
+    PayloadMetadata payload("TestPayload");
+    payload.checksum = "0123456789abcdef";
+
+    PayloadCache cache("cache");
+    EXPECT_FALSE(cache.find(payload));
+    EXPECT_TRUE(payload.filename.empty());
+    // nothing to add without a file
+    EXPECT_FALSE(cache.insert(payload));
+
+    payload.filename = "payload.root";
+    EXPECT_TRUE(cache.insert(payload));
+    EXPECT_NE(payload.filename, "payload.root");
+    EXPECT_EQ(std::filesystem::path(payload.filename).parent_path(), std::filesystem::absolute("cache"));
+    EXPECT_EQ(std::filesystem::file_size(payload.filename), std::filesystem::file_size("payload.root"));
+
+    // found by checksum, also by another instance like a different process would
+    PayloadCache other("cache");
+    PayloadMetadata found("TestPayload");
+    found.checksum = payload.checksum;
+    EXPECT_TRUE(other.find(found));
+    EXPECT_EQ(found.filename, payload.filename);
+    PayloadMetadata changed("TestPayload");
+    changed.checksum = "fedcba9876543210";
+    EXPECT_FALSE(other.find(changed));
+    // uncounted lookups
+    EXPECT_TRUE(other.find(found, false));
+
+    // adding it again doesn't copy it again
+    payload.filename = "payload.root";
+    EXPECT_TRUE(other.insert(payload, true));
+    EXPECT_EQ(payload.filename, found.filename);
+
+    EXPECT_EQ(cache.getStatistics().hits, 0u);
+    EXPECT_EQ(cache.getStatistics().misses, 1u);
+    EXPECT_EQ(cache.getStatistics().inserted, 1u);
+    EXPECT_EQ(other.getStatistics().hits, 1u);
+    EXPECT_EQ(other.getStatistics().misses, 1u);
+    EXPECT_EQ(other.getStatistics().inserted, 0u);
+    EXPECT_EQ(other.getStatistics().prefetched, 0u);
+    const auto shared = cache.getSharedStatistics();
+    EXPECT_EQ(shared.hits, 1u);
+    EXPECT_EQ(shared.misses, 2u);
+    EXPECT_EQ(shared.inserted, 1u);
+    EXPECT_EQ(shared.prefetched, 0u);
+  }
+
+  /** The cache directory has to be usable */
+  TEST(PayloadCacheTest, invalidDirectory)
+  {
+    TestHelpers::TempDirCreator tempDir;
+    {
+      std::ofstream file("file");
+    }
+    EXPECT_THROW(PayloadCache("file"), std::runtime_error);
+  }
+}
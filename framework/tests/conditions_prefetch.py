@@ -0,0 +1,102 @@
+#!/usr/bin/env python3
+
+##########################################################################
+# basf2 (Belle II Analysis Software Framework)                           #
+# Author: The Belle II Collaboration                                     #
+#                                                                        #
+# See git log for contributors and copyright holders.                    #
+# This file is licensed under LGPL-3.0, see LICENSE.md.                  #
+##########################################################################
+
+"""
+Check prefetching of payloads for the next run together with the shared payload cache.
+
+A local globaltag contains a different revision of the same payload for each run.
+With prefetching enabled, the payload of the next run is added to the shared
+cache in the background, so it is found there once the run starts. With
+parallel processing the workers are forked right after the input process
+started the prefetch of the second run, which must neither hang nor leave the
+workers with a broken database state.
+"""
+
+import hashlib
+import os
+import basf2
+import ROOT
+from ROOT import Belle2
+from b2test_utils import clean_working_directory, safe_process
+from conditions_db import PayloadInformation
+from conditions_db.local_metadata import LocalMetadataProvider
+
+ROOT.gInterpreter.Declare("#include <framework/database/PayloadCache.h>")
+
+#: runs to process, each with its own payload revision
+RUNS = [1, 2, 3]
+
+
+class CheckPayload(basf2.Module):
+    """Check that each run sees the payload created for it"""
+
+    def __init__(self):
+        """Request the payload"""
+        super().__init__()
+        self.set_property_flags(basf2.ModulePropFlags.PARALLELPROCESSINGCERTIFIED)
+        #: the payload to check
+        self.payload = Belle2.PyDBObj("PrefetchTest")
+
+    def event(self):
+        """Compare the payload contents with the run number"""
+        run = Belle2.PyStoreObj("EventMetaData").obj().getRun()
+        if not self.payload.isValid() or self.payload.obj().GetTitle() != f"run {run}":
+            basf2.B2FATAL(f"Wrong payload for run {run}")
+
+
+def create_database():
+    """Create a payload file for each run and a local metadata file with one globaltag containing them"""
+    os.mkdir("payloads")
+    iovs = []
+    for run in RUNS:
+        filename = f"payloads/dbstore_PrefetchTest_rev_{run}.root"
+        payload_file = ROOT.TFile(filename, "RECREATE")
+        ROOT.TNamed("PrefetchTest", f"run {run}").Write("PrefetchTest")
+        payload_file.Close()
+        with open(filename, "rb") as f:
+            checksum = hashlib.md5(f.read()).hexdigest()
+        iovs.append(PayloadInformation(run, "PrefetchTest", run, checksum, "", "", None, (0, run, 0, run)))
+    LocalMetadataProvider("database.sqlite", "overwrite").add_globaltag(1, "prefetch", "PUBLISHED", iovs)
+
+
+def process(nprocesses):
+    """Process all runs with prefetching and return the statistics of the shared payload cache"""
+    cache = os.path.abspath(f"cache{nprocesses}")
+    basf2.conditions.reset()
+    basf2.conditions.override_globaltags(["prefetch"])
+    basf2.conditions.metadata_providers = [os.path.abspath("database.sqlite")]
+    basf2.conditions.payload_locations = [os.path.abspath("payloads")]
+    basf2.conditions.expert_settings(shared_payload_cache=cache, prefetch_payloads=True)
+    basf2.set_nprocesses(nprocesses)
+
+    path = basf2.Path()
+    path.add_module("EventInfoSetter", expList=[0] * len(RUNS), runList=RUNS, evtNumList=[5] * len(RUNS))
+    path.add_module(CheckPayload())
+    assert safe_process(path) == 0, f"processing with {nprocesses} processes failed"
+    return Belle2.Conditions.PayloadCache(cache).getSharedStatistics()
+
+
+basf2.set_log_level(basf2.LogLevel.WARNING)
+with clean_working_directory():
+    create_database()
+
+    # the first run is looked up normally, all following runs were prefetched
+    statistics = process(0)
+    assert statistics.misses == 1, f"expected one cache miss, got {statistics.misses}"
+    assert statistics.inserted == 1, f"expected one payload added on request, got {statistics.inserted}"
+    assert statistics.prefetched == len(RUNS) - 1, f"expected {len(RUNS) - 1} prefetched payloads, got {statistics.prefetched}"
+    assert statistics.hits >= len(RUNS) - 1, f"expected the prefetched payloads to be used, got {statistics.hits} hits"
+
+    # all processes inherit the cache state of the input process, which forks
+    # while the second run is prefetched, and prefetch by themselves afterwards
+    statistics = process(2)
+    assert statistics.misses == 1, f"expected one cache miss, got {statistics.misses}"
+    assert statistics.prefetched >= len(RUNS) - 1, f"expected prefetched payloads, got {statistics.prefetched}"
+    assert statistics.hits >= len(RUNS) - 1, f"expected the prefetched payloads to be used, got {statistics.hits} hits"
@@ -10,7 +10,9 @@
 #include <framework/database/Configuration.h>
 #include <framework/database/DBObjPtr.h>
 #include <framework/database/DBArray.h>
+#include <framework/database/DBImportObjPtr.h>
 #include <framework/database/EventDependency.h>
+#include <framework/database/TimeDependency.h>
 #include <framework/database/PayloadFile.h>
 #include <framework/database/DBPointer.h>
 #include <framework/datastore/StoreObjPtr.h>
@@ -27,6 +29,7 @@
 
 #include <filesystem>
 #include <list>
+#include <random>
 #include <cstdio>
 
 using namespace std;
@@ -357,6 +360,95 @@ namespace {
     EXPECT_TRUE(strcmp(intraRun->GetName(), "X") == 0);
   }
 
+  /** Test that intra run dependent objects in the wrong order are not imported */
+  TEST_F(DataBaseTest, IntraRunImportOrder)
+  {
+    DBImportObjPtr<TNamed> importer("IntraRunOutOfOrder");
+    importer.construct("A", "A");
+    importer.addEventDependency(50);
+    importer.construct("B", "B");
+    importer.addEventDependency(10);
+    importer.construct("C", "C");
+    bool imported = true;
+    EXPECT_B2ERROR(imported = importer.import(IntervalOfValidity(1, 1, 1, 1)));
+    EXPECT_FALSE(imported);
+  }
+
+  /** Index of the object valid for a given value by scanning all boundaries */
+  template<class T> unsigned int linearIndex(const std::vector<T>& boundaries, T value)
+  {
+    unsigned int index = 0;
+    while (index < boundaries.size() and boundaries[index] <= value) ++index;
+    return index;
+  }
+
+  /** Test the lookup of event dependent objects in sequential and random order */
+  TEST(IntraRunDependencyTest, EventDependency)
+  {
+    const int nIntervals = 2000;
+    std::mt19937 rng(42);
+    EventDependency intraRunDep(new TObject);
+    unsigned int event = 0;
+    for (int i = 1; i < nIntervals; ++i) {
+      // include some empty intervals
+      event += std::uniform_int_distribution<unsigned int>(0, 100)(rng);
+      auto* object = new TObject;
+      object->SetUniqueID(i);
+      intraRunDep.add(event, object);
+    }
+    const auto& boundaries = intraRunDep.getEventNumbers();
+    ASSERT_EQ(boundaries.size(), nIntervals - 1u);
+
+    EventMetaData meta(0, 1, 1);
+    int hint = 0;
+    for (unsigned int e = 0; e < event + 10; ++e) {
+      meta.setEvent(e);
+      ASSERT_EQ(intraRunDep.getObject(meta)->GetUniqueID(), linearIndex(boundaries, e)) << "event " << e;
+      ASSERT_EQ(intraRunDep.getObject(meta, hint)->GetUniqueID(), linearIndex(boundaries, e)) << "event " << e;
+      ASSERT_EQ(hint, linearIndex(boundaries, e));
+    }
+    std::uniform_int_distribution<unsigned int> randomEvent(0, event + 10);
+    for (int i = 0; i < 10000; ++i) {
+      const unsigned int e = randomEvent(rng);
+      meta.setEvent(e);
+      ASSERT_EQ(intraRunDep.getObject(meta)->GetUniqueID(), linearIndex(boundaries, e)) << "event " << e;
+      ASSERT_EQ(intraRunDep.getObject(meta, hint)->GetUniqueID(), linearIndex(boundaries, e)) << "event " << e;
+    }
+    // a hint which is out of range is ignored
+    hint = nIntervals + 5;
+    meta.setEvent(0);
+    EXPECT_EQ(intraRunDep.getObject(meta, hint)->GetUniqueID(), 0u);
+    EXPECT_EQ(hint, 0);
+
+    // out of order boundaries are rejected
+    EXPECT_FALSE(intraRunDep.add(0, new TObject));
+    EXPECT_EQ(intraRunDep.getEventNumbers().size(), nIntervals - 1u);
+  }
+
+  /** Test the lookup of time dependent objects */
+  TEST(IntraRunDependencyTest, TimeDependency)
+  {
+    const unsigned long long start = 1600000000000000000ull;
+    TimeDependency intraRunDep(new TNamed("A", "A"));
+    intraRunDep.add(start + 1000, new TNamed("B", "B"));
+    intraRunDep.add(start + 5000, new TNamed("C", "C"));
+    EXPECT_EQ(intraRunDep.getTimes().size(), 2u);
+    EXPECT_TRUE(intraRunDep.getBoundaries().empty());
+
+    EventMetaData meta(0, 1, 1);
+    const std::vector<std::pair<unsigned long long, std::string>> expected{
+      {0, "A"}, {start + 999, "A"}, {start + 1000, "B"}, {start + 4999, "B"}, {start + 5000, "C"}, {start + 1000, "B"}, {start, "A"}
+    };
+    for (const auto& [time, name] : expected) {
+      meta.setTime(time);
+      EXPECT_EQ(intraRunDep.getObject(meta)->GetName(), name) << "time " << time;
+    }
+
+    // out of order boundaries are rejected
+    EXPECT_FALSE(intraRunDep.add(start, new TNamed("D", "D")));
+    EXPECT_EQ(intraRunDep.getTimes().size(), 2u);
+  }
+
   /** Test the database content change notification */
   TEST_F(DataBaseTest, HasChanged)
   {
@@ -758,6 +758,77 @@ namespace {
     EXPECT_EQ(0, DataStore::Instance().getListOfObjects(TObject::Class(), DataStore::c_Persistent).size());
   }
 
+  /** Handles should point to the same entries as name lookups, also after switching DataStore IDs. */
+  TEST_F(DataStoreTest, EntryHandles)
+  {
+    StoreArray<EventMetaData> evtData;
+    StoreArray<EventMetaData> evtDataDifferentDurability("", DataStore::c_Persistent);
+    const int handle = evtData.getHandle();
+    EXPECT_EQ(handle, DataStore::Instance().getHandle(evtData.getName(), DataStore::c_Event));
+    EXPECT_EQ(handle, StoreArray<EventMetaData>().getHandle());
+    EXPECT_NE(handle, StoreArray<EventMetaData>("EventMetaDatas_2").getHandle());
+
+    auto& map = DataStore::Instance().getStoreEntryMap(DataStore::c_Event);
+    EXPECT_EQ(&map.at(evtData.getName()), DataStore::Instance().getEntry(evtData));
+    auto& persistentMap = DataStore::Instance().getStoreEntryMap(DataStore::c_Persistent);
+    EXPECT_EQ(&persistentMap.at(evtData.getName()), DataStore::Instance().getEntry(evtDataDifferentDurability));
+
+    //unregistered names get a handle, but no entry
+    StoreArray<EventMetaData> notRegistered("NotRegistered");
+    EXPECT_GE(notRegistered.getHandle(), 0);
+    EXPECT_EQ(nullptr, DataStore::Instance().getEntry(notRegistered));
+
+    DataStore::Instance().createNewDataStoreID("foo");
+    DataStore::Instance().switchID("foo");
+    EXPECT_EQ(&DataStore::Instance().getStoreEntryMap(DataStore::c_Event).at(evtData.getName()),
+              DataStore::Instance().getEntry(evtData));
+    DataStore::Instance().switchID("");
+    EXPECT_EQ(&map.at(evtData.getName()), DataStore::Instance().getEntry(evtData));
+
+    //changing the name must not keep the old handle
+    StoreArray<EventMetaData> renamed;
+    DataStore::Instance().setInitializeActive(true);
+    renamed.registerInDataStore("RenamedArray");
+    EXPECT_NE(handle, renamed.getHandle());
+    EXPECT_EQ(&map.at("RenamedArray"), DataStore::Instance().getEntry(renamed));
+  }
+
+  /** Handle lookups should find the same entries as map lookups for a realistic number of arrays. */
+  TEST_F(DataStoreTest, EntryHandlesManyArrays)
+  {
+    const int nArrays = 200;
+
+    std::vector<StoreArray<EventMetaData>> arrays;
+    arrays.reserve(nArrays);
+    DataStore::Instance().setInitializeActive(true);
+    for (int i = 0; i < nArrays; i++) {
+      arrays.emplace_back("ManyArrays" + std::to_string(i));
+      arrays.back().registerInDataStore();
+    }
+    DataStore::Instance().setInitializeActive(false);
+
+    const auto& map = DataStore::Instance().getStoreEntryMap(DataStore::c_Event);
+    for (const auto& array : arrays) {
+      EXPECT_EQ(&map.find(array.getName())->second, DataStore::Instance().getEntry(array));
+    }
+  }
+
+  /** Entries looked up before they were registered should be found after registration. */
+  TEST_F(DataStoreTest, EntryHandlesLateRegistration)
+  {
+    StoreObjPtr<EventMetaData> lateObject("LateObject");
+    EXPECT_EQ(nullptr, DataStore::Instance().getEntry(lateObject));
+    //second lookup uses the cached missing entry
+    EXPECT_EQ(nullptr, DataStore::Instance().getEntry(lateObject));
+
+    DataStore::Instance().setInitializeActive(true);
+    lateObject.registerInDataStore();
+    DataStore::Instance().setInitializeActive(false);
+
+    const auto& map = DataStore::Instance().getStoreEntryMap(DataStore::c_Event);
+    EXPECT_EQ(&map.find("LateObject")->second, DataStore::Instance().getEntry(lateObject));
+  }
+
   TEST_F(DataStoreTest, Assign)
   {
     StoreArray<EventMetaData> evtData;
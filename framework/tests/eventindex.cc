@@ -0,0 +1,78 @@
+/**************************************************************************
+ * basf2 (Belle II Analysis Software Framework)                           *
+ * Author: The Belle II Collaboration                                     *
+ *                                                                        *
+ * See git log for contributors and copyright holders.                    *
+ * This file is licensed under LGPL-3.0, see LICENSE.md.                  *
+ **************************************************************************/
+
+#include <framework/io/EventIndex.h>
+#include <framework/utilities/TestHelpers.h>
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+
+using namespace Belle2;
+
+namespace {
+  /** Events are found by experiment, run and event number after writing and reading the index. */
+  TEST(EventIndexTest, WriteAndFind)
+  {
+    TestHelpers::TempDirCreator tempDir;
+    EventIndex index;
+    const uint32_t first = index.addFile("/data/first.root");
+    const uint32_t second = index.addFile("/data/second.root");
+    EXPECT_EQ(index.addFile("/data/first.root"), first);
+    for (unsigned int i = 0; i < 100; i++) {
+      index.addEvent(1, 2, 100 - i, i < 50 ? first : second, i % 50);
+    }
+    index.write("test.b2idx");
+
+    const EventIndex read = EventIndex::read("test.b2idx");
+    EXPECT_EQ(read.getFiles().size(), 2u);
+    EXPECT_EQ(read.getEntries().size(), 100u);
+    auto found = read.find(1, 2, 30);
+    ASSERT_EQ(found.size(), 1u);
+    EXPECT_EQ(found[0].file, second);
+    EXPECT_EQ(found[0].entry, 20u);
+    EXPECT_TRUE(read.find(1, 3, 30).empty());
+    EXPECT_TRUE(read.find(1, 2, 101).empty());
+
+    EXPECT_EQ(read.findFile("/data/second.root"), 1);
+    EXPECT_EQ(read.findFile("other/dir/second.root"), 1);
+    EXPECT_EQ(read.findFile("third.root"), -1);
+    EXPECT_THROW(EventIndex::read("missing.b2idx"), std::runtime_error);
+  }
+
+  /** Skim flags select entries per file and survive merging. */
+  TEST(EventIndexTest, SkimsAndMerge)
+  {
+    EventIndex a;
+    const unsigned int muons = a.addSkim("muons");
+    const uint32_t fileA = a.addFile("a.root");
+    for (unsigned int i = 0; i < 10; i++)
+      a.addEvent(0, 0, i, fileA, i, i % 3 == 0 ? (1u << muons) : 0);
+
+    EventIndex b;
+    const unsigned int taus = b.addSkim("taus");
+    const unsigned int muonsB = b.addSkim("muons");
+    const uint32_t fileB = b.addFile("b.root");
+    for (unsigned int i = 0; i < 10; i++)
+      b.addEvent(0, 1, i, fileB, i, (i == 5 ? (1u << muonsB) : 0) | (i == 7 ? (1u << taus) : 0));
+
+    a.merge(b);
+    ASSERT_EQ(a.getSkims().size(), 2u);
+    const uint64_t muonMask = uint64_t(1) << a.getSkimBit("muons");
+    const auto selected = a.selectEntries(muonMask);
+    ASSERT_EQ(selected.size(), 2u);
+    EXPECT_EQ(selected[0], std::vector<uint64_t>({0, 3, 6, 9}));
+    EXPECT_EQ(selected[1], std::vector<uint64_t>({5}));
+    EXPECT_EQ(a.selectEntries(uint64_t(1) << a.getSkimBit("taus"))[1], std::vector<uint64_t>({7}));
+    EXPECT_EQ(a.selectEntries(0)[1].size(), 10u);
+    EXPECT_EQ(a.getSkimBit("electrons"), -1);
+
+    for (size_t i = a.getSkims().size(); i < EventIndex::c_maxSkims; i++)
+      a.addSkim("skim" + std::to_string(i));
+    EXPECT_THROW(a.addSkim("one too many"), std::length_error);
+  }
+}
@@ -0,0 +1,185 @@
+/**************************************************************************
+ * basf2 (Belle II Analysis Software Framework)                           *
+ * Author: The Belle II Collaboration                                     *
+ *                                                                        *
+ * See git log for contributors and copyright holders.                    *
+ * This file is licensed under LGPL-3.0, see LICENSE.md.                  *
+ **************************************************************************/
+
+#include <framework/pcore/EventQueue.h>
+#include <framework/pcore/EvtMessage.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace Belle2;
+
+namespace {
+  /** Create a message containing just the given number. */
+  EvtMessage* createMessage(int number)
+  {
+    return new EvtMessage(reinterpret_cast<const char*>(&number), sizeof(number), MSG_EVENT);
+  }
+
+  /** Get the number stored by createMessage(). */
+  int getNumber(EvtMessage* msg)
+  {
+    return *reinterpret_cast<int*>(msg->msg());
+  }
+
+  /** Messages are returned in order, and nullptr once the queue is closed and empty. */
+  TEST(EventQueueTest, PushPop)
+  {
+    EventQueue queue(4);
+    queue.addProducer();
+    queue.addConsumer();
+    for (int i = 0; i < 3; i++)
+      EXPECT_TRUE(queue.push(createMessage(i)));
+    EXPECT_FALSE(queue.isIdle());
+    queue.removeProducer();
+    //remaining messages can still be read
+    for (int i = 0; i < 3; i++) {
+      EvtMessage* msg = queue.pop();
+      ASSERT_NE(msg, nullptr);
+      EXPECT_EQ(getNumber(msg), i);
+      delete msg;
+    }
+    EXPECT_EQ(queue.pop(), nullptr);
+    EXPECT_FALSE(queue.push(createMessage(4)));
+  }
+
+  /** Messages are discarded once all consumers are gone. */
+  TEST(EventQueueTest, ConsumersGone)
+  {
+    EventQueue queue(2);
+    queue.addProducer();
+    queue.addConsumer();
+    EXPECT_TRUE(queue.push(createMessage(1)));
+    queue.removeConsumer();
+    EXPECT_TRUE(queue.isIdle());
+    EXPECT_FALSE(queue.push(createMessage(2)));
+  }
+
+  /** waitUntilIdle() returns once all messages are processed and the consumers wait for more. */
+  TEST(EventQueueTest, WaitUntilIdle)
+  {
+    const int nMessages = 500;
+    EventQueue queue(2);
+    queue.addProducer();
+    std::atomic<int> processed{0};
+    std::vector<std::thread> consumers;
+    for (int i = 0; i < 3; i++) {
+      queue.addConsumer();
+      consumers.emplace_back([&queue, &processed]() {
+        while (EvtMessage* msg = queue.pop()) {
+          delete msg;
+          processed++;
+        }
+        queue.removeConsumer();
+      });
+    }
+    for (int round = 1; round <= 3; round++) {
+      for (int i = 0; i < nMessages; i++)
+        queue.push(createMessage(i));
+      queue.waitUntilIdle();
+      EXPECT_TRUE(queue.isIdle());
+      EXPECT_EQ(processed, round * nMessages);
+    }
+    queue.removeProducer();
+    for (std::thread& consumer : consumers)
+      consumer.join();
+    //doesn't block once the queue is closed
+    queue.waitUntilIdle();
+  }
+
+  /** All messages arrive exactly once with several producers and consumers. */
+  TEST(EventQueueTest, Threads)
+  {
+    const int nThreads = 4;
+    const int nMessages = 1000;
+    EventQueue queue(3);
+    std::vector<int> received(nThreads * nMessages, 0);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < nThreads; i++) {
+      queue.addProducer();
+      queue.addConsumer();
+    }
+    for (int i = 0; i < nThreads; i++) {
+      threads.emplace_back([&queue, i]() {
+        for (int j = 0; j < nMessages; j++)
+          queue.push(createMessage(i * nMessages + j));
+        queue.removeProducer();
+      });
+      threads.emplace_back([&queue, &received]() {
+        while (EvtMessage* msg = queue.pop()) {
+          //each number is only sent once, so no two threads write to the same element
+          received[getNumber(msg)]++;
+          delete msg;
+        }
+        queue.removeConsumer();
+      });
+    }
+    for (std::thread& thread : threads)
+      thread.join();
+    for (int count : received)
+      EXPECT_EQ(count, 1);
+  }
+
+  /** Stages as in the ThreadedEventProcessor: the input sends the events of several runs to the
+   * workers, which pass them on to the output. Waiting for both queues to be idle before a new run
+   * is started keeps the runs in order at the output. */
+  TEST(EventQueueTest, RunsStayInOrder)
+  {
+    const int nWorkers = 4;
+    const std::vector<int> nEvents = {40, 25, 60};
+    EventQueue input(2 * nWorkers);
+    EventQueue output(2 * nWorkers);
+    input.addProducer();
+    output.addConsumer();
+    std::vector<std::thread> threads;
+    for (int i = 0; i < nWorkers; i++) {
+      input.addConsumer();
+      output.addProducer();
+      threads.emplace_back([&input, &output]() {
+        while (EvtMessage* msg = input.pop()) {
+          output.push(createMessage(getNumber(msg)));
+          delete msg;
+        }
+        input.removeConsumer();
+        output.removeProducer();
+      });
+    }
+    //event number is 1000 * run + event
+    std::vector<int> written;
+    threads.emplace_back([&output, &written]() {
+      while (EvtMessage* msg = output.pop()) {
+        written.push_back(getNumber(msg));
+        delete msg;
+      }
+      output.removeConsumer();
+    });
+    for (int run = 0; run < int(nEvents.size()); run++) {
+      input.waitUntilIdle();
+      output.waitUntilIdle();
+      for (int event = 0; event < nEvents[run]; event++)
+        input.push(createMessage(1000 * run + event));
+    }
+    input.removeProducer();
+    for (std::thread& thread : threads)
+      thread.join();
+
+    std::vector<int> expected;
+    for (int run = 0; run < int(nEvents.size()); run++)
+      for (int event = 0; event < nEvents[run]; event++)
+        expected.push_back(1000 * run + event);
+    ASSERT_EQ(written.size(), expected.size());
+    for (size_t i = 1; i < written.size(); i++)
+      EXPECT_LE(written[i - 1] / 1000, written[i] / 1000);
+    std::sort(written.begin(), written.end());
+    EXPECT_EQ(written, expected);
+  }
+}
@@ -9,6 +9,9 @@
 #include <framework/utilities/TestHelpers.h>
 #include <gtest/gtest.h>
 
+#include <cmath>
+#include <limits>
+
 using namespace Belle2;
 namespace {
   /// Class to mock objects for out variable manager.
@@ -271,4 +274,73 @@ namespace {
   }
 
 
+  /// Compile a cut directly into the node tree, to compare it with the bytecode.
+  std::unique_ptr<const AbstractBooleanNode<MockVariableManager>> compileTree(const std::string& cut)
+  {
+    py::tuple tuple = py::extract<py::tuple>(py::import("b2parser").attr("parse")(cut));
+    return NodeFactory::compile_boolean_node<MockVariableManager>(tuple);
+  }
+
+  /// Test that the bytecode gives the same results as the node tree, including short-circuits and folded constants.
+  TEST(GeneralCutTest, bytecodeMatchesTree)
+  {
+    const std::vector<std::string> cuts = {
+      "mocking_variable > 1.0",
+      "1.0 < mocking_variable <= 5",
+      "-mocking_variable < -4 or mocking_variable == 0",
+      "not [mocking_variable > 2 and mocking_variable < 100]",
+      "[mocking_variable * 2 + 1 > 3 or mocking_variable ** 2 == 1] and mocking_variable / 3 != 1",
+      "( mocking_variable - 1 ) * 2 >= mocking_variable",
+      "1 < 2 and mocking_variable > 0",
+      "1 > 2 or mocking_variable > 0",
+      "3 * 2 == 6 and -( 2 - 3 ) == 1 and 7 / 2 == 3.5 and 2 ** 3 == 8",
+      "mocking_variable",
+      "not mocking_variable",
+      "mocking_variable == mocking_variable",
+      "0 < mocking_variable < 1e10 and not [mocking_variable < -1 or mocking_variable > 1]",
+      "[1.8 < mocking_variable < 1.9 or mocking_variable > 5.2] and mocking_variable * 2 != 3 and "
+      "-mocking_variable > -10 and [mocking_variable < 0 or mocking_variable ** 2 > 0.1]",
+      "[mocking_variable > 1 or mocking_variable < 0] and [mocking_variable < 3 or mocking_variable > 10]",
+      "[mocking_variable > 1 and mocking_variable < 5] or not [mocking_variable == 0 or mocking_variable > 0.7] or 1 < 2 and False",
+      "[[0 < mocking_variable < 2 and mocking_variable != 1] or [mocking_variable > 4 and mocking_variable]] and mocking_variable < 4.5",
+    };
+    const std::vector<double> values = {4.2, -1.0, 0.0, 1.0, 1e20, std::numeric_limits<double>::quiet_NaN(), 0.5, 1.85};
+    MockObjectType testObject;
+    for (const std::string& cut : cuts) {
+      std::unique_ptr<MockGeneralCut> compiled = MockGeneralCut::compile(cut, true);
+      auto tree = compileTree(cut);
+      for (double value : values) {
+        testObject.value = value;
+        EXPECT_EQ(compiled->check(&testObject), tree->check(&testObject)) << cut << " with " << value;
+      }
+    }
+
+    // the node tree is used unless the bytecode is requested
+    EXPECT_EQ(MockGeneralCut::compile("mocking_variable > 1.0")->getBytecode(), nullptr);
+
+    // only the comparison with the variable remains, the variable table has a single entry
+    std::unique_ptr<MockGeneralCut> a = MockGeneralCut::compile("2 * 3 < mocking_variable + 1 and 1 < 2 and mocking_variable < 2 ** 4", true);
+    ASSERT_NE(a->getBytecode(), nullptr);
+    EXPECT_EQ(a->getBytecode()->getVariables().size(), 1u);
+    testObject.value = 5.5;
+    EXPECT_TRUE(a->check(&testObject));
+    testObject.value = 16;
+    EXPECT_FALSE(a->check(&testObject));
+
+    // a range is a load, a comparison jumping to the end if it fails and the second comparison
+    a = MockGeneralCut::compile("1.0 < mocking_variable <= 5", true);
+    EXPECT_EQ(a->getBytecode()->getInstructions().size(), 3u);
+
+    // cuts without variables are folded completely
+    a = MockGeneralCut::compile("[1 < 2 < 3 or 3 > 4 ] and [ 5 < 6 or 7 > 6 ]", true);
+    EXPECT_TRUE(a->getBytecode()->getInstructions().empty());
+    EXPECT_TRUE(a->check(&testObject));
+
+    // invalid operations are reported when checking, like in the tree
+    a = MockGeneralCut::compile("-True == 1", true);
+    EXPECT_THROW(a->check(&testObject), std::runtime_error);
+    a = MockGeneralCut::compile("True + 1 == 2", true);
+    EXPECT_THROW(a->check(&testObject), std::runtime_error);
+  }
+
 }  // namespace
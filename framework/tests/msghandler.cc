@@ -55,6 +55,33 @@ namespace {
     delete msg;
   }
 
+  /** encode_msg_inplace() creates the same message as encode_msg(), without an extra copy. */
+  TEST(MsgHandlerTest, inplace)
+  {
+    TClonesArray longarray("Belle2::EventMetaData");
+    longarray.ExpandCreate(100);
+    for (int complevel : {0, 101}) {
+      MsgHandler handler(complevel);
+      handler.add(&longarray, "mcparticles");
+      EvtMessage* msg = handler.encode_msg(MSG_EVENT);
+      handler.add(&longarray, "mcparticles");
+      EvtMessage* inplace = handler.encode_msg_inplace(MSG_EVENT);
+      ASSERT_EQ(msg->size(), inplace->size());
+      EXPECT_EQ(msg->getMsgFlags(), inplace->getMsgFlags());
+      EXPECT_EQ(0, memcmp(msg->msg(), inplace->msg(), msg->paddedSize() * sizeof(int) - sizeof(EvtHeader)));
+
+      MsgHandler handler2;
+      vector<TObject*> objs;
+      vector<string> names;
+      handler2.decode_msg(inplace, objs, names);
+      ASSERT_EQ(1, objs.size());
+      ASSERT_EQ("mcparticles", names[0]);
+      EXPECT_EQ(100, static_cast<TClonesArray*>(objs[0])->GetEntriesFast());
+      for (auto o : objs) delete o;
+      delete msg;
+    }
+  }
+
   TEST(MsgHandlerTest, compression)
   {
     TClonesArray longarray("Belle2::EventMetaData");
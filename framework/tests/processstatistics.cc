@@ -90,4 +90,34 @@ namespace {
     EXPECT_EQ(1, a.getStatistics(&dummyMod).getCalls());
     EXPECT_FLOAT_EQ(sum, a.getGlobal().getTimeSum());
   }
+
+  TEST(ProcessStatisticsTest, InputCounts)
+  {
+    ProcessStatistics a;
+    DummyModule dummyMod;
+    a.startModule();
+    ProcessStatistics::countInput(100);
+    ProcessStatistics::countReadAhead(2, 1, 5);
+    a.stopModule(&dummyMod, ModuleStatistics::c_Event);
+    //counted outside of a module call, not attributed to the next one
+    ProcessStatistics::countInput(50);
+    a.startModule();
+    ProcessStatistics::countInput(10);
+    a.stopModule(&dummyMod, ModuleStatistics::c_Event);
+
+    const ModuleStatistics& stats = a.getStatistics(&dummyMod);
+    EXPECT_EQ(110u, stats.getInputBytes());
+    EXPECT_EQ(2u, stats.getReadAheadHits());
+    EXPECT_EQ(1u, stats.getReadAheadRestarts());
+    EXPECT_DOUBLE_EQ(5, stats.getReadAheadWaitTime());
+
+    ModuleStatistics merged;
+    merged.update(stats);
+    merged.update(stats);
+    EXPECT_EQ(220u, merged.getInputBytes());
+    EXPECT_EQ(4u, merged.getReadAheadHits());
+    merged.clear();
+    EXPECT_EQ(0u, merged.getInputBytes());
+    EXPECT_DOUBLE_EQ(0, merged.getReadAheadWaitTime());
+  }
 }  // namespace
@@ -9,6 +9,7 @@
 #include <framework/dataobjects/EventMetaData.h>
 #include <framework/dataobjects/ProfileInfo.h>
 #include <framework/datastore/RelationsObject.h>
+#include <framework/datastore/RelationIndex.h>
 #include <framework/utilities/TestHelpers.h>
 
 #include <gtest/gtest.h>
@@ -267,4 +268,83 @@ namespace {
     EXPECT_B2FATAL((relObjData)[0]->addRelationTo(&notInArray, 1.0, relationName));
   }
 
+  /** Test that relations added or modified between lookups are found in the right order. */
+  TEST_F(RelationsObjectTest, InterleavedAddAndFind)
+  {
+    StoreArray<RelationsObject> otherObjects("OtherObjects");
+    otherObjects.registerInDataStore();
+    relObjData.registerRelationTo(otherObjects);
+    DataStore::Instance().setInitializeActive(false);
+    for (int i = 0; i < 10; ++i)
+      otherObjects.appendNew();
+
+    relObjData[0]->addRelationTo(otherObjects[3], 1.0);
+    relObjData[1]->addRelationTo(otherObjects[3], 2.0);
+    EXPECT_EQ(2u, otherObjects[3]->getRelationsFrom<RelationsObject>().size());
+
+    //added after the first lookup
+    for (int i = 0; i < 50; i++) {
+      relObjData[0]->addRelationTo(otherObjects[i % 10], i);
+      RelationVector<RelationsObject> rels = relObjData[0]->getRelationsTo<RelationsObject>();
+      ASSERT_EQ(i + 2u, rels.size());
+      EXPECT_EQ(otherObjects[3], rels.object(0));
+      EXPECT_EQ(otherObjects[i % 10], rels.object(i + 1));
+      EXPECT_DOUBLE_EQ(i, rels.weight(i + 1));
+    }
+    EXPECT_EQ(otherObjects[3], relObjData[0]->getRelatedTo<RelationsObject>());
+    EXPECT_EQ(relObjData[0], otherObjects[3]->getRelatedFrom<RelationsObject>());
+    EXPECT_EQ(7u, otherObjects[3]->getRelationsFrom<RelationsObject>().size());
+    EXPECT_EQ(nullptr, relObjData[2]->getRelatedTo<RelationsObject>());
+
+    //modified through a RelationVector
+    RelationVector<RelationsObject> rels = relObjData[1]->getRelationsTo<RelationsObject>();
+    rels.setWeight(0, 5.0);
+    EXPECT_DOUBLE_EQ(5.0, relObjData[1]->getRelatedToWithWeight<RelationsObject>().second);
+    rels.remove(0);
+    EXPECT_EQ(nullptr, relObjData[1]->getRelatedTo<RelationsObject>());
+    EXPECT_EQ(6u, otherObjects[3]->getRelationsFrom<RelationsObject>().size());
+
+    //next event
+    DataStore::Instance().invalidateData(DataStore::c_Event);
+    for (int i = 0; i < 3; ++i) {
+      relObjData.appendNew();
+      otherObjects.appendNew();
+    }
+    EXPECT_EQ(nullptr, relObjData[0]->getRelatedTo<RelationsObject>());
+    relObjData[2]->addRelationTo(otherObjects[1]);
+    EXPECT_EQ(otherObjects[1], relObjData[2]->getRelatedTo<RelationsObject>());
+    EXPECT_EQ(1u, otherObjects[1]->getRelationsWith<RelationsObject>().size());
+  }
+
+  /** Relation lookups through RelationsObject should give the same relations as the RelationIndex. */
+  TEST_F(RelationsObjectTest, RelationLookupMatchesIndex)
+  {
+    const int nObjects = 100;
+    const int nRelationsPerObject = 3;
+
+    relObjData.registerRelationTo(profileData);
+    DataStore::Instance().setInitializeActive(false);
+    for (int i = 10; i < nObjects; ++i) {
+      relObjData.appendNew();
+      profileData.appendNew();
+    }
+    for (int i = 0; i < nObjects; ++i)
+      for (int j = 0; j < nRelationsPerObject; ++j)
+        relObjData[i]->addRelationTo(profileData[(i * 7 + j) % nObjects], j);
+
+    RelationIndex<RelationsObject, ProfileInfo> relIndex;
+    for (const RelationsObject& obj : relObjData) {
+      RelationVector<ProfileInfo> rels = obj.getRelationsTo<ProfileInfo>();
+      ASSERT_EQ(size_t(nRelationsPerObject), rels.size());
+      size_t iRel = 0;
+      for (const auto& element : relIndex.getElementsFrom(obj)) {
+        ASSERT_LT(iRel, rels.size());
+        EXPECT_EQ(element.to, rels.object(iRel));
+        EXPECT_DOUBLE_EQ(element.weight, rels.weight(iRel));
+        iRel++;
+      }
+      EXPECT_EQ(rels.size(), iRel);
+    }
+  }
+
 }  // namespace
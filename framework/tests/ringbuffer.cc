@@ -0,0 +1,321 @@
+/**************************************************************************
+ * basf2 (Belle II Analysis Software Framework)                           *
+ * Author: The Belle II Collaboration                                     *
+ *                                                                        *
+ * See git log for contributors and copyright holders.                    *
+ * This file is licensed under LGPL-3.0, see LICENSE.md.                  *
+ **************************************************************************/
+
+#include <framework/pcore/LockFreeRingBuffer.h>
+#include <framework/pcore/SysVRingBuffer.h>
+#include <framework/logging/Logger.h>
+#include <framework/utilities/TestHelpers.h>
+
+#include <gtest/gtest.h>
+
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace Belle2;
+
+namespace {
+  /** Unique name for a named ring buffer used by this process. */
+  std::string bufferName(const std::string& test)
+  {
+    return "test_" + test + "_" + std::to_string(getpid());
+  }
+
+  /** Fill buffer with a pattern depending on the message number. */
+  void fillMessage(std::vector<int>& buffer, int number)
+  {
+    for (size_t i = 0; i < buffer.size(); i++)
+      buffer[i] = number + i;
+  }
+
+  /** Entries are returned in order with their contents, also after wrapping around. */
+  TEST(LockFreeRingBufferTest, InsertRemove)
+  {
+    LockFreeRingBuffer rb(1000);
+    std::vector<int> out(1000);
+    EXPECT_EQ(rb.remq(out.data()), 0);
+    for (int round = 0; round < 100; round++) {
+      //varying sizes, so records end up at all positions of the data area
+      const int size = 1 + (round * 37) % 150;
+      std::vector<int> in(size);
+      fillMessage(in, round);
+      ASSERT_EQ(rb.insq(in.data(), size), size);
+      ASSERT_EQ(rb.insq(in.data(), size), size);
+      EXPECT_EQ(rb.numq(), 2);
+      for (int i = 0; i < 2; i++) {
+        ASSERT_EQ(rb.remq(out.data()), size);
+        for (int j = 0; j < size; j++)
+          ASSERT_EQ(out[j], round + j);
+      }
+      EXPECT_EQ(rb.numq(), 0);
+    }
+    EXPECT_EQ(rb.ninsq(), 200);
+    EXPECT_EQ(rb.nremq(), 200);
+  }
+
+  /** readInPlace() returns the data inside the ring buffer, its space is reused only after releaseInPlace(). */
+  TEST(LockFreeRingBufferTest, ReadInPlace)
+  {
+    LockFreeRingBuffer rb(1000);
+    std::vector<int> in(100);
+    fillMessage(in, 7);
+    int nwords = -1;
+    EXPECT_EQ(rb.readInPlace(nwords), nullptr);
+    EXPECT_EQ(nwords, 0);
+    while (rb.insq(in.data(), in.size()) > 0) { }
+    const int inserted = rb.numq();
+    const int* data = rb.readInPlace(nwords);
+    ASSERT_NE(data, nullptr);
+    EXPECT_EQ(nwords, 100);
+    //still full while we hold the record
+    EXPECT_EQ(rb.insq(in.data(), in.size()), -1);
+    EXPECT_EQ(rb.numq(), inserted);
+    for (int i = 0; i < nwords; i++)
+      EXPECT_EQ(data[i], 7 + i);
+    rb.releaseInPlace();
+    EXPECT_EQ(rb.numq(), inserted - 1);
+    EXPECT_EQ(rb.insq(in.data(), in.size()), 100);
+  }
+
+  /** insq() fails if there is no space and succeeds again once entries are removed. */
+  TEST(LockFreeRingBufferTest, Full)
+  {
+    LockFreeRingBuffer rb(1000);
+    std::vector<int> in(100, 1);
+    int inserted = 0;
+    while (rb.insq(in.data(), in.size()) > 0)
+      inserted++;
+    EXPECT_GT(inserted, 0);
+    EXPECT_EQ(rb.numq(), inserted);
+    EXPECT_EQ(rb.insq(in.data(), in.size()), -1);
+    //discarding an entry makes space
+    EXPECT_EQ(rb.remq(nullptr), 100);
+    EXPECT_EQ(rb.insq(in.data(), in.size()), 100);
+    EXPECT_EQ(rb.clear(), 0);
+    EXPECT_EQ(rb.numq(), 0);
+
+    std::vector<int> tooLarge(1000);
+    EXPECT_THROW(rb.insq(tooLarge.data(), tooLarge.size()), std::runtime_error);
+  }
+
+  /** Readers see the buffer as dead once the writers are gone and the entries are read, or after kill(). */
+  TEST(LockFreeRingBufferTest, Dead)
+  {
+    LockFreeRingBuffer rb(1000);
+    std::vector<int> buffer(10, 1);
+    //no writer attached yet
+    EXPECT_FALSE(rb.isDead());
+    rb.txAttached();
+    rb.txAttached();
+    rb.insq(buffer.data(), buffer.size());
+    rb.txDetached();
+    rb.txDetached();
+    EXPECT_FALSE(rb.isDead());
+    EXPECT_FALSE(rb.allRxWaiting());
+    EXPECT_EQ(rb.remq(buffer.data()), 10);
+    //we are still processing the entry
+    EXPECT_FALSE(rb.allRxWaiting());
+    EXPECT_EQ(rb.remq(buffer.data()), 0);
+    EXPECT_TRUE(rb.allRxWaiting());
+    EXPECT_TRUE(rb.isDead());
+    //doesn't block
+    rb.waitForEntries(-1);
+
+    LockFreeRingBuffer rb2(1000);
+    rb2.txAttached();
+    rb2.insq(buffer.data(), buffer.size());
+    rb2.kill();
+    EXPECT_TRUE(rb2.isDead());
+    EXPECT_EQ(rb2.remq(buffer.data()), 0);
+  }
+
+  /** Private buffers are shared with forked processes. */
+  TEST(LockFreeRingBufferTest, Fork)
+  {
+    LockFreeRingBuffer rb(10000);
+    const int nMessages = 1000;
+    rb.txAttached();
+    pid_t pid = fork();
+    ASSERT_GE(pid, 0);
+    if (pid == 0) {
+      std::vector<int> buffer(50);
+      for (int i = 0; i < nMessages; i++) {
+        fillMessage(buffer, i);
+        while (rb.insq(buffer.data(), buffer.size()) < 0)
+          rb.waitForSpace(1000);
+      }
+      rb.txDetached();
+      _exit(0);
+    }
+    std::vector<int> buffer(50);
+    int received = 0;
+    while (!rb.isDead()) {
+      if (rb.remq(buffer.data()) == 0) {
+        rb.waitForEntries(1000);
+        continue;
+      }
+      EXPECT_EQ(buffer[49], received + 49);
+      received++;
+    }
+    EXPECT_EQ(received, nMessages);
+    int status = -1;
+    waitpid(pid, &status, 0);
+    EXPECT_EQ(status, 0);
+  }
+
+  /** A producer killed while holding the producer lock doesn't block the other producers. */
+  TEST(LockFreeRingBufferTest, ProducerDied)
+  {
+    const std::string name = bufferName("died");
+    LockFreeRingBuffer rb(name, 1000);
+    //map the control structure a second time to take the lock directly
+    const char* user = getenv("USER");
+    const std::string path = "/" + std::string(user ? user : "basf2") + "_LFRB_" + name;
+    const int fd = shm_open(path.c_str(), O_RDWR, 0644);
+    ASSERT_GE(fd, 0);
+    void* shm = mmap(nullptr, sizeof(LockFreeRingBufInfo), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    ASSERT_NE(shm, MAP_FAILED);
+    auto* info = reinterpret_cast<LockFreeRingBufInfo*>(shm);
+    pid_t pid = fork();
+    ASSERT_GE(pid, 0);
+    if (pid == 0) {
+      pthread_mutex_lock(&info->producerLock);
+      _exit(0);
+    }
+    int status = -1;
+    waitpid(pid, &status, 0);
+    EXPECT_EQ(status, 0);
+    munmap(shm, sizeof(LockFreeRingBufInfo));
+
+    std::vector<int> in(10);
+    fillMessage(in, 3);
+    EXPECT_B2WARNING(EXPECT_EQ(rb.insq(in.data(), in.size()), 10));
+    //and the lock works normally afterwards
+    EXPECT_EQ(rb.insq(in.data(), in.size()), 10);
+    std::vector<int> out(10);
+    EXPECT_EQ(rb.remq(out.data()), 10);
+    EXPECT_EQ(out, in);
+  }
+
+  /** A consumer killed while holding a record doesn't block the producers once the buffer is full. */
+  TEST(LockFreeRingBufferTest, ConsumerDied)
+  {
+    LockFreeRingBuffer rb(1000);
+    std::vector<int> in(100);
+    fillMessage(in, 5);
+    int inserted = 0;
+    while (rb.insq(in.data(), in.size()) > 0)
+      inserted++;
+    pid_t pid = fork();
+    ASSERT_GE(pid, 0);
+    if (pid == 0) {
+      int nwords = 0;
+      rb.readInPlace(nwords);
+      _exit(nwords == 100 ? 0 : 1);
+    }
+    int status = -1;
+    waitpid(pid, &status, 0);
+    EXPECT_EQ(status, 0);
+    EXPECT_EQ(rb.numq(), inserted);
+    EXPECT_FALSE(rb.allRxWaiting());
+
+    //the record of the dead consumer is dropped to make space
+    EXPECT_B2WARNING(EXPECT_EQ(rb.insq(in.data(), in.size()), 100));
+    EXPECT_EQ(rb.numq(), inserted);
+    std::vector<int> out(100);
+    for (int i = 0; i < inserted; i++) {
+      ASSERT_EQ(rb.remq(out.data()), 100);
+      EXPECT_EQ(out, in);
+    }
+    EXPECT_EQ(rb.remq(out.data()), 0);
+    EXPECT_TRUE(rb.allRxWaiting());
+  }
+
+  /** All messages arrive exactly once with several reading threads, each attached to the named buffer. */
+  TEST(LockFreeRingBufferTest, Threads)
+  {
+    const std::string name = bufferName("threads");
+    const int nMessages = 20000;
+    const int nReaders = 3;
+    const int messageWords = 100;
+    LockFreeRingBuffer writer(name, 5000);
+    writer.txAttached();
+    std::vector<int> received(nReaders, 0);
+    std::atomic<int> started{0};
+    std::vector<std::thread> readers;
+    for (int i = 0; i < nReaders; i++) {
+      readers.emplace_back([&, i]() {
+        LockFreeRingBuffer reader(name);
+        std::vector<int> buffer(messageWords);
+        started++;
+        while (!reader.isDead()) {
+          if (reader.remq(buffer.data()) == 0) {
+            reader.waitForEntries(1000);
+            continue;
+          }
+          received[i]++;
+        }
+      });
+    }
+    while (started < nReaders)
+      std::this_thread::yield();
+
+    std::vector<int> message(messageWords);
+    for (int i = 0; i < nMessages; i++) {
+      message[0] = i;
+      while (writer.insq(message.data(), messageWords) < 0)
+        writer.waitForSpace(1000);
+    }
+    writer.txDetached();
+    for (std::thread& reader : readers)
+      reader.join();
+    int total = 0;
+    for (int count : received)
+      total += count;
+    EXPECT_EQ(total, nMessages);
+  }
+
+  /** Named buffers for external programs are plain SysV RingBuffers, readInPlace() copies. */
+  TEST(SysVRingBufferTest, ExternalRingBuffer)
+  {
+    const std::string name = bufferName("SysV");
+    SysVRingBuffer rb(name, 100000);
+    RingBuffer external(name);
+    std::vector<int> in(3);
+    fillMessage(in, 1);
+    EXPECT_EQ(rb.insq(in.data(), 3), 3);
+    EXPECT_EQ(external.numq(), 1);
+    std::vector<int> out(3);
+    EXPECT_EQ(external.remq(out.data()), 3);
+    EXPECT_EQ(out, in);
+
+    external.insq(in.data(), 2);
+    int nwords = 0;
+    const int* data = rb.readInPlace(nwords);
+    ASSERT_NE(data, nullptr);
+    EXPECT_EQ(nwords, 2);
+    EXPECT_EQ(data[1], in[1]);
+    rb.releaseInPlace();
+    EXPECT_EQ(rb.readInPlace(nwords), nullptr);
+    EXPECT_EQ(nwords, 0);
+
+    rb.txAttached();
+    EXPECT_FALSE(rb.isDead());
+    rb.txDetached();
+    EXPECT_TRUE(rb.isDead());
+  }
+}
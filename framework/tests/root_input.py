@@ -8,6 +8,7 @@
 # This file is licensed under LGPL-3.0, see LICENSE.md.                  #
 ##########################################################################
 
+import glob
 import os
 import basf2
 from ROOT import Belle2
@@ -171,3 +172,66 @@ with clean_working_directory():
     main.add_module("RootInput", inputFileName="brokenevents.root")
     main.add_module(TestingModule([3, 5, 6, 8]))
     assert safe_process(main) == 0
+
+    class EventDigest(basf2.Module):
+        """
+        Writes the event number and a summary of the PXDDigits of each event
+        into a text file per process
+        """
+
+        def __init__(self, prefix):
+            """
+            Initialize with the prefix of the output file names
+            """
+            super().__init__()
+            self.set_property_flags(basf2.ModulePropFlags.PARALLELPROCESSINGCERTIFIED)
+            #: prefix of the output file names
+            self._prefix = prefix
+
+        def event(self):
+            """Append the summary of this event to the file of this process"""
+            emd = Belle2.PyStoreObj('EventMetaData')
+            digits = Belle2.PyStoreArray('PXDDigits')
+            charge = sum(digit.getCharge() for digit in digits)
+            with open(f"{self._prefix}_{os.getpid()}.txt", "a") as digest:
+                digest.write(f"{emd.getEvent()} {digits.getEntries()} {charge}\n")
+
+    def read_digest(nprocesses=0, **params):
+        """
+        Read root_input.root with the given RootInput parameters and return the
+        summaries of all events, sorted by event number for multiprocessing
+        """
+        prefix = f"digest_{nprocesses}_" + "_".join(f"{key}{value}" for key, value in params.items())
+        main = basf2.Path()
+        main.add_module("RootInput", inputFileName="root_input.root", branchNames=["EventMetaData", "PXDDigits"], **params)
+        main.add_module(EventDigest(prefix))
+        basf2.set_nprocesses(nprocesses)
+        assert safe_process(main) == 0
+        basf2.set_nprocesses(0)
+        lines = []
+        for filename in glob.glob(f"{prefix}_*.txt"):
+            with open(filename) as digest:
+                lines += digest.readlines()
+        assert lines
+        return sorted(lines, key=lambda line: int(line.split()[0])) if nprocesses > 0 else lines
+
+    # Reading ahead in a background thread, with and without parallel decompression, has to give
+    # the same events with the same content as reading synchronously. With multiprocessing the
+    # first entry is read before the input process is forked, so read-ahead must only start afterwards.
+    log_level = basf2.logging.log_level
+    basf2.logging.log_level = basf2.LogLevel.WARNING  # suppress output
+    expected = read_digest()
+    # the amount of data read and the read-ahead counters are in the module statistics
+    stats = next(stats for stats in basf2.statistics.modules if stats.name == "RootInput")
+    assert stats.input_bytes > 0
+    assert stats.read_ahead_hits == 0
+    assert read_digest(readAheadEntries=3) == expected
+    stats = next(stats for stats in basf2.statistics.modules if stats.name == "RootInput")
+    assert stats.input_bytes > 0
+    assert stats.read_ahead_hits <= stats.calls(basf2.statistics.EVENT)
+    assert stats.read_ahead_restarts == 0
+    assert read_digest(readAheadEntries=3, decompressionThreads=2) == expected
+    expected_sorted = sorted(expected, key=lambda line: int(line.split()[0]))
+    assert read_digest(nprocesses=2) == expected_sorted
+    assert read_digest(nprocesses=2, readAheadEntries=3) == expected_sorted
+    basf2.logging.log_level = log_level
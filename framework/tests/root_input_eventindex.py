@@ -0,0 +1,86 @@
+#!/usr/bin/env python3
+
+##########################################################################
+# basf2 (Belle II Analysis Software Framework)                           #
+# Author: The Belle II Collaboration                                     #
+#                                                                        #
+# See git log for contributors and copyright holders.                    #
+# This file is licensed under LGPL-3.0, see LICENSE.md.                  #
+##########################################################################
+
+"""Check that RootInput can select events and find events across files with an event index"""
+
+import subprocess
+import basf2
+from ROOT import Belle2
+from b2test_utils import clean_working_directory, safe_process
+
+# @cond internal_test
+
+
+class Select(basf2.Module):
+    """Create an array only for selected events, used as skim flag"""
+
+    def initialize(self):
+        self.selected = Belle2.PyStoreArray(Belle2.EventMetaData.Class(), "Selected")
+        self.selected.registerInDataStore()
+        self.event_meta_data = Belle2.PyStoreObj("EventMetaData")
+
+    def event(self):
+        meta = self.event_meta_data.obj()
+        if meta.getRun() < 3 and meta.getEvent() % 5 == 0:
+            self.selected.appendNew()
+
+
+class CollectEvents(basf2.Module):
+    """Remember run and event numbers of all events"""
+
+    def __init__(self):
+        super().__init__()
+        self.events = []
+
+    def event(self):
+        meta = Belle2.PyStoreObj("EventMetaData").obj()
+        self.events.append((meta.getRun(), meta.getEvent()))
+
+
+def read(filenames, **parameters):
+    """Read the files and return the list of (run, event)"""
+    collect = CollectEvents()
+    path = basf2.Path()
+    path.add_module("RootInput", inputFileNames=filenames, **parameters)
+    path.add_module(collect)
+    assert safe_process(path) == 0, "RootInput failed"
+    return collect.events
+
+
+if __name__ == "__main__":
+    basf2.logging.log_level = basf2.LogLevel.ERROR
+    basf2.logging.enable_summary(False)
+    with clean_working_directory():
+        files = []
+        for run in range(1, 4):
+            files.append(f"run{run}.root")
+            path = basf2.Path()
+            path.add_module("EventInfoSetter", expList=[0], runList=[run], evtNumList=[20])
+            path.add_module(Select())
+            path.add_module("RootOutput", outputFileName=files[-1], eventIndexFileName=f"run{run}.b2idx",
+                            eventIndexSkimBranches=["Selected"], updateFileCatalog=False)
+            assert safe_process(path) == 0, "RootOutput failed"
+
+        # merge the indices of all jobs
+        subprocess.check_call(["b2file-index", "-o", "all.b2idx", "run1.b2idx", "run2.b2idx", "run3.b2idx"])
+
+        expected = [(run, event) for run in (1, 2) for event in range(1, 21) if event % 5 == 0]
+        assert read(files, eventIndex="all.b2idx", eventIndexSkims=["Selected"]) == expected, "Wrong events selected"
+
+        # skipToEvent finds the event in any file
+        events = read(files, eventIndex="all.b2idx", skipToEvent=[0, 3, 18])
+        assert events == [(3, 18), (3, 19), (3, 20)], "skipToEvent did not start at the right event"
+
+        # the index can also be created from the files themselves
+        subprocess.check_call(["b2file-index", "-o", "files.b2idx"] + files)
+        events = read(files, eventIndex="files.b2idx", skipToEvent=[0, 2, 20])
+        assert events[0] == (2, 20) and len(events) == 21, "skipToEvent did not start at the right event"
+
+# @endcond
@@ -0,0 +1,79 @@
+#!/usr/bin/env python3
+
+##########################################################################
+# basf2 (Belle II Analysis Software Framework)                           #
+# Author: The Belle II Collaboration                                     #
+#                                                                        #
+# See git log for contributors and copyright holders.                    #
+# This file is licensed under LGPL-3.0, see LICENSE.md.                  #
+##########################################################################
+
+"""Check that writing in a separate output thread (writeQueueDepth) produces the same file layout"""
+
+import os
+import basf2
+import ROOT
+from ROOT import Belle2
+from b2test_utils import clean_working_directory, safe_process
+
+# @cond internal_test
+
+
+class CreateDummyData(basf2.Module):
+    """Create some random data to have event size not be too small"""
+
+    def __init__(self, size):
+        super().__init__()
+        self.size = size // 8
+        self.chunk_data = Belle2.PyStoreObj(Belle2.TestChunkData.Class())
+
+    def initialize(self):
+        self.chunk_data.registerInDataStore()
+
+    def event(self):
+        self.chunk_data.assign(Belle2.TestChunkData(self.size))
+
+
+def write(filename, **parameters):
+    """Write some events with the given RootOutput parameters"""
+    basf2.set_random_seed("something important")
+    path = basf2.Path()
+    path.add_module("EventInfoSetter", evtNumList=500)
+    path.add_module(CreateDummyData(1024 * 10))
+    path.add_module("RootOutput", outputFileName=filename, updateFileCatalog=False, compressionAlgorithm=1,
+                    compressionLevel=1, autoFlushSize=-1000000, **parameters)
+    assert safe_process(path) == 0, "RootOutput failed"
+
+
+def get_baskets(filename):
+    """Return position and size of all baskets in the event tree"""
+    rootfile = ROOT.TFile.Open(filename)
+    tree = rootfile.Get("tree")
+    baskets = {}
+    branches = list(tree.GetListOfBranches())
+    while branches:
+        branch = branches.pop()
+        branches += list(branch.GetListOfBranches())
+        nbaskets = branch.GetWriteBasket()
+        baskets[branch.GetName()] = [(branch.GetBasketSeek(i), branch.GetBasketBytes()[i]) for i in range(nbaskets)]
+    rootfile.Close()
+    return baskets
+
+
+if __name__ == "__main__":
+    basf2.logging.log_level = basf2.LogLevel.ERROR
+    basf2.logging.enable_summary(False)
+    with clean_working_directory():
+        os.mkdir("sync")
+        os.mkdir("async")
+        write("sync/output.root")
+        write("async/output.root", writeQueueDepth=10)
+        sync = get_baskets("sync/output.root")
+        assert sync == get_baskets("async/output.root"), "File layout differs when writing in the output thread"
+        assert sum(len(baskets) for baskets in sync.values()) > 0, "No baskets written"
+
+        # file splitting also has to work with queued events
+        write("async/split.root", writeQueueDepth=10, outputSplitSize=2)
+        assert os.path.exists("async/split.f00001.root"), "File was not split"
+
+# @endcond
@@ -0,0 +1,98 @@
+/**************************************************************************
+ * basf2 (Belle II Analysis Software Framework)                           *
+ * Author: The Belle II Collaboration                                     *
+ *                                                                        *
+ * See git log for contributors and copyright holders.                    *
+ * This file is licensed under LGPL-3.0, see LICENSE.md.                  *
+ **************************************************************************/
+
+#include <framework/utilities/TaskPool.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace Belle2;
+
+namespace {
+  /** Results are returned through futures, in the order the caller asks for them. */
+  TEST(TaskPoolTest, Results)
+  {
+    TaskPool pool(4);
+    std::deque<std::future<int>> results;
+    for (int i = 0; i < 1000; i++)
+      results.push_back(pool.submit([i]() { return i * i; }));
+    for (int i = 0; i < 1000; i++) {
+      EXPECT_EQ(results.front().get(), i * i);
+      results.pop_front();
+    }
+    pool.wait();
+    const TaskPool::Statistics statistics = pool.getStatistics();
+    EXPECT_EQ(statistics.submitted, 1000u);
+    EXPECT_EQ(statistics.executed, 1000u);
+    EXPECT_EQ(statistics.queueDepth, 0u);
+  }
+
+  /** Exceptions are passed to the caller. */
+  TEST(TaskPoolTest, Exception)
+  {
+    TaskPool pool(2);
+    auto result = pool.submit([]() -> int { throw std::runtime_error("failed"); });
+    EXPECT_THROW(result.get(), std::runtime_error);
+  }
+
+  /** submit() blocks once the maximal queue depth is reached. */
+  TEST(TaskPoolTest, QueueDepth)
+  {
+    const size_t maxDepth = 3;
+    TaskPool pool(1, maxDepth);
+    std::atomic<bool> release{false};
+    //keep the only worker busy
+    auto blocker = pool.submit([&release]() { while (!release) std::this_thread::yield(); });
+    while (pool.getQueueDepth() > 0)
+      std::this_thread::yield();
+    for (size_t i = 0; i < maxDepth; i++)
+      pool.submit([]() {});
+    EXPECT_EQ(pool.getQueueDepth(), maxDepth);
+
+    std::atomic<bool> submitted{false};
+    std::thread producer([&]() {
+      pool.submit([]() {});
+      submitted = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_FALSE(submitted);
+    release = true;
+    producer.join();
+    EXPECT_TRUE(submitted);
+    pool.wait();
+    const TaskPool::Statistics statistics = pool.getStatistics();
+    EXPECT_EQ(statistics.maxQueueDepth, maxDepth);
+    EXPECT_EQ(statistics.blocked, 1u);
+    EXPECT_EQ(statistics.executed, maxDepth + 2);
+  }
+
+  /** Tasks submitted by a task go to the queue of its worker, the other workers steal them. */
+  TEST(TaskPoolTest, Stealing)
+  {
+    TaskPool pool(4);
+    auto parent = pool.submit([&pool]() {
+      std::vector<std::future<void>> children;
+      for (int i = 0; i < 20; i++)
+        children.push_back(pool.submit([]() { std::this_thread::sleep_for(std::chrono::milliseconds(1)); }));
+      //we block our own worker, so all children are executed by the other workers
+      for (auto& child : children)
+        child.get();
+    });
+    parent.get();
+    pool.wait();
+    //the parent itself may also have been stolen from the queue it was submitted to
+    const uint64_t stolen = pool.getStatistics().stolen;
+    EXPECT_GE(stolen, 20u);
+    EXPECT_LE(stolen, 21u);
+  }
+}
@@ -0,0 +1,54 @@
+#!/usr/bin/env python3
+
+##########################################################################
+# basf2 (Belle II Analysis Software Framework)                           #
+# Author: The Belle II Collaboration                                     #
+#                                                                        #
+# See git log for contributors and copyright holders.                    #
+# This file is licensed under LGPL-3.0, see LICENSE.md.                  #
+##########################################################################
+
+# Test multi-threaded event processing: the thread safe modules run in two worker
+# threads, RootOutput in the output thread. Every event has to be written exactly
+# once, processed by the thread safe modules, and a new run may only start once
+# all events of the previous run are written.
+
+import basf2
+from ROOT import TFile, Belle2
+from b2test_utils import clean_working_directory, safe_process
+
+basf2.set_log_level(basf2.LogLevel.ERROR)
+basf2.conditions.disable_globaltag_replay()
+
+runs = [(1, 40), (2, 25), (3, 60)]
+
+main = basf2.Path()
+# input stage
+main.add_module("EventInfoSetter", expList=[0] * len(runs), runList=[run for run, _ in runs],
+                evtNumList=[events for _, events in runs])
+# worker threads
+errorflag = main.add_module("EventErrorFlag", errorFlag=Belle2.EventMetaData.c_B2LinkEventCRCError)
+prune = main.add_module("PruneDataStore", matchEntries=[])
+# output stage
+main.add_module("RootOutput", outputFileName="threaded_processing.root", updateFileCatalog=False)
+
+for module in errorflag, prune:
+    if not module.has_properties(basf2.ModulePropFlags.THREADSAFE):
+        basf2.B2FATAL(f"{module.name()} is not flagged thread safe")
+
+basf2.set_nthreads(2)
+with clean_working_directory():
+    assert safe_process(main) == 0, "multi-threaded processing failed"
+
+    tfile = TFile("threaded_processing.root")
+    tree = tfile.Get("tree")
+    seen = []
+    for entry in tree:
+        metadata = entry.EventMetaData
+        assert metadata.getErrorFlag() == Belle2.EventMetaData.c_B2LinkEventCRCError, "event not processed by worker"
+        seen.append((metadata.getRun(), metadata.getEvent()))
+
+    expected = [(run, event) for run, events in runs for event in range(1, events + 1)]
+    assert sorted(seen) == expected, "missing or duplicate events"
+    written_runs = [run for run, _ in seen]
+    assert written_runs == sorted(written_runs), "events of different runs are mixed"
@@ -0,0 +1,126 @@
+/**************************************************************************
+ * basf2 (Belle II Analysis Software Framework)                           *
+ * Author: The Belle II Collaboration                                     *
+ *                                                                        *
+ * See git log for contributors and copyright holders.                    *
+ * This file is licensed under LGPL-3.0, see LICENSE.md.                  *
+ **************************************************************************/
+
+// Basf2 headers
+#include <framework/dataobjects/EventMetaData.h>
+#include <framework/io/EventIndex.h>
+#include <framework/io/RootFileInfo.h>
+#include <framework/logging/Logger.h>
+
+// ROOT headers
+#include <TError.h>
+#include <TTree.h>
+
+// C++ headers
+#include <csignal>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Boost headers
+#include <boost/program_options.hpp>
+
+using namespace Belle2;
+namespace prog = boost::program_options;
+
+namespace {
+  /** Add the events of a basf2 output file to the index. */
+  void addRootFile(EventIndex& index, const std::string& fileName)
+  {
+    RootIOUtilities::RootFileInfo fileInfo{fileName};
+    TTree& tree = fileInfo.getEventTree();
+    // only read the EventMetaData
+    tree.SetBranchStatus("*", false);
+    tree.SetBranchStatus("EventMetaData*", true);
+    EventMetaData* eventMetaData = nullptr;
+    if (tree.SetBranchAddress("EventMetaData", &eventMetaData) < 0)
+      throw std::runtime_error("No EventMetaData in file");
+
+    const uint32_t file = index.addFile(fileName);
+    const long nEntries = tree.GetEntries();
+    for (long entry = 0; entry < nEntries; entry++) {
+      if (tree.GetEntry(entry) <= 0 or !eventMetaData)
+        throw std::runtime_error("Cannot read entry " + std::to_string(entry));
+      index.addEvent(eventMetaData->getExperiment(), eventMetaData->getRun(), eventMetaData->getEvent(), file, entry);
+    }
+    tree.ResetBranchAddresses();
+    delete eventMetaData;
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  //remove SIGPIPE handler set by ROOT which sometimes caused infinite loops
+  //See https://savannah.cern.ch/bugs/?97991
+  //default action is to abort
+  if (std::signal(SIGPIPE, SIG_DFL) == SIG_ERR)
+    B2FATAL("Cannot remove SIGPIPE signal handler");
+
+  // Define command line options
+  prog::options_description options("Options");
+  options.add_options()
+  ("help,h", "print all available options")
+  ("output,o", prog::value<std::string>(), "name of the event index file to create")
+  ("input", prog::value<std::vector<std::string>>(), "basf2 output files (.root) to index, or event index files (.b2idx) to merge")
+  ("absolute,a", "store absolute file names for the indexed files")
+  ;
+
+  prog::positional_options_description posOptDesc;
+  posOptDesc.add("input", -1);
+
+  const std::string usage = std::string("Usage: ") + argv[0] + " [OPTIONS] -o INDEX FILE...\n"
+                            "Create an event index for the given files, to be used with the eventIndex parameter of RootInput.\n";
+  prog::variables_map varMap;
+  try {
+    prog::store(prog::command_line_parser(argc, argv).
+                options(options).positional(posOptDesc).run(), varMap);
+    prog::notify(varMap);
+  } catch (std::exception& e) {
+    std::cout << "Problem parsing command line: " << e.what() << std::endl;
+    std::cout << usage;
+    std::cout << options << std::endl;
+    return 1;
+  }
+
+  //Check for help option
+  if (varMap.count("help") or argc == 1) {
+    std::cout << usage;
+    std::cout << options << std::endl;
+    return 0;
+  }
+
+  if (!varMap.count("output") or !varMap.count("input"))
+    B2FATAL("Please specify the output file and at least one input file");
+
+  gErrorIgnoreLevel = kError;
+  EventIndex index;
+  for (std::string fileName : varMap["input"].as<std::vector<std::string>>()) {
+    try {
+      if (std::filesystem::path(fileName).extension() == ".b2idx") {
+        index.merge(EventIndex::read(fileName));
+      } else {
+        if (varMap.count("absolute"))
+          fileName = std::filesystem::absolute(fileName).string();
+        addRootFile(index, fileName);
+      }
+    } catch (const std::exception& e) {
+      B2FATAL("Could not index input file" << LogVar("File name", fileName) << LogVar("Issue", e.what()));
+    }
+  }
+
+  const std::string output = varMap["output"].as<std::string>();
+  try {
+    index.write(output);
+  } catch (const std::exception& e) {
+    B2FATAL("Could not write event index" << LogVar("File name", output) << LogVar("Issue", e.what()));
+  }
+  B2INFO("Event index written" << LogVar("File name", output) << LogVar("files", index.getFiles().size())
+         << LogVar("events", index.getEntries().size()));
+  return 0;
+}
@@ -12,6 +12,9 @@
 
 namespace Belle2 {
 
+  template<class AVariableManager>
+  class CutBytecode;
+
   /**
    * A parsed cut-string naturally has a tree shape which incorporates
    * the information of operator precedence and evaluation order
@@ -46,6 +49,11 @@ namespace Belle2 {
      * pure virtual decompile function, has to be overridden in derived class
     **/
     virtual std::string decompile() const = 0;
+    /**
+     * pure virtual function to append the instructions checking this node to the bytecode,
+     * returns the operand holding the boolean result. Has to be overridden in derived class
+    **/
+    virtual int emit(CutBytecode<AVariableManager>& bytecode) const = 0;
     /**
      * Virtual destructor
     **/
@@ -82,6 +90,11 @@ namespace Belle2 {
      * pure virtual decompile function, has to be overridden in derived class
     **/
     virtual std::string decompile() const = 0;
+    /**
+     * pure virtual function to append the instructions evaluating this node to the bytecode,
+     * returns the operand holding the result. Has to be overridden in derived class
+    **/
+    virtual int emit(CutBytecode<AVariableManager>& bytecode) const = 0;
     /**
      * Virtual destructor
     **/
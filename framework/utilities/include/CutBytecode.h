@@ -0,0 +1,425 @@
+/**************************************************************************
+ * basf2 (Belle II Analysis Software Framework)                           *
+ * Author: The Belle II Collaboration                                     *
+ *                                                                        *
+ * See git log for contributors and copyright holders.                    *
+ * This file is licensed under LGPL-3.0, see LICENSE.md.                  *
+ **************************************************************************/
+
+#pragma once
+#include <framework/utilities/AbstractNodes.h>
+#include <framework/utilities/CutHelpers.h>
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <variant>
+#include <vector>
+
+namespace Belle2 {
+
+  /**
+   * Value of an expression during the evaluation of a CutBytecode.
+   * Holds a double, int or bool like the VarVariant of the variable managers, but as a plain tagged union
+   * which can be kept in a register array without the overhead of std::variant.
+   */
+  struct CutValue {
+    /** Type of the value. */
+    enum EType : uint8_t {
+      c_Double, /**< double value, stored in d */
+      c_Int, /**< int value, stored in i */
+      c_Bool /**< bool value, stored in b */
+    };
+    EType type; /**< type of the value */
+    union {
+      double d; /**< value if type is c_Double */
+      int i; /**< value if type is c_Int */
+      bool b; /**< value if type is c_Bool */
+    };
+
+    /** Create a double value */
+    static CutValue fromDouble(double value) { CutValue v; v.type = c_Double; v.d = value; return v; }
+    /** Create an int value */
+    static CutValue fromInt(int value) { CutValue v; v.type = c_Int; v.i = value; return v; }
+    /** Create a bool value */
+    static CutValue fromBool(bool value) { CutValue v; v.type = c_Bool; v.b = value; return v; }
+
+    /** Convert a variant<double, int, bool> as returned by the variable managers. */
+    template<class AVariant>
+    static CutValue fromVariant(const AVariant& value)
+    {
+      if (std::holds_alternative<double>(value)) return fromDouble(std::get<double>(value));
+      if (std::holds_alternative<int>(value)) return fromInt(std::get<int>(value));
+      return fromBool(std::get<bool>(value));
+    }
+
+    /** Value converted to double */
+    double asDouble() const { return type == c_Double ? d : (type == c_Int ? i : b); }
+    /** Value converted to int, for int and bool values */
+    int asInt() const { return type == c_Int ? i : b; }
+
+    /**
+     * Compare two values with the same rules as the Visitor and EqualVisitor in CutNodes.h:
+     * if one of the values is a double both are compared as double (== and != with almostEqualDouble),
+     * otherwise they are compared as int.
+     */
+    static bool compare(ComparisonOperator coperator, const CutValue& left, const CutValue& right)
+    {
+      if (left.type == c_Double or right.type == c_Double) {
+        const double l = left.asDouble();
+        const double r = right.asDouble();
+        switch (coperator) {
+          case ComparisonOperator::EQUALEQUAL: return almostEqualDouble(l, r);
+          case ComparisonOperator::GREATEREQUAL: return l >= r;
+          case ComparisonOperator::LESSEQUAL: return l <= r;
+          case ComparisonOperator::GREATER: return l > r;
+          case ComparisonOperator::LESS: return l < r;
+          case ComparisonOperator::NOTEQUAL: return !almostEqualDouble(l, r);
+        }
+      } else {
+        const int l = left.asInt();
+        const int r = right.asInt();
+        switch (coperator) {
+          case ComparisonOperator::EQUALEQUAL: return l == r;
+          case ComparisonOperator::GREATEREQUAL: return l >= r;
+          case ComparisonOperator::LESSEQUAL: return l <= r;
+          case ComparisonOperator::GREATER: return l > r;
+          case ComparisonOperator::LESS: return l < r;
+          case ComparisonOperator::NOTEQUAL: return l != r;
+        }
+      }
+      throw std::runtime_error("CutBytecode has an invalid ComparisonOperator.");
+    }
+
+    /**
+     * Apply an arithmetic operation with the same rules as the BinaryExpressionNode:
+     * int op int gives int except for division and power, bool operands are invalid.
+     */
+    static CutValue arithmetic(ArithmeticOperation aoperation, const CutValue& left, const CutValue& right);
+
+    /** Negate the value, bool values cannot be negated. */
+    static CutValue negate(const CutValue& value)
+    {
+      if (value.type == c_Int) return fromInt(-1 * value.i);
+      if (value.type == c_Double) return fromDouble(-1.0 * value.d);
+      throw std::runtime_error("Attempted unary sign with boolean type value.");
+    }
+
+    /**
+     * Convert to bool like the UnaryRelationalNode: nan is false and a warning is printed
+     * if a double other than 0 or 1 is converted.
+     * @param value value to convert
+     * @param cut the cut substring which gave this value, for the warning
+     */
+    static bool toBool(const CutValue& value, const std::string& cut);
+  };
+
+  /**
+   * Compiled form of a cut: the tree of AbstractBooleanNode and AbstractExpressionNode objects is lowered
+   * into a flat list of register based instructions which GeneralCut::check() runs in a single loop,
+   * without virtual calls and std::variant return values.
+   *
+   * Every node appends its instructions in emit() and returns the operand holding its result.
+   * Operands >= 0 are registers, each instruction writes to a new register, except that and/or
+   * share one result register for both sides. Negative operands refer to constants. While emitting
+   * * subexpressions without variables are folded to constants,
+   * * and/or and range comparisons skip the evaluation of the right hand side with jumps if the result is already known,
+   *   a comparison and the following jump are a single instruction and jumps to a jump with the same outcome go to its target,
+   * * the variable pointers are collected once in a table, which is used by the load instructions,
+   * * each variable is evaluated at most once per check, all loads of a variable share one register.
+   *
+   * Errors which the node tree raises during the check (e.g. arithmetic with bool values) are raised
+   * during the check as well, they are not folded.
+   */
+  template<class AVariableManager>
+  class CutBytecode {
+    /**
+    * Template argument dependent Particle type definition
+    **/
+    typedef typename AVariableManager::Object Object;
+    /**
+    * Template argument dependent Variable type definition
+    **/
+    typedef typename AVariableManager::Var Var;
+
+  public:
+    /** Instruction codes */
+    enum class OpCode : uint8_t {
+      LoadVariable, /**< result = variables[index](p), unless already loaded in this check */
+      Negate, /**< result = -left */
+      Arithmetic, /**< result = left (operation) right */
+      Compare, /**< result = left (operation) right */
+      ToBool, /**< result = bool(left), warning uses cut string index */
+      Not, /**< result = not left */
+      Move, /**< result = left */
+      JumpIfFalse, /**< continue at instruction index if left is false */
+      JumpIfTrue, /**< continue at instruction index if left is true */
+      CompareJumpIfFalse, /**< Compare, then continue at instruction index if the result is false */
+      CompareJumpIfTrue /**< Compare, then continue at instruction index if the result is true */
+    };
+
+    /** A single instruction */
+    struct Instruction {
+      OpCode code; /**< what to do */
+      uint8_t operation; /**< ArithmeticOperation or ComparisonOperator */
+      int16_t result; /**< register for the result */
+      int16_t left; /**< first operand */
+      int16_t right; /**< second operand */
+      uint32_t index; /**< variable index, jump target or cut string index */
+    };
+
+    /** Compile the tree below the given root node. */
+    explicit CutBytecode(const AbstractBooleanNode<AVariableManager>& root) : m_result{root.emit(*this)} {}
+
+    /**
+     * Run the bytecode for the given object and return the result of the cut.
+     * @param p pointer to the object, that should be checked.
+     */
+    bool check(const Object* p) const
+    {
+      if (m_result < 0) return getConstant(m_result).b;
+      CutValue stackRegisters[c_stackRegisters];
+      std::vector<CutValue> heapRegisters;
+      CutValue* registers = stackRegisters;
+      if (m_nRegisters > c_stackRegisters) {
+        heapRegisters.resize(m_nRegisters);
+        registers = heapRegisters.data();
+      }
+      auto get = [&](int operand) -> const CutValue& { return operand >= 0 ? registers[operand] : getConstant(operand); };
+      // variables which are already in their register, only tracked for the first 64
+      uint64_t loaded = 0;
+
+      const size_t nInstructions = m_instructions.size();
+      size_t pc = 0;
+      while (pc < nInstructions) {
+        const Instruction& instruction = m_instructions[pc++];
+        switch (instruction.code) {
+          case OpCode::LoadVariable: {
+            const uint64_t bit = instruction.index < 64 ? (uint64_t(1) << instruction.index) : 0;
+            if (loaded & bit) break;
+            const typename AVariableManager::VarVariant value = m_variables[instruction.index]->function(p);
+            registers[instruction.result] = CutValue::fromVariant(value);
+            loaded |= bit;
+            break;
+          }
+          case OpCode::Negate:
+            registers[instruction.result] = CutValue::negate(get(instruction.left));
+            break;
+          case OpCode::Arithmetic:
+            registers[instruction.result] = CutValue::arithmetic(static_cast<ArithmeticOperation>(instruction.operation),
+                                                                 get(instruction.left), get(instruction.right));
+            break;
+          case OpCode::Compare:
+            registers[instruction.result] = CutValue::fromBool(CutValue::compare(static_cast<ComparisonOperator>(instruction.operation),
+                                                               get(instruction.left), get(instruction.right)));
+            break;
+          case OpCode::ToBool:
+            registers[instruction.result] = CutValue::fromBool(CutValue::toBool(get(instruction.left), m_cutStrings[instruction.index]));
+            break;
+          case OpCode::Not:
+            registers[instruction.result] = CutValue::fromBool(!get(instruction.left).b);
+            break;
+          case OpCode::Move:
+            registers[instruction.result] = get(instruction.left);
+            break;
+          case OpCode::JumpIfFalse:
+            if (!get(instruction.left).b) pc = instruction.index;
+            break;
+          case OpCode::JumpIfTrue:
+            if (get(instruction.left).b) pc = instruction.index;
+            break;
+          case OpCode::CompareJumpIfFalse:
+          case OpCode::CompareJumpIfTrue: {
+            const bool result = CutValue::compare(static_cast<ComparisonOperator>(instruction.operation),
+                                                  get(instruction.left), get(instruction.right));
+            registers[instruction.result] = CutValue::fromBool(result);
+            if (result == (instruction.code == OpCode::CompareJumpIfTrue)) pc = instruction.index;
+            break;
+          }
+        }
+      }
+      return registers[m_result].b;
+    }
+
+    /** Add a constant, returns its operand. */
+    int constant(const CutValue& value)
+    {
+      m_constants.push_back(value);
+      if (m_constants.size() > c_maxOperands)
+        throw std::runtime_error("Cut string has too many constants to be compiled.");
+      return -static_cast<int>(m_constants.size());
+    }
+
+    /**
+     * Add the evaluation of a variable, returns the register of its value.
+     * The first load of a variable reserves its register, later loads only evaluate it
+     * if none of the earlier ones was reached.
+     */
+    int loadVariable(const Var* var)
+    {
+      for (uint32_t index = 0; index < m_variables.size(); ++index) {
+        if (m_variables[index] != var) continue;
+        const int16_t result = m_variableRegisters[index];
+        m_instructions.push_back({OpCode::LoadVariable, 0, result, 0, 0, index});
+        return result;
+      }
+      m_variables.push_back(var);
+      m_variableRegisters.push_back(append(OpCode::LoadVariable, 0, 0, 0, m_variables.size() - 1));
+      return m_variableRegisters.back();
+    }
+
+    /** Add a unary minus, returns the operand of the result. */
+    int negate(int operand)
+    {
+      if (operand < 0) {
+        try {
+          return constant(CutValue::negate(getConstant(operand)));
+        } catch (std::runtime_error&) {
+          // invalid, leave it to the check to complain
+        }
+      }
+      return append(OpCode::Negate, 0, operand, 0, 0);
+    }
+
+    /** Add an arithmetic operation, returns the operand of the result. */
+    int arithmetic(ArithmeticOperation aoperation, int left, int right)
+    {
+      if (left < 0 and right < 0) {
+        try {
+          return constant(CutValue::arithmetic(aoperation, getConstant(left), getConstant(right)));
+        } catch (std::runtime_error&) {
+          // invalid, leave it to the check to complain
+        }
+      }
+      return append(OpCode::Arithmetic, static_cast<uint8_t>(aoperation), left, right, 0);
+    }
+
+    /** Add a comparison, returns the operand of the boolean result. */
+    int compare(ComparisonOperator coperator, int left, int right)
+    {
+      if (left < 0 and right < 0)
+        return constant(CutValue::fromBool(CutValue::compare(coperator, getConstant(left), getConstant(right))));
+      return append(OpCode::Compare, static_cast<uint8_t>(coperator), left, right, 0);
+    }
+
+    /**
+     * Add the conversion of an expression to bool, returns the operand of the result.
+     * @param operand the expression
+     * @param cut the expression as cut string, needed for warnings
+     */
+    int toBool(int operand, const std::string& cut)
+    {
+      if (operand < 0) {
+        const CutValue& value = getConstant(operand);
+        // doubles other than 0 and 1 warn on every check, so keep them
+        if (value.type != CutValue::c_Double or std::isnan(value.d) or value.d == 0.0 or value.d == 1.0)
+          return constant(CutValue::fromBool(CutValue::toBool(value, cut)));
+      }
+      m_cutStrings.push_back(cut);
+      return append(OpCode::ToBool, 0, operand, 0, m_cutStrings.size() - 1);
+    }
+
+    /** Add a negation of a boolean operand, returns the operand of the result. */
+    int logicalNot(int operand)
+    {
+      if (operand < 0) return constant(CutValue::fromBool(!getConstant(operand).b));
+      return append(OpCode::Not, 0, operand, 0, 0);
+    }
+
+    /**
+     * Combine a boolean operand with a second one, which is only evaluated if the result is not yet known.
+     * @param boperator and/or
+     * @param left operand of the left hand side
+     * @param emitRight callable which emits the right hand side and returns its operand
+     */
+    template<class AEmitFunction>
+    int combine(BooleanOperator boperator, int left, AEmitFunction emitRight)
+    {
+      const bool shortCircuitValue = boperator == BooleanOperator::OR;
+      if (left < 0) {
+        if (getConstant(left).b == shortCircuitValue) return left;
+        return emitRight();
+      }
+      // jumps to the end of the left hand side which test left, see below
+      const size_t leftEnd = m_instructions.size();
+      size_t jump = leftEnd;
+      if (jump > 0 and m_instructions[jump - 1].code == OpCode::Compare and m_instructions[jump - 1].result == left) {
+        // compare and jump in one instruction
+        --jump;
+        m_instructions[jump].code = shortCircuitValue ? OpCode::CompareJumpIfTrue : OpCode::CompareJumpIfFalse;
+      } else {
+        append(shortCircuitValue ? OpCode::JumpIfTrue : OpCode::JumpIfFalse, 0, left, 0, 0);
+      }
+      const int firstRightRegister = m_nRegisters;
+      const int right = emitRight();
+      if (right >= firstRightRegister) {
+        // left is a register only used here and right a new register of the right hand side,
+        // so the right hand side can write its result directly into left
+        for (size_t i = jump + 1; i < m_instructions.size(); ++i) {
+          Instruction& instruction = m_instructions[i];
+          if (instruction.result == right) instruction.result = left;
+          if (instruction.left == right) instruction.left = left;
+          if (instruction.right == right) instruction.right = left;
+        }
+      } else {
+        m_instructions.push_back({OpCode::Move, 0, static_cast<int16_t>(left), static_cast<int16_t>(right), 0, 0});
+      }
+      const uint32_t end = m_instructions.size();
+      m_instructions[jump].index = end;
+      // jumps of the left hand side to its end leave the result in left: if they
+      // short-circuit the same way, the result is known and they can go to the end directly,
+      // otherwise the right hand side is evaluated.
+      for (size_t i = 0; i < jump; ++i) {
+        Instruction& instruction = m_instructions[i];
+        if (instruction.index != leftEnd) continue;
+        bool onTrue;
+        if (instruction.code == OpCode::JumpIfFalse or instruction.code == OpCode::JumpIfTrue) {
+          if (instruction.left != left) continue;
+          onTrue = instruction.code == OpCode::JumpIfTrue;
+        } else if (instruction.code == OpCode::CompareJumpIfFalse or instruction.code == OpCode::CompareJumpIfTrue) {
+          if (instruction.result != left) continue;
+          onTrue = instruction.code == OpCode::CompareJumpIfTrue;
+        } else {
+          continue;
+        }
+        instruction.index = onTrue == shortCircuitValue ? end : jump + 1;
+      }
+      return left;
+    }
+
+    /** Instructions, for tests and debugging */
+    const std::vector<Instruction>& getInstructions() const { return m_instructions; }
+
+    /** Variables used by the cut, for tests and debugging */
+    const std::vector<const Var*>& getVariables() const { return m_variables; }
+
+  private:
+    /** Number of registers which are kept on the stack during check(), more are allocated on the heap */
+    static constexpr size_t c_stackRegisters = 32;
+    /** Maximal number of registers or constants, to fit into the instruction */
+    static constexpr size_t c_maxOperands = std::numeric_limits<int16_t>::max();
+
+    /** Constant for a negative operand */
+    const CutValue& getConstant(int operand) const { return m_constants[-operand - 1]; }
+
+    /** Append an instruction writing into a new register, returns the register. */
+    int append(OpCode code, uint8_t operation, int left, int right, uint32_t index)
+    {
+      if (m_nRegisters >= c_maxOperands)
+        throw std::runtime_error("Cut string is too long to be compiled.");
+      const int16_t result = m_nRegisters++;
+      m_instructions.push_back({code, operation, result, static_cast<int16_t>(left), static_cast<int16_t>(right), index});
+      return result;
+    }
+
+    std::vector<Instruction> m_instructions; /**< the program */
+    std::vector<CutValue> m_constants; /**< constants, operand -1 is the first one */
+    std::vector<const Var*> m_variables; /**< variables used by the load instructions */
+    std::vector<int16_t> m_variableRegisters; /**< register of each variable */
+    std::vector<std::string> m_cutStrings; /**< cut substrings for warnings of ToBool instructions */
+    size_t m_nRegisters{0}; /**< number of registers needed */
+    int m_result; /**< operand holding the result */
+  };
+}
@@ -12,6 +12,7 @@
 #include <functional>
 
 #include <framework/utilities/AbstractNodes.h>
+#include <framework/utilities/CutBytecode.h>
 #include <framework/utilities/NodeFactory.h>
 #include <framework/logging/Logger.h>
 
@@ -236,6 +237,16 @@ namespace Belle2 {
 
       return stringstream.str();
     }
+    /**
+     * Emit the child node, negated if m_negation is true.
+     * @param bytecode bytecode to which the instructions are appended
+     */
+    int emit(CutBytecode<AVariableManager>& bytecode) const override
+    {
+      const int operand = m_bnode->emit(bytecode);
+      if (m_negation) return bytecode.logicalNot(operand);
+      return operand;
+    }
     /**
      * Destructor
     **/
@@ -317,6 +328,17 @@ namespace Belle2 {
 
       return stringstream.str();
     }
+    /**
+     * Emit both child nodes, the right one is skipped if the left one already determines the result.
+     * @param bytecode bytecode to which the instructions are appended
+     */
+    int emit(CutBytecode<AVariableManager>& bytecode) const override
+    {
+      if (m_boperator != BooleanOperator::AND and m_boperator != BooleanOperator::OR)
+        throw std::runtime_error("BinaryBooleanNode has an invalid BooleanOperator");
+      const int left = m_left_bnode->emit(bytecode);
+      return bytecode.combine(m_boperator, left, [&]() { return m_right_bnode->emit(bytecode); });
+    }
     /**
      * Destructor
     **/
@@ -398,6 +420,14 @@ namespace Belle2 {
     {
       return m_enode->decompile();
     }
+    /**
+     * Emit the expression and its conversion to bool.
+     * @param bytecode bytecode to which the instructions are appended
+     */
+    int emit(CutBytecode<AVariableManager>& bytecode) const override
+    {
+      return bytecode.toBool(m_enode->emit(bytecode), m_enode->decompile());
+    }
     /**
      * Destructor
     **/
@@ -486,6 +516,16 @@ namespace Belle2 {
 
       return stringstream.str();
     }
+    /**
+     * Emit both expressions and their comparison.
+     * @param bytecode bytecode to which the instructions are appended
+     */
+    int emit(CutBytecode<AVariableManager>& bytecode) const override
+    {
+      const int left = m_left_enode->emit(bytecode);
+      const int right = m_right_enode->emit(bytecode);
+      return bytecode.compare(m_coperator, left, right);
+    }
     /**
      * Destructor
     **/
@@ -606,6 +646,19 @@ namespace Belle2 {
       stringstream << m_right_enode->decompile();
       return stringstream.str();
     }
+    /**
+     * Emit the left-center comparison, the right expression is only evaluated if it is true.
+     * @param bytecode bytecode to which the instructions are appended
+     */
+    int emit(CutBytecode<AVariableManager>& bytecode) const override
+    {
+      const int left = m_left_enode->emit(bytecode);
+      const int center = m_center_enode->emit(bytecode);
+      const int lc = bytecode.compare(m_lc_coperator, left, center);
+      return bytecode.combine(BooleanOperator::AND, lc, [&]() {
+        return bytecode.compare(m_cr_coperator, center, m_right_enode->emit(bytecode));
+      });
+    }
     /**
      * Destructor
     **/
@@ -691,6 +744,16 @@ namespace Belle2 {
       if (m_parenthesized) stringstream << " )";
       return stringstream.str();
     }
+    /**
+     * Emit the child node, negated if m_unary_minus is true.
+     * @param bytecode bytecode to which the instructions are appended
+     */
+    int emit(CutBytecode<AVariableManager>& bytecode) const override
+    {
+      const int operand = m_enode->emit(bytecode);
+      if (m_unary_minus) return bytecode.negate(operand);
+      return operand;
+    }
     /**
      * Destructor
     **/
@@ -852,6 +915,16 @@ namespace Belle2 {
 
       return stringstream.str();
     }
+    /**
+     * Emit both child nodes and the arithmetic operation.
+     * @param bytecode bytecode to which the instructions are appended
+     */
+    int emit(CutBytecode<AVariableManager>& bytecode) const override
+    {
+      const int left = m_left_enode->emit(bytecode);
+      const int right = m_right_enode->emit(bytecode);
+      return bytecode.arithmetic(m_aoperation, left, right);
+    }
     /**
      * Destructor
     **/
@@ -923,6 +996,15 @@ namespace Belle2 {
       stringstream << m_value;
       return stringstream.str();
     }
+    /**
+     * Add m_value as constant.
+     * @param bytecode bytecode to which the constant is added
+     */
+    int emit(CutBytecode<AVariableManager>& bytecode) const override
+    {
+      const typename AVariableManager::VarVariant value{m_value};
+      return bytecode.constant(CutValue::fromVariant(value));
+    }
     /**
      * Destructor
     **/
@@ -985,6 +1067,16 @@ namespace Belle2 {
           "Cut string has an invalid format: Variable not found: " + m_name);
       }
     }
+    /**
+     * Emit the evaluation of m_var.
+     * @param bytecode bytecode to which the instructions are appended
+     */
+    int emit(CutBytecode<AVariableManager>& bytecode) const override
+    {
+      if (m_var == nullptr)
+        throw std::runtime_error("Cut string has an invalid format: Neither number nor variable name");
+      return bytecode.loadVariable(m_var);
+    }
     /**
      * Destructor
     **/
@@ -1058,6 +1150,14 @@ namespace Belle2 {
           "Cut string has an invalid format: Metavariable not found: " + fullname);
       }
     }
+    /**
+     * Emit the evaluation of m_var.
+     * @param bytecode bytecode to which the instructions are appended
+     */
+    int emit(CutBytecode<AVariableManager>& bytecode) const override
+    {
+      return bytecode.loadVariable(m_var);
+    }
     /**
      * Destructor
     **/
@@ -9,6 +9,7 @@
 #pragma once
 
 #include <boost/python.hpp>
+#include <framework/utilities/CutBytecode.h>
 #include <framework/utilities/CutNodes.h>
 #include <framework/utilities/NodeFactory.h>
 
@@ -47,6 +48,10 @@ namespace Belle2 {
    * daughter(0, M) < daughter(1, M)
    * [M > 1.5 or M < 0.5] and 0.2 < getExtraInfo(SignalProbability) < 0.7
    *
+   * On request the parsed cut is also compiled into a flat CutBytecode program, which check() then runs instead
+   * of the node tree. The node tree is the default because it is not slower for typical selection cuts,
+   * only long cuts with arithmetic gain from the bytecode.
+   *
    * == and != conditions are evaluated not exactly because we deal with floating point values
    * instead two floating point number are equal if their distance in their integral ordering is less than 3.
    *
@@ -75,16 +80,17 @@ namespace Belle2 {
      * Creates an instance of a cut and returns a unique_ptr to it, if you need a copy-able object instead
      * you can cast it to a shared_ptr using std::shared_ptr<Variable::Cut>(Cut::compile(cutString))
      * @param cut the string defining the cut
+     * @param useBytecode evaluate the cut with the compiled CutBytecode instead of the node tree
      * @return std::unique_ptr<Cut>
      */
-    static std::unique_ptr<GeneralCut> compile(const std::string& cut)
+    static std::unique_ptr<GeneralCut> compile(const std::string& cut, bool useBytecode = false)
     {
       // Here we parse
       Py_Initialize();
       try {
         py::object b2parser_namespace = py::import("b2parser");
         py::tuple tuple = py::extract<py::tuple>(b2parser_namespace.attr("parse")(cut));
-        return std::unique_ptr<GeneralCut>(new GeneralCut(tuple));
+        return std::unique_ptr<GeneralCut>(new GeneralCut(tuple, useBytecode));
       } catch (py::error_already_set&) {
         PyErr_Print();
         B2FATAL("Parsing error on cutstring:\n" + cut);
@@ -97,10 +103,19 @@ namespace Belle2 {
      */
     bool check(const Object* p) const
     {
+      if (m_bytecode) return m_bytecode->check(p);
       if (m_root != nullptr) return m_root->check(p);
       throw std::runtime_error("GeneralCut m_root is not initialized.");
     }
 
+    /**
+     * Compiled form of the cut which is used by check(), nullptr if the cut is evaluated with the node tree.
+     */
+    const CutBytecode<AVariableManager>* getBytecode() const
+    {
+      return m_bytecode.get();
+    }
+
     /**
      * Print cut tree
      */
@@ -124,8 +139,12 @@ namespace Belle2 {
     /**
      * Constructor of the cut. Call init with given Nodetuple
      * @param tuple (const boost::python::tuple&) constructed by the python parser from cut.
+     * @param useBytecode compile the node tree into the bytecode used by check()
      */
-    explicit GeneralCut(Nodetuple tuple) : m_root{NodeFactory::compile_boolean_node<AVariableManager>(tuple)} {}
+    GeneralCut(Nodetuple tuple, bool useBytecode) : m_root{NodeFactory::compile_boolean_node<AVariableManager>(tuple)}
+    {
+      if (useBytecode) m_bytecode = std::make_unique<const CutBytecode<AVariableManager>>(*m_root);
+    }
 
     /**
      * Delete Copy constructor
@@ -138,5 +157,6 @@ namespace Belle2 {
     GeneralCut& operator=(const GeneralCut&) = delete;
 
     std::unique_ptr<const AbstractBooleanNode<AVariableManager>> m_root; /**< cut root node */
+    std::unique_ptr<const CutBytecode<AVariableManager>> m_bytecode; /**< compiled cut, evaluated in check() if set */
   };
 }
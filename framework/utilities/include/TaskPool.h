@@ -0,0 +1,174 @@
+/**************************************************************************
+ * basf2 (Belle II Analysis Software Framework)                           *
+ * Author: The Belle II Collaboration                                     *
+ *                                                                        *
+ * See git log for contributors and copyright holders.                    *
+ * This file is licensed under LGPL-3.0, see LICENSE.md.                  *
+ **************************************************************************/
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Belle2 {
+  /** Fixed-size pool of worker threads executing tasks, with work stealing and bounded queues.
+   *
+   * Each worker has its own task queue. Tasks submitted from outside the pool are distributed
+   * round-robin over the workers, tasks submitted by a task go to the queue of the worker
+   * running it. Workers take tasks from the front of their own queue (oldest first) and steal
+   * from the back of the other queues once their own queue is empty.
+   *
+   * submit() blocks while the number of queued tasks (submitted, but not yet started) has
+   * reached the maximal queue depth, so a fast producer cannot run out of memory. Several
+   * threads submitting at the same time may exceed it by one task each. Tasks submitted from
+   * inside the pool are never blocked, to avoid deadlocks.
+   *
+   * Submitting and running tasks only locks the affected worker queues and updates atomic
+   * counters. The pool wide mutex is only taken to sleep on or wake up threads waiting for
+   * tasks, for space in the queues or in wait().
+   *
+   * Results and exceptions are returned through std::future, so the caller decides in which
+   * order results are consumed:
+     \code
+     TaskPool pool(4);
+     std::deque<std::future<int>> results;
+     for (int i = 0; i < 100; i++)
+       results.push_back(pool.submit([i]() { return i * i; }));
+     for (auto& result : results)
+       B2INFO(result.get()); // in submission order
+     \endcode
+   *
+   * The destructor executes all remaining tasks and joins the threads.
+   */
+  class TaskPool {
+  public:
+    /** Counters to monitor and tune the pool. All times are in seconds. */
+    struct Statistics {
+      uint64_t submitted{0}; /**< number of submitted tasks. */
+      uint64_t executed{0}; /**< number of finished tasks. */
+      uint64_t stolen{0}; /**< number of tasks executed by another worker than the one they were queued for. */
+      uint64_t blocked{0}; /**< number of submit() calls which had to wait because the queues were full. */
+      size_t queueDepth{0}; /**< number of tasks currently queued (not yet started). */
+      size_t maxQueueDepth{0}; /**< maximal number of queued tasks so far. */
+      double totalWaitTime{0}; /**< summed time between submission and start of the tasks. */
+      double maxWaitTime{0}; /**< maximal time between submission and start of a task. */
+      double totalRunTime{0}; /**< summed execution time of the tasks. */
+
+      /** Mean time between submission and start of a task. */
+      double meanWaitTime() const { return executed > 0 ? totalWaitTime / executed : 0; }
+      /** Mean execution time of a task. */
+      double meanRunTime() const { return executed > 0 ? totalRunTime / executed : 0; }
+    };
+
+    /** Start the worker threads.
+     *
+     * @param nThreads number of worker threads, at least one thread is started.
+     * @param maxQueueDepth maximal number of queued tasks before submit() blocks, 0 for no limit.
+     */
+    explicit TaskPool(unsigned int nThreads, size_t maxQueueDepth = 0);
+    /** Execute all remaining tasks and join the worker threads. */
+    ~TaskPool();
+    /** No copies */
+    TaskPool(const TaskPool&) = delete;
+    /** No assignment */
+    TaskPool& operator=(const TaskPool&) = delete;
+
+    /** Queue a callable for execution, blocking while the queues are full.
+     *
+     * @return future for the result (or exception) of the callable.
+     */
+    template<class Function> auto submit(Function&& function) -> std::future<decltype(function())>
+    {
+      using Result = decltype(function());
+      auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Function>(function));
+      std::future<Result> result = task->get_future();
+      enqueue([task]() { (*task)(); });
+      return result;
+    }
+
+    /** Block until all submitted tasks are finished. */
+    void wait();
+
+    /** Number of worker threads. */
+    unsigned int getNumberThreads() const { return m_workers.size(); }
+    /** Number of tasks currently queued (not yet started). */
+    size_t getQueueDepth() const;
+    /** Get a snapshot of the counters. */
+    Statistics getStatistics() const;
+
+  private:
+    /** Clock used for the statistics. */
+    typedef std::chrono::steady_clock Clock;
+
+    /** A queued task. */
+    struct Task {
+      std::function<void()> function; /**< the callable. */
+      Clock::time_point submitted; /**< submission time. */
+    };
+
+    /** Task queue of one worker thread. */
+    struct Worker {
+      std::mutex mutex; /**< protects tasks. */
+      std::deque<Task> tasks; /**< queued tasks, the worker takes them from the front, thieves from the back. */
+      std::thread thread; /**< the worker thread. */
+    };
+
+    /** Queue a task, see submit(). */
+    void enqueue(std::function<void()> function);
+
+    /** Take a task from the own queue or steal one from another worker.
+     *
+     * The task is counted as running from then on.
+     *
+     * @param id index of the worker
+     * @param task set to the task if one was found
+     * @param stolen set to true if the task comes from another queue
+     */
+    bool popTask(unsigned int id, Task& task, bool& stolen);
+
+    /** Event loop of the worker thread with the given index. */
+    void run(unsigned int id);
+
+    /** Wake up threads sleeping on the given condition variable, if there are any.
+     *
+     * @param condition condition variable to notify
+     * @param waiters number of threads waiting on condition, incremented by them with m_mutex held
+     * @param all notify all threads instead of one
+     */
+    void wakeUp(std::condition_variable& condition, const std::atomic<unsigned int>& waiters, bool all);
+
+    std::vector<std::unique_ptr<Worker>> m_workers; /**< worker threads and their queues. */
+    size_t m_maxQueueDepth; /**< maximal number of queued tasks, 0 for no limit. */
+
+    std::atomic<size_t> m_queued{0}; /**< number of queued tasks, changed together with the queues under their lock. */
+    std::atomic<size_t> m_running{0}; /**< number of running tasks, incremented before m_queued is decremented. */
+    std::atomic<unsigned int> m_nextWorker{0}; /**< worker for the next task submitted from outside the pool. */
+
+    mutable std::mutex m_mutex; /**< only used to sleep on the condition variables below, and protects m_stop. */
+    std::condition_variable m_taskAvailable; /**< notified when a task is queued or the pool is stopped. */
+    std::condition_variable m_spaceAvailable; /**< notified when a task is taken from the queues. */
+    std::condition_variable m_idle; /**< notified when the last running task is finished. */
+    std::atomic<unsigned int> m_waitingForTask{0}; /**< number of workers waiting on m_taskAvailable. */
+    std::atomic<unsigned int> m_waitingForSpace{0}; /**< number of threads waiting on m_spaceAvailable. */
+    std::atomic<unsigned int> m_waitingForIdle{0}; /**< number of threads waiting on m_idle. */
+    bool m_stop{false}; /**< set by the destructor. */
+
+    std::atomic<uint64_t> m_submitted{0}; /**< see Statistics::submitted. */
+    std::atomic<uint64_t> m_executed{0}; /**< see Statistics::executed. */
+    std::atomic<uint64_t> m_stolen{0}; /**< see Statistics::stolen. */
+    std::atomic<uint64_t> m_blocked{0}; /**< see Statistics::blocked. */
+    std::atomic<size_t> m_highestQueueDepth{0}; /**< see Statistics::maxQueueDepth. */
+    std::atomic<int64_t> m_totalWaitTime{0}; /**< see Statistics::totalWaitTime, in nanoseconds. */
+    std::atomic<int64_t> m_maxWaitTime{0}; /**< see Statistics::maxWaitTime, in nanoseconds. */
+    std::atomic<int64_t> m_totalRunTime{0}; /**< see Statistics::totalRunTime, in nanoseconds. */
+  };
+}
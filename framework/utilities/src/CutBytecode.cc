@@ -0,0 +1,60 @@
+/**************************************************************************
+ * basf2 (Belle II Analysis Software Framework)                           *
+ * Author: The Belle II Collaboration                                     *
+ *                                                                        *
+ * See git log for contributors and copyright holders.                    *
+ * This file is licensed under LGPL-3.0, see LICENSE.md.                  *
+ **************************************************************************/
+
+#include <framework/utilities/CutBytecode.h>
+#include <framework/logging/Logger.h>
+
+#include <cmath>
+#include <stdexcept>
+
+namespace Belle2 {
+
+  CutValue CutValue::arithmetic(ArithmeticOperation aoperation, const CutValue& left, const CutValue& right)
+  {
+    if (left.type == c_Bool or right.type == c_Bool) {
+      switch (aoperation) {
+        case ArithmeticOperation::PLUS: throw std::runtime_error("Invalid datatypes in plus operation.");
+        case ArithmeticOperation::MINUS: throw std::runtime_error("Invalid datatypes in minus operation.");
+        case ArithmeticOperation::PRODUCT: throw std::runtime_error("Invalid datatypes in product operation.");
+        case ArithmeticOperation::DIVISION: throw std::runtime_error("Invalid datatypes in division operation.");
+        case ArithmeticOperation::POWER: throw std::runtime_error("Invalid datatypes in power operation.");
+        default: throw std::runtime_error("Operation not valid");
+      }
+    }
+    const bool integer = left.type == c_Int and right.type == c_Int;
+    switch (aoperation) {
+      case ArithmeticOperation::PLUS:
+        return integer ? fromInt(left.i + right.i) : fromDouble(left.asDouble() + right.asDouble());
+      case ArithmeticOperation::MINUS:
+        return integer ? fromInt(left.i - right.i) : fromDouble(left.asDouble() - right.asDouble());
+      case ArithmeticOperation::PRODUCT:
+        return integer ? fromInt(left.i * right.i) : fromDouble(left.asDouble() * right.asDouble());
+      case ArithmeticOperation::DIVISION:
+        // Always do double division
+        return fromDouble(left.asDouble() / right.asDouble());
+      case ArithmeticOperation::POWER:
+        return fromDouble(std::pow(left.asDouble(), right.asDouble()));
+      default:
+        throw std::runtime_error("Operation not valid");
+    }
+  }
+
+  bool CutValue::toBool(const CutValue& value, const std::string& cut)
+  {
+    if (value.type == c_Bool) return value.b;
+    if (value.type == c_Int) return static_cast<bool>(value.i);
+    // nan is considered false.
+    if (std::isnan(value.d)) return false;
+    if (value.d != 0.0 and value.d != 1.0) {
+      B2WARNING("Static casting of double value to bool in cutstring evaluation." << LogVar("Cut substring", cut)
+                << LogVar(" Casted value", value.d) << LogVar("Casted to", static_cast<bool>(value.d) ? "true" : "false"));
+    }
+    return static_cast<bool>(value.d);
+  }
+
+}
@@ -0,0 +1,187 @@
+/**************************************************************************
+ * basf2 (Belle II Analysis Software Framework)                           *
+ * Author: The Belle II Collaboration                                     *
+ *                                                                        *
+ * See git log for contributors and copyright holders.                    *
+ * This file is licensed under LGPL-3.0, see LICENSE.md.                  *
+ **************************************************************************/
+
+#include <framework/utilities/TaskPool.h>
+
+#include <algorithm>
+
+using namespace Belle2;
+
+namespace {
+  /** Pool the current thread is a worker of, or nullptr. */
+  thread_local const TaskPool* s_currentPool = nullptr;
+  /** Index of the current thread in s_currentPool. */
+  thread_local unsigned int s_currentWorker = 0;
+
+  /** Set value to the maximum of its current value and candidate. */
+  template<class T> void atomicMax(std::atomic<T>& value, T candidate)
+  {
+    T current = value.load(std::memory_order_relaxed);
+    while (current < candidate and !value.compare_exchange_weak(current, candidate, std::memory_order_relaxed)) { }
+  }
+
+  /** Nanoseconds in the given duration. */
+  template<class Duration> int64_t nanoseconds(Duration duration)
+  {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+  }
+}
+
+TaskPool::TaskPool(unsigned int nThreads, size_t maxQueueDepth): m_maxQueueDepth(maxQueueDepth)
+{
+  nThreads = std::max(nThreads, 1u);
+  //create all queues before the threads start stealing from them
+  for (unsigned int i = 0; i < nThreads; i++)
+    m_workers.emplace_back(new Worker);
+  for (unsigned int i = 0; i < nThreads; i++)
+    m_workers[i]->thread = std::thread(&TaskPool::run, this, i);
+}
+
+TaskPool::~TaskPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = true;
+  }
+  m_taskAvailable.notify_all();
+  m_spaceAvailable.notify_all();
+  for (auto& worker : m_workers)
+    worker->thread.join();
+}
+
+void TaskPool::wakeUp(std::condition_variable& condition, const std::atomic<unsigned int>& waiters, bool all)
+{
+  //Waiters increment their counter with m_mutex held before checking their condition, and we changed the condition before
+  //reading the counter. So either they see the change, or we see them and they are waiting once we get the mutex.
+  if (waiters == 0)
+    return;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+  }
+  if (all)
+    condition.notify_all();
+  else
+    condition.notify_one();
+}
+
+void TaskPool::enqueue(std::function<void()> function)
+{
+  const bool fromWorker = (s_currentPool == this);
+  if (!fromWorker and m_maxQueueDepth > 0 and m_queued >= m_maxQueueDepth) {
+    m_blocked++;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_waitingForSpace++;
+    m_spaceAvailable.wait(lock, [this]() { return m_queued < m_maxQueueDepth or m_stop; });
+    m_waitingForSpace--;
+  }
+  const unsigned int id = fromWorker ? s_currentWorker : (m_nextWorker++ % m_workers.size());
+  size_t queued = 0;
+  {
+    std::lock_guard<std::mutex> workerLock(m_workers[id]->mutex);
+    m_workers[id]->tasks.push_back(Task{std::move(function), Clock::now()});
+    queued = ++m_queued;
+  }
+  m_submitted++;
+  atomicMax(m_highestQueueDepth, queued);
+  wakeUp(m_taskAvailable, m_waitingForTask, false);
+}
+
+bool TaskPool::popTask(unsigned int id, Task& task, bool& stolen)
+{
+  {
+    Worker& own = *m_workers[id];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    if (!own.tasks.empty()) {
+      task = std::move(own.tasks.front());
+      own.tasks.pop_front();
+      m_running++;
+      m_queued--;
+      stolen = false;
+      return true;
+    }
+  }
+  for (size_t i = 1; i < m_workers.size(); i++) {
+    Worker& victim = *m_workers[(id + i) % m_workers.size()];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if (!victim.tasks.empty()) {
+      task = std::move(victim.tasks.back());
+      victim.tasks.pop_back();
+      m_running++;
+      m_queued--;
+      stolen = true;
+      return true;
+    }
+  }
+  return false;
+}
+
+void TaskPool::run(unsigned int id)
+{
+  s_currentPool = this;
+  s_currentWorker = id;
+  Task task;
+  bool stolen = false;
+  while (true) {
+    if (!popTask(id, task, stolen)) {
+      //m_queued only counts tasks which are in the queues, so if it is not 0 the next popTask() finds one,
+      //unless another worker was faster
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_waitingForTask++;
+      m_taskAvailable.wait(lock, [this]() { return m_queued > 0 or m_stop; });
+      m_waitingForTask--;
+      if (m_queued == 0 and m_stop)
+        return;
+      continue;
+    }
+
+    const Clock::time_point start = Clock::now();
+    const int64_t waitTime = nanoseconds(start - task.submitted);
+    m_totalWaitTime += waitTime;
+    atomicMax(m_maxWaitTime, waitTime);
+    if (stolen)
+      m_stolen++;
+    wakeUp(m_spaceAvailable, m_waitingForSpace, false);
+
+    task.function();
+    task.function = nullptr;
+
+    m_totalRunTime += nanoseconds(Clock::now() - start);
+    m_executed++;
+    //if tasks are still queued, the worker finishing the last of them wakes up wait()
+    if (--m_running == 0 and m_queued == 0)
+      wakeUp(m_idle, m_waitingForIdle, true);
+  }
+}
+
+void TaskPool::wait()
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_waitingForIdle++;
+  m_idle.wait(lock, [this]() { return m_queued == 0 and m_running == 0; });
+  m_waitingForIdle--;
+}
+
+size_t TaskPool::getQueueDepth() const
+{
+  return m_queued;
+}
+
+TaskPool::Statistics TaskPool::getStatistics() const
+{
+  Statistics statistics;
+  statistics.submitted = m_submitted;
+  statistics.executed = m_executed;
+  statistics.stolen = m_stolen;
+  statistics.blocked = m_blocked;
+  statistics.queueDepth = m_queued;
+  statistics.maxQueueDepth = m_highestQueueDepth;
+  statistics.totalWaitTime = 1e-9 * m_totalWaitTime;
+  statistics.maxWaitTime = 1e-9 * m_maxWaitTime;
+  statistics.totalRunTime = 1e-9 * m_totalRunTime;
+  return statistics;
+}
@@ -0,0 +1,160 @@
+/**************************************************************************
+ * basf2 (Belle II Analysis Software Framework)                           *
+ * Author: The Belle II Collaboration                                     *
+ *                                                                        *
+ * See git log for contributors and copyright holders.                    *
+ * This file is licensed under LGPL-3.0, see LICENSE.md.                  *
+ **************************************************************************/
+
+#include <framework/utilities/GeneralCut.h>
+
+#include <boost/python.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace Belle2;
+namespace py = boost::python;
+
+namespace {
+  /** Candidate with the quantities used by typical selection cuts. */
+  struct Candidate {
+    double mass = 0; /**< invariant mass */
+    double momentum = 0; /**< momentum */
+    double cosTheta = 0; /**< cosine of the polar angle */
+    int charge = 0; /**< charge */
+    bool isSignal = false; /**< truth matching result */
+  };
+
+  /** Variable returning one quantity of the candidate, through a std::function like the analysis variables. */
+  class Variable {
+  public:
+    /** Type of the value of a variable. */
+    typedef std::variant<double, int, bool> VarVariant;
+    /** Constructor. */
+    Variable(const std::string& name_, std::function<VarVariant(const Candidate*)> function_) : name(name_), m_function(function_) {}
+    /** Evaluate the variable for the given candidate. */
+    VarVariant function(const Candidate* candidate) const { return m_function(candidate); }
+    /** Name of the variable. */
+    const std::string name;
+  private:
+    /** Function returning the value. */
+    std::function<VarVariant(const Candidate*)> m_function;
+  };
+
+  /** Minimal variable manager for the candidates, as required by GeneralCut. */
+  class VariableManager {
+  public:
+    /** Objects the cuts are applied to. */
+    using Object = Candidate;
+    /** Variables of the manager. */
+    using Var = Variable;
+    /** Type of the value of a variable. */
+    typedef Variable::VarVariant VarVariant;
+
+    /** Singleton. */
+    static VariableManager& Instance()
+    {
+      static VariableManager instance;
+      return instance;
+    }
+
+    /** Get a variable by name, nullptr if there is none. */
+    Var* getVariable(const std::string& name)
+    {
+      auto it = m_variables.find(name);
+      return (it == m_variables.end()) ? nullptr : &it->second;
+    }
+
+    /** There are no meta variables. */
+    Var* getVariable(const std::string&, const std::vector<std::string>&) { return nullptr; }
+
+  private:
+    /** All variables by name. */
+    std::map<std::string, Var> m_variables{
+      {"M", Var("M", [](const Candidate * c) -> VarVariant { return c->mass; })},
+      {"p", Var("p", [](const Candidate * c) -> VarVariant { return c->momentum; })},
+      {"cosTheta", Var("cosTheta", [](const Candidate * c) -> VarVariant { return c->cosTheta; })},
+      {"charge", Var("charge", [](const Candidate * c) -> VarVariant { return c->charge; })},
+      {"isSignal", Var("isSignal", [](const Candidate * c) -> VarVariant { return c->isSignal; })},
+    };
+  };
+
+  /** Time the evaluation of the cut for all candidates with the node tree and with the bytecode.
+   * @return false if the results differ
+   */
+  bool compare(const std::string& cut, const std::vector<Candidate>& candidates, int nRepetitions)
+  {
+    std::unique_ptr<GeneralCut<VariableManager>> compiled = GeneralCut<VariableManager>::compile(cut, true);
+    py::tuple tuple = py::extract<py::tuple>(py::import("b2parser").attr("parse")(cut));
+    auto tree = NodeFactory::compile_boolean_node<VariableManager>(tuple);
+
+    int treePassed = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int rep = 0; rep < nRepetitions; rep++) {
+      for (const Candidate& candidate : candidates) {
+        if (tree->check(&candidate)) treePassed++;
+      }
+    }
+    const std::chrono::duration<double, std::nano> treeTime = std::chrono::steady_clock::now() - start;
+
+    int bytecodePassed = 0;
+    start = std::chrono::steady_clock::now();
+    for (int rep = 0; rep < nRepetitions; rep++) {
+      for (const Candidate& candidate : candidates) {
+        if (compiled->check(&candidate)) bytecodePassed++;
+      }
+    }
+    const std::chrono::duration<double, std::nano> bytecodeTime = std::chrono::steady_clock::now() - start;
+
+    const double nChecks = double(candidates.size()) * nRepetitions;
+    std::cout << cut << "\n  node tree " << treeTime.count() / nChecks << " ns, bytecode " << bytecodeTime.count() / nChecks <<
+              " ns per candidate, " << bytecodePassed / nRepetitions << " of " << candidates.size() << " pass\n";
+    return treePassed == bytecodePassed;
+  }
+}
+
+/** Compare the time per candidate of the node tree and of the bytecode for typical selection cuts.
+ *
+ * Usage: framework-utilities-cut_evaluation [cut]
+ */
+int main(int argc, char* argv[])
+{
+  Py_Initialize();
+  std::vector<std::string> cuts = {
+    "p > 0.1",
+    "1.8 < M < 1.9 and -0.9 < cosTheta < 0.9",
+    "[1.8 < M < 1.9 or M > 5.2] and M * 2 != 3 and -p > -10 and [charge == 0 or p ** 2 > 0.1]",
+    "isSignal == 1 and [charge > 0 or cosTheta < -0.5] and p < 3 and 0.5 < M < 5.5",
+  };
+  if (argc > 1) cuts = {argv[1]};
+
+  std::vector<Candidate> candidates(1000);
+  for (size_t i = 0; i < candidates.size(); i++) {
+    candidates[i].mass = 0.01 * (i % 600);
+    candidates[i].momentum = 0.005 * (i % 997);
+    candidates[i].cosTheta = -1 + 0.002 * (i % 1000);
+    candidates[i].charge = int(i % 3) - 1;
+    candidates[i].isSignal = (i % 7 == 0);
+  }
+
+  int result = 0;
+  try {
+    for (const std::string& cut : cuts) {
+      if (!compare(cut, candidates, 1000)) {
+        std::cerr << "The node tree and the bytecode disagree for " << cut << "\n";
+        result = 1;
+      }
+    }
+  } catch (py::error_already_set&) {
+    PyErr_Print();
+    return 1;
+  }
+  return result;
+}
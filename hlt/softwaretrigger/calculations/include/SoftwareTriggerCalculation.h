@@ -70,6 +70,10 @@ namespace Belle2 {
       SoftwareTriggerObject m_calculationResult;
       /// Flag to not add the branches twice to the TTree.
       bool m_debugPrepared = false;
+      /// Slots of the variables written to the debug TTree, in the order of the branches.
+      std::vector<SoftwareTriggerObject::Slot> m_debugSlots;
+      /// Values of the variables written to the debug TTree, in the order of the branches.
+      std::vector<double> m_debugValues;
     };
   }
 }
@@ -15,23 +15,28 @@ namespace Belle2 {
     void SoftwareTriggerCalculation::writeDebugOutput(const std::unique_ptr<TTree>& debugOutputTTree)
     {
       if (not m_debugPrepared) {
-        for (auto& identifierWithValue : m_calculationResult) {
-          const std::string& identifier = identifierWithValue.first;
-          double& value = identifierWithValue.second;
-
-          debugOutputTTree->Branch(identifier.c_str(), &value);
+        // The branches need fixed addresses so we copy the values to our own buffer which
+        // does not change in size anymore. The branches are sorted by name as before.
+        m_debugSlots = m_calculationResult.getSlotsSortedByName();
+        m_debugValues.assign(m_debugSlots.size(), 0);
+        for (unsigned int i = 0; i < m_debugSlots.size(); ++i) {
+          const std::string& identifier = SoftwareTriggerObject::getName(m_debugSlots[i]);
+          debugOutputTTree->Branch(identifier.c_str(), &m_debugValues[i]);
         }
         m_debugPrepared = true;
       }
 
+      for (unsigned int i = 0; i < m_debugValues.size(); ++i) {
+        m_debugValues[i] = m_calculationResult.at(m_debugSlots[i]);
+      }
       debugOutputTTree->Fill();
     }
 
     void SoftwareTriggerCalculation::addDebugOutput(const StoreObjPtr<SoftwareTriggerVariables>& storeObject, const std::string& prefix)
     {
-      for (auto& identifierWithValue : m_calculationResult) {
-        const std::string& identifier = identifierWithValue.first;
-        const double value = identifierWithValue.second;
+      for (SoftwareTriggerObject::Slot slot : m_calculationResult.getSlotsSortedByName()) {
+        const std::string& identifier = SoftwareTriggerObject::getName(slot);
+        const double value = m_calculationResult.at(slot);
 
         storeObject->append(prefix + "_" + identifier, value);
       }
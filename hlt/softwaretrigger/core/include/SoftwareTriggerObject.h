@@ -7,20 +7,99 @@
  **************************************************************************/
 #pragma once
 
-#include <map>
 #include <string>
+#include <vector>
 
 namespace Belle2 {
   namespace SoftwareTrigger {
     /**
-     * Base object to store the variable_name to double value map,
+     * Base object to store the values of the variables by name,
      * which is used in the software trigger variable manager and the cuts.
-     * This map has to be compiled before using any cut and has to be given
+     * This object has to be filled before using any cut and has to be given
      * to the cut whenever it is checked.
      *
      * This has the advantage that the values are only created once and can
      * share temporary objects during calculation.
+     *
+     * Every variable name is assigned a fixed slot number the first time it is
+     * used anywhere in the process (see getSlot()) and the values are stored
+     * in a flat array indexed by this slot. The cuts resolve their variable
+     * names to slots once when they are compiled so checking a cut does not
+     * need any string comparison.
+     *
+     * The calculations can fill the object by name with operator[] as if it
+     * was a std::map<std::string, double>. A variable is only defined in an
+     * object after it has been set, asking for a variable which is not
+     * defined throws std::out_of_range like std::map::at().
      */
-    typedef std::map<std::string, double> SoftwareTriggerObject;
+    class SoftwareTriggerObject {
+    public:
+      /// Type of the slot number of a variable
+      typedef unsigned int Slot;
+
+      /// Get the slot of the variable with the given name, assign a new one if it doesn't have one yet. Thread safe.
+      static Slot getSlot(const std::string& name);
+
+      /// Get the name of the variable with the given slot. Thread safe, the returned reference stays valid.
+      static const std::string& getName(Slot slot);
+
+      /// Access the value of a variable by slot, defining it (with value 0) if it is not yet defined.
+      double& operator[](Slot slot)
+      {
+        if (slot >= m_values.size()) {
+          m_values.resize(slot + 1, 0);
+          m_defined.resize(slot + 1, false);
+        }
+        if (not m_defined[slot]) {
+          m_defined[slot] = true;
+          m_slots.push_back(slot);
+        }
+        return m_values[slot];
+      }
+
+      /// Access the value of a variable by name, defining it (with value 0) if it is not yet defined.
+      double& operator[](const std::string& name) { return (*this)[getSlot(name)]; }
+
+      /// Get the value of a defined variable by slot, throws std::out_of_range if it is not defined.
+      double at(Slot slot) const
+      {
+        if (not has(slot)) throwUndefined(slot);
+        return m_values[slot];
+      }
+
+      /// Get the value of a defined variable by name, throws std::out_of_range if it is not defined.
+      double at(const std::string& name) const { return at(getSlot(name)); }
+
+      /// Check if a variable is defined in this object.
+      bool has(Slot slot) const { return slot < m_defined.size() and m_defined[slot]; }
+
+      /// Number of defined variables.
+      size_t size() const { return m_slots.size(); }
+
+      /// Slots of all defined variables in the order they were first set.
+      const std::vector<Slot>& getSlots() const { return m_slots; }
+
+      /// Slots of all defined variables sorted by the variable names, as the entries of a std::map<std::string, double>.
+      std::vector<Slot> getSlotsSortedByName() const;
+
+      /// Remove all variables.
+      void clear()
+      {
+        m_values.clear();
+        m_defined.clear();
+        m_slots.clear();
+      }
+
+    private:
+      /// Throw std::out_of_range for an undefined variable.
+      [[noreturn]] static void throwUndefined(Slot slot);
+
+      /// Values of all variables indexed by slot.
+      std::vector<double> m_values;
+      /// Whether the variable with the given slot is defined.
+      std::vector<char> m_defined;
+      /// Slots of all defined variables.
+      std::vector<Slot> m_slots;
+    };
   }
 }
@@ -7,6 +7,7 @@
  **************************************************************************/
 #pragma once
 #include <hlt/softwaretrigger/core/SoftwareTriggerObject.h>
+#include <map>
 #include <memory>
 #include <variant>
 #include <vector>
@@ -26,7 +27,7 @@ namespace Belle2 {
      * at hand at all time) or use temporary shared calculation objects when compiling the numbers.
      * Whenever a SoftwareTriggerCut has a variable it it and the check function asks the variable
      * manager for its value, the variable manager will collect this value from the
-     * SoftwareTriggerObject (a map from std::string to double) with the given variable name. So you as
+     * SoftwareTriggerObject (the values of all variables by name) with the given variable name. So you as
      * the user has to make sure that the needed variables can be found in the SoftwareTriggerObject,
      * that you hand in to the checkPreScaled function of the SoftwareTriggerCut.
      */
@@ -37,8 +38,8 @@ namespace Belle2 {
        * It fulfills all requirements for a "Variable", that are given by the GeneralCut class,
        * namely a name member and a function to calculate.
        * In the SoftwareTrigger case, this function is really simple: Just take the needed value
-       * (with the name given by the variable's name) out of the already precompiled map
-       * of values given as a SoftwareTriggerObject.
+       * (with the slot belonging to the variable's name) out of the already precompiled
+       * values given as a SoftwareTriggerObject.
        *
        * In normal use cases, you do not have to create a variable on your own and you should
        * not have contact with them (this is why they are a private class of the VariableManager).
@@ -48,19 +49,22 @@ namespace Belle2 {
         /**
          * Function which is called by the SoftwareTriggerCut whenever the value of this variable is needed.
          * As the values are all already compiled, it just takes the corresponding number
-         * from the map of values given as the SoftwareTriggerObject.
+         * from the values given as the SoftwareTriggerObject.
          */
         double function(const SoftwareTriggerObject* mapOfValues) const
         {
-          return mapOfValues->at(name);
+          return mapOfValues->at(slot);
         }
 
         /// Name of this particular variable.
         std::string name = "";
 
+        /// Slot of this variable in the SoftwareTriggerObject, resolved when the variable is created.
+        SoftwareTriggerObject::Slot slot = 0;
+
       private:
         /// Private constructor. Should only be called by the SoftwareTriggerVariableManager.
-        explicit SoftwareTriggerVariable(const std::string& theName) : name(theName) { }
+        explicit SoftwareTriggerVariable(const std::string& theName) : name(theName), slot(SoftwareTriggerObject::getSlot(theName)) { }
 
         /// Make the object move constructable
         SoftwareTriggerVariable(SoftwareTriggerVariable&&) = default;
@@ -76,11 +80,11 @@ namespace Belle2 {
       };
 
     public:
-      /// As an object handed in for every cut to be checked, use a map of variable name -> precompiled value.
+      /// As an object handed in for every cut to be checked, use the precompiled values of all variables.
       typedef SoftwareTriggerObject Object;
       /**
        * Use a very slim object for the variables: only draw out the corresponding value from the
-       * precompiled map of values.
+       * precompiled values.
        */
       typedef SoftwareTriggerVariable Var;
 
@@ -89,7 +93,7 @@ namespace Belle2 {
 
       /**
        * Make this variable manager a singleton and get the only single instance of the manager.
-       * You can still use it multiple times in different modules, as it depends on the map of values
+       * You can still use it multiple times in different modules, as it depends on the values
        * you hand in when checking the cut if the variable is defined or not.
        */
       static SoftwareTriggerVariableManager& Instance();
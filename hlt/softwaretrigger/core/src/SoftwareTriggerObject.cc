@@ -0,0 +1,74 @@
+/**************************************************************************
+ * basf2 (Belle II Analysis Software Framework)                           *
+ * Author: The Belle II Collaboration                                     *
+ *                                                                        *
+ * See git log for contributors and copyright holders.                    *
+ * This file is licensed under LGPL-3.0, see LICENSE.md.                  *
+ **************************************************************************/
+#include <hlt/softwaretrigger/core/SoftwareTriggerObject.h>
+
+#include <algorithm>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace Belle2 {
+  namespace SoftwareTrigger {
+    namespace {
+      /// Registry of all variable names with their slots, shared by all objects in the process
+      struct SlotRegistry {
+        /// protects the registry, new variables can be added by modules running in different threads
+        std::mutex mutex;
+        /// slot for each name
+        std::unordered_map<std::string, SoftwareTriggerObject::Slot> slots;
+        /// name for each slot, a deque so that references to the names stay valid when new ones are added
+        std::deque<std::string> names;
+      };
+
+      /// Get the one registry
+      SlotRegistry& getRegistry()
+      {
+        static SlotRegistry registry;
+        return registry;
+      }
+    }
+
+    SoftwareTriggerObject::Slot SoftwareTriggerObject::getSlot(const std::string& name)
+    {
+      // The calculations look up their variables by name in every event, so each thread keeps
+      // its own copy of the slots it already knows and only locks the registry for new names.
+      static thread_local std::unordered_map<std::string, Slot> knownSlots;
+      const auto known = knownSlots.find(name);
+      if (known != knownSlots.end()) return known->second;
+
+      SlotRegistry& registry = getRegistry();
+      std::lock_guard<std::mutex> lock(registry.mutex);
+      auto [it, inserted] = registry.slots.try_emplace(name, registry.names.size());
+      if (inserted) registry.names.push_back(name);
+      knownSlots.emplace(name, it->second);
+      return it->second;
+    }
+
+    const std::string& SoftwareTriggerObject::getName(Slot slot)
+    {
+      SlotRegistry& registry = getRegistry();
+      std::lock_guard<std::mutex> lock(registry.mutex);
+      return registry.names.at(slot);
+    }
+
+    std::vector<SoftwareTriggerObject::Slot> SoftwareTriggerObject::getSlotsSortedByName() const
+    {
+      std::vector<Slot> slots = m_slots;
+      SlotRegistry& registry = getRegistry();
+      std::lock_guard<std::mutex> lock(registry.mutex);
+      std::sort(slots.begin(), slots.end(), [&registry](Slot lhs, Slot rhs) { return registry.names[lhs] < registry.names[rhs]; });
+      return slots;
+    }
+
+    void SoftwareTriggerObject::throwUndefined(Slot slot)
+    {
+      throw std::out_of_range("Software trigger variable " + getName(slot) + " is not defined");
+    }
+  }
+}
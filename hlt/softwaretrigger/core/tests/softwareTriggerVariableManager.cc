@@ -9,6 +9,12 @@
 #include <hlt/softwaretrigger/core/SoftwareTriggerCut.h>
 #include <gtest/gtest.h>
 
+#include <functional>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
 using namespace std;
 
 namespace Belle2 {
@@ -38,5 +44,110 @@ namespace Belle2 {
       softwareTriggerObject["two_variable"] = 2.3;
       EXPECT_EQ(SoftwareTriggerCutResult::c_noResult, compiledSecondCut->checkPreScaled(softwareTriggerObject));
     }
+
+    /** Test that the variables are resolved to slots of the object. */
+    TEST(SoftwareTriggerVarialeManagerTest, slots)
+    {
+      SoftwareTriggerObject object;
+      EXPECT_EQ(object.size(), 0u);
+      object["slot_b"] = 2;
+      object["slot_a"] = 1;
+      object["slot_b"] = 3;
+      EXPECT_EQ(object.size(), 2u);
+
+      const auto slotA = SoftwareTriggerObject::getSlot("slot_a");
+      const auto slotB = SoftwareTriggerObject::getSlot("slot_b");
+      EXPECT_NE(slotA, slotB);
+      EXPECT_EQ(SoftwareTriggerObject::getName(slotA), "slot_a");
+      EXPECT_EQ(object.getSlots(), std::vector<SoftwareTriggerObject::Slot>({slotB, slotA}));
+      EXPECT_EQ(object.getSlotsSortedByName(), std::vector<SoftwareTriggerObject::Slot>({slotA, slotB}));
+      EXPECT_EQ(object.at(slotA), 1);
+      EXPECT_EQ(object.at("slot_b"), 3);
+
+      // the variable of the cut uses the same slot
+      EXPECT_EQ(SoftwareTriggerVariableManager::Instance().getVariable("slot_a")->slot, slotA);
+
+      // a slot known in the process is not automatically defined in every object
+      SoftwareTriggerObject other;
+      EXPECT_FALSE(other.has(slotA));
+      EXPECT_THROW(other.at(slotA), std::out_of_range);
+      other[slotA] = 4;
+      EXPECT_TRUE(other.has(slotA));
+      EXPECT_FALSE(other.has(slotB));
+
+      object.clear();
+      EXPECT_EQ(object.size(), 0u);
+      EXPECT_THROW(object.at(slotA), std::out_of_range);
+    }
+
+    /** Variables first used in different threads at the same time get one slot each. */
+    TEST(SoftwareTriggerVarialeManagerTest, slotsInThreads)
+    {
+      const unsigned int nThreads = 4;
+      const unsigned int nVariables = 200;
+      vector<vector<SoftwareTriggerObject::Slot>> slots(nThreads);
+      vector<thread> threads;
+      for (unsigned int i = 0; i < nThreads; ++i) {
+        threads.emplace_back([&slots, i]() {
+          for (unsigned int variable = 0; variable < nVariables; ++variable) {
+            slots[i].push_back(SoftwareTriggerObject::getSlot("thread_variable_" + to_string(variable)));
+          }
+        });
+      }
+      for (thread& t : threads) t.join();
+
+      for (unsigned int i = 1; i < nThreads; ++i) {
+        EXPECT_EQ(slots[i], slots[0]);
+      }
+      for (unsigned int variable = 0; variable < nVariables; ++variable) {
+        EXPECT_EQ(SoftwareTriggerObject::getName(slots[0][variable]), "thread_variable_" + to_string(variable));
+      }
+    }
+
+    /** Fill and check a menu of the size of the filter and skim menus, refilling the same object for each event. */
+    TEST(SoftwareTriggerVarialeManagerTest, menu)
+    {
+      // 93 filter and 55 skim variables as filled by the calculations, a cut on each skim
+      // variable and accept/reject cuts on combinations of the filter variables
+      const unsigned int nFilter = 93;
+      const unsigned int nSkim = 55;
+      std::vector<std::string> names;
+      for (unsigned int i = 0; i < nFilter; ++i) names.push_back("menuFilter" + std::to_string(i));
+      for (unsigned int i = 0; i < nSkim; ++i) names.push_back("menuSkim" + std::to_string(i));
+      std::vector<std::unique_ptr<SoftwareTriggerCut>> menu;
+      // the expected result of each cut for the given values, looked up by name
+      std::vector<std::function<SoftwareTriggerCutResult(const std::map<std::string, double>&)>> expected;
+      for (unsigned int i = 0; i < nFilter; i += 2) {
+        const std::string a = names[i];
+        const std::string b = names[(i + 1) % nFilter];
+        const std::string c = names[(i + 7) % nFilter];
+        const bool reject = i % 3 == 0;
+        menu.push_back(SoftwareTriggerCut::compile("[[" + a + " >= 2] and [" + b + " < 0.5]] or [" + c + " == 1]", 1, reject));
+        expected.push_back([a, b, c, reject](const std::map<std::string, double>& values) {
+          const bool condition = (values.at(a) >= 2 and values.at(b) < 0.5) or values.at(c) == 1;
+          if (not condition) return SoftwareTriggerCutResult::c_noResult;
+          return reject ? SoftwareTriggerCutResult::c_reject : SoftwareTriggerCutResult::c_accept;
+        });
+      }
+      for (unsigned int i = nFilter; i < names.size(); ++i) {
+        const std::string name = names[i];
+        menu.push_back(SoftwareTriggerCut::compile(name + " == 1", 1));
+        expected.push_back([name](const std::map<std::string, double>& values) {
+          return values.at(name) == 1 ? SoftwareTriggerCutResult::c_accept : SoftwareTriggerCutResult::c_noResult;
+        });
+      }
+
+      SoftwareTriggerObject object;
+      std::map<std::string, double> values;
+      for (unsigned int event = 0; event < 6; ++event) {
+        for (unsigned int i = 0; i < names.size(); ++i) {
+          object[names[i]] = (event + i) % 3;
+          values[names[i]] = (event + i) % 3;
+        }
+        for (unsigned int iCut = 0; iCut < menu.size(); ++iCut) {
+          EXPECT_EQ(menu[iCut]->check(object).second, expected[iCut](values)) << "cut " << iCut << " in event " << event;
+        }
+      }
+    }
   }
 }
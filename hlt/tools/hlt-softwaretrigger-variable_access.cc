@@ -0,0 +1,79 @@
+/**************************************************************************
+ * basf2 (Belle II Analysis Software Framework)                           *
+ * Author: The Belle II Collaboration                                     *
+ *                                                                        *
+ * See git log for contributors and copyright holders.                    *
+ * This file is licensed under LGPL-3.0, see LICENSE.md.                  *
+ **************************************************************************/
+
+#include <hlt/softwaretrigger/core/SoftwareTriggerObject.h>
+
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace Belle2::SoftwareTrigger;
+
+/** Compare filling and reading the variables of a menu of the size of the filter and skim menus through the slots
+ * of a SoftwareTriggerObject with the same operations on a std::map<std::string, double>, as used before.
+ *
+ * The calculations fill the variables by name, the cuts read them by the slot resolved when they are compiled
+ * or, with the map, by name. The evaluation of the cuts themselves is the same for both and not included.
+ *
+ * Usage: hlt-softwaretrigger-variable_access
+ */
+int main()
+{
+  // 93 filter and 55 skim variables as filled by the calculations, a cut on each skim
+  // variable and cuts on three of the filter variables each
+  const unsigned int nFilter = 93;
+  const unsigned int nSkim = 55;
+  std::vector<std::string> names;
+  for (unsigned int i = 0; i < nFilter; ++i) names.push_back("filterVariable" + std::to_string(i));
+  for (unsigned int i = 0; i < nSkim; ++i) names.push_back("skimVariable" + std::to_string(i));
+  std::vector<std::vector<std::string>> menuVariables;
+  for (unsigned int i = 0; i < nFilter; i += 2) {
+    menuVariables.push_back({names[i], names[(i + 1) % nFilter], names[(i + 7) % nFilter]});
+  }
+  for (unsigned int i = nFilter; i < names.size(); ++i) {
+    menuVariables.push_back({names[i]});
+  }
+  std::vector<std::vector<SoftwareTriggerObject::Slot>> menuSlots;
+  for (const auto& variables : menuVariables) {
+    menuSlots.emplace_back();
+    for (const std::string& name : variables) menuSlots.back().push_back(SoftwareTriggerObject::getSlot(name));
+  }
+
+  const unsigned int nEvents = 100000;
+  SoftwareTriggerObject object;
+  double slotSum = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (unsigned int event = 0; event < nEvents; ++event) {
+    for (unsigned int i = 0; i < names.size(); ++i) object[names[i]] = (event + i) % 3;
+    for (const auto& slots : menuSlots) {
+      for (SoftwareTriggerObject::Slot slot : slots) slotSum += object.at(slot);
+    }
+  }
+  const double slotTime = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / nEvents;
+
+  std::map<std::string, double> map;
+  double mapSum = 0;
+  start = std::chrono::steady_clock::now();
+  for (unsigned int event = 0; event < nEvents; ++event) {
+    for (unsigned int i = 0; i < names.size(); ++i) map[names[i]] = (event + i) % 3;
+    for (const auto& variables : menuVariables) {
+      for (const std::string& name : variables) mapSum += map.at(name);
+    }
+  }
+  const double mapTime = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / nEvents;
+
+  if (slotSum != mapSum) {
+    std::cerr << "The slots and the map give different values\n";
+    return 1;
+  }
+  std::cout << "Menu with " << menuVariables.size() << " cuts on " << names.size() << " variables: slots " << slotTime <<
+            " us, std::map " << mapTime << " us per event for filling and reading the variables\n";
+  return 0;
+}
@@ -223,6 +223,71 @@ namespace Belle2 {
 
     };
 
+    /**
+     * Wraps the feature values of many events stored in one contiguous buffer, row by row.
+     * In contrast to the MultiDataset it can be cleared and refilled without allocating memory,
+     * so it is used to apply an expert to all candidates of an event at once.
+     * Like the SingleDataset used by the experts before, it only stores the features and no spectators.
+     */
+    class BatchDataset : public Dataset {
+
+    public:
+      /**
+       * Constructs a new empty BatchDataset
+       * @param general_options which defines e.g. number of variables
+       */
+      explicit BatchDataset(const GeneralOptions& general_options);
+
+      /**
+       * Returns the number of features in this dataset
+       */
+      virtual unsigned int getNumberOfFeatures() const override { return m_input.size(); }
+
+      /**
+       * Returns the number of spectators in this dataset, which is always 0 since they are not stored
+       */
+      virtual unsigned int getNumberOfSpectators() const override { return 0; }
+
+      /**
+       * Returns the number of events in this dataset
+       */
+      virtual unsigned int getNumberOfEvents() const override { return m_nEvents; }
+
+      /**
+       * Load the event number iEvent
+       * @param iEvent event number to load
+       */
+      virtual void loadEvent(unsigned int iEvent) override;
+
+      /**
+       * Returns all values of one feature in a std::vector<float>
+       * @param iFeature the position of the feature to return
+       */
+      virtual std::vector<float> getFeature(unsigned int iFeature) override;
+
+      /**
+       * Removes all events, the allocated memory is kept for the next batch
+       */
+      void clear() { m_nEvents = 0; }
+
+      /**
+       * Reserves memory for the given number of events
+       * @param nEvents expected number of events
+       */
+      void reserve(unsigned int nEvents) { m_matrix.reserve(static_cast<size_t>(nEvents) * m_input.size()); }
+
+      /**
+       * Appends a new event and returns a pointer to its getNumberOfFeatures() feature values,
+       * which have to be filled by the caller. The pointer is invalidated by the next call.
+       */
+      float* addEvent();
+
+    private:
+      std::vector<float> m_matrix; /**< Feature values of all events, row by row */
+      unsigned int m_nEvents = 0; /**< Number of events in the current batch */
+
+    };
+
     /**
      * Wraps another Dataset and provides a view to a subset of its features and events.
      * Used by the Combination method which can combine multiple methods with possibly different variables
@@ -14,6 +14,7 @@
 
 #include <TLeaf.h>
 
+#include <algorithm>
 #include <filesystem>
 
 namespace Belle2 {
@@ -179,6 +180,38 @@ namespace Belle2 {
 
     }
 
+    BatchDataset::BatchDataset(const GeneralOptions& general_options) : Dataset(general_options)
+    {
+      // Spectators are not needed to apply an expert, so they are not stored
+      m_spectators.clear();
+    }
+
+    void BatchDataset::loadEvent(unsigned int iEvent)
+    {
+      const size_t nFeatures = m_input.size();
+      std::copy_n(m_matrix.begin() + iEvent * nFeatures, nFeatures, m_input.begin());
+    }
+
+    std::vector<float> BatchDataset::getFeature(unsigned int iFeature)
+    {
+
+      const size_t nFeatures = m_input.size();
+      std::vector<float> result(m_nEvents);
+      for (unsigned int iEvent = 0; iEvent < m_nEvents; ++iEvent) {
+        result[iEvent] = m_matrix[iEvent * nFeatures + iFeature];
+      }
+      return result;
+
+    }
+
+    float* BatchDataset::addEvent()
+    {
+      const size_t nFeatures = m_input.size();
+      const size_t size = (m_nEvents + 1) * nFeatures;
+      if (m_matrix.size() < size) m_matrix.resize(size);
+      return m_matrix.data() + (m_nEvents++) * nFeatures;
+    }
+
     SubDataset::SubDataset(const GeneralOptions& general_options, const std::vector<bool>& events,
                            Dataset& dataset) : Dataset(general_options), m_dataset(dataset)
     {
@@ -198,6 +198,60 @@ namespace {
 
   }
 
+  TEST(DatasetTest, BatchDataset)
+  {
+
+    MVA::GeneralOptions general_options;
+    general_options.m_variables = {"a", "b", "c"};
+    general_options.m_spectators = {"e"};
+    MVA::BatchDataset x(general_options);
+
+    EXPECT_EQ(x.getNumberOfFeatures(), 3);
+    EXPECT_EQ(x.getNumberOfSpectators(), 0);
+    EXPECT_EQ(x.m_spectators.size(), 0);
+    EXPECT_EQ(x.getNumberOfEvents(), 0);
+
+    for (float offset : {0.0, 3.0, 6.0}) {
+      float* input = x.addEvent();
+      for (unsigned int i = 0; i < 3; ++i) input[i] = offset + i + 1;
+    }
+    EXPECT_EQ(x.getNumberOfEvents(), 3);
+
+    x.loadEvent(1);
+    EXPECT_EQ(x.m_input.size(), 3);
+    EXPECT_FLOAT_EQ(x.m_input[0], 4.0);
+    EXPECT_FLOAT_EQ(x.m_input[1], 5.0);
+    EXPECT_FLOAT_EQ(x.m_input[2], 6.0);
+    EXPECT_FLOAT_EQ(x.m_weight, 1.0);
+
+    auto feature = x.getFeature(1);
+    EXPECT_EQ(feature.size(), 3);
+    EXPECT_FLOAT_EQ(feature[0], 2.0);
+    EXPECT_FLOAT_EQ(feature[1], 5.0);
+    EXPECT_FLOAT_EQ(feature[2], 8.0);
+
+    // Same result for mother class implementation
+    feature = x.Dataset::getFeature(1);
+    EXPECT_EQ(feature.size(), 3);
+    EXPECT_FLOAT_EQ(feature[0], 2.0);
+    EXPECT_FLOAT_EQ(feature[1], 5.0);
+    EXPECT_FLOAT_EQ(feature[2], 8.0);
+
+    // Refilling after clear reuses the memory and only contains the new events
+    x.clear();
+    EXPECT_EQ(x.getNumberOfEvents(), 0);
+    float* input = x.addEvent();
+    input[0] = 10.0;
+    input[1] = 11.0;
+    input[2] = 12.0;
+    EXPECT_EQ(x.getNumberOfEvents(), 1);
+    x.loadEvent(0);
+    EXPECT_FLOAT_EQ(x.m_input[0], 10.0);
+    EXPECT_FLOAT_EQ(x.m_input[2], 12.0);
+    EXPECT_EQ(x.getFeature(0).size(), 1);
+
+  }
+
   TEST(DatasetTest, SubDataset)
   {
 
@@ -18,6 +18,9 @@
 #include <FastBDT_IO.h>
 #include <Classifier.h>
 
+#include <istream>
+#include <vector>
+
 namespace Belle2 {
   namespace MVA {
 
@@ -67,6 +70,7 @@ namespace Belle2 {
       bool m_purityTransformation = false; /**< Activates purity transformation globally for all features */
       std::vector<bool>
       m_individualPurityTransformation; /**< Vector which decided for each feature individually if the purity transformation should be used. */
+      bool m_flatForest = false; /**< Use the flattened forest for the inference if possible */
     };
 
 
@@ -94,6 +98,97 @@ namespace Belle2 {
     };
 
 
+    /**
+     * FastBDT forest flattened into contiguous arrays to evaluate many samples at once.
+     *
+     * The cuts of all trees are stored tree by tree in the order of the binary heap
+     * FastBDT uses, as pairs of feature and threshold, so a sample is evaluated without
+     * following any pointers and without branches. The samples of a block go through
+     * each tree one after the other, they are independent and the processor evaluates
+     * several of them at the same time. The result is the same as the one of
+     * FastBDT::Forest<float>::Analyse(): a sample stops in an inner node if the cut
+     * is not valid or the value is NaN and the boost weights are summed in the
+     * order of the trees.
+     *
+     * Only forests which work on the feature values themselves can be flattened,
+     * i.e. not the ones of classifiers using the purity transformation.
+     */
+    class FastBDTFlatForest {
+
+    public:
+      /**
+       * Read a forest as written by FastBDT for a FastBDT::Forest<float>
+       * @param stream to read from
+       * @return false if the stream doesn't contain a valid forest
+       */
+      bool readForest(std::istream& stream);
+
+      /**
+       * Read the forest of a FastBDT::Classifier as written by FastBDT
+       * @param stream to read from
+       * @return false if the classifier can not be evaluated on the feature values directly
+       *         or the stream doesn't contain a valid classifier
+       */
+      bool readClassifier(std::istream& stream);
+
+      /**
+       * Returns the number of features a sample needs to have
+       */
+      unsigned int getNumberOfFeatures() const { return m_nFeatures; }
+
+      /**
+       * Returns the sorted values of all valid cuts on the given feature
+       * @param feature index of the feature
+       */
+      std::vector<float> getCutValues(unsigned int feature) const;
+
+      /**
+       * Evaluate the forest for a single sample
+       * @param sample getNumberOfFeatures() feature values
+       */
+      float analyse(const float* sample) const;
+
+      /**
+       * Evaluate the forest for many samples
+       * @param samples feature values of the samples, one sample after the other
+       * @param nSamples number of samples
+       * @param stride number of values per sample, at least getNumberOfFeatures()
+       * @param result output for each sample
+       */
+      void analyse(const float* samples, unsigned int nSamples, unsigned int stride, float* result) const;
+
+      /** Number of samples evaluated together */
+      static constexpr unsigned int c_blockSize = 16;
+
+    private:
+      /**
+       * Cut of an inner node, a sample continues with the second child if its value is not lower than the threshold.
+       * Cuts which FastBDT doesn't apply have a NaN threshold on the first feature, all nodes below them have their boost weight.
+       */
+      struct Cut {
+        unsigned int feature; /**< index of the feature */
+        float threshold; /**< value of the cut */
+      };
+
+      /**
+       * Evaluate at most c_blockSize samples
+       * @tparam depth depth of all trees, 0 to use the depth of each tree
+       */
+      template<unsigned int depth>
+      void analyseBlock(const float* samples, unsigned int nSamples, unsigned int stride, float* result) const;
+
+      double m_F0 = 0; /**< Initial value of the boosting */
+      double m_shrinkage = 0; /**< Shrinkage of the boost weights */
+      bool m_transform2probability = true; /**< Transform the result to a probability */
+      unsigned int m_nFeatures = 0; /**< Number of features used by the cuts */
+      unsigned int m_depth = 0; /**< Depth of all trees, 0 if they differ */
+      std::vector<unsigned int> m_depths; /**< Depth of each tree */
+      std::vector<unsigned int> m_cutOffsets; /**< Index of the first cut of each tree */
+      std::vector<unsigned int> m_weightOffsets; /**< Index of the first boost weight of each tree */
+      std::vector<Cut> m_cuts; /**< Cuts of all trees */
+      std::vector<float> m_weights; /**< Boost weights of all nodes */
+    };
+
     /**
      * Expert for the FastBDT MVA method
      */
@@ -112,9 +207,28 @@ namespace Belle2 {
        */
       virtual std::vector<float> apply(Dataset& test_data) const override;
 
+      /**
+       * Returns true if the flattened forest is used for the inference
+       */
+      bool isUsingFlatForest() const { return m_use_flat_forest; }
+
+      /**
+       * Returns the flattened forest, only filled if it is used for the inference
+       */
+      const FastBDTFlatForest& getFlatForest() const { return m_flat_forest; }
+
     private:
+      /**
+       * Check that the flattened forest returns exactly the same values as FastBDT
+       * for samples around the cut values of the forest
+       * @param nVariables number of values FastBDT expects for each sample
+       */
+      bool validateFlatForest(unsigned int nVariables) const;
+
       FastBDTOptions m_specific_options; /**< Method specific options */
       bool m_use_simplified_interface = false; /**< Use the simplified FastBDT interface of version 4 */
+      bool m_use_flat_forest = false; /**< Use the flattened forest for the inference */
+      FastBDTFlatForest m_flat_forest; /**< Flattened forest used for the inference */
       FastBDT::Classifier m_classifier; /**< Simplified FastBDT interface: classifier combines preprocessing and forest */
       FastBDT::Forest<float> m_expert_forest; /**< Forest Expert -> used in case of no purity transformation. */
     };
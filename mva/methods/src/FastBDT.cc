@@ -9,9 +9,33 @@
 #include <mva/methods/FastBDT.h>
 
 #include <framework/logging/Logger.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
 #include <sstream>
+#include <string>
+#include <type_traits>
 #include <vector>
 
+namespace {
+  /** Read a floating point number as written by FastBDT, which includes nan and inf */
+  template<class T>
+  bool readNumber(std::istream& stream, T& value)
+  {
+    std::string token;
+    if (!(stream >> token))
+      return false;
+    char* end = nullptr;
+    if constexpr(std::is_same_v<T, float>)
+      value = std::strtof(token.c_str(), &end);
+    else
+      value = std::strtod(token.c_str(), &end);
+    return end != token.c_str() and *end == '\0';
+  }
+}
+
 namespace Belle2 {
   namespace MVA {
     bool isValidSignal(const std::vector<bool>& Signals)
@@ -59,6 +83,7 @@ namespace Belle2 {
         m_flatnessLoss = -1.0;
         m_sPlot = false;
       }
+      m_flatForest = pt.get<bool>("FastBDT_flatForest", false);
     }
 
     void FastBDTOptions::save(boost::property_tree::ptree& pt) const
@@ -80,6 +105,7 @@ namespace Belle2 {
       for (unsigned int i = 0; i < m_individualPurityTransformation.size(); ++i) {
         pt.put(std::string("FastBDT_individualPurityTransformation") + std::to_string(i), m_individualPurityTransformation[i]);
       }
+      pt.put("FastBDT_flatForest", m_flatForest);
     }
 
     po::options_description FastBDTOptions::getDescription()
@@ -105,7 +131,9 @@ namespace Belle2 {
       ("individualPurityTransformation", po::value<std::vector<bool>>(&m_individualPurityTransformation)->multitoken(),
        "Activates purity transformation for each feature: Vector of boolean values which decide if the purity transformed of the feature should be added in addition to this training.")
       ("randRatio", po::value<double>(&m_randRatio)->notifier(check_bounds<double>(0.0, 1.0001, "randRatio")),
-       "Fraction of the data sampled each training iteration. Reasonable values are between 0.1 and 1.0.");
+       "Fraction of the data sampled each training iteration. Reasonable values are between 0.1 and 1.0.")
+      ("flatForest", po::value<bool>(&m_flatForest),
+       "Evaluate the trained forest with the flattened forest, which evaluates many samples at once and returns the same values. Not available if the purity transformation is used, off by default.");
       return description;
     }
 
@@ -185,6 +213,189 @@ namespace Belle2 {
 
     }
 
+    bool FastBDTFlatForest::readForest(std::istream& stream)
+    {
+      unsigned int nTrees = 0;
+      if (!readNumber(stream, m_F0) or !readNumber(stream, m_shrinkage) or !(stream >> m_transform2probability >> nTrees))
+        return false;
+
+      m_nFeatures = 0;
+      m_depth = 0;
+      m_depths.clear();
+      m_cutOffsets.clear();
+      m_weightOffsets.clear();
+      m_cuts.clear();
+      m_weights.clear();
+      for (unsigned int iTree = 0; iTree < nTrees; ++iTree) {
+        // the cuts of a tree of depth d are a complete binary tree with 2^d - 1 nodes
+        unsigned int nCuts = 0;
+        if (!(stream >> nCuts) or ((nCuts + 1) & nCuts) != 0)
+          return false;
+        unsigned int depth = 0;
+        while ((1u << depth) < nCuts + 1) ++depth;
+        m_depth = (iTree == 0 or depth == m_depth) ? depth : 0;
+        m_depths.push_back(depth);
+        m_cutOffsets.push_back(m_cuts.size());
+        m_weightOffsets.push_back(m_weights.size());
+        // nodes in which FastBDT stops because the cut is not applied, and the nodes below them
+        std::vector<bool> stops(2 * nCuts + 1, false);
+        for (unsigned int iCut = 0; iCut < nCuts; ++iCut) {
+          unsigned int feature = 0;
+          float index = 0;
+          bool valid = false;
+          double gain = 0;
+          if (!(stream >> feature) or !readNumber(stream, index) or !(stream >> valid) or !readNumber(stream, gain))
+            return false;
+          if (valid) {
+            m_cuts.push_back({feature, index});
+            m_nFeatures = std::max(m_nFeatures, feature + 1);
+          } else {
+            m_cuts.push_back({0, std::numeric_limits<float>::quiet_NaN()});
+            stops[iCut] = true;
+          }
+        }
+        if (nCuts > 0)
+          m_nFeatures = std::max(m_nFeatures, 1u);
+        // boost weights, purities and number of entries of all nodes, only the boost weights are needed
+        for (unsigned int iVector = 0; iVector < 3; ++iVector) {
+          unsigned int size = 0;
+          if (!(stream >> size) or size != 2 * nCuts + 1)
+            return false;
+          for (unsigned int i = 0; i < size; ++i) {
+            float value = 0;
+            if (!readNumber(stream, value))
+              return false;
+            if (iVector == 0)
+              m_weights.push_back(value);
+          }
+        }
+        // the cuts which are not applied are evaluated as well, so all nodes below them return their boost weight
+        float* weights = m_weights.data() + m_weightOffsets.back();
+        for (unsigned int node = 1; node < 2 * nCuts + 1; ++node) {
+          const unsigned int parent = (node - 1) / 2;
+          if (stops[parent]) {
+            stops[node] = true;
+            weights[node] = weights[parent];
+          }
+        }
+      }
+      return true;
+    }
+
+    bool FastBDTFlatForest::readClassifier(std::istream& stream)
+    {
+      // Skips a vector of values as written by FastBDT, which starts with its size
+      auto skipVector = [&stream]() {
+        unsigned int size = 0;
+        if (!(stream >> size))
+          return false;
+        std::string value;
+        for (unsigned int i = 0; i < size; ++i) {
+          if (!(stream >> value))
+            return false;
+        }
+        return true;
+      };
+
+      unsigned int version = 0, nTrees = 0, depth = 0;
+      double shrinkage = 0, subsample = 0, flatnessLoss = 0;
+      bool sPlot = false, transform2probability = false;
+      if (!(stream >> version >> nTrees >> depth) or !skipVector())
+        return false;
+      if (!readNumber(stream, shrinkage) or !readNumber(stream, subsample) or !(stream >> sPlot)
+          or !readNumber(stream, flatnessLoss))
+        return false;
+      // a purity transformation changes the features before they enter the forest
+      unsigned int nPurityTransformation = 0;
+      if (!(stream >> nPurityTransformation))
+        return false;
+      for (unsigned int i = 0; i < nPurityTransformation; ++i) {
+        bool purityTransformation = false;
+        if (!(stream >> purityTransformation) or purityTransformation)
+          return false;
+      }
+      unsigned int nFeatureBinnings = 0;
+      if (!(stream >> transform2probability >> nFeatureBinnings))
+        return false;
+      for (unsigned int i = 0; i < nFeatureBinnings; ++i) {
+        unsigned int nLevels = 0;
+        if (!(stream >> nLevels) or !skipVector())
+          return false;
+      }
+      unsigned int nPurityBinnings = 0;
+      if (!(stream >> nPurityBinnings) or nPurityBinnings != 0)
+        return false;
+      unsigned int nFeatures = 0, nFinalFeatures = 0, nFlatnessFeatures = 0;
+      bool canUseFastForest = false;
+      if (!(stream >> nFeatures >> nFinalFeatures >> nFlatnessFeatures >> canUseFastForest) or not canUseFastForest)
+        return false;
+      return readForest(stream) and m_nFeatures <= nFeatures;
+    }
+
+    std::vector<float> FastBDTFlatForest::getCutValues(unsigned int feature) const
+    {
+      std::vector<float> values;
+      for (const Cut& cut : m_cuts) {
+        if (cut.feature == feature and not std::isnan(cut.threshold))
+          values.push_back(cut.threshold);
+      }
+      std::sort(values.begin(), values.end());
+      values.erase(std::unique(values.begin(), values.end()), values.end());
+      return values;
+    }
+
+    float FastBDTFlatForest::analyse(const float* sample) const
+    {
+      float result = 0;
+      analyse(sample, 1, std::max(m_nFeatures, 1u), &result);
+      return result;
+    }
+
+    void FastBDTFlatForest::analyse(const float* samples, unsigned int nSamples, unsigned int stride, float* result) const
+    {
+      // the usual depths are known at compile time, so the loop over the levels is unrolled
+      void (FastBDTFlatForest::*evaluate)(const float*, unsigned int, unsigned int, float*) const;
+      switch (m_depth) {
+        case 1: evaluate = &FastBDTFlatForest::analyseBlock<1>; break;
+        case 2: evaluate = &FastBDTFlatForest::analyseBlock<2>; break;
+        case 3: evaluate = &FastBDTFlatForest::analyseBlock<3>; break;
+        case 4: evaluate = &FastBDTFlatForest::analyseBlock<4>; break;
+        case 5: evaluate = &FastBDTFlatForest::analyseBlock<5>; break;
+        case 6: evaluate = &FastBDTFlatForest::analyseBlock<6>; break;
+        default: evaluate = &FastBDTFlatForest::analyseBlock<0>; break;
+      }
+      for (unsigned int iSample = 0; iSample < nSamples; iSample += c_blockSize) {
+        (this->*evaluate)(samples + iSample * stride, std::min(c_blockSize, nSamples - iSample), stride, result + iSample);
+      }
+    }
+
+    template<unsigned int depth>
+    void FastBDTFlatForest::analyseBlock(const float* samples, unsigned int nSamples, unsigned int stride, float* result) const
+    {
+      double F[c_blockSize];
+      std::fill_n(F, nSamples, m_F0);
+      for (unsigned int iTree = 0; iTree < m_depths.size(); ++iTree) {
+        const Cut* cuts = m_cuts.data() + m_cutOffsets[iTree];
+        const float* weights = m_weights.data() + m_weightOffsets[iTree];
+        const unsigned int nLevels = depth > 0 ? depth : m_depths[iTree];
+        for (unsigned int i = 0; i < nSamples; ++i) {
+          const float* sample = samples + i * stride;
+          unsigned int node = 0;
+          for (unsigned int level = 0; level < nLevels; ++level) {
+            const Cut& cut = cuts[node];
+            const float value = sample[cut.feature];
+            const unsigned int next = 2 * node + 1 + (value >= cut.threshold);
+            // a sample with a missing value stays in this node, also on the next levels
+            node = std::isnan(value) ? node : next;
+          }
+          F[i] += m_shrinkage * weights[node];
+        }
+      }
+      for (unsigned int i = 0; i < nSamples; ++i) {
+        result[i] = m_transform2probability ? 1.0 / (1.0 + std::exp(-2 * F[i])) : F[i];
+      }
+    }
+
     void FastBDTExpert::load(Weightfile& weightfile)
     {
 
@@ -194,6 +405,7 @@ namespace Belle2 {
 
       int version = weightfile.getElement<int>("FastBDT_version", 0);
       B2DEBUG(100, "FastBDT Weightfile Version " << version);
+      bool oldFormat = false;
       if (version < 2) {
         std::stringstream s;
         {
@@ -213,6 +425,7 @@ namespace Belle2 {
                  "I will convert your FastBDT on-the-fly to the new version."
                  "Retrain the classifier to get rid of this message");
           // Old format before version 3
+          oldFormat = true;
           // We read in first the feature binnings and than rewrite the tree
           std::vector<FastBDT::FeatureBinning<float>> feature_binnings;
           file >> feature_binnings;
@@ -242,13 +455,78 @@ namespace Belle2 {
       file.close();
 
       weightfile.getOptions(m_specific_options);
+
+      m_use_flat_forest = false;
+      if (m_specific_options.m_flatForest and not oldFormat) {
+        GeneralOptions general_options;
+        weightfile.getOptions(general_options);
+        const unsigned int nVariables = general_options.m_variables.size() + general_options.m_spectators.size();
+        std::fstream flatFile(custom_weightfile, std::ios_base::in);
+        const bool flattened = m_use_simplified_interface ? m_flat_forest.readClassifier(flatFile) : m_flat_forest.readForest(flatFile);
+        if (not flattened) {
+          B2DEBUG(100, "FastBDT: The forest cannot be flattened, e.g. because of the purity transformation. Using FastBDT for the inference.");
+        } else if (not validateFlatForest(nVariables)) {
+          B2WARNING("FastBDT: The flattened forest doesn't return the same values as FastBDT. Using FastBDT for the inference.");
+        } else {
+          m_use_flat_forest = true;
+        }
+      }
+    }
+
+    bool FastBDTExpert::validateFlatForest(unsigned int nVariables) const
+    {
+      const unsigned int nFeatures = m_flat_forest.getNumberOfFeatures();
+      if (nFeatures > nVariables)
+        return false;
+
+      std::vector<std::vector<float>> cutValues(nFeatures);
+      unsigned int nProbes = 2;
+      for (unsigned int iFeature = 0; iFeature < nFeatures; ++iFeature) {
+        cutValues[iFeature] = m_flat_forest.getCutValues(iFeature);
+        nProbes = std::max<unsigned int>(nProbes, 2 * cutValues[iFeature].size() + 2);
+      }
+
+      // Every probe uses for each feature one of its cut values, alternately exactly the cut value and
+      // the next lower value, so that every cut is tested from both sides. Some values are NaN.
+      std::vector<float> sample(std::max(nVariables, 1u), 0.0);
+      for (unsigned int iProbe = 0; iProbe < nProbes; ++iProbe) {
+        for (unsigned int iFeature = 0; iFeature < nFeatures; ++iFeature) {
+          const std::vector<float>& values = cutValues[iFeature];
+          if (values.empty() or (iProbe + iFeature) % 17 == 0) {
+            sample[iFeature] = std::numeric_limits<float>::quiet_NaN();
+          } else {
+            const float value = values[(iProbe / 2 + 7 * iFeature) % values.size()];
+            sample[iFeature] = (iProbe % 2 == 0) ? value : std::nextafter(value, -std::numeric_limits<float>::infinity());
+          }
+        }
+        const float expected = m_use_simplified_interface ? m_classifier.predict(sample) : m_expert_forest.Analyse(sample);
+        if (m_flat_forest.analyse(sample.data()) != expected)
+          return false;
+      }
+      return true;
     }
 
     std::vector<float> FastBDTExpert::apply(Dataset& test_data) const
     {
 
-      std::vector<float> probabilities(test_data.getNumberOfEvents());
-      for (unsigned int iEvent = 0; iEvent < test_data.getNumberOfEvents(); ++iEvent) {
+      const unsigned int nEvents = test_data.getNumberOfEvents();
+      std::vector<float> probabilities(nEvents);
+      if (m_use_flat_forest and test_data.getNumberOfFeatures() >= m_flat_forest.getNumberOfFeatures()) {
+        // Collect the features of a block of events and evaluate them together
+        const unsigned int stride = std::max(test_data.getNumberOfFeatures(), 1u);
+        std::vector<float> block(FastBDTFlatForest::c_blockSize * stride, 0.0);
+        for (unsigned int iEvent = 0; iEvent < nEvents; iEvent += FastBDTFlatForest::c_blockSize) {
+          const unsigned int nBlock = std::min(FastBDTFlatForest::c_blockSize, nEvents - iEvent);
+          for (unsigned int i = 0; i < nBlock; ++i) {
+            test_data.loadEvent(iEvent + i);
+            std::copy_n(test_data.m_input.begin(), std::min<size_t>(stride, test_data.m_input.size()), block.begin() + i * stride);
+          }
+          m_flat_forest.analyse(block.data(), nBlock, stride, probabilities.data() + iEvent);
+        }
+        return probabilities;
+      }
+
+      for (unsigned int iEvent = 0; iEvent < nEvents; ++iEvent) {
         test_data.loadEvent(iEvent);
         if (m_use_simplified_interface)
           probabilities[iEvent] = m_classifier.predict(test_data.m_input);
@@ -14,6 +14,11 @@
 
 #include <gtest/gtest.h>
 
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <sstream>
+
 using namespace Belle2;
 
 namespace {
@@ -32,6 +37,7 @@ namespace {
     EXPECT_EQ(specific_options.m_individualPurityTransformation.size(), 0);
     EXPECT_EQ(specific_options.m_purityTransformation, false);
     EXPECT_FLOAT_EQ(specific_options.m_flatnessLoss, -1.0);
+    EXPECT_EQ(specific_options.m_flatForest, false);
 
     specific_options.m_nTrees = 100;
     specific_options.m_nCuts = 10;
@@ -43,6 +49,7 @@ namespace {
     specific_options.m_sPlot = true;
     specific_options.m_purityTransformation = true;
     specific_options.m_individualPurityTransformation = {true, false, true};
+    specific_options.m_flatForest = true;
 
     boost::property_tree::ptree pt;
     specific_options.save(pt);
@@ -62,6 +69,7 @@ namespace {
     EXPECT_EQ(pt.get<bool>("FastBDT_individualPurityTransformation0"), true);
     EXPECT_EQ(pt.get<bool>("FastBDT_individualPurityTransformation1"), false);
     EXPECT_EQ(pt.get<bool>("FastBDT_individualPurityTransformation2"), true);
+    EXPECT_EQ(pt.get<bool>("FastBDT_flatForest"), true);
 
     MVA::FastBDTOptions specific_options2;
     specific_options2.load(pt);
@@ -82,13 +90,14 @@ namespace {
     EXPECT_EQ(specific_options2.m_individual_nCuts[0], 2);
     EXPECT_EQ(specific_options2.m_individual_nCuts[1], 3);
     EXPECT_EQ(specific_options2.m_individual_nCuts[2], 4);
+    EXPECT_EQ(specific_options2.m_flatForest, true);
 
     EXPECT_EQ(specific_options.getMethod(), std::string("FastBDT"));
 
     // Test if po::options_description is created without crashing
     auto description = specific_options.getDescription();
 
-    EXPECT_EQ(description.options().size(), 10);
+    EXPECT_EQ(description.options().size(), 11);
 
     // Check for B2ERROR and throw if version is wrong
     // we try with version 100, surely we will never reach this!
@@ -151,6 +160,40 @@ namespace {
 
   }
 
+  TEST(FastBDTTest, BatchedApplication)
+  {
+    MVA::Interface<MVA::FastBDTOptions, MVA::FastBDTTeacher, MVA::FastBDTExpert> interface;
+
+    MVA::GeneralOptions general_options;
+    general_options.m_variables = {"A"};
+    MVA::FastBDTOptions specific_options;
+    specific_options.m_randRatio = 1.0;
+    TestDataset dataset({1.0, 1.0, 1.0, 1.0, 2.0, 3.0, 2.0, 3.0});
+
+    auto teacher = interface.getTeacher(general_options, specific_options);
+    auto weightfile = teacher->train(dataset);
+    auto expert = interface.getExpert();
+    expert->load(weightfile);
+
+    // compare applying the expert to each candidate on its own with applying it once to all candidates of an event,
+    // the batch is refilled with a different number of candidates for each event
+    MVA::SingleDataset single(general_options, {0.0}, 0.0);
+    MVA::BatchDataset batch(general_options);
+    for (unsigned int nCandidates : {10u, 1u, 100u}) {
+      std::vector<float> singleResults;
+      for (unsigned int i = 0; i < nCandidates; ++i) {
+        single.m_input[0] = 1.0 + (i % 3);
+        singleResults.push_back(expert->apply(single)[0]);
+      }
+
+      batch.clear();
+      for (unsigned int i = 0; i < nCandidates; ++i) {
+        batch.addEvent()[0] = 1.0 + (i % 3);
+      }
+      EXPECT_EQ(singleResults, expert->apply(batch));
+    }
+  }
+
   TEST(FastBDTTest, FastBDTInterfaceWithPurityTransformation)
   {
     MVA::Interface<MVA::FastBDTOptions, MVA::FastBDTTeacher, MVA::FastBDTExpert> interface;
@@ -229,4 +272,102 @@ namespace {
     EXPECT_NEAR(probabilities_v5[5], probabilities_v3[5], 0.001);
   }
 
+  TEST(FastBDTTest, FlatForestIsIdenticalOnRealWeightfiles)
+  {
+    MVA::Interface<MVA::FastBDTOptions, MVA::FastBDTTeacher, MVA::FastBDTExpert> interface;
+
+    MVA::GeneralOptions general_options;
+    general_options.m_variables = {"M", "p", "pt"};
+    // samples around the region used in the training, including some missing values
+    const unsigned int nSamples = 1000;
+    std::vector<std::vector<float>> samples(nSamples);
+    for (unsigned int i = 0; i < nSamples; ++i) {
+      samples[i] = {1.8f + 0.1f * ((i * 7) % 101) / 100.0f, 3.0f * ((i * 13) % 97) / 96.0f, 2.0f * ((i * 29) % 89) / 88.0f};
+      if (i % 31 == 0) samples[i][i % 3] = std::numeric_limits<float>::quiet_NaN();
+    }
+    MVA::MultiDataset dataset(general_options, samples, {});
+
+    for (const std::string name : {"FastBDTv3.xml", "FastBDTv5.xml"}) {
+      const std::string filename = FileSystem::findFile("mva/methods/tests/" + name);
+      auto flatWeightfile = MVA::Weightfile::loadFromFile(filename);
+      flatWeightfile.addElement("FastBDT_flatForest", true);
+      auto flatExpert = interface.getExpert();
+      flatExpert->load(flatWeightfile);
+      EXPECT_TRUE(static_cast<MVA::FastBDTExpert&>(*flatExpert).isUsingFlatForest()) << name;
+
+      // the flattened forest has to be requested
+      auto weightfile = MVA::Weightfile::loadFromFile(filename);
+      auto expert = interface.getExpert();
+      expert->load(weightfile);
+      EXPECT_FALSE(static_cast<MVA::FastBDTExpert&>(*expert).isUsingFlatForest()) << name;
+
+      // the results have to be bit-identical, not only close
+      auto flatProbabilities = flatExpert->apply(dataset);
+      auto probabilities = expert->apply(dataset);
+      ASSERT_EQ(flatProbabilities.size(), probabilities.size());
+      for (unsigned int i = 0; i < nSamples; ++i) {
+        EXPECT_EQ(flatProbabilities[i], probabilities[i]) << name << " sample " << i;
+      }
+    }
+  }
+
+  TEST(FastBDTTest, FlatForestRejectsInvalidClassifiers)
+  {
+    auto weightfile = MVA::Weightfile::loadFromFile(FileSystem::findFile("mva/methods/tests/FastBDTv5.xml"));
+    const std::string filename = weightfile.generateFileName();
+    weightfile.getFile("FastBDT_Weightfile", filename);
+    std::ifstream file(filename);
+    const std::string classifier((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    MVA::FastBDTFlatForest forest;
+    std::istringstream valid(classifier);
+    EXPECT_TRUE(forest.readClassifier(valid));
+
+    // a truncated classifier or one with an unreadable value is not flattened, so FastBDT is used instead
+    for (size_t length : {size_t(0), classifier.size() / 10, classifier.size() / 2, classifier.size() * 9 / 10}) {
+      std::istringstream truncated(classifier.substr(0, length));
+      EXPECT_FALSE(forest.readClassifier(truncated)) << "truncated to " << length << " characters";
+    }
+    std::string corrupt = classifier;
+    corrupt.replace(corrupt.find("0.1"), 3, "abc");
+    std::istringstream corruptStream(corrupt);
+    EXPECT_FALSE(forest.readClassifier(corruptStream));
+  }
+
+  TEST(FastBDTTest, FlatForestStopsAtInvalidCutsAndMissingValues)
+  {
+    // tree of depth 2 whose second cut was not applied, the boost weight of each node is its number plus 10
+    const std::string tree = "3\n0 1.0 1 0.5\n1 2.0 0 0\n1 3.0 1 0.5\n"
+                             "7 10 11 12 13 14 15 16\n7 0.5 0.5 0.5 0.5 0.5 0.5 0.5\n7 1 1 1 1 1 1 1\n";
+    // tree of depth 1
+    const std::string smallTree = "1\n1 0.5 1 0.5\n3 100 200 300\n3 0.5 0.5 0.5\n3 1 1 1\n";
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    const std::vector<std::vector<float>> samples = {{0, 5}, {5, 4}, {5, 1}, {nan, 1}, {5, nan}, {0, nan}};
+    const std::vector<float> expected = {11, 16, 15, 10, 12, 11};
+    const std::vector<float> smallExpected = {300, 300, 300, 300, 100, 100};
+
+    // with F0 = 0, shrinkage = 1 and without the transformation to a probability the result is the sum of the boost weights
+    for (bool mixedDepths : {false, true}) {
+      std::istringstream stream("0\n1\n0\n" + std::string(mixedDepths ? "2\n" + tree + smallTree : "1\n" + tree));
+      MVA::FastBDTFlatForest forest;
+      ASSERT_TRUE(forest.readForest(stream));
+      EXPECT_EQ(forest.getNumberOfFeatures(), 2);
+      EXPECT_EQ(forest.getCutValues(1), mixedDepths ? std::vector<float>({0.5, 3.0}) : std::vector<float>({3.0}));
+
+      // more samples than fit into one block
+      const unsigned int nSamples = 3 * MVA::FastBDTFlatForest::c_blockSize + 1;
+      std::vector<float> values;
+      for (unsigned int i = 0; i < nSamples; ++i)
+        values.insert(values.end(), samples[i % samples.size()].begin(), samples[i % samples.size()].end());
+      std::vector<float> results(nSamples);
+      forest.analyse(values.data(), nSamples, 2, results.data());
+      for (unsigned int i = 0; i < nSamples; ++i) {
+        const unsigned int iSample = i % samples.size();
+        const float result = expected[iSample] + (mixedDepths ? smallExpected[iSample] : 0);
+        EXPECT_EQ(results[i], result) << "sample " << i;
+        EXPECT_EQ(forest.analyse(samples[iSample].data()), result) << "sample " << i;
+      }
+    }
+  }
+
 }
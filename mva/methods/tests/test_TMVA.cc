@@ -268,4 +268,46 @@ namespace {
     EXPECT_NEAR(probabilities[5], 1.4245844629813542e-13, 0.0001);
   }
 
+  TEST(TMVATest, BatchedApplication)
+  {
+    MVA::Interface<MVA::TMVAOptionsClassification, MVA::TMVATeacherClassification, MVA::TMVAExpertClassification>
+    interface;
+
+    MVA::GeneralOptions general_options;
+    general_options.m_variables = {"M", "p", "pt"};
+    const std::vector<std::vector<float>> candidates = {{1.835127, 1.179507, 1.164944},
+      {1.873689, 1.881940, 1.843310},
+      {1.863657, 1.774831, 1.753773},
+      {1.858293, 1.605311, 0.631336},
+      {1.837129, 1.575739, 1.490166},
+      {1.811395, 1.524029, 0.565220}
+    };
+
+    auto expert = interface.getExpert();
+    auto weightfile = MVA::Weightfile::loadFromFile(FileSystem::findFile("mva/methods/tests/TMVA.xml"));
+    expert->load(weightfile);
+
+    // compare applying the expert to each candidate on its own with applying it once to all candidates of an event,
+    // the batch is refilled with a different number of candidates for each event
+    MVA::SingleDataset single(general_options, {0.0, 0.0, 0.0}, 0.0);
+    MVA::BatchDataset batch(general_options);
+    for (unsigned int nCandidates : {10u, 1u, 100u}) {
+      std::vector<float> singleResults;
+      for (unsigned int i = 0; i < nCandidates; ++i) {
+        single.m_input = candidates[i % candidates.size()];
+        singleResults.push_back(expert->apply(single)[0]);
+      }
+
+      batch.clear();
+      for (unsigned int i = 0; i < nCandidates; ++i) {
+        std::copy(candidates[i % candidates.size()].begin(), candidates[i % candidates.size()].end(), batch.addEvent());
+      }
+      auto batchResults = expert->apply(batch);
+      ASSERT_EQ(singleResults.size(), batchResults.size());
+      for (unsigned int i = 0; i < singleResults.size(); ++i) {
+        EXPECT_FLOAT_EQ(singleResults[i], batchResults[i]);
+      }
+    }
+  }
+
 }
@@ -62,14 +62,14 @@ namespace Belle2 {
 
   private:
     /**
-     * Calculates expert output for given Particle pointer
+     * Calculates expert output for all candidates in the dataset at once
      */
-    float analyse(const Particle*);
+    std::vector<float> analyse();
 
     /**
-     * Calculates expert output for given Particle pointer
+     * Calculates expert output for all candidates in the dataset at once
      */
-    std::vector<float> analyseMulticlass(const Particle*);
+    std::vector<std::vector<float>> analyseMulticlass();
 
     /**
      * Initialize mva expert, dataset and features
@@ -78,10 +78,15 @@ namespace Belle2 {
     void init_mva(MVA::Weightfile& weightfile);
 
     /**
-     * Evaluate the variables and fill the Dataset to be used by the expert.
+     * Evaluate the variables and add them as a new event to the Dataset to be used by the expert.
      */
     void fillDataset(const Particle*);
 
+    /**
+     * Apply the expert to all collected candidates and store the output in their extra info.
+     */
+    void applyToCandidates();
+
     /**
      * Set the extra info field.
      */
@@ -113,7 +118,8 @@ namespace Belle2 {
     std::unique_ptr<DBObjPtr<DatabaseRepresentationOfWeightfile>>
                                                                m_weightfile_representation; /**< Database pointer to the Database representation of the weightfile */
     std::unique_ptr<MVA::Expert> m_expert; /**< Pointer to the current MVA Expert */
-    std::unique_ptr<MVA::SingleDataset> m_dataset; /**< Pointer to the current dataset */
+    std::unique_ptr<MVA::BatchDataset> m_dataset; /**< Pointer to the current dataset, holding the features of all candidates of the event */
+    std::vector<const Particle*> m_candidates; /**< Candidates of the current event in the order of the dataset */
 
     int m_overwriteExistingExtraInfo; /**< -1/0/1/2: overwrite if lower/ don't overwrite / overwrite if higher/ always overwrite, in case the given extraInfo is already defined. */
     bool m_existGivenExtraInfo; /**< check if the given extraInfo is already defined. */
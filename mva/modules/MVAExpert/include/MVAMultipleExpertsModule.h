@@ -60,9 +60,10 @@ namespace Belle2 {
 
   private:
     /**
-     * Calculates expert output for given Particle pointer
+     * Applies the expert with the given index to all collected candidates at once
+     * and stores its output in their extra info.
      */
-    std::vector<std::vector<float>> analyse(Particle*);
+    void applyExpert(unsigned int i);
 
     /**
      * Initialize mva expert, dataset and features
@@ -71,7 +72,7 @@ namespace Belle2 {
     void init_mva(MVA::Weightfile& weightfile, unsigned int i);
 
     /**
-     * Evaluate the variables and fill the Datasets to be used by the experts.
+     * Evaluate the variables and add them as a new event to the Datasets to be used by the experts.
      */
     void fillDatasets(Particle*);
 
@@ -106,7 +107,10 @@ namespace Belle2 {
 
     std::vector<std::unique_ptr<MVA::Expert>> m_experts; /**< Vector of pointers to the current MVA Experts */
 
-    std::vector<std::unique_ptr<MVA::SingleDataset>> m_datasets; /**< Vector of pointers to the current input datasets */
+    std::vector<std::unique_ptr<MVA::BatchDataset>>
+    m_datasets; /**< Vector of pointers to the current input datasets, holding the features of all candidates of the event */
+
+    std::vector<Particle*> m_candidates; /**< Candidates of the current event in the order of the datasets */
 
     std::vector<int>
     m_overwriteExistingExtraInfo; /**< vector of -1/0/1/2: overwrite if lower/ don't overwrite / overwrite if higher/ always overwrite, in case the given extraInfo for the corresponding method is already defined. */
@@ -118,44 +118,41 @@ void MVAExpertModule::init_mva(MVA::Weightfile& weightfile)
     B2FATAL("One or more feature variables could not be loaded via the Variable::Manager. Check the names!");
   }
 
-  std::vector<float> dummy;
-  dummy.resize(m_feature_variables.size(), 0);
-  m_dataset = std::make_unique<MVA::SingleDataset>(general_options, dummy, 0);
+  m_dataset = std::make_unique<MVA::BatchDataset>(general_options);
   m_nClasses = general_options.m_nClasses;
 }
 
 void MVAExpertModule::fillDataset(const Particle* particle)
 {
+  float* input = m_dataset->addEvent();
   for (unsigned int i = 0; i < m_feature_variables.size(); ++i) {
     auto var_result = m_feature_variables[i]->function(particle);
     if (std::holds_alternative<double>(var_result)) {
-      m_dataset->m_input[i] = std::get<double>(var_result);
+      input[i] = std::get<double>(var_result);
     } else if (std::holds_alternative<int>(var_result)) {
-      m_dataset->m_input[i] = std::get<int>(var_result);
+      input[i] = std::get<int>(var_result);
     } else if (std::holds_alternative<bool>(var_result)) {
-      m_dataset->m_input[i] = std::get<bool>(var_result);
+      input[i] = std::get<bool>(var_result);
     }
   }
 }
 
-float MVAExpertModule::analyse(const Particle* particle)
+std::vector<float> MVAExpertModule::analyse()
 {
   if (not m_expert) {
     B2ERROR("MVA Expert is not loaded! I will return 0");
-    return 0.0;
+    return std::vector<float>(m_candidates.size(), 0.0);
   }
-  fillDataset(particle);
-  return m_expert->apply(*m_dataset)[0];
+  return m_expert->apply(*m_dataset);
 }
 
-std::vector<float> MVAExpertModule::analyseMulticlass(const Particle* particle)
+std::vector<std::vector<float>> MVAExpertModule::analyseMulticlass()
 {
   if (not m_expert) {
     B2ERROR("MVA Expert is not loaded! I will return 0");
-    return std::vector<float>(m_nClasses, 0.0);
+    return std::vector<std::vector<float>>(m_candidates.size(), std::vector<float>(m_nClasses, 0.0));
   }
-  fillDataset(particle);
-  return m_expert->applyMulticlass(*m_dataset)[0];
+  return m_expert->applyMulticlass(*m_dataset);
 }
 
 void MVAExpertModule::setExtraInfoField(Particle* particle, std::string extraInfoName, float responseValue)
@@ -205,52 +202,77 @@ void MVAExpertModule::setEventExtraInfoField(StoreObjPtr<EventExtraInfo> eventEx
 
 void MVAExpertModule::event()
 {
+  // Collect the features of all candidates first so that the expert is applied only once per event
+  m_candidates.clear();
+  if (m_dataset) m_dataset->clear();
   for (auto& listName : m_targetListNames) {
     StoreObjPtr<ParticleList> list(listName);
-    // Calculate target Value for Particles
+    DecayDescriptor& dd = m_decaydescriptors[listName];
+    const bool selectDaughter = dd.getSelectionNames().size() > 0;
     for (unsigned i = 0; i < list->getListSize(); ++i) {
-      auto dd = m_decaydescriptors[listName];
-      unsigned int nSelectedDaughters = dd.getSelectionNames().size();
-      const Particle* particle = (nSelectedDaughters > 0) ? dd.getSelectionParticles(list->getParticle(i))[0] : list->getParticle(i);
-      if (m_nClasses == 2) {
-        float responseValue = analyse(particle);
-        setExtraInfoField(m_particles[particle->getArrayIndex()], m_extraInfoName, responseValue);
-      } else if (m_nClasses > 2) {
-        std::vector<float> responseValues = analyseMulticlass(particle);
-        if (responseValues.size() != m_nClasses) {
-          B2ERROR("Size of results returned by MVA Expert applyMulticlass (" << responseValues.size() <<
-                  ") does not match the declared number of classes (" << m_nClasses << ").");
-        }
-        for (unsigned int iClass = 0; iClass < m_nClasses; iClass++) {
-          setExtraInfoField(m_particles[particle->getArrayIndex()], m_extraInfoName + "_" + std::to_string(iClass), responseValues[iClass]);
-        }
-      } else {
-        B2ERROR("Received a value of " << m_nClasses <<
-                " for the number of classes considered by the MVA Expert. This value should be >=2.");
-      }
+      const Particle* particle = selectDaughter ? dd.getSelectionParticles(list->getParticle(i))[0] : list->getParticle(i);
+      m_candidates.push_back(particle);
     }
   }
   if (m_listNames.empty()) {
+    m_candidates.push_back(nullptr);
+  }
+  if (m_candidates.empty()) return;
+
+  if (m_dataset) {
+    m_dataset->reserve(m_candidates.size());
+    for (const Particle* particle : m_candidates) fillDataset(particle);
+  }
+  applyToCandidates();
+}
+
+void MVAExpertModule::applyToCandidates()
+{
+  if (m_nClasses == 2) {
+    const std::vector<float> responseValues = analyse();
+    if (responseValues.size() != m_candidates.size()) {
+      B2ERROR("Size of results returned by MVA Expert apply (" << responseValues.size() <<
+              ") does not match the number of candidates (" << m_candidates.size() << ").");
+      return;
+    }
+    if (m_listNames.empty()) {
+      StoreObjPtr<EventExtraInfo> eventExtraInfo;
+      if (not eventExtraInfo.isValid())
+        eventExtraInfo.create();
+      setEventExtraInfoField(eventExtraInfo, m_extraInfoName, responseValues[0]);
+      return;
+    }
+    for (unsigned int iCandidate = 0; iCandidate < m_candidates.size(); ++iCandidate) {
+      setExtraInfoField(m_particles[m_candidates[iCandidate]->getArrayIndex()], m_extraInfoName, responseValues[iCandidate]);
+    }
+  } else if (m_nClasses > 2) {
+    const std::vector<std::vector<float>> responseValues = analyseMulticlass();
+    if (responseValues.size() != m_candidates.size()) {
+      B2ERROR("Size of results returned by MVA Expert applyMulticlass (" << responseValues.size() <<
+              ") does not match the number of candidates (" << m_candidates.size() << ").");
+      return;
+    }
     StoreObjPtr<EventExtraInfo> eventExtraInfo;
-    if (not eventExtraInfo.isValid())
+    if (m_listNames.empty() and not eventExtraInfo.isValid())
       eventExtraInfo.create();
-
-    if (m_nClasses == 2) {
-      float responseValue = analyse(nullptr);
-      setEventExtraInfoField(eventExtraInfo, m_extraInfoName, responseValue);
-    } else if (m_nClasses > 2) {
-      std::vector<float> responseValues = analyseMulticlass(nullptr);
-      if (responseValues.size() != m_nClasses) {
-        B2ERROR("Size of results returned by MVA Expert applyMulticlass (" << responseValues.size() <<
+    for (unsigned int iCandidate = 0; iCandidate < m_candidates.size(); ++iCandidate) {
+      const std::vector<float>& candidateValues = responseValues[iCandidate];
+      if (candidateValues.size() != m_nClasses) {
+        B2ERROR("Size of results returned by MVA Expert applyMulticlass (" << candidateValues.size() <<
                 ") does not match the declared number of classes (" << m_nClasses << ").");
       }
-      for (unsigned int iClass = 0; iClass < m_nClasses; iClass++) {
-        setEventExtraInfoField(eventExtraInfo, m_extraInfoName + "_" + std::to_string(iClass), responseValues[iClass]);
+      for (unsigned int iClass = 0; iClass < m_nClasses and iClass < candidateValues.size(); iClass++) {
+        const std::string extraInfoName = m_extraInfoName + "_" + std::to_string(iClass);
+        if (m_listNames.empty()) {
+          setEventExtraInfoField(eventExtraInfo, extraInfoName, candidateValues[iClass]);
+        } else {
+          setExtraInfoField(m_particles[m_candidates[iCandidate]->getArrayIndex()], extraInfoName, candidateValues[iClass]);
+        }
       }
-    } else {
-      B2ERROR("Received a value of " << m_nClasses <<
-              " for the number of classes considered by the MVA Expert. This value should be >=2.");
     }
+  } else {
+    B2ERROR("Received a value of " << m_nClasses <<
+            " for the number of classes considered by the MVA Expert. This value should be >=2.");
   }
 }
 
@@ -132,9 +132,7 @@ void MVAMultipleExpertsModule::init_mva(MVA::Weightfile& weightfile, unsigned in
     }
   }
 
-  std::vector<float> dummy;
-  dummy.resize(m_individual_feature_variables[i].size(), 0);
-  m_datasets[i] = std::make_unique<MVA::SingleDataset>(general_options, dummy, 0);
+  m_datasets[i] = std::make_unique<MVA::BatchDataset>(general_options);
 
   m_nClasses[i] = general_options.m_nClasses;
 
@@ -153,28 +151,58 @@ void MVAMultipleExpertsModule::fillDatasets(Particle* particle)
   }
 
   for (unsigned int i = 0; i < m_identifiers.size(); ++i) {
+    float* input = m_datasets[i]->addEvent();
     for (unsigned int j = 0; j < m_individual_feature_variables[i].size(); ++j) {
-      m_datasets[i]->m_input[j] = m_feature_variables[m_individual_feature_variables[i][j]];
+      input[j] = m_feature_variables[m_individual_feature_variables[i][j]];
     }
   }
 }
 
-std::vector<std::vector<float>> MVAMultipleExpertsModule::analyse(Particle* particle)
+void MVAMultipleExpertsModule::applyExpert(unsigned int i)
 {
-  std::vector<std::vector<float>> responseValues;
-  fillDatasets(particle);
-
-  for (unsigned int i = 0; i < m_identifiers.size(); ++i) {
-    if (m_nClasses[i] == 2) {
-      responseValues.push_back({m_experts[i]->apply(*m_datasets[i])[0],});
-    } else if (m_nClasses[i] > 2) {
-      responseValues.push_back(m_experts[i]->applyMulticlass(*m_datasets[i])[0]);
+  // without particle lists the expert is applied once per event and the result is stored in the event extra info
+  StoreObjPtr<EventExtraInfo> eventExtraInfo;
+  if (m_listNames.empty() and not eventExtraInfo.isValid())
+    eventExtraInfo.create();
+  auto setResponse = [&](unsigned int iCandidate, const std::string & extraInfoName, float responseValue) {
+    if (m_listNames.empty()) {
+      setEventExtraInfoField(eventExtraInfo, extraInfoName, responseValue, i);
     } else {
-      B2ERROR("Received a value of " << m_nClasses[i] <<
-              " for the number of classes considered by the MVA Expert. This value should be >=2.");
+      setExtraInfoField(m_candidates[iCandidate], extraInfoName, responseValue, i);
+    }
+  };
+
+  if (m_nClasses[i] == 2) {
+    const std::vector<float> responseValues = m_experts[i]->apply(*m_datasets[i]);
+    if (responseValues.size() != m_candidates.size()) {
+      B2ERROR("Size of results returned by MVA Expert apply (" << responseValues.size() <<
+              ") does not match the number of candidates (" << m_candidates.size() << ").");
+      return;
+    }
+    for (unsigned int iCandidate = 0; iCandidate < m_candidates.size(); ++iCandidate) {
+      setResponse(iCandidate, m_extraInfoNames[i], responseValues[iCandidate]);
+    }
+  } else if (m_nClasses[i] > 2) {
+    const std::vector<std::vector<float>> responseValues = m_experts[i]->applyMulticlass(*m_datasets[i]);
+    if (responseValues.size() != m_candidates.size()) {
+      B2ERROR("Size of results returned by MVA Expert applyMulticlass (" << responseValues.size() <<
+              ") does not match the number of candidates (" << m_candidates.size() << ").");
+      return;
     }
+    for (unsigned int iCandidate = 0; iCandidate < m_candidates.size(); ++iCandidate) {
+      const std::vector<float>& candidateValues = responseValues[iCandidate];
+      if (candidateValues.size() != m_nClasses[i]) {
+        B2ERROR("Size of results returned by MVA Expert applyMulticlass (" << candidateValues.size() <<
+                ") does not match the declared number of classes (" << m_nClasses[i] << ").");
+      }
+      for (unsigned int iClass = 0; iClass < m_nClasses[i] and iClass < candidateValues.size(); iClass++) {
+        setResponse(iCandidate, m_extraInfoNames[i] + "_" + std::to_string(iClass), candidateValues[iClass]);
+      }
+    }
+  } else {
+    B2ERROR("Received a value of " << m_nClasses[i] <<
+            " for the number of classes considered by the MVA Expert. This value should be >=2.");
   }
-  return responseValues;
 }
 
 void MVAMultipleExpertsModule::setExtraInfoField(Particle* particle, std::string extraInfoName, float responseValue, unsigned int i)
@@ -224,52 +252,26 @@ void MVAMultipleExpertsModule::setEventExtraInfoField(StoreObjPtr<EventExtraInfo
 
 void MVAMultipleExpertsModule::event()
 {
+  // Collect the features of all candidates first so that each expert is applied only once per event
+  m_candidates.clear();
   for (auto& listName : m_listNames) {
     StoreObjPtr<ParticleList> list(listName);
-    // Calculate target Value for Particles
     for (unsigned i = 0; i < list->getListSize(); ++i) {
-      Particle* particle = list->getParticle(i);
-      std::vector<std::vector<float>> responseValues = analyse(particle);
-      for (unsigned int j = 0; j < m_identifiers.size(); ++j) {
-        if (m_nClasses[j] == 2) {
-          setExtraInfoField(particle, m_extraInfoNames[j], responseValues[j][0], j);
-        } else if (m_nClasses[j] > 2) {
-          if (responseValues[j].size() != m_nClasses[j]) {
-            B2ERROR("Size of results returned by MVA Expert applyMulticlass (" << responseValues[j].size() <<
-                    ") does not match the declared number of classes (" << m_nClasses[j] << ").");
-          }
-          for (unsigned int iClass = 0; iClass < m_nClasses[j]; iClass++) {
-            setExtraInfoField(particle, m_extraInfoNames[j] + "_" + std::to_string(iClass), responseValues[j][iClass], j);
-          }
-        } else {
-          B2ERROR("Received a value of " << m_nClasses[j] <<
-                  " for the number of classes considered by the MVA Expert. This value should be >=2.");
-        }
-      } //identifiers
+      m_candidates.push_back(list->getParticle(i));
     }
-  } // listnames
+  }
   if (m_listNames.empty()) {
-    StoreObjPtr<EventExtraInfo> eventExtraInfo;
-    if (not eventExtraInfo.isValid())
-      eventExtraInfo.create();
-    std::vector<std::vector<float>> responseValues = analyse(nullptr);
-    for (unsigned int j = 0; j < m_identifiers.size(); ++j) {
-      if (m_nClasses[j] == 2) {
-        setEventExtraInfoField(eventExtraInfo, m_extraInfoNames[j], responseValues[j][0], j);
-      } else if (m_nClasses[j] > 2) {
-        if (responseValues[j].size() != m_nClasses[j]) {
-          B2ERROR("Size of results returned by MVA Expert applyMulticlass (" << responseValues[j].size() <<
-                  ") does not match the declared number of classes (" << m_nClasses[j] << ").");
-        }
-        for (unsigned int iClass = 0; iClass < m_nClasses[j]; iClass++) {
-          setEventExtraInfoField(eventExtraInfo, m_extraInfoNames[j] + "_" + std::to_string(iClass), responseValues[j][iClass], j);
-        }
-      } else {
-        B2ERROR("Received a value of " << m_nClasses[j] <<
-                " for the number of classes considered by the MVA Expert. This value should be >=2.");
-      }
-    } //identifiers
+    m_candidates.push_back(nullptr);
+  }
+  if (m_candidates.empty()) return;
+
+  for (auto& dataset : m_datasets) {
+    dataset->clear();
+    dataset->reserve(m_candidates.size());
   }
+  for (Particle* particle : m_candidates) fillDatasets(particle);
+
+  for (unsigned int i = 0; i < m_identifiers.size(); ++i) applyExpert(i);
 }
 
 void MVAMultipleExpertsModule::terminate()
@@ -0,0 +1,92 @@
+/**************************************************************************
+ * basf2 (Belle II Analysis Software Framework)                           *
+ * Author: The Belle II Collaboration                                     *
+ *                                                                        *
+ * See git log for contributors and copyright holders.                    *
+ * This file is licensed under LGPL-3.0, see LICENSE.md.                  *
+ **************************************************************************/
+
+#include <mva/interface/Interface.h>
+#include <mva/interface/Dataset.h>
+#include <mva/interface/Weightfile.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace Belle2::MVA;
+
+/** Compare applying an expert to each candidate on its own with applying it once to all candidates of an event.
+ *
+ * The features are drawn from a normal distribution, so only the timing and not the output is meaningful.
+ *
+ * Usage: basf2_mva_batched_application weightfile [number of candidates per event]
+ */
+int main(int argc, char* argv[])
+{
+  if (argc < 2) {
+    std::cerr << "Usage: " << argv[0] << " weightfile [number of candidates per event]\n";
+    return 1;
+  }
+  std::vector<unsigned int> candidateNumbers = {1, 10, 100, 1000};
+  if (argc > 2) candidateNumbers = {static_cast<unsigned int>(std::atoi(argv[2]))};
+
+  AbstractInterface::initSupportedInterfaces();
+  auto supported_interfaces = AbstractInterface::getSupportedInterfaces();
+  auto weightfile = Weightfile::load(argv[1]);
+  GeneralOptions general_options;
+  weightfile.getOptions(general_options);
+  if (supported_interfaces.find(general_options.m_method) == supported_interfaces.end()) {
+    std::cerr << "Method " << general_options.m_method << " is not supported\n";
+    return 1;
+  }
+  auto expert = supported_interfaces[general_options.m_method]->getExpert();
+  expert->load(weightfile);
+
+  const unsigned int nFeatures = general_options.m_variables.size();
+  SingleDataset single(general_options, std::vector<float>(nFeatures, 0.0), 0.0);
+  BatchDataset batch(general_options);
+  std::mt19937 generator(42);
+  std::normal_distribution<float> distribution;
+
+  int result = 0;
+  const unsigned int nEvents = 100;
+  for (unsigned int nCandidates : candidateNumbers) {
+    std::vector<float> features(nCandidates * nFeatures);
+    std::chrono::duration<double, std::micro> singleTime{0};
+    std::chrono::duration<double, std::micro> batchTime{0};
+    unsigned int nDifferent = 0;
+    for (unsigned int iEvent = 0; iEvent < nEvents; ++iEvent) {
+      for (float& feature : features) feature = distribution(generator);
+
+      std::vector<float> singleResults;
+      auto start = std::chrono::steady_clock::now();
+      for (unsigned int i = 0; i < nCandidates; ++i) {
+        std::copy_n(features.begin() + i * nFeatures, nFeatures, single.m_input.begin());
+        singleResults.push_back(expert->apply(single)[0]);
+      }
+      singleTime += std::chrono::steady_clock::now() - start;
+
+      start = std::chrono::steady_clock::now();
+      batch.clear();
+      for (unsigned int i = 0; i < nCandidates; ++i) {
+        std::copy_n(features.begin() + i * nFeatures, nFeatures, batch.addEvent());
+      }
+      const std::vector<float> batchResults = expert->apply(batch);
+      batchTime += std::chrono::steady_clock::now() - start;
+
+      for (unsigned int i = 0; i < nCandidates; ++i) {
+        if (batchResults.at(i) != singleResults[i]) nDifferent++;
+      }
+    }
+    if (nDifferent > 0) {
+      std::cerr << nDifferent << " batched results differ from the results one by one\n";
+      result = 1;
+    }
+    std::cout << general_options.m_method << " with " << nCandidates << " candidates: " << singleTime.count() / nEvents <<
+              " us per event one by one, " << batchTime.count() / nEvents << " us per event batched\n";
+  }
+  return result;
+}
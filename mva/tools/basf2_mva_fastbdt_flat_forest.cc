@@ -0,0 +1,165 @@
+/**************************************************************************
+ * basf2 (Belle II Analysis Software Framework)                           *
+ * Author: The Belle II Collaboration                                     *
+ *                                                                        *
+ * See git log for contributors and copyright holders.                    *
+ * This file is licensed under LGPL-3.0, see LICENSE.md.                  *
+ **************************************************************************/
+
+#include <mva/methods/FastBDT.h>
+#include <mva/interface/Dataset.h>
+#include <mva/interface/Weightfile.h>
+
+#include <boost/program_options.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace po = boost::program_options;
+using namespace Belle2::MVA;
+
+namespace {
+  /** Load the FastBDT expert of the weightfile, with or without the flattened forest. */
+  std::unique_ptr<FastBDTExpert> loadExpert(const std::string& identifier, bool flatForest)
+  {
+    auto weightfile = Weightfile::load(identifier);
+    weightfile.addElement("FastBDT_flatForest", flatForest);
+    auto expert = std::make_unique<FastBDTExpert>();
+    expert->load(weightfile);
+    return expert;
+  }
+
+  /** Time of Expert::apply() per sample in ns. */
+  double timeApply(const FastBDTExpert& expert, Dataset& dataset, std::vector<float>& results)
+  {
+    const auto start = std::chrono::steady_clock::now();
+    results = expert.apply(dataset);
+    const std::chrono::duration<double, std::nano> time = std::chrono::steady_clock::now() - start;
+    return time.count() / dataset.getNumberOfEvents();
+  }
+
+  /** Time of Expert::apply() per sample in ns, if it is called for each sample on its own like for a single candidate. */
+  double timeApplyOneByOne(const FastBDTExpert& expert, Dataset& dataset, const GeneralOptions& general_options,
+                           std::vector<float>& results)
+  {
+    SingleDataset single(general_options, std::vector<float>(dataset.getNumberOfFeatures(), 0.0), 0.0);
+    results.clear();
+    std::chrono::duration<double, std::nano> time{0};
+    for (unsigned int iEvent = 0; iEvent < dataset.getNumberOfEvents(); ++iEvent) {
+      dataset.loadEvent(iEvent);
+      single.m_input = dataset.m_input;
+      const auto start = std::chrono::steady_clock::now();
+      results.push_back(expert.apply(single)[0]);
+      time += std::chrono::steady_clock::now() - start;
+    }
+    return time.count() / dataset.getNumberOfEvents();
+  }
+}
+
+/** Compare the flattened forest with FastBDT on FastBDT weightfiles: time per sample and bit-identical results.
+ *
+ * The samples are read from the given datafiles, otherwise each feature is drawn uniformly between the
+ * lowest and highest cut on it, 1% of the values are NaN.
+ * Returns 1 if any result of the flattened forest differs from the one of FastBDT.
+ */
+int main(int argc, char* argv[])
+{
+  std::vector<std::string> identifiers;
+  std::vector<std::string> datafiles;
+  std::string treename = "variables";
+  unsigned int nSamples = 100000;
+
+  po::options_description description("Options");
+  description.add_options()
+  ("help", "print this message")
+  ("identifiers", po::value<std::vector<std::string>>(&identifiers)->multitoken()->required(),
+   "Identifiers of the trained FastBDT methods")
+  ("datafiles", po::value<std::vector<std::string>>(&datafiles)->multitoken(),
+   "ROOT files containing the samples, if not given the samples are generated")
+  ("treename", po::value<std::string>(&treename), "Name of tree in ROOT datafile")
+  ("nSamples", po::value<unsigned int>(&nSamples), "Number of samples, at most the number of samples in the datafiles");
+
+  po::variables_map vm;
+
+  try {
+    po::parsed_options parsed = po::command_line_parser(argc, argv).options(description).run();
+    po::store(parsed, vm);
+
+    if (vm.count("help")) {
+      std::cout << description << std::endl;
+      return 1;
+    }
+    po::notify(vm);
+  } catch (po::error& err) {
+    std::cerr << "Error: " << err.what() << "\n";
+    return 1;
+  }
+
+  int result = 0;
+  for (const std::string& identifier : identifiers) {
+    GeneralOptions general_options;
+    Weightfile::load(identifier).getOptions(general_options);
+    if (general_options.m_method != "FastBDT") {
+      std::cerr << identifier << ": method " << general_options.m_method << " is not FastBDT\n";
+      result = 1;
+      continue;
+    }
+    auto expert = loadExpert(identifier, false);
+    auto flatExpert = loadExpert(identifier, true);
+    if (not flatExpert->isUsingFlatForest()) {
+      std::cerr << identifier << ": the forest cannot be flattened\n";
+      continue;
+    }
+
+    std::unique_ptr<Dataset> dataset;
+    if (datafiles.empty()) {
+      const FastBDTFlatForest& forest = flatExpert->getFlatForest();
+      std::vector<std::vector<float>> cutValues(general_options.m_variables.size());
+      for (unsigned int iFeature = 0; iFeature < forest.getNumberOfFeatures(); ++iFeature)
+        cutValues[iFeature] = forest.getCutValues(iFeature);
+      std::mt19937 generator(42);
+      std::uniform_real_distribution<float> uniform;
+      std::vector<std::vector<float>> samples(nSamples, std::vector<float>(general_options.m_variables.size(), 0.0));
+      for (std::vector<float>& sample : samples) {
+        for (unsigned int iFeature = 0; iFeature < sample.size(); ++iFeature) {
+          const std::vector<float>& values = cutValues[iFeature];
+          if (uniform(generator) < 0.01)
+            sample[iFeature] = std::numeric_limits<float>::quiet_NaN();
+          else if (not values.empty())
+            sample[iFeature] = values.front() + (values.back() - values.front()) * uniform(generator);
+        }
+      }
+      dataset = std::make_unique<MultiDataset>(general_options, samples, std::vector<std::vector<float>>());
+    } else {
+      general_options.m_datafiles = datafiles;
+      general_options.m_treename = treename;
+      general_options.m_max_events = nSamples;
+      dataset = std::make_unique<ROOTDataset>(general_options);
+    }
+
+    std::vector<float> results, flatResults, oneByOneResults, flatOneByOneResults;
+    const double time = timeApply(*expert, *dataset, results);
+    const double flatTime = timeApply(*flatExpert, *dataset, flatResults);
+    const double oneByOneTime = timeApplyOneByOne(*expert, *dataset, general_options, oneByOneResults);
+    const double flatOneByOneTime = timeApplyOneByOne(*flatExpert, *dataset, general_options, flatOneByOneResults);
+
+    unsigned int nDifferent = 0;
+    for (unsigned int i = 0; i < results.size(); ++i) {
+      if (flatResults[i] != results[i] or flatOneByOneResults[i] != results[i] or oneByOneResults[i] != results[i])
+        nDifferent++;
+    }
+    if (nDifferent > 0) {
+      std::cerr << identifier << ": " << nDifferent << " of " << results.size() << " results of the flattened forest differ\n";
+      result = 1;
+    }
+    std::cout << identifier << " (" << results.size() << " samples): FastBDT " << time << " ns, flattened forest " << flatTime <<
+              " ns per sample for all samples at once, FastBDT " << oneByOneTime << " ns, flattened forest " << flatOneByOneTime <<
+              " ns per sample one by one\n";
+  }
+  return result;
+}
@@ -15,7 +15,7 @@
 #include <mdst/dataobjects/EventLevelTrackingInfo.h>
 
 #include <tracking/trackFindingVXD/algorithms/CellularAutomaton.h>
-#include <tracking/trackFindingVXD/algorithms/PathCollectorRecursive.h>
+#include <tracking/trackFindingVXD/algorithms/PathCollectorIterative.h>
 #include <tracking/trackFindingVXD/algorithms/NodeFamilyDefiner.h>
 #include <tracking/trackFindingVXD/algorithms/SPTCSelectorXBestPerFamily.h>
 
@@ -100,12 +100,15 @@ namespace Belle2 {
     /** Maximal number of paths per event; if exceeded, the execution of the trackfinder will be stopped. */
     unsigned int m_PARAMmaxPaths = 400000;
 
+    /** Maximal number of paths stored per seed, only the longest ones are kept; 0 stores all paths. */
+    unsigned int m_PARAMmaxPathsPerSeed = 0;
+
     /// member variables
     /** CA algorithm */
     CellularAutomaton<NodeNetworkType, Belle2::CAValidator<Belle2::CACell>> m_cellularAutomaton;
 
     /** Algorithm for finding paths of segments. */
-    PathCollectorRecursive<NodeNetworkType, NodeType, Path, Belle2::NodeCompatibilityCheckerBase<NodeType>> m_pathCollector;
+    PathCollectorIterative<NodeNetworkType, NodeType, Belle2::NodeCompatibilityCheckerBase<NodeType>> m_pathCollector;
 
     /** Tool for creating SPTCs, which fills storeArray directly. */
     SpacePointTrackCandCreator<StoreArray<Belle2::SpacePointTrackCand>> m_sptcCreator;
@@ -81,6 +81,12 @@ TrackFinderVXDCellOMatModule::TrackFinderVXDCellOMatModule() : Module()
            m_PARAMmaxPaths,
            "Maximal number of paths per an event; if exceeded, the event execution will be skipped.",
            m_PARAMmaxPaths);
+
+  addParam("maxPathsPerSeed",
+           m_PARAMmaxPathsPerSeed,
+           "Maximal number of paths stored per seed, only the longest ones are kept. "
+           "Branches which can not yield a longer path are skipped using the CA state. 0 stores all paths.",
+           m_PARAMmaxPathsPerSeed);
 }
 
 
@@ -94,6 +100,8 @@ void TrackFinderVXDCellOMatModule::initialize()
   }
 
   m_eventLevelTrackingInfo.isRequired(m_PARAMEventLevelTrackingInfoName);
+
+  m_pathCollector.maxPathsPerSeed = m_PARAMmaxPathsPerSeed;
 }
 
 
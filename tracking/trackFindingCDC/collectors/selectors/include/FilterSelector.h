@@ -17,6 +17,7 @@
 #include <algorithm>
 #include <vector>
 #include <string>
+#include <cmath>
 
 namespace Belle2 {
   class ModuleParamList;
@@ -63,9 +64,14 @@ namespace Belle2 {
       /// Main function of the class: calculate the filter result and remove all relations, where the filter returns NaN
       void apply(std::vector<WeightedRelationItem>& weightedRelations) override
       {
+        // Evaluate the filter for all relations at once
+        m_weightedRelationPtrs.clear();
         for (WeightedRelationItem& weightedRelation : weightedRelations) {
-          const Weight weight = m_filter(weightedRelation);
-          weightedRelation.setWeight(weight);
+          m_weightedRelationPtrs.push_back(&weightedRelation);
+        }
+        const std::vector<float> weights = m_filter(m_weightedRelationPtrs);
+        for (size_t iRelation = 0; iRelation < weightedRelations.size(); ++iRelation) {
+          weightedRelations[iRelation].setWeight(weights[iRelation]);
         }
 
         const auto& weightIsNan = [](const WeightedRelationItem & item) {
@@ -81,6 +87,9 @@ namespace Belle2 {
     private:
       /// The filter to use.
       AFilter m_filter;
+
+      /// Memory for the pointers to the relations given to the filter.
+      std::vector<WeightedRelationItem*> m_weightedRelationPtrs;
     };
   }
 }
@@ -0,0 +1,75 @@
+/**************************************************************************
+ * basf2 (Belle II Analysis Software Framework)                           *
+ * Author: The Belle II Collaboration                                     *
+ *                                                                        *
+ * See git log for contributors and copyright holders.                    *
+ * This file is licensed under LGPL-3.0, see LICENSE.md.                  *
+ **************************************************************************/
+
+#include <tracking/trackFindingCDC/collectors/selectors/FilterSelector.h>
+
+#include <tracking/trackFindingCDC/filters/base/Filter.icc.h>
+
+#include <gtest/gtest.h>
+
+using namespace Belle2;
+using namespace TrackFindingCDC;
+
+namespace {
+  /// Filter accepting relations to values below 4 with the value as weight, counting the batches it is given
+  class BatchCountingFilter : public Filter<WeightedRelation<int, const double>> {
+  public:
+    /// Accept relations to values below 4
+    Weight operator()(const WeightedRelation<int, const double>& relation) override
+    {
+      const double to = *relation.getTo();
+      return to < 4 ? to : NAN;
+    }
+
+    /// Count the batches and evaluate them one by one
+    std::vector<float> operator()(const std::vector<WeightedRelation<int, const double>*>& relations) override
+    {
+      ++s_nBatches;
+      s_nRelations += relations.size();
+      return Filter<WeightedRelation<int, const double>>::operator()(relations);
+    }
+
+    /// Number of batches given to all filters
+    static int s_nBatches;
+
+    /// Number of relations given to all filters
+    static int s_nRelations;
+  };
+
+  int BatchCountingFilter::s_nBatches = 0;
+  int BatchCountingFilter::s_nRelations = 0;
+
+  /// Test that the FilterSelector gives all relations to the filter at once
+  TEST(TrackFindingCDCTest, filter_selector_batch)
+  {
+    FilterSelector<int, double, BatchCountingFilter> selector;
+
+    int a = 1;
+    double b = 2, c = 3, d = 4, e = 5;
+
+    std::vector<WeightedRelation<int, const double>> relations = {
+      WeightedRelation<int, const double>(&a, 0, &b),
+      WeightedRelation<int, const double>(&a, 0, &c),
+      WeightedRelation<int, const double>(&a, 0, &d),
+      WeightedRelation<int, const double>(&a, 0, &e)
+    };
+
+    BatchCountingFilter::s_nBatches = 0;
+    BatchCountingFilter::s_nRelations = 0;
+    selector.apply(relations);
+
+    ASSERT_EQ(BatchCountingFilter::s_nBatches, 1);
+    ASSERT_EQ(BatchCountingFilter::s_nRelations, 4);
+
+    ASSERT_EQ(relations.size(), 2);
+    ASSERT_EQ(relations[0].getWeight(), 3);
+    ASSERT_EQ(relations[0].getTo(), &c);
+    ASSERT_EQ(relations[1].getWeight(), 2);
+    ASSERT_EQ(relations[1].getTo(), &b);
+  }
+}
@@ -19,14 +19,5 @@ MVARealisticAxialSegmentPairFilter::MVARealisticAxialSegmentPairFilter()
           "trackfindingcdc_RealisticAxialSegmentPairFilterParameters")
 {
   this->addProcessingSignalListener(&m_feasibleAxialSegmentPairFilter);
-}
-
-Weight MVARealisticAxialSegmentPairFilter::operator()(const CDCAxialSegmentPair& axialSegmentPair)
-{
-  double isFeasibleWeight = m_feasibleAxialSegmentPairFilter(axialSegmentPair);
-  if (std::isnan(isFeasibleWeight)) {
-    return NAN;
-  } else {
-    return Super::operator()(axialSegmentPair);
-  }
+  this->setFeasibilityFilter(&m_feasibleAxialSegmentPairFilter);
 }
@@ -55,6 +55,9 @@ namespace Belle2 {
       /// Indicates if the filter requires Monte Carlo information.
       bool needsTruthInformation() override;
 
+      /// Indicates if the chosen filter evaluates a vector of objects faster than each object on its own.
+      bool hasBatchEvaluation() override;
+
       /**
        *  Function to evaluate the object.
        *  Delegates to the filter chosen by module parameters.
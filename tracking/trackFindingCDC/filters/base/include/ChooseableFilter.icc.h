@@ -86,6 +86,12 @@ namespace Belle2 {
       return m_filter->needsTruthInformation();
     }
 
+    template <class AFilter>
+    bool Chooseable<AFilter>::hasBatchEvaluation()
+    {
+      return m_filter->hasBatchEvaluation();
+    }
+
     template <class AFilter>
     Weight Chooseable<AFilter>::operator()(const Object& object)
     {
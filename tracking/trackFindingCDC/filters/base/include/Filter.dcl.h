@@ -43,6 +43,9 @@ namespace Belle2 {
       /// Indicates if the filter requires Monte Carlo information.
       virtual bool needsTruthInformation();
 
+      /// Indicates if the filter evaluates a vector of objects faster than each object on its own.
+      virtual bool hasBatchEvaluation();
+
     public:
       /**
        *  Function to evaluate the object.
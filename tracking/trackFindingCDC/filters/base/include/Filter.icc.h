@@ -33,6 +33,12 @@ namespace Belle2 {
       return false;
     }
 
+    template <class AObject>
+    bool Filter<AObject>::hasBatchEvaluation()
+    {
+      return false;
+    }
+
     template <class AObject>
     Weight Filter<AObject>::operator()(const Object& obj __attribute__((unused)))
     {
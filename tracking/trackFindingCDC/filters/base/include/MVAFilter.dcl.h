@@ -19,6 +19,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 #include <cmath>
 
 namespace Belle2 {
@@ -69,11 +70,38 @@ namespace Belle2 {
       /// Evaluate the mva method
       virtual double predict(const Object& obj);
 
-      /// Evaluate the MVA method over several inputs simultaneously
+      /**
+       *  Evaluate the MVA method over several inputs simultaneously.
+       *  The features of all objects are collected in one contiguous matrix and the expert is called once.
+       *  Objects given as nullptr or for which the variables cannot be extracted get a NAN prediction.
+       */
       std::vector<float> predict(const std::vector<Object*>& objs);
 
       /// Evaluate the MVA method over a vector of objects
       virtual std::vector<float> operator()(const std::vector <Object*>& objs) override;
+
+      /// The expert is called once for a vector of objects.
+      bool hasBatchEvaluation() override
+      {
+        return true;
+      }
+
+    protected:
+      /**
+       *  Set a filter that has to accept an object before the mva method is evaluated for it.
+       *  The filter is not owned and also has to be registered as a processing signal listener by the caller.
+       */
+      void setFeasibilityFilter(AFilter* feasibilityFilter)
+      {
+        m_feasibilityFilter = feasibilityFilter;
+      }
+
+      /// Transform the output of the mva method to the weight of the object, the cut is applied afterwards.
+      virtual double transformPrediction(double prediction) const
+      {
+        return prediction;
+      }
+
     private:
       /// Database identifier of the expert or weight file name
       std::string m_identifier = "";
@@ -89,6 +117,18 @@ namespace Belle2 {
 
       /// named variables, ordered as in the weightFile:
       std::vector<Named<Float_t*>> m_namedVariables;
+
+      /// Optional filter applied before the mva method, not owned
+      AFilter* m_feasibilityFilter = nullptr;
+
+      /// Objects passing the feasibility filter of the current batch, rejected ones are nullptr
+      std::vector<Object*> m_feasibleObjs;
+
+      /// Feature matrix of the current batch, one row per extracted object
+      std::vector<float> m_features;
+
+      /// Position in the batch of each row in the feature matrix
+      std::vector<size_t> m_rows;
     };
 
     /// Convenience template to create a mva filter for a set of variables.
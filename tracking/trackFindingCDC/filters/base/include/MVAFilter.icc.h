@@ -109,6 +109,9 @@ namespace Belle2 {
     template <class AFilter>
     Weight MVA<AFilter>::operator()(const Object& obj)
     {
+      if (m_feasibilityFilter and std::isnan((*m_feasibilityFilter)(obj))) {
+        return NAN;
+      }
       double prediction = predict(obj);
       return prediction < m_cutValue ? NAN : prediction;
     }
@@ -120,32 +123,52 @@ namespace Belle2 {
       if (std::isnan(extracted)) {
         return NAN;
       } else {
-        return m_mvaExpert->predict();
+        return transformPrediction(m_mvaExpert->predict());
       }
     }
 
     template <class AFilter>
     std::vector<float> MVA<AFilter>::predict(const std::vector<Object*>& objs)
     {
-      const int nFeature = m_namedVariables.size();
-      const int nRows    = objs.size();
-      auto allFeatures = std::unique_ptr<float[]>(new float[nRows * nFeature]);
-      size_t iRow = 0;
-      for (const auto& obj : objs) {
-        if (Super::getVarSet().extract(obj)) {
-          for (int iFeature = 0; iFeature < nFeature; iFeature += 1) {
-            allFeatures[nFeature * iRow + iFeature] = *m_namedVariables[iFeature];
-          }
-          iRow += 1;
+      const size_t nFeature = m_namedVariables.size();
+      std::vector<float> out(objs.size(), NAN);
+
+      // Collect the features of all objects that can be extracted row by row
+      m_features.clear();
+      m_rows.clear();
+      for (size_t iObj = 0; iObj < objs.size(); ++iObj) {
+        const Object* obj = objs[iObj];
+        if (not obj or std::isnan(Super::operator()(*obj))) continue;
+        for (size_t iFeature = 0; iFeature < nFeature; ++iFeature) {
+          m_features.push_back(*m_namedVariables[iFeature]);
         }
+        m_rows.push_back(iObj);
+      }
+      if (m_rows.empty()) return out;
+
+      // Evaluate all rows at once and put the predictions back at the position of their object
+      const std::vector<float> predictions = m_mvaExpert->predict(m_features.data(), nFeature, m_rows.size());
+      for (size_t iRow = 0; iRow < m_rows.size(); ++iRow) {
+        out[m_rows[iRow]] = transformPrediction(predictions[iRow]);
       }
-      return m_mvaExpert->predict(allFeatures.get(), nFeature, nRows);
+      return out;
     }
 
     template <class AFilter>
     std::vector<float> MVA<AFilter>::operator()(const std::vector<Object*>& objs)
     {
-      auto out = predict(objs);
+      std::vector<float> out;
+      if (m_feasibilityFilter) {
+        // Only evaluate the objects accepted by the feasibility filter
+        const std::vector<float> feasibleWeights = (*m_feasibilityFilter)(objs);
+        m_feasibleObjs.assign(objs.begin(), objs.end());
+        for (size_t iObj = 0; iObj < objs.size(); ++iObj) {
+          if (std::isnan(feasibleWeights[iObj])) m_feasibleObjs[iObj] = nullptr;
+        }
+        out = predict(m_feasibleObjs);
+      } else {
+        out = predict(objs);
+      }
       for (auto& res : out) {
         res = res < m_cutValue ? NAN : res;
       }
@@ -24,6 +24,7 @@
 #include <vector>
 #include <limits>
 #include <algorithm>
+#include <cmath>
 
 namespace Belle2 {
   namespace TrackFindingCDC {
@@ -98,6 +99,63 @@ namespace Belle2 {
       }
       /* *@}*/
 
+      /**
+       *  Appends relations between elements in the given AItems using the ARelationFilter.
+       *  In contrast to appendUsing the possible relations of several froms are collected first
+       *  and handed to the filter in batches, such that mva based filters can evaluate all of them
+       *  with a single call to their expert.
+       */
+      template <class AObject, class ARelationFilter>
+      static void appendUsingBatched(ARelationFilter& relationFilter,
+                                     const std::vector<AObject*>& froms,
+                                     const std::vector<AObject*>& tos,
+                                     std::vector<WeightedRelation<AObject>>& weightedRelations)
+      {
+        // Minimal number of relations handed to the filter at once, limits the memory of the feature matrix
+        const std::size_t minBatchSize = 1024;
+
+        std::vector<Relation<AObject>> relations;
+        std::vector<Relation<AObject>*> relationPtrs;
+        relations.reserve(minBatchSize);
+        relationPtrs.reserve(minBatchSize);
+
+        auto evaluateBatch = [&relationFilter, &relations, &relationPtrs, &weightedRelations]() {
+          relationPtrs.clear();
+          for (Relation<AObject>& relation : relations) {
+            relationPtrs.push_back(&relation);
+          }
+          const std::vector<float> weights = relationFilter(relationPtrs);
+          for (std::size_t iRelation = 0; iRelation < relations.size(); ++iRelation) {
+            const Weight weight = weights[iRelation];
+            if (std::isnan(weight)) continue;
+            weightedRelations.emplace_back(relations[iRelation].getFrom(), weight, relations[iRelation].getTo());
+          }
+          relations.clear();
+        };
+
+        for (AObject* from : froms) {
+          std::vector<AObject*> possibleTos = relationFilter.getPossibleTos(from, tos);
+          for (AObject* to : possibleTos) {
+            if (from == to) continue;
+            relations.emplace_back(from, to);
+          }
+          if (relations.size() >= minBatchSize) evaluateBatch();
+        }
+        if (not relations.empty()) evaluateBatch();
+
+        // sort everything afterwards
+        std::sort(std::begin(weightedRelations), std::end(weightedRelations));
+      }
+
+      /// Shortcut for applying appendUsingBatched with froms=tos
+      template <class AObject, class ARelationFilter>
+      static void appendUsingBatched(ARelationFilter& relationFilter,
+                                     const std::vector<AObject*>& objects,
+                                     std::vector<WeightedRelation<AObject>>& weightedRelations)
+      {
+        appendUsingBatched(relationFilter, objects, objects, weightedRelations);
+      };
+
       /// Shortcut for applying appendUsing with froms=tos
       template <class AObject, class ARelationFilter>
       static void appendUsing(ARelationFilter& relationFilter,
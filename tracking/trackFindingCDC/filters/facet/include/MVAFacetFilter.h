@@ -37,11 +37,12 @@ namespace Belle2 {
       /// Constructor initialising the MVAFilter with standard training name for this filter.
       MVAFacetFilter();
 
+    protected:
       /**
-       *  Main filter method returning the weight of the facet.
+       *  Transform the mva output to the weight of the facet.
        *  The size of the facet with a small penalty depending on the mva probability.
        */
-      Weight predict(const CDCFacet& facet) final;
+      double transformPrediction(double prediction) const final;
     };
   }
 }
@@ -23,7 +23,7 @@ MVAFacetFilter::MVAFacetFilter()
 {
 }
 
-Weight MVAFacetFilter::predict(const CDCFacet& facet)
+double MVAFacetFilter::transformPrediction(double prediction) const
 {
-  return 3 - 0.2 * (1 - Super::predict(facet));
+  return 3 - 0.2 * (1 - prediction);
 }
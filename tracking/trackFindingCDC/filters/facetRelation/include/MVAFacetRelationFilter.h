@@ -33,11 +33,12 @@ namespace Belle2 {
       /// Constructor initialising the MVAFilter with standard training name for this filter.
       MVAFacetRelationFilter();
 
+    protected:
       /**
-       *  Main filter method returning the weight of the facet relation.
+       *  Transform the mva output to the weight of the facet relation.
        *  The size of the facetRelation with a small penalty depending on the mva probability.
        */
-      Weight predict(const Relation<const CDCFacet>& facetRelation) final;
+      double transformPrediction(double prediction) const final;
     };
   }
 }
@@ -20,7 +20,7 @@ MVAFacetRelationFilter::MVAFacetRelationFilter()
 {
 }
 
-Weight MVAFacetRelationFilter::predict(const Relation<const CDCFacet>& facetRelation)
+double MVAFacetRelationFilter::transformPrediction(double prediction) const
 {
-  return -2 - 0.2 * (1 - Super::predict(facetRelation));
+  return -2 - 0.2 * (1 - prediction);
 }
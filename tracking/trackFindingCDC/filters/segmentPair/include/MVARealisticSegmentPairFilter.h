@@ -36,9 +36,6 @@ namespace Belle2 {
       /// Constructor initialising the MVAFilter with standard training name for this filter.
       MVARealisticSegmentPairFilter();
 
-      /// Function to object for its signalness
-      Weight operator()(const CDCSegmentPair& segmentPair) final;
-
     private:
       /// Feasibility filter applied first before invoking the main cut
       MVAFeasibleSegmentPairFilter m_feasibleSegmentPairFilter;
@@ -19,14 +19,5 @@ MVARealisticSegmentPairFilter::MVARealisticSegmentPairFilter()
   : Super("trackfindingcdc_RealisticSegmentPairFilter", 0.02, "trackfindingcdc_RealisticSegmentPairFilterParameters")
 {
   this->addProcessingSignalListener(&m_feasibleSegmentPairFilter);
-}
-
-Weight MVARealisticSegmentPairFilter::operator()(const CDCSegmentPair& segmentPair)
-{
-  double isFeasibleWeight = m_feasibleSegmentPairFilter(segmentPair);
-  if (std::isnan(isFeasibleWeight)) {
-    return NAN;
-  } else {
-    return Super::operator()(segmentPair);
-  }
+  this->setFeasibilityFilter(&m_feasibleSegmentPairFilter);
 }
@@ -41,10 +41,6 @@ namespace Belle2 {
       /// Tell Root to look at this operator
       using Super::operator();
 
-    private:
-      /// Function to object for its signalness
-      Weight operator()(const Relation<const CDCSegment2D>& segmentRelation) override;
-
     private:
       /// Feasibility filter applied first before invoking the main cut
       MVAFeasibleSegmentRelationFilter m_feasibleSegmentRelationFilter;
@@ -21,14 +21,5 @@ MVARealisticSegmentRelationFilter::MVARealisticSegmentRelationFilter()
           "trackfindingcdc_RealisticSegmentRelationFilterParameters")
 {
   this->addProcessingSignalListener(&m_feasibleSegmentRelationFilter);
-}
-
-Weight MVARealisticSegmentRelationFilter::operator()(const Relation<const CDCSegment2D>& segmentRelation)
-{
-  double isFeasibleWeight = m_feasibleSegmentRelationFilter(segmentRelation);
-  if (std::isnan(isFeasibleWeight)) {
-    return NAN;
-  } else {
-    return Super::operator()(segmentRelation);
-  }
+  this->setFeasibilityFilter(&m_feasibleSegmentRelationFilter);
 }
@@ -35,9 +35,6 @@ namespace Belle2 {
       /// Constructor initialising the MVAFilter with standard training name for this filter.
       MVARealisticTrackRelationFilter();
 
-      /// Function to object for its signalness
-      Weight operator()(const Relation<const CDCTrack>& trackRelation) final;
-
     private:
       /// Feasibility filter applied first before invoking the main cut
       MVAFeasibleTrackRelationFilter m_feasibleTrackRelationFilter;
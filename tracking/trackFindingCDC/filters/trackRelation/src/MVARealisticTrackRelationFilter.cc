@@ -19,14 +19,5 @@ MVARealisticTrackRelationFilter::MVARealisticTrackRelationFilter()
           "trackfindingcdc_RealisticTrackRelationFilterParameters")
 {
   this->addProcessingSignalListener(&m_feasibleTrackRelationFilter);
-}
-
-Weight MVARealisticTrackRelationFilter::operator()(const Relation<const CDCTrack>& trackRelation)
-{
-  double isFeasibleWeight = m_feasibleTrackRelationFilter(trackRelation);
-  if (std::isnan(isFeasibleWeight)) {
-    return NAN;
-  } else {
-    return Super::operator()(trackRelation);
-  }
+  this->setFeasibilityFilter(&m_feasibleTrackRelationFilter);
 }
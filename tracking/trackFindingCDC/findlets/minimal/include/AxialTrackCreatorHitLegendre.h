@@ -11,6 +11,10 @@
 
 #include <tracking/trackFindingCDC/legendre/quadtree/AxialHitQuadTreeProcessor.h>
 
+#include <framework/utilities/TaskPool.h>
+
+#include <memory>
+
 namespace Belle2 {
 
   namespace TrackFindingCDC {
@@ -66,6 +70,9 @@ namespace Belle2 {
       /// Initialisation before the event processing starts
       void initialize() final;
 
+      /// Release the quad tree and the threads after the event processing
+      void terminate() final;
+
       /// Execute one pass over a quad tree
       void apply(const std::vector<const CDCWireHit*>& axialWireHits,
                  std::vector<CDCTrack>& tracks) final;
@@ -96,6 +103,16 @@ namespace Belle2 {
 
       /// Parameter to define precision of quadtree search in case of straight pass
       double m_param_precision = 0.00000001;
+
+      /// Parameter to define the number of additional threads filling the seed level of the quadtree
+      int m_param_nThreads = 0;
+
+    private: // Cached objects
+      /// Quad tree processor reused for all events such that its nodes are recycled
+      std::unique_ptr<AxialHitQuadTreeProcessor> m_qtProcessor;
+
+      /// Threads filling the seed level, created on the first event to be safe with forked event processing
+      std::unique_ptr<TaskPool> m_taskPool;
     };
   }
 }
@@ -13,6 +13,7 @@
 #include <tracking/trackFindingCDC/filters/facet/FeasibleRLFacetFilter.h>
 #include <tracking/trackFindingCDC/filters/wireHitRelation/BridgingWireHitRelationFilter.h>
 
+#include <tracking/trackFindingCDC/eventdata/hits/CDCFacet.h>
 #include <tracking/trackFindingCDC/eventdata/utils/DriftLengthEstimator.h>
 
 #include <tracking/trackFindingCDC/utilities/WeightedRelation.h>
@@ -24,7 +25,6 @@ namespace Belle2 {
 
 
   namespace TrackFindingCDC {
-    class CDCFacet;
     class CDCWireHitCluster;
 
     /// Class providing construction combinatorics for the facets.
@@ -57,6 +57,8 @@ namespace Belle2 {
       /**
        *  Generates facets on the given wire hits generating neighboring triples of hits.
        *  Inserts the result to the end of the GenericFacetCollection.
+       *  If the facet filter supports it, it is evaluated once for all facet candidates of the wire hits
+       *  and only the accepted ones are inserted.
        */
       void createFacets(const std::vector<CDCWireHit*>& wireHits,
                         const std::vector<WeightedRelation<CDCWireHit> >& wireHitRelations,
@@ -66,11 +68,13 @@ namespace Belle2 {
        *  Generates reconstruted facets on the three given wire hits by hypothesizing
        *  over the 8 left right passage combinations.
        *  Inserts the result to the end of the GenericFacetCollection.
+       *  If applyFilter is false, all feasible candidates are inserted without evaluating the facet filter.
        */
       void createFacetsForHitTriple(const CDCWireHit& startWireHit,
                                     const CDCWireHit& middleWireHit,
                                     const CDCWireHit& endWireHit,
-                                    std::vector<CDCFacet>& facets);
+                                    std::vector<CDCFacet>& facets,
+                                    bool applyFilter = true);
     private:
       /// Parameter : Switch to apply the rl feasibility cut
       bool m_param_feasibleRLOnly = true;
@@ -97,6 +101,12 @@ namespace Belle2 {
     private:
       /// Memory for the wire hit neighborhood in within a cluster.
       std::vector<WeightedRelation<CDCWireHit> > m_wireHitRelations;
+
+      /// Memory for the facet candidates to be given to the facet filter at once.
+      std::vector<CDCFacet> m_facetCandidates;
+
+      /// Memory for the pointers to the facet candidates as taken by the facet filter.
+      std::vector<const CDCFacet*> m_facetCandidatePtrs;
     };
   }
 }
@@ -13,6 +13,8 @@
 
 #include <tracking/trackFindingCDC/filters/segmentPair/ChooseableSegmentPairFilter.h>
 
+#include <tracking/trackFindingCDC/eventdata/tracks/CDCSegmentPair.h>
+
 #include <tracking/trackFindingCDC/topology/ISuperLayer.h>
 
 #include <vector>
@@ -24,7 +26,6 @@ namespace Belle2 {
 
   namespace TrackFindingCDC {
     class CDCSegment2D;
-    class CDCSegmentPair;
 
     /// Class providing construction combinatorics for the axial stereo segment pairs.
     class SegmentPairCreator : public Findlet<const CDCSegment2D, CDCSegmentPair> {
@@ -48,7 +49,11 @@ namespace Belle2 {
                  std::vector<CDCSegmentPair>& segmentPairs) final;
 
     private:
-      /// Creates segment pairs from a combination of from segments and to segments.
+      /**
+       *  Creates segment pairs from a combination of from segments and to segments.
+       *  If the segment pair filter supports it, it is evaluated once for all combinations
+       *  and only the accepted segment pairs are inserted.
+       */
       void create(const std::vector<const CDCSegment2D*>& fromSegments,
                   const std::vector<const CDCSegment2D*>& toSegments,
                   std::vector<CDCSegmentPair>& segmentPairs);
@@ -67,6 +72,12 @@ namespace Belle2 {
       // Object pools
       /// Structure for the segments grouped by super layer id.
       std::array<std::vector<const CDCSegment2D*>, ISuperLayerUtil::c_N> m_segmentsBySuperLayer;
+
+      /// Memory for the segment pair candidates to be given to the segment pair filter at once.
+      std::vector<CDCSegmentPair> m_segmentPairCandidates;
+
+      /// Memory for the pointers to the segment pair candidates as taken by the segment pair filter.
+      std::vector<CDCSegmentPair*> m_segmentPairCandidatePtrs;
     };
   }
 }
@@ -78,7 +78,7 @@ namespace Belle2 {
         B2ASSERT("Expected the objects on which relations are constructed to be sorted",
         std::is_sorted(inputObjects.begin(), inputObjects.end(), LessOf<Deref>()));
 
-        RelationFilterUtil::appendUsing(m_relationFilter, inputObjects, weightedRelations);
+        RelationFilterUtil::appendUsingBatched(m_relationFilter, inputObjects, weightedRelations);
 
         if (m_param_onlyBest > 0)
         {
@@ -89,11 +89,24 @@ void AxialTrackCreatorHitLegendre::exposeParameters(ModuleParamList* moduleParam
                                   "Parameter to define precision of quadtree search.",
                                   m_param_precision);
   }
+  moduleParamList->addParameter(prefixed(prefix, "nThreads"),
+                                m_param_nThreads,
+                                "Number of additional threads to fill the seed level of the quadtree. "
+                                "The found tracks do not depend on it.",
+                                m_param_nThreads);
 }
 
 void AxialTrackCreatorHitLegendre::initialize()
 {
   Super::initialize();
+  m_qtProcessor = constructQTProcessor(m_pass);
+}
+
+void AxialTrackCreatorHitLegendre::terminate()
+{
+  m_qtProcessor.reset();
+  m_taskPool.reset();
+  Super::terminate();
 }
 
 void AxialTrackCreatorHitLegendre::apply(const std::vector<const CDCWireHit*>& axialWireHits,
@@ -108,10 +121,14 @@ void AxialTrackCreatorHitLegendre::apply(const std::vector<const CDCWireHit*>& a
     unusedAxialWireHits.push_back(wireHit);
   }
 
-  // Create quadtree processor
-  std::unique_ptr<AxialHitQuadTreeProcessor> qtProcessor = constructQTProcessor(m_pass);
-  qtProcessor->seed(unusedAxialWireHits);
-//   qtProcessor->drawHits(unusedAxialWireHits, 9);
+  // Prepare the quadtree processor, recycling the nodes of the last event
+  if (m_param_nThreads > 0 and not m_taskPool) {
+    m_taskPool = std::make_unique<TaskPool>(m_param_nThreads);
+    m_qtProcessor->setTaskPool(m_taskPool.get());
+  }
+  m_qtProcessor->clear();
+  m_qtProcessor->seed(unusedAxialWireHits);
+//   m_qtProcessor->drawHits(unusedAxialWireHits, 9);
 
   // Create object which contains interface between quadtree processor and track processor (module)
   std::unique_ptr<BaseCandidateReceiver> receiver;
@@ -122,10 +139,13 @@ void AxialTrackCreatorHitLegendre::apply(const std::vector<const CDCWireHit*>& a
   }
 
   // Start candidate finding
-  this->executeRelaxation(std::ref(*receiver), *qtProcessor);
+  this->executeRelaxation(std::ref(*receiver), *m_qtProcessor);
 
   const std::vector<CDCTrack>& newTracks = receiver->getTracks();
   tracks.insert(tracks.end(), newTracks.begin(), newTracks.end());
+
+  // Do not keep pointers to the hits of this event
+  m_qtProcessor->clear();
 }
 
 void AxialTrackCreatorHitLegendre::executeRelaxation(const CandidateReceiver& candidateReceiver,
@@ -22,6 +22,7 @@
 #include <vector>
 #include <string>
 #include <algorithm>
+#include <cmath>
 
 using namespace Belle2;
 using namespace TrackFindingCDC;
@@ -99,6 +100,12 @@ void FacetCreator::createFacets(const std::vector<CDCWireHit*>& wireHits,
                                 const std::vector<WeightedRelation<CDCWireHit> >& wireHitRelations,
                                 std::vector<CDCFacet>& facets)
 {
+  // A filter evaluating many facets at once gets all candidates of the wire hits in one call,
+  // any other filter is applied to each candidate as it is created.
+  const bool batchFilter = m_facetFilter.hasBatchEvaluation();
+  m_facetCandidates.clear();
+  std::vector<CDCFacet>& candidates = batchFilter ? m_facetCandidates : facets;
+
   for (const CDCWireHit* ptrMiddleWireHit : wireHits) {
     if (not ptrMiddleWireHit) continue;
     const CDCWireHit& middleWireHit = *ptrMiddleWireHit;
@@ -124,16 +131,32 @@ void FacetCreator::createFacets(const std::vector<CDCWireHit*>& wireHits,
         // Skip combinations where the facet starts and ends on the same wire
         if (ptrStartWireHit->isOnWire(ptrEndWireHit->getWire())) continue;
 
-        createFacetsForHitTriple(startWireHit, middleWireHit, endWireHit, facets);
+        createFacetsForHitTriple(startWireHit, middleWireHit, endWireHit, candidates, not batchFilter);
       } // end for itEndWireHit
     } // end for itStartWireHit
   } // end for itMiddleWireHit
+
+  if (not batchFilter) return;
+
+  // Evaluate the facet filter for all candidates at once and keep only the accepted ones
+  m_facetCandidatePtrs.clear();
+  for (const CDCFacet& facet : m_facetCandidates) {
+    m_facetCandidatePtrs.push_back(&facet);
+  }
+  const std::vector<float> weights = m_facetFilter(m_facetCandidatePtrs);
+  for (std::size_t iCandidate = 0; iCandidate < m_facetCandidates.size(); ++iCandidate) {
+    if (std::isnan(weights[iCandidate])) continue;
+    CDCFacet& facet = m_facetCandidates[iCandidate];
+    facet.getAutomatonCell().setCellWeight(weights[iCandidate]);
+    facets.push_back(facet);
+  }
 }
 
 void FacetCreator::createFacetsForHitTriple(const CDCWireHit& startWireHit,
                                             const CDCWireHit& middleWireHit,
                                             const CDCWireHit& endWireHit,
-                                            std::vector<CDCFacet>& facets)
+                                            std::vector<CDCFacet>& facets,
+                                            bool applyFilter)
 {
   /// Prepare a facet - without fitted tangent lines.
   CDCRLWireHit startRLWireHit(&startWireHit, ERightLeft::c_Left);
@@ -175,6 +198,11 @@ void FacetCreator::createFacetsForHitTriple(const CDCWireHit& startWireHit,
           m_driftLengthEstimator.updateDriftLength(facet);
         }
 
+        if (not applyFilter) {
+          facets.insert(facets.end(), facet);
+          continue;
+        }
+
         Weight weight = m_facetFilter(facet);
 
         if (not std::isnan(weight)) {
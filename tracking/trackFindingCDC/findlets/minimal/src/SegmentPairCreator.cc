@@ -19,6 +19,7 @@
 #include <array>
 #include <string>
 #include <algorithm>
+#include <cmath>
 
 using namespace Belle2;
 using namespace TrackFindingCDC;
@@ -161,19 +162,43 @@ void SegmentPairCreator::create(const std::vector<const CDCSegment2D*>& fromSegm
                                 const std::vector<const CDCSegment2D*>& toSegments,
                                 std::vector<CDCSegmentPair>& segmentPairs)
 {
-  CDCSegmentPair segmentPair;
+  if (not m_segmentPairFilter.hasBatchEvaluation()) {
+    CDCSegmentPair segmentPair;
+    for (const CDCSegment2D* ptrFromSegment : fromSegments) {
+      for (const CDCSegment2D* ptrToSegment : toSegments) {
+
+        if (ptrFromSegment == ptrToSegment) continue;
+        segmentPair.setSegments(ptrFromSegment, ptrToSegment);
+        segmentPair.clearTrajectory3D();
+
+        Weight pairWeight = m_segmentPairFilter(segmentPair);
+        if (not std::isnan(pairWeight)) {
+          segmentPair.getAutomatonCell().setCellWeight(pairWeight);
+          segmentPairs.push_back(segmentPair);
+        }
+      }
+    }
+    return;
+  }
+
+  // Evaluate the segment pair filter for all candidates at once and keep only the accepted ones
+  m_segmentPairCandidates.clear();
   for (const CDCSegment2D* ptrFromSegment : fromSegments) {
     for (const CDCSegment2D* ptrToSegment : toSegments) {
-
       if (ptrFromSegment == ptrToSegment) continue;
-      segmentPair.setSegments(ptrFromSegment, ptrToSegment);
-      segmentPair.clearTrajectory3D();
-
-      Weight pairWeight = m_segmentPairFilter(segmentPair);
-      if (not std::isnan(pairWeight)) {
-        segmentPair.getAutomatonCell().setCellWeight(pairWeight);
-        segmentPairs.push_back(segmentPair);
-      }
+      m_segmentPairCandidates.emplace_back(ptrFromSegment, ptrToSegment);
     }
   }
+
+  m_segmentPairCandidatePtrs.clear();
+  for (CDCSegmentPair& segmentPair : m_segmentPairCandidates) {
+    m_segmentPairCandidatePtrs.push_back(&segmentPair);
+  }
+  const std::vector<float> weights = m_segmentPairFilter(m_segmentPairCandidatePtrs);
+  for (std::size_t iCandidate = 0; iCandidate < m_segmentPairCandidates.size(); ++iCandidate) {
+    if (std::isnan(weights[iCandidate])) continue;
+    CDCSegmentPair& segmentPair = m_segmentPairCandidates[iCandidate];
+    segmentPair.getAutomatonCell().setCellWeight(weights[iCandidate]);
+    segmentPairs.push_back(segmentPair);
+  }
 }
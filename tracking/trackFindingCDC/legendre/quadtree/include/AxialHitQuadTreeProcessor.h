@@ -72,6 +72,18 @@ namespace Belle2 {
        */
       bool isInNode(QuadTree* node, const CDCWireHit* wireHit) const final;
 
+      /**
+       * Check for all hits and nodes whether the hits belong to the node.
+       * The hit positions are gathered once and checked against each node in a vectorisable loop,
+       * the result is identical to isInNode.
+       * @param nodes quadtree nodes
+       * @param items hits being checked
+       * @param[out] inNodes flag for each node and hit, inNodes[iNode * items.size() + iItem]
+       */
+      void isInNodes(const std::vector<QuadTree*>& nodes,
+                     const std::vector<Item*>& items,
+                     std::vector<char>& inNodes) const final;
+
     protected: // Implementation details
       /**
        * Check derivative of the sinogram.
@@ -93,6 +105,21 @@ namespace Belle2 {
        */
       bool checkExtremum(QuadTree* node, const CDCWireHit* wireHit) const;
 
+    private:
+      /**
+       * Check the sinograms of the given hits against the borders of the node.
+       * The hit coordinates are relative to the local origin, r2 is the squared distance minus the squared drift length.
+       * The result for each hit is one of the EClassification values in the implementation,
+       * hits with a sinogram extremum in the node are left to checkExtremum.
+       */
+      void classifyHits(QuadTree* node,
+                        const double* x,
+                        const double* y,
+                        const double* l,
+                        const double* r2,
+                        size_t nHits,
+                        char* inNode) const;
+
     public: // debug stuff
       /// Draw QuadTree node
       void drawHits(std::vector<const CDCWireHit*> hits, unsigned int color = 46) const;
@@ -10,6 +10,7 @@
 
 #include <framework/logging/Logger.h>
 
+#include <array>
 #include <vector>
 
 namespace Belle2 {
@@ -51,23 +52,35 @@ namespace Belle2 {
        */
       // cppcheck-suppress passedByValue
       QuadTreeNode(XSpan xSpan, YSpan ySpan, int level, This* parent)
-        : m_xBinBounds {
-        xSpan[0],
-        xSpan[0] + (xSpan[1] - xSpan[0]) / 2,
-        xSpan[1] - (xSpan[1] - xSpan[0]) / 2,
-        xSpan[1]
-      }
-      , m_yBinBounds({
-        ySpan[0],
-        ySpan[0] + (ySpan[1] - ySpan[0]) / 2,
-        ySpan[1] - (ySpan[1] - ySpan[0]) / 2,
-        ySpan[1]
-      })
-      , m_parent(level > 0 ? parent : nullptr)
-      , m_level(level)
-      , m_filled(false)
+      {
+        reset(xSpan, ySpan, level, parent);
+      }
+
+      /**
+       *  Set the node up again for the given spans as if it was newly constructed,
+       *  but keep the memory acquired for the items such that the node can be recycled.
+       */
+      // cppcheck-suppress passedByValue
+      void reset(XSpan xSpan, YSpan ySpan, int level, This* parent)
       {
         B2ASSERT("QuadTree datastructure only supports levels < 255", level < 255);
+        m_xBinBounds = {
+          xSpan[0],
+          xSpan[0] + (xSpan[1] - xSpan[0]) / 2,
+          xSpan[1] - (xSpan[1] - xSpan[0]) / 2,
+          xSpan[1]
+        };
+        m_yBinBounds = {
+          ySpan[0],
+          ySpan[0] + (ySpan[1] - ySpan[0]) / 2,
+          ySpan[1] - (ySpan[1] - ySpan[0]) / 2,
+          ySpan[1]
+        };
+        m_parent = level > 0 ? parent : nullptr;
+        m_level = level;
+        m_filled = false;
+        m_items.clear();
+        m_children = nullptr;
       }
 
       /** Insert item into node */
@@ -100,20 +113,32 @@ namespace Belle2 {
         m_items.clear();
       }
 
-      /** Returns the children structure of this node */
-      Children& getChildren()
+      /**
+       *  Returns the children structure of this node.
+       *  Returns nullptr if the children have not been created yet.
+       */
+      Children* getChildren() const
       {
         return m_children;
       }
 
       /**
-       *  Clear items which the node holds and destroy all children below this node.
+       *  Set the children structure of this node.
+       *  The memory of the children is owned by the QuadTreeProcessor, which recycles it between events.
+       */
+      void setChildren(Children* children)
+      {
+        m_children = children;
+      }
+
+      /**
+       *  Detach all children below this node.
        *  This method must only be called on the root node, for fast QuadTree reusage
        */
       void clearChildren()
       {
-        // automatically removes all lower level objects
-        m_children.clear();
+        // the lower level objects are owned and recycled by the processor
+        m_children = nullptr;
         m_filled = false;
       }
 
@@ -219,20 +244,20 @@ namespace Belle2 {
       /// Vector of items which belongs to the node
       std::vector<AItem*> m_items;
 
-      /// Pointers to the children nodes
-      std::vector<This> m_children;
+      /// Pointer to the children nodes, nullptr if they have not been created yet
+      Children* m_children = nullptr;
 
       /// bins range on r
       YBinBounds m_yBinBounds;
 
       /// Pointer to the parent node
-      This* m_parent;
+      This* m_parent = nullptr;
 
       /// Level of node in the tree
-      int m_level;
+      int m_level = 0;
 
       /// Is the node has been filled with items
-      bool m_filled;
+      bool m_filled = false;
     };
   }
 }
@@ -12,8 +12,11 @@
 
 #include <tracking/trackFindingCDC/utilities/Algorithms.h>
 
+#include <framework/utilities/TaskPool.h>
+
 #include <algorithm>
 #include <functional>
+#include <future>
 #include <memory>
 #include <map>
 #include <vector>
@@ -28,6 +31,15 @@ namespace Belle2 {
      * It provides some functions to create, fill, clear and postprocess a quad tree.
      * If you want to use your own class as a quad tree item, you have to overload this processor.
      * You have provide only the two functions isInNode and createChild.
+     *
+     * The nodes below the root are taken from a pool owned by the processor, which is recycled
+     * by clear() such that a processor reused for many events does not allocate in the steady state.
+     *
+     * The classification of the items into nodes goes through isInNodes, which sees all items
+     * and nodes of one filling step at once and can be overloaded with a vectorised implementation.
+     * If a TaskPool is set, the sectors of the seed level are filled concurrently. The search itself
+     * stays sequential, because the items used by a found candidate are removed from all
+     * later candidates, so the results do not depend on the number of threads.
      */
     template<typename AX, typename AY, class AData>
     class QuadTreeProcessor {
@@ -91,6 +103,16 @@ namespace Belle2 {
         m_quadTree->clearChildren();
         m_quadTree->clearItems();
         m_items.clear();
+        m_nUsedChildren = 0;
+      }
+
+      /**
+       * Set the pool of threads used to fill the seed level, nullptr to fill it in the calling thread.
+       * The pool is not owned by the processor and has to outlive its usage in seed().
+       */
+      void setTaskPool(TaskPool* taskPool)
+      {
+        m_taskPool = taskPool;
       }
 
       /**
@@ -113,10 +135,10 @@ namespace Belle2 {
 
         for (int level = 0; level < m_seedLevel; ++level) {
           for (QuadTree* node : m_seededTrees) {
-            if (node->getChildren().empty()) {
-              this->createChildren(node, node->getChildren());
+            if (not node->getChildren()) {
+              this->createChildren(node);
             }
-            for (QuadTree& child :  node->getChildren()) {
+            for (QuadTree& child : *node->getChildren()) {
               nextSeededTrees.push_back(&child);
             }
           }
@@ -125,15 +147,38 @@ namespace Belle2 {
         }
 
         // Fill the seed level with the items
-        for (QuadTree* seededTree : m_seededTrees) {
-          seededTree->reserveItems(m_items.size());
+        std::vector<Item*> unusedItems;
+        unusedItems.reserve(m_items.size());
+        for (Item& item : m_items) {
+          if (item.isUsed()) continue;
+          unusedItems.push_back(&item);
+        }
 
-          for (Item& item : m_items) {
-            if (item.isUsed()) continue;
-            if (isInNode(seededTree, item.getPointer())) {
-              seededTree->insertItem(&item);
-            }
-          }
+        const size_t nSeededTrees = m_seededTrees.size();
+        const size_t nChunks = m_taskPool ? std::min<size_t>(m_taskPool->getNumberThreads() + 1, nSeededTrees) : 1;
+        if (nChunks <= 1) {
+          fillNodes(m_seededTrees, unusedItems);
+          return;
+        }
+
+        // The sectors are independent, so each chunk of them can be filled by another thread.
+        // The calling thread takes the first chunk itself.
+        std::vector<std::vector<QuadTree*>> chunks(nChunks);
+        for (size_t iSeededTree = 0; iSeededTree < nSeededTrees; ++iSeededTree) {
+          chunks[iSeededTree * nChunks / nSeededTrees].push_back(m_seededTrees[iSeededTree]);
+        }
+        std::vector<std::future<void>> results;
+        for (size_t iChunk = 1; iChunk < nChunks; ++iChunk) {
+          const std::vector<QuadTree*>& chunk = chunks[iChunk];
+          results.push_back(m_taskPool->submit([this, &chunk, &unusedItems]() { fillNodes(chunk, unusedItems); }));
+        }
+        fillNodes(chunks.front(), unusedItems);
+        // Wait for all chunks before rethrowing any exception, as they refer to the local chunks
+        for (std::future<void>& result : results) {
+          result.wait();
+        }
+        for (std::future<void>& result : results) {
+          result.get();
         }
       }
 
@@ -208,8 +253,8 @@ namespace Belle2 {
           return;
         }
 
-        if (node->getChildren().empty()) {
-          this->createChildren(node, node->getChildren());
+        if (not node->getChildren()) {
+          this->createChildren(node);
         }
 
         if (!node->checkFilled()) {
@@ -218,7 +263,7 @@ namespace Belle2 {
         }
 
         std::vector<QuadTree*> children;
-        for (QuadTree& child : node->getChildren()) {
+        for (QuadTree& child : *node->getChildren()) {
           children.push_back(&child);
         }
         const auto compareNItems = [](const QuadTree * lhs, const QuadTree * rhs) {
@@ -241,40 +286,80 @@ namespace Belle2 {
       /**
        * Creates the sub node of a given node. This function is called by fillGivenTree.
        * To calculate the spans of the children nodes the user-defined function createChiildWithParent is used.
+       * The memory of the children is recycled from the previous events.
        */
-      void createChildren(QuadTree* node, QuadTreeChildren& m_children) const
+      void createChildren(QuadTree* node)
       {
+        QuadTreeChildren* children = getUnusedChildren();
+        children->reserve(node->getXNbins() * node->getYNbins());
+        size_t iChild = 0;
         for (int i = 0; i < node->getXNbins(); ++i) {
           for (int j = 0; j < node->getYNbins(); ++j) {
             const XYSpans& xySpans = createChild(node, i, j);
             const XSpan& xSpan = xySpans.first;
             const YSpan& ySpan = xySpans.second;
-            m_children.push_back(QuadTree(xSpan, ySpan, node->getLevel() + 1, node));
+            if (iChild < children->size()) {
+              (*children)[iChild].reset(xSpan, ySpan, node->getLevel() + 1, node);
+            } else {
+              children->emplace_back(xSpan, ySpan, node->getLevel() + 1, node);
+            }
+            ++iChild;
           }
         }
+        node->setChildren(children);
+      }
+
+      /// Acquire the next unused child node structure, recycling all memory.
+      QuadTreeChildren* getUnusedChildren()
+      {
+        if (m_nUsedChildren >= m_children.size()) {
+          m_children.emplace_back();
+        }
+        ++m_nUsedChildren;
+        return &(m_children[m_nUsedChildren - 1]);
       }
 
       /**
        * This function is called by fillGivenTree and fills the items into the corresponding children.
-       * For this the user-defined method isInNode is called.
+       * For this the user-defined method isInNodes is called.
        */
       void fillChildren(QuadTree* node, const std::vector<Item*>& items)
       {
-        const size_t neededSize = 2 * items.size();
-        for (QuadTree& child : node->getChildren()) {
-          child.reserveItems(neededSize);
-        }
-
+        std::vector<Item*> unusedItems;
+        unusedItems.reserve(items.size());
         for (Item* item : items) {
           if (item->isUsed()) continue;
+          unusedItems.push_back(item);
+        }
 
-          for (QuadTree& child : node->getChildren()) {
-            if (isInNode(&child, item->getPointer())) {
-              child.insertItem(item);
+        std::vector<QuadTree*> children;
+        for (QuadTree& child : *node->getChildren()) {
+          children.push_back(&child);
+        }
+        fillNodes(children, unusedItems);
+        afterFillDebugHook(*node->getChildren());
+      }
+
+      /**
+       * Insert all items into the nodes they belong to, keeping the order of the items.
+       * Only touches the given nodes, such that disjoint sets of nodes can be filled concurrently.
+       */
+      void fillNodes(const std::vector<QuadTree*>& nodes, const std::vector<Item*>& items) const
+      {
+        const size_t nItems = items.size();
+        std::vector<char> inNodes;
+        isInNodes(nodes, items, inNodes);
+
+        for (size_t iNode = 0; iNode < nodes.size(); ++iNode) {
+          const char* inNode = inNodes.data() + iNode * nItems;
+          QuadTree* node = nodes[iNode];
+          node->reserveItems(node->getNItems() + std::count(inNode, inNode + nItems, char(true)));
+          for (size_t iItem = 0; iItem < nItems; ++iItem) {
+            if (inNode[iItem]) {
+              node->insertItem(items[iItem]);
             }
           }
         }
-        afterFillDebugHook(node->getChildren());
       }
 
       /**
@@ -322,6 +407,27 @@ namespace Belle2 {
        */
       virtual bool isInNode(QuadTree* node, AData* item) const = 0;
 
+      /**
+       * Decide for all items and all nodes of one filling step if the item belongs into the node.
+       * Overload this function to provide a vectorised version of isInNode, the result has to be the same.
+       * It may be called concurrently for different nodes and must not modify the processor.
+       * @param nodes     nodes to be filled
+       * @param items     items to be filled into the nodes or not
+       * @param[out] inNodes  flag for each node and item, inNodes[iNode * items.size() + iItem]
+       */
+      virtual void isInNodes(const std::vector<QuadTree*>& nodes,
+                             const std::vector<Item*>& items,
+                             std::vector<char>& inNodes) const
+      {
+        const size_t nItems = items.size();
+        inNodes.resize(nodes.size() * nItems);
+        for (size_t iNode = 0; iNode < nodes.size(); ++iNode) {
+          for (size_t iItem = 0; iItem < nItems; ++iItem) {
+            inNodes[iNode * nItems + iItem] = isInNode(nodes[iNode], items[iItem]->getPointer());
+          }
+        }
+      }
+
       /**
        * Function which checks if given node is leaf
        * Implemented as virtual to keep possibility of changing lastLevel values depending on region is phase-space
@@ -381,6 +487,15 @@ namespace Belle2 {
       std::vector<QuadTree*> m_seededTrees;
 
     private:
+      /// Central point to provide memory for the child nodes, recycled by clear()
+      std::deque<QuadTreeChildren> m_children;
+
+      /// Number of child structures taken from m_children since the last clear()
+      size_t m_nUsedChildren = 0;
+
+      /// Optional pool of threads to fill the seed level with, not owned
+      TaskPool* m_taskPool = nullptr;
+
       /// The last level to be filled
       int m_lastLevel;
 
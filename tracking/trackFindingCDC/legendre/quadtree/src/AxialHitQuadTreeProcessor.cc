@@ -21,11 +21,22 @@ using namespace Belle2;
 using namespace TrackFindingCDC;
 
 namespace {
+  /// Evaluated without short circuits to keep the loop in classifyHits branch free
   bool sameSign(double n1, double n2, double n3, double n4)
   {
-    return ((n1 > 0 && n2 > 0 && n3 > 0 && n4 > 0) || (n1 < 0 && n2 < 0 && n3 < 0 && n4 < 0));
+    return ((n1 > 0) & (n2 > 0) & (n3 > 0) & (n4 > 0)) | ((n1 < 0) & (n2 < 0) & (n3 < 0) & (n4 < 0));
   }
 
+  /// Outcome of the check of one hit against one node in classifyHits
+  enum EClassification : char {
+    /// The sinograms of the hit do not cross the node
+    c_NotInNode = 0,
+    /// The sinograms of the hit cross the borders of the node
+    c_InNode = 1,
+    /// The sinograms of the hit have their extremum in the theta range of the node, see checkExtremum
+    c_CheckExtremum = 2,
+  };
+
   using YSpan = AxialHitQuadTreeProcessor::YSpan;
   YSpan splitCurvSpan(const YSpan& curvSpan, int nodeLevel, int lastLevel, int j)
   {
@@ -192,70 +203,113 @@ AxialHitQuadTreeProcessor::createChild(QuadTree* node, int i, int j) const
 
 bool AxialHitQuadTreeProcessor::isInNode(QuadTree* node, const CDCWireHit* wireHit) const
 {
-  // Check whether the hit lies in the forward direction
-  if (node->getLevel() <= 4 and m_twoSidedPhaseSpace and node->getYMin() > -c_curlCurv and
-      node->getYMax() < c_curlCurv) {
-    if (not checkDerivative(node, wireHit)) return false;
-  }
-
   const double& l = wireHit->getRefDriftLength();
   const Vector2D& pos2D = wireHit->getRefPos2D() - m_localOrigin;
   double r2 = pos2D.normSquared() - l * l;
+  double x = pos2D.x();
+  double y = pos2D.y();
 
-  using Quadlet = std::array<std::array<float, 2>, 2>;
-  Quadlet distRight{};
-  Quadlet distLeft{};
-
-  // get top and bottom borders of the node
-  float rMin = node->getYMin() * r2 / 2;
-  float rMax = node->getYMax() * r2 / 2;
-
-  // get left and right borders of the node
-  long thetaMin = node->getXMin();
-  long thetaMax = node->getXMax();
-
-  const Vector2D& thetaVecMin = m_cosSinLookupTable->at(thetaMin);
-  const Vector2D& thetaVecMax = m_cosSinLookupTable->at(thetaMax);
-
-  float rHitMin = thetaVecMin.dot(pos2D);
-  float rHitMax = thetaVecMax.dot(pos2D);
-
-  // compute sinograms at the left and right borders of the node
-  float rHitMinRight = rHitMin - l;
-  float rHitMaxRight = rHitMax - l;
-
-  float rHitMinLeft = rHitMin + l;
-  float rHitMaxLeft = rHitMax + l;
+  char inNode = c_NotInNode;
+  classifyHits(node, &x, &y, &l, &r2, 1, &inNode);
+  if (inNode == c_CheckExtremum) return checkExtremum(node, wireHit);
+  return inNode == c_InNode;
+}
 
-  // Compute distance from the sinograms to bottom and top borders of the node
-  distRight[0][0] = rMin - rHitMinRight;
-  distRight[0][1] = rMin - rHitMaxRight;
-  distRight[1][0] = rMax - rHitMinRight;
-  distRight[1][1] = rMax - rHitMaxRight;
+void AxialHitQuadTreeProcessor::isInNodes(const std::vector<QuadTree*>& nodes,
+                                          const std::vector<Item*>& items,
+                                          std::vector<char>& inNodes) const
+{
+  // Gather the hit positions relative to the local origin once for all nodes
+  const size_t nHits = items.size();
+  std::vector<double> x(nHits);
+  std::vector<double> y(nHits);
+  std::vector<double> l(nHits);
+  std::vector<double> r2(nHits);
+  for (size_t iHit = 0; iHit < nHits; ++iHit) {
+    const CDCWireHit* wireHit = items[iHit]->getPointer();
+    const Vector2D& pos2D = wireHit->getRefPos2D() - m_localOrigin;
+    x[iHit] = pos2D.x();
+    y[iHit] = pos2D.y();
+    l[iHit] = wireHit->getRefDriftLength();
+    r2[iHit] = pos2D.normSquared() - l[iHit] * l[iHit];
+  }
 
-  distLeft[0][0] = rMin - rHitMinLeft;
-  distLeft[0][1] = rMin - rHitMaxLeft;
-  distLeft[1][0] = rMax - rHitMinLeft;
-  distLeft[1][1] = rMax - rHitMaxLeft;
+  inNodes.resize(nodes.size() * nHits);
+  for (size_t iNode = 0; iNode < nodes.size(); ++iNode) {
+    char* inNode = inNodes.data() + iNode * nHits;
+    classifyHits(nodes[iNode], x.data(), y.data(), l.data(), r2.data(), nHits, inNode);
 
-  // Compare distance signs from sinograms to the node
-  // Check right
-  if (not sameSign(distRight[0][0], distRight[0][1], distRight[1][0], distRight[1][1])) {
-    return true;
+    // The few hits with the extremum of their sinogram in the node are checked one by one
+    for (size_t iHit = 0; iHit < nHits; ++iHit) {
+      if (inNode[iHit] == c_CheckExtremum) {
+        inNode[iHit] = checkExtremum(nodes[iNode], items[iHit]->getPointer());
+      }
+    }
   }
+}
 
-  // Check left
-  if (not sameSign(distLeft[0][0], distLeft[0][1], distLeft[1][0], distLeft[1][1])) {
-    return true;
-  }
+void AxialHitQuadTreeProcessor::classifyHits(QuadTree* node,
+                                             const double* x,
+                                             const double* y,
+                                             const double* l,
+                                             const double* r2,
+                                             size_t nHits,
+                                             char* inNode) const
+{
+  // Check whether the hit lies in the forward direction, see checkDerivative
+  const bool checkForward = node->getLevel() <= 4 and m_twoSidedPhaseSpace and
+                            node->getYMin() > -c_curlCurv and node->getYMax() < c_curlCurv;
 
-  // Check the extremum
-  float rHitMinExtr = thetaVecMin.cross(pos2D);
-  float rHitMaxExtr = thetaVecMax.cross(pos2D);
-  if (rHitMinExtr * rHitMaxExtr < 0.) return checkExtremum(node, wireHit);
+  // get top and bottom borders of the node
+  const float yMin = node->getYMin();
+  const float yMax = node->getYMax();
 
-  // Not contained
-  return false;
+  // get left and right borders of the node
+  const Vector2D& thetaVecMin = m_cosSinLookupTable->at(node->getXMin());
+  const Vector2D& thetaVecMax = m_cosSinLookupTable->at(node->getXMax());
+  const double cosMin = thetaVecMin.x();
+  const double sinMin = thetaVecMin.y();
+  const double cosMax = thetaVecMax.x();
+  const double sinMax = thetaVecMax.y();
+
+  // All operations are done in the same order and precision as in Vector2D::dot and Vector2D::cross
+  // such that the result does not depend on whether the hits are checked one by one or in bulk.
+  for (size_t iHit = 0; iHit < nHits; ++iHit) {
+    float rMin = yMin * r2[iHit] / 2;
+    float rMax = yMax * r2[iHit] / 2;
+
+    // compute sinograms at the left and right borders of the node
+    float rHitMin = cosMin * x[iHit] + sinMin * y[iHit];
+    float rHitMax = cosMax * x[iHit] + sinMax * y[iHit];
+
+    float rHitMinRight = rHitMin - l[iHit];
+    float rHitMaxRight = rHitMax - l[iHit];
+
+    float rHitMinLeft = rHitMin + l[iHit];
+    float rHitMaxLeft = rHitMax + l[iHit];
+
+    // Compare distance signs from sinograms to the bottom and top borders of the node
+    float distRight00 = rMin - rHitMinRight;
+    float distRight01 = rMin - rHitMaxRight;
+    float distRight10 = rMax - rHitMinRight;
+    float distRight11 = rMax - rHitMaxRight;
+    bool crossesRight = not sameSign(distRight00, distRight01, distRight10, distRight11);
+
+    float distLeft00 = rMin - rHitMinLeft;
+    float distLeft01 = rMin - rHitMaxLeft;
+    float distLeft10 = rMax - rHitMinLeft;
+    float distLeft11 = rMax - rHitMaxLeft;
+    bool crossesLeft = not sameSign(distLeft00, distLeft01, distLeft10, distLeft11);
+
+    // Derivative of the sinograms at the borders, also used for the extremum
+    float rHitMinExtr = cosMin * y[iHit] - sinMin * x[iHit];
+    float rHitMaxExtr = cosMax * y[iHit] - sinMax * x[iHit];
+    bool forward = ((rHitMinExtr > 0) & (rHitMaxExtr * rHitMinExtr >= 0)) | (rHitMaxExtr * rHitMinExtr < 0);
+    bool hasExtremum = rHitMinExtr * rHitMaxExtr < 0.;
+
+    EClassification classification = (crossesRight | crossesLeft) ? c_InNode : (hasExtremum ? c_CheckExtremum : c_NotInNode);
+    inNode[iHit] = (forward | not checkForward) ? classification : c_NotInNode;
+  }
 }
 
 bool AxialHitQuadTreeProcessor::checkDerivative(QuadTree* node, const CDCWireHit* wireHit) const
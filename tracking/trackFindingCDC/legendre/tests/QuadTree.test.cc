@@ -10,6 +10,8 @@
 #include <tracking/trackFindingCDC/legendre/quadtree/AxialHitQuadTreeProcessor.h>
 #include <tracking/trackFindingCDC/legendre/precisionFunctions/PrecisionUtil.h>
 
+#include <framework/utilities/TaskPool.h>
+
 #include <vector>
 #include <gtest/gtest.h>
 
@@ -70,4 +72,44 @@ namespace {
     EXPECT_GE(candidates[0].size(), 30);
     EXPECT_GE(candidates[1].size(), 30);
   }
+
+  /// Test that recycling the nodes and filling the seed level concurrently does not change the candidates
+  TEST_F(TrackFindingCDCTestWithSimpleSimulation, legendre_QuadTreeReuseAndTaskPoolTest)
+  {
+    using XYSpans = AxialHitQuadTreeProcessor::XYSpans;
+    const int maxTheta = std::pow(2, PrecisionUtil::getLookupGridLevel());
+    XYSpans xySpans({0, maxTheta}, { -0.02, 0.14});
+    PrecisionUtil::PrecisionFunction precisionFunction = &PrecisionUtil::getOriginCurvPrecision;
+
+    using Candidate = std::vector<const CDCWireHit*>;
+    this->loadPreparedEvent();
+
+    AxialHitQuadTreeProcessor qtProcessor(12, 4, xySpans, precisionFunction);
+    auto findCandidates = [&]() {
+      std::vector<Candidate> candidates;
+      auto candidateReceiver = [&candidates](const Candidate & candidate, void*) {
+        candidates.push_back(candidate);
+      };
+      for (const CDCWireHit* wireHit : m_axialWireHits) {
+        (*wireHit)->unsetTakenFlag();
+        (*wireHit)->unsetMaskedFlag();
+      }
+      qtProcessor.clear();
+      qtProcessor.seed(m_axialWireHits);
+      qtProcessor.fill(candidateReceiver, 30);
+      return candidates;
+    };
+
+    const std::vector<Candidate> serialCandidates = findCandidates();
+    ASSERT_EQ(m_mcTracks.size(), serialCandidates.size());
+
+    // Second event with recycled nodes
+    EXPECT_EQ(serialCandidates, findCandidates());
+
+    // Seed level filled by other threads
+    TaskPool taskPool(3);
+    qtProcessor.setTaskPool(&taskPool);
+    EXPECT_EQ(serialCandidates, findCandidates());
+    qtProcessor.setTaskPool(nullptr);
+  }
 }
@@ -42,8 +42,13 @@ namespace Belle2 {
       /// Evaluate the MVA method and return the MVAOutput
       double predict();
 
-      /// Evaluate the MVA method and return the MVAOutput for multiple inputs at the same time
-      std::vector<float> predict(float* /* test_data */, int /* nFeature */, int nRows);
+      /**
+       *  Evaluate the MVA method and return the MVAOutput for multiple inputs at the same time
+       *  @param test_data   Feature values of all inputs, row by row in the order of getVariableNames()
+       *  @param nFeature    Number of features per input
+       *  @param nRows       Number of inputs
+       */
+      std::vector<float> predict(const float* test_data, int nFeature, int nRows);
 
       /// Get selected variable names
       std::vector<std::string> getVariableNames();
@@ -19,6 +19,7 @@ namespace Belle2 {
   namespace MVA {
     class Expert;
     class SingleDataset;
+    class BatchDataset;
     class Weightfile;
   }
 
@@ -32,7 +33,7 @@ namespace Belle2 {
       void beginRun(); /**< Called once before a new run begins */
       std::unique_ptr<MVA::Weightfile> getWeightFile(); /**< Get the weight file */
       double predict(); /**< Get the MVA prediction */
-      std::vector<float> predict(float* /* test_data */, int /* nFeature */, int /* nRows */); /** Get predictions for several inputs */
+      std::vector<float> predict(const float* /* test_data */, int /* nFeature */, int /* nRows */); /**< Get predictions for several inputs */
       std::vector<std::string> getVariableNames();
     private:
       /// References to the all named values from the source variable set.
@@ -50,6 +51,9 @@ namespace Belle2 {
       /// Pointer to the current dataset
       std::unique_ptr<MVA::Dataset> m_dataset;
 
+      /// Dataset holding the feature matrix of the current batch, its memory is reused for all batches
+      std::unique_ptr<MVA::BatchDataset> m_batchDataset;
+
       /// General options
       MVA::GeneralOptions m_generalOptions;
 
@@ -66,6 +70,7 @@ namespace Belle2 {
 #include <framework/logging/Logger.h>
 
 #include <algorithm>
+#include <cmath>
 
 using namespace Belle2;
 using namespace TrackFindingCDC;
@@ -131,6 +136,7 @@ void MVAExpert::Impl::beginRun()
     std::vector<float> dummy;
     dummy.resize(m_selectedNamedVariables.size(), 0);
     m_dataset = std::make_unique<MVA::SingleDataset>(m_generalOptions, std::move(dummy), 0);
+    m_batchDataset = std::make_unique<MVA::BatchDataset>(m_generalOptions);
   } else {
     B2ERROR("Could not find weight file for identifier " << m_identifier);
   }
@@ -161,20 +167,22 @@ double MVAExpert::Impl::predict()
   return m_expert->apply(*m_dataset)[0];
 }
 
-std::vector<float> MVAExpert::Impl::predict(float* test_data, int nFeature, int nRows)   /** Get predictions for several inputs */
+std::vector<float> MVAExpert::Impl::predict(const float* test_data, int nFeature, int nRows)
 {
-  std::vector<std::vector<float>> spectators;
-  std::vector<std::vector <float> > data;
-  data.resize(nRows);
-  for (int iRow = 0; iRow < nRows; iRow += 1) {
-    data[iRow].resize(nFeature);
-    for (int iFeature = 0; iFeature < nFeature; iFeature += 1) {
-      data[iRow][iFeature] = test_data[nFeature * iRow + iFeature];
-    }
+  if (not m_expert) {
+    B2ERROR("MVA Expert is not loaded! I will return NAN");
+    return std::vector<float>(nRows, NAN);
   }
+  B2ASSERT("Number of features mismatch", nFeature == static_cast<int>(m_batchDataset->getNumberOfFeatures()));
 
-  MVA::MultiDataset dataSet(m_generalOptions, data, spectators);
-  return m_expert->apply(dataSet);
+  // Copy the rows into the batch dataset without reallocating it
+  m_batchDataset->clear();
+  m_batchDataset->reserve(nRows);
+  for (int iRow = 0; iRow < nRows; iRow += 1) {
+    const float* row = test_data + nFeature * iRow;
+    std::copy(row, row + nFeature, m_batchDataset->addEvent());
+  }
+  return m_expert->apply(*m_batchDataset);
 }
 
 std::vector<std::string> MVAExpert::Impl::getVariableNames()
@@ -215,7 +223,7 @@ double MVAExpert::predict()
   return m_impl->predict();
 }
 
-std::vector<float> MVAExpert::predict(float* test_data, int nFeature, int nRows)
+std::vector<float> MVAExpert::predict(const float* test_data, int nFeature, int nRows)
 {
   return m_impl->predict(test_data, nFeature, nRows);
 }
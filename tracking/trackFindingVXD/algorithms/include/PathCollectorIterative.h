@@ -0,0 +1,290 @@
+/**************************************************************************
+ * basf2 (Belle II Analysis Software Framework)                           *
+ * Author: The Belle II Collaboration                                     *
+ *                                                                        *
+ * See git log for contributors and copyright holders.                    *
+ * This file is licensed under LGPL-3.0, see LICENSE.md.                  *
+ **************************************************************************/
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <sstream>
+
+#include <framework/logging/Logger.h>
+
+namespace Belle2 {
+
+  /** Path finder for generic ContainerType.
+   *
+   * Collects all paths starting at the seeds of a network with a depth first search using an explicit stack
+   * and returns a vector of paths, which are vectors of NodeType*.
+   *
+   * The paths of a seed are not copied at each branch, instead they are stored as a tree of path nodes,
+   * where each path node only knows the network node and its parent, so all paths of a seed share their common prefixes.
+   * Only the accepted paths are converted to vectors once the seed is done and the tree is reused for the next seed.
+   * The path limit is checked whenever a path is accepted, so the search stops as soon as it is exceeded
+   * and not only after the seed is done.
+   *
+   * The paths are returned in the same order as the former recursive path collector returned them.
+   *
+   * Optionally only the best maxPathsPerSeed paths of each seed are kept, where longer paths are better
+   * and the earlier found one is kept for paths of the same length. Branches which can not yield a path
+   * better than the ones already kept are pruned early using the CA state of the nodes, which is the
+   * maximal number of nodes which can still follow a node.
+   *
+   * Requirements for ContainerType:
+   * - must have begin() and end() with iterator pointing to pointers of entries ( = ContainerType< NodeType*>)
+   *
+   * Requirements for NodeType:
+   * - must have function: bool NodeType::getMetaInfo().isSeed()
+   * - must have function: unsigned int NodeType::getMetaInfo().getState()
+   * - must have function: NodeType::getInnerNodes() returning a container of NodeType* with size() and operator []
+   * - must have function: bool NodeType::getOuterNodes().empty()
+   * - other requirements depend on NodeCompatibilityCheckerType used.
+   *
+   * Requirements for NodeCompatibilityCheckerType:
+   * - must have function bool areCompatible(NodeType* outerNode, NodeType* innerNode);
+   */
+  template<class ContainerType, class NodeType, class NodeCompatibilityCheckerType>
+  class PathCollectorIterative {
+  public:
+    /// Using Path for vector of pointers to NodeTypes
+    using Path = std::vector<NodeType*>;
+
+
+    /** Main functionality of this class
+     * Evaluates provided network and creates all allowed paths.
+     * All found paths are filled into the provided vector 'paths', which is cleared before.
+     * If storeSubsets is turned on, also the sub-paths are saved to vector 'paths'.
+     * If a defined limit on the number of possible paths is exceeded, the search is aborted immediately,
+     * 'paths' is left empty and false is returned.
+     */
+    // cppcheck-suppress constParameter
+    bool findPaths(ContainerType& aNetwork, std::vector<Path>& paths, unsigned int pathLimit, bool storeSubsets = false)
+    {
+      m_storeSubsets = storeSubsets;
+      paths.clear();
+
+      for (NodeType* aNode : aNetwork) {
+        if (aNode->getMetaInfo().isSeed() == false) {
+          continue;
+        }
+
+        if (aNode->getInnerNodes().empty()) {
+          continue;
+        }
+        if (aNode->getOuterNodes().empty()) {
+          nTrees++;
+        }
+
+        if (not findPathsOfSeed(aNode, paths.size(), pathLimit)) {
+          B2WARNING("Number of collected paths is too large: skipping the event and not processing it."
+                    << LogVar("Number of node paths", paths.size() + m_acceptedPaths.size())
+                    << LogVar("Current limit of paths", pathLimit));
+          paths.clear();
+          return false;
+        }
+
+        for (const AcceptedPath& acceptedPath : m_acceptedPaths) {
+          paths.push_back(createPath(acceptedPath));
+        }
+      }
+      return true;
+    }
+
+
+    /// Prints information about all paths provided in a vector of paths
+    static std::string printPaths(const std::vector<Path>& allPaths)
+    {
+      std::stringstream out;
+      unsigned int longestPath = 0, longesPathIndex = 0, index = 0;
+      out << "Print " << allPaths.size() << " paths:";
+      for (Path const& aPath : allPaths) {
+        if (longestPath < aPath.size()) {
+          longestPath = aPath.size();
+          longesPathIndex = index;
+        }
+        out << "\n" << "path " << index << ": length " << aPath.size() << ", entries:\n";
+        for (auto* entry : aPath) {
+          out << entry->getEntry() << "| ";
+        }
+        index++;
+      }
+      out << "\n" << "longest path was " << longesPathIndex << " with length of " << longestPath << "\n";
+
+      return out.str();
+    }
+
+
+  protected:
+    /// Node of the tree of paths of one seed: the path to this node is the path to the parent followed by this node
+    struct PathNode {
+      /// Node of the network
+      NodeType* node;
+      /// Index of the parent path node, c_noParent for the seed
+      std::uint32_t parent;
+      /// Number of nodes in the path up to and including this node
+      std::uint32_t length;
+    };
+
+    /// A path accepted for the current seed
+    struct AcceptedPath {
+      /// Index of the last path node of the path
+      std::uint32_t pathNode;
+      /// Number of nodes in the path
+      std::uint32_t length;
+      /// Position of the path in the order of the depth first search
+      std::uint32_t order;
+    };
+
+    /// Parent of the path node of the seed
+    static constexpr std::uint32_t c_noParent = UINT32_MAX;
+
+    /// Paths longer than this are not continued
+    static constexpr std::uint32_t c_maxPathLength = 30;
+
+    /** Collects the accepted paths starting at the given seed into m_acceptedPaths in the order of the depth first search.
+     * Returns false as soon as nPreviousPaths plus the number of accepted paths exceeds the pathLimit.
+     */
+    bool findPathsOfSeed(NodeType* seed, size_t nPreviousPaths, unsigned int pathLimit)
+    {
+      m_pathNodes.clear();
+      m_stack.clear();
+      m_acceptedPaths.clear();
+      std::uint32_t nFound = 0;
+
+      m_pathNodes.push_back({seed, c_noParent, 1});
+      m_stack.push_back(0);
+
+      while (not m_stack.empty()) {
+        const std::uint32_t iPathNode = m_stack.back();
+        m_stack.pop_back();
+        nVisitedNodes++;
+
+        NodeType* node = m_pathNodes[iPathNode].node;
+        const std::uint32_t length = m_pathNodes[iPathNode].length;
+
+        if (isPruned(node, length)) {
+          continue;
+        }
+
+        bool isLeaf = true;
+        if (length > c_maxPathLength) {
+          B2WARNING("PathCollectorIterative reached a path length of over " << c_maxPathLength << ". Stopping Path here!");
+        } else {
+          // the viable neighbours are pushed in reverse order, so they are visited in the order of the network
+          const auto& innerNeighbours = node->getInnerNodes();
+          for (size_t iNeighbour = innerNeighbours.size(); iNeighbour > 0; --iNeighbour) {
+            NodeType* innerNode = innerNeighbours[iNeighbour - 1];
+            if (m_compatibilityChecker.areCompatible(node, innerNode)) {
+              m_stack.push_back(m_pathNodes.size());
+              m_pathNodes.push_back({innerNode, iPathNode, length + 1});
+              isLeaf = false;
+            }
+          }
+        }
+
+        // only complete paths are stored, if the current path continues it is only stored as a subset
+        if ((isLeaf or m_storeSubsets) and length >= minPathLength) {
+          acceptPath({iPathNode, length, nFound++});
+          if (nPreviousPaths + m_acceptedPaths.size() > pathLimit) {
+            return false;
+          }
+        }
+      }
+
+      if (maxPathsPerSeed != 0) {
+        std::sort(m_acceptedPaths.begin(), m_acceptedPaths.end(),
+        [](const AcceptedPath & lhs, const AcceptedPath & rhs) { return lhs.order < rhs.order; });
+      }
+      return true;
+    }
+
+
+    /** Ordering of the accepted paths for the best-N selection: true if lhs is better than rhs,
+     * so the worst path is at the front of the heap. */
+    static bool isBetter(const AcceptedPath& lhs, const AcceptedPath& rhs)
+    {
+      if (lhs.length != rhs.length) return lhs.length > rhs.length;
+      return lhs.order < rhs.order;
+    }
+
+
+    /// Adds the path to the accepted paths, removing the worst path if more than maxPathsPerSeed are accepted
+    void acceptPath(const AcceptedPath& acceptedPath)
+    {
+      m_acceptedPaths.push_back(acceptedPath);
+      if (maxPathsPerSeed == 0) {
+        return;
+      }
+      std::push_heap(m_acceptedPaths.begin(), m_acceptedPaths.end(), isBetter);
+      if (m_acceptedPaths.size() > maxPathsPerSeed) {
+        std::pop_heap(m_acceptedPaths.begin(), m_acceptedPaths.end(), isBetter);
+        m_acceptedPaths.pop_back();
+      }
+    }
+
+
+    /** Checks if no path through the node with the given path length can replace one of the accepted paths.
+     * The CA state of the node is the maximal number of nodes which can still follow it.
+     */
+    bool isPruned(NodeType* node, std::uint32_t length) const
+    {
+      if (maxPathsPerSeed == 0 or m_acceptedPaths.size() < maxPathsPerSeed) {
+        return false;
+      }
+      const std::uint32_t maxLength = length + node->getMetaInfo().getState();
+      // paths of the same length are found later than the accepted ones, so they can not replace them either
+      return maxLength <= m_acceptedPaths.front().length;
+    }
+
+
+    /// Converts an accepted path from the tree of path nodes to a path starting at the seed
+    Path createPath(const AcceptedPath& acceptedPath) const
+    {
+      Path path(acceptedPath.length);
+      std::uint32_t iPathNode = acceptedPath.pathNode;
+      for (auto it = path.rbegin(); it != path.rend(); ++it) {
+        *it = m_pathNodes[iPathNode].node;
+        iPathNode = m_pathNodes[iPathNode].parent;
+      }
+      return path;
+    }
+
+  public:
+    /// public Data members:
+    /** parameter for setting minimal path length:
+     * path length == number of nodes collected in a row from given network, this is not necessarily number of hits! */
+    unsigned int minPathLength = 2;
+
+    /** parameter for setting the maximal number of paths stored per seed, only the longest ones are kept.
+     * 0 means all paths are stored. */
+    unsigned int maxPathsPerSeed = 0;
+
+    /// Counter for number of trees found
+    unsigned int nTrees = 0;
+
+    /// Counter for number of nodes visited during the search
+    unsigned int nVisitedNodes = 0;
+
+    /// flag if subsets should be stored or not
+    bool m_storeSubsets = false;
+
+  protected:
+    /// protected Data members:
+    /** Stores mini-Class for checking compatibility of two nodes passed. */
+    NodeCompatibilityCheckerType m_compatibilityChecker;
+
+    /// Tree of the paths of the current seed, reused for all seeds
+    std::vector<PathNode> m_pathNodes;
+
+    /// Stack of the path nodes still to be visited
+    std::vector<std::uint32_t> m_stack;
+
+    /// Paths accepted for the current seed, a heap with the worst path at the front if maxPathsPerSeed is set
+    std::vector<AcceptedPath> m_acceptedPaths;
+  };
+}
@@ -17,7 +17,7 @@
 #include <tracking/trackFindingVXD/segmentNetwork/CACell.h>
 #include <tracking/trackFindingVXD/algorithms/CellularAutomaton.h>
 #include <tracking/trackFindingVXD/algorithms/CAValidator.h>
-#include <tracking/trackFindingVXD/algorithms/PathCollectorRecursive.h>
+#include <tracking/trackFindingVXD/algorithms/PathCollectorIterative.h>
 #include <tracking/trackFindingVXD/algorithms/NodeCompatibilityCheckerPathCollector.h>
 
 
@@ -31,7 +31,7 @@ using namespace Belle2;
 namespace CellularAutomatonTests {
 
 
-  /// Test class demonstrating the behavior of The Cellular Automaton and the PathCollectorRecursive
+  /// Test class demonstrating the behavior of The Cellular Automaton and the PathCollectorIterative
   class CellularAutomatonTest : public ::testing::Test {
   protected:
 
@@ -39,9 +39,9 @@ namespace CellularAutomatonTests {
 
 
   /** Test without external mockup. Fills a DirectedNodeNetwork< int, CACell> to be able to apply a CA,
-  * find seeds and collect the Paths using PathCollectorRecursive:
+  * find seeds and collect the Paths using PathCollectorIterative:
   */
-  TEST(CellularAutomatonTest, TestCAAndPathCollectorRecursiveUsingDirectedNodeNetworkInt)
+  TEST(CellularAutomatonTest, TestCAAndPathCollectorIterativeUsingDirectedNodeNetworkInt)
   {
     // just some input for testing (same as in DirectedNodeNetwork-tests):
     std::array<int, 5> intArray  = { { 2, 5, 3, 4, 99} };
@@ -126,10 +126,9 @@ namespace CellularAutomatonTests {
               nRounds); // CA starts counting with 1, not with 0, the length of the paths is the number of Cells stored in it. the last round is an empty round.
     EXPECT_EQ(13, nSeeds);
 
-    typedef PathCollectorRecursive <
+    typedef PathCollectorIterative <
     DirectedNodeNetwork<int, CACell>,
                         DirectedNode<int, CACell>,
-                        std::vector<DirectedNode<int, CACell>*>,
                         NodeCompatibilityCheckerPathCollector<DirectedNode<int, CACell>> > PathCollectorType;
 
 
@@ -143,7 +142,7 @@ namespace CellularAutomatonTests {
     B2INFO(out);
 
     // there could be more paths than seeds: why?
-    // -> the pathCollectorRecursive based on the CA also adds alternative paths with the same length.
+    // -> the path collector based on the CA also adds alternative paths with the same length.
     EXPECT_EQ(13, paths.size());
     unsigned int longestPath = 0;
     for (auto& aPath : paths) {
@@ -166,5 +165,26 @@ namespace CellularAutomatonTests {
     paths.clear();
     test = pathCollector.findPaths(intNetwork, paths, 10);
     EXPECT_EQ(false, test); // Should return false, as 13 paths exceed the given limit of 10
+    EXPECT_EQ(0, paths.size()); // no partial result is returned
+
+    // keeping only the best path of each seed: the longest one, the first one found for paths of the same length
+    std::vector< PathCollectorType::Path> allPaths;
+    pathCollector.findPaths(intNetwork, allPaths, 100000000, true);
+    pathCollector.maxPathsPerSeed = 1;
+    paths.clear();
+    test = pathCollector.findPaths(intNetwork, paths, 13, true);
+    EXPECT_EQ(true, test);
+    EXPECT_EQ(13, paths.size()); // the subsets are shorter than the full path of each seed
+
+    for (auto& aPath : paths) {
+      const PathCollectorType::Path* bestPath = nullptr;
+      for (auto& otherPath : allPaths) {
+        if (otherPath.front() == aPath.front() and (bestPath == nullptr or bestPath->size() < otherPath.size())) {
+          bestPath = &otherPath;
+        }
+      }
+      ASSERT_NE(nullptr, bestPath);
+      EXPECT_EQ(*bestPath, aPath);
+    }
   }
 }
@@ -0,0 +1,187 @@
+/**************************************************************************
+ * basf2 (Belle II Analysis Software Framework)                           *
+ * Author: The Belle II Collaboration                                     *
+ *                                                                        *
+ * See git log for contributors and copyright holders.                    *
+ * This file is licensed under LGPL-3.0, see LICENSE.md.                  *
+ **************************************************************************/
+
+#include <tracking/trackFindingVXD/segmentNetwork/DirectedNodeNetwork.h>
+#include <tracking/trackFindingVXD/segmentNetwork/CACell.h>
+#include <tracking/trackFindingVXD/algorithms/CellularAutomaton.h>
+#include <tracking/trackFindingVXD/algorithms/CAValidator.h>
+#include <tracking/trackFindingVXD/algorithms/PathCollectorIterative.h>
+#include <tracking/trackFindingVXD/algorithms/NodeCompatibilityCheckerPathCollector.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace Belle2;
+
+namespace {
+  /** Segment network with the same node and meta info types as in the SegmentNetworkProducerModule. */
+  using Network = DirectedNodeNetwork<std::int64_t, CACell>;
+  /** Node of the segment network */
+  using Node = DirectedNode<std::int64_t, CACell>;
+
+  /** Number of VXD layers */
+  const int c_nLayers = 6;
+
+  /** Hit of the synthetic event: unique id, layer and azimuthal angle */
+  struct Hit {
+    /** unique id of the hit */
+    std::int64_t id;
+    /** layer of the hit, 0 is the innermost one */
+    int layer;
+    /** azimuthal angle of the hit */
+    double phi;
+  };
+
+  /** Time spent in the steps of the segment network, summed over all events */
+  struct Timing {
+    /** filling the network */
+    double fill = 0;
+    /** cellular automaton and seeding */
+    double ca = 0;
+    /** path collection */
+    double paths = 0;
+    /** number of nodes */
+    size_t nNodes = 0;
+    /** number of collected paths */
+    size_t nPaths = 0;
+  };
+
+  /** Seconds since the given time point */
+  double secondsSince(std::chrono::steady_clock::time_point start)
+  {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  }
+
+  /** Create the hits of one event: nTracks tracks crossing all layers plus nBackground uniformly distributed hits per layer. */
+  std::vector<Hit> createHits(std::mt19937& rng, int nTracks, int nBackground)
+  {
+    std::uniform_real_distribution<double> uniformPhi(-M_PI, M_PI);
+    std::normal_distribution<double> curvature(0, 0.02);
+    std::vector<Hit> hits;
+    for (int track = 0; track < nTracks; track++) {
+      const double phi0 = uniformPhi(rng);
+      const double dphi = curvature(rng);
+      for (int layer = 0; layer < c_nLayers; layer++) {
+        hits.push_back({static_cast<std::int64_t>(hits.size()), layer, phi0 + layer * dphi});
+      }
+    }
+    for (int layer = 0; layer < c_nLayers; layer++) {
+      for (int i = 0; i < nBackground; i++) {
+        hits.push_back({static_cast<std::int64_t>(hits.size()), layer, uniformPhi(rng)});
+      }
+    }
+    return hits;
+  }
+
+  /** Whether two hits are in compatible sectors, i.e. close in phi, as a stand-in for the sector map */
+  bool areNeighbours(const Hit& outer, const Hit& inner, double window)
+  {
+    return std::abs(std::remainder(outer.phi - inner.phi, 2 * M_PI)) < window;
+  }
+
+  /** Fill, evaluate and collect the paths of the segment network for each event. */
+  Timing runEvents(const std::vector<std::vector<Hit>>& events, double window)
+  {
+    Timing timing;
+    for (const std::vector<Hit>& hits : events) {
+      // the compatible inner hits stand in for the sector map and are not part of the timing
+      std::vector<std::vector<const Hit*>> innerHits(hits.size());
+      for (const Hit& outerHit : hits) {
+        for (const Hit& innerHit : hits) {
+          if (innerHit.layer + 1 == outerHit.layer and areNeighbours(outerHit, innerHit, window)) {
+            innerHits[outerHit.id].push_back(&innerHit);
+          }
+        }
+      }
+
+      auto start = std::chrono::steady_clock::now();
+      Network network;
+      std::deque<std::int64_t> segments;
+      // same filling scheme as in the SegmentNetworkProducerModule: outer segment linked to all compatible inner segments
+      for (const Hit& outerHit : hits) {
+        for (const Hit* centerHit : innerHits[outerHit.id]) {
+          const std::int64_t outerSegmentID = outerHit.id << 32 | centerHit->id;
+          bool wasAnythingFoundSoFar = false;
+          for (const Hit* innerHit : innerHits[centerHit->id]) {
+            const std::int64_t innerSegmentID = centerHit->id << 32 | innerHit->id;
+            if (not network.isNodeInNetwork(innerSegmentID)) {
+              segments.push_back(innerSegmentID);
+              network.addNode(innerSegmentID, segments.back());
+            }
+            if (not network.isNodeInNetwork(outerSegmentID)) {
+              segments.push_back(outerSegmentID);
+              network.addNode(outerSegmentID, segments.back());
+            }
+            if (not wasAnythingFoundSoFar) {
+              wasAnythingFoundSoFar = network.linkNodes(outerSegmentID, innerSegmentID);
+            } else {
+              network.addInnerToLastOuterNode(innerSegmentID);
+            }
+          }
+        }
+      }
+      timing.nNodes += network.getNodes().size();
+      timing.fill += secondsSince(start);
+
+      start = std::chrono::steady_clock::now();
+      CellularAutomaton<Network, CAValidator<CACell>> cellularAutomaton;
+      if (cellularAutomaton.apply(network) < 0) {
+        std::cerr << "Cellular automaton failed\n";
+      }
+      cellularAutomaton.findSeeds(network);
+      timing.ca += secondsSince(start);
+
+      start = std::chrono::steady_clock::now();
+      PathCollectorIterative<Network, Node, NodeCompatibilityCheckerPathCollector<Node>> pathCollector;
+      std::vector<std::vector<Node*>> paths;
+      pathCollector.findPaths(network, paths, 50000);
+      timing.nPaths += paths.size();
+      timing.paths += secondsSince(start);
+    }
+    return timing;
+  }
+}
+
+/** Time filling the VXDTF2 segment network, the cellular automaton and the path collection
+ * for synthetic events with nominal and doubled background.
+ *
+ * The sector map is replaced by a window in phi, so only the scaling with the occupancy is meaningful,
+ * the absolute numbers are not those of the full reconstruction.
+ *
+ * Usage: tracking-vxdtf2-network_benchmark [number of events]
+ */
+int main(int argc, char* argv[])
+{
+  const int nEvents = (argc > 1) ? std::atoi(argv[1]) : 200;
+  if (nEvents <= 0) {
+    std::cerr << "Usage: " << argv[0] << " [number of events]\n";
+    return 1;
+  }
+  const int nTracks = 10;
+  const int nominalBackground = 300;
+  const double window = 0.008;
+  for (int backgroundScale : {1, 2}) {
+    std::mt19937 rng(42);
+    std::vector<std::vector<Hit>> events;
+    for (int i = 0; i < nEvents; i++) {
+      events.push_back(createHits(rng, nTracks, backgroundScale * nominalBackground));
+    }
+    const Timing timing = runEvents(events, window);
+    std::cout << backgroundScale << "x background: " << timing.nNodes / nEvents << " segments, "
+              << timing.nPaths / nEvents << " paths per event; fill " << 1e6 * timing.fill / nEvents
+              << " us, CA " << 1e6 * timing.ca / nEvents
+              << " us, paths " << 1e6 * timing.paths / nEvents << " us per event\n";
+  }
+  return 0;
+}